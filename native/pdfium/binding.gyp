@@ -4,9 +4,38 @@
       "target_name": "pdfium",
       "sources": [
         "src/addon.cc",
+        "src/analyze.cc",
         "src/document.cc",
         "src/render.cc",
-        "src/objects.cc"
+        "src/layers.cc",
+        "src/objects.cc",
+        "src/outline.cc",
+        "src/previews.cc",
+        "src/thumbnails.cc",
+        "src/fonts.cc",
+        "src/measure.cc",
+        "src/drag.cc",
+        "src/ink.cc",
+        "src/annotations.cc",
+        "src/jobs.cc",
+        "src/flatten.cc",
+        "src/rasterize.cc",
+        "src/textpage.cc",
+        "src/textgeometry.cc",
+        "src/redact.cc",
+        "src/redactmatch.cc",
+        "src/replace.cc",
+        "src/regexsearch.cc",
+        "src/merge.cc",
+        "src/pdfscan.cc",
+        "src/inflate.cc",
+        "src/deflate.cc",
+        "src/png.cc",
+        "src/extract.cc",
+        "src/compare.cc",
+        "src/ocr.cc",
+        "src/sha256.cc",
+        "src/sign.cc"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -63,6 +92,68 @@
           "cflags_cc": ["-std=c++17", "-fexceptions"]
         }]
       ]
+    },
+    {
+      "target_name": "pdfium_tests",
+      "type": "executable",
+      "sources": [
+        "test/main.cc",
+        "test/pdfscan_test.cc",
+        "test/inflate_test.cc",
+        "test/png_test.cc",
+        "test/regexsearch_test.cc",
+        "test/sha256_test.cc",
+        "test/layers_test.cc",
+        "test/redactmatch_test.cc",
+        "src/pdfscan.cc",
+        "src/inflate.cc",
+        "src/deflate.cc",
+        "src/png.cc",
+        "src/regexsearch.cc",
+        "src/redactmatch.cc",
+        "src/sha256.cc",
+        "src/layers.cc"
+      ],
+      "include_dirs": [
+        "src",
+        "vendor"
+      ],
+      "cflags!": ["-fno-exceptions"],
+      "cflags_cc!": ["-fno-exceptions"],
+      "conditions": [
+        ["OS=='win'", {
+          "libraries": [
+            "<(module_root_dir)/vendor/pdfium.dll.lib"
+          ],
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "ExceptionHandling": 1,
+              "AdditionalOptions": ["/std:c++17"]
+            }
+          }
+        }],
+        ["OS=='mac'", {
+          "libraries": [
+            "-L<(module_root_dir)/vendor",
+            "-lpdfium"
+          ],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+            "MACOSX_DEPLOYMENT_TARGET": "10.15",
+            "OTHER_LDFLAGS": ["-Wl,-rpath,@loader_path"]
+          }
+        }],
+        ["OS=='linux'", {
+          "libraries": [
+            "-L<(module_root_dir)/vendor",
+            "-lpdfium"
+          ],
+          "ldflags": ["-Wl,-rpath,'$$ORIGIN'"],
+          "cflags_cc": ["-std=c++17", "-fexceptions"]
+        }]
+      ]
     }
   ]
 }
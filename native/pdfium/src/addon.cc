@@ -5,9 +5,30 @@
  */
 
 #include "common.h"
+#include "analyze.h"
+#include "annotations.h"
+#include "compare.h"
 #include "document.h"
+#include "drag.h"
+#include "extract.h"
+#include "fonts.h"
+#include "ink.h"
+#include "measure.h"
 #include "render.h"
 #include "objects.h"
+#include "ocr.h"
+#include "outline.h"
+#include "previews.h"
+#include "jobs.h"
+#include "flatten.h"
+#include "merge.h"
+#include "rasterize.h"
+#include "redact.h"
+#include "replace.h"
+#include "sign.h"
+#include "textgeometry.h"
+#include "textpage.h"
+#include "thumbnails.h"
 
 #include <fpdf_edit.h>
 
@@ -17,6 +38,7 @@ std::map<int, FPDF_DOCUMENT> g_documents;
 std::map<int, std::map<int, CachedPage>> g_pageCache;
 int g_nextHandle = 1;
 bool g_initialized = false;
+std::mutex g_pdfiumMutex;
 
 // ── PDFium library lifecycle ────────────────────────────────────────
 
@@ -45,6 +67,18 @@ FPDF_DOCUMENT RequireDocument(Napi::Env env, int handle) {
   return it->second;
 }
 
+bool GetBoolOption(Napi::Value options, const char* key, bool fallback) {
+  if (!options.IsObject()) return fallback;
+  Napi::Value v = options.As<Napi::Object>().Get(key);
+  return v.IsBoolean() ? v.As<Napi::Boolean>().Value() : fallback;
+}
+
+double GetNumberOption(Napi::Value options, const char* key, double fallback) {
+  if (!options.IsObject()) return fallback;
+  Napi::Value v = options.As<Napi::Object>().Get(key);
+  return v.IsNumber() ? v.As<Napi::Number>().DoubleValue() : fallback;
+}
+
 // ── Page cache helpers ──────────────────────────────────────────────
 
 FPDF_PAGE AcquirePage(int handle, FPDF_DOCUMENT doc, int pageIndex,
@@ -70,6 +104,23 @@ void ReleasePage(int handle, int pageIndex, FPDF_PAGE page, bool fromCache) {
 
 void CachePageDirty(int handle, int pageIndex, FPDF_PAGE page) {
   g_pageCache[handle][pageIndex] = { page, true };
+  InvalidateTextPageData(handle, pageIndex);
+}
+
+bool FlushCachedPage(int handle, int pageIndex) {
+  auto docIt = g_pageCache.find(handle);
+  if (docIt == g_pageCache.end()) return true;
+  auto pgIt = docIt->second.find(pageIndex);
+  if (pgIt == docIt->second.end()) return true;
+
+  bool ok = true;
+  if (pgIt->second.dirty) {
+    ok = FPDFPage_GenerateContent(pgIt->second.page) != 0;
+  }
+  FPDF_ClosePage(pgIt->second.page);
+  docIt->second.erase(pgIt);
+  if (docIt->second.empty()) g_pageCache.erase(docIt);
+  return ok;
 }
 
 bool FlushAndCloseCachedPages(int handle) {
@@ -104,6 +155,8 @@ void DiscardCachedPages(int handle) {
  * Closes all open documents and destroys the PDFium library.
  */
 static void Cleanup(void* /*arg*/) {
+  PdfiumLock lock(g_pdfiumMutex);
+
   // Close all cached pages before closing documents
   for (auto& [handle, pages] : g_pageCache) {
     for (auto& [idx, cp] : pages) {
@@ -113,6 +166,14 @@ static void Cleanup(void* /*arg*/) {
   g_pageCache.clear();
 
   for (auto& [id, doc] : g_documents) {
+    DiscardTextPageData(id);
+    DiscardDragSessions(id);
+    DiscardInkSessions(id);
+    DiscardMeasureCache(id);
+    DiscardImagePreviews(id);
+    DiscardFonts(id);
+    DiscardOutline(id);
+    DiscardThumbnails(id);
     FPDF_CloseDocument(doc);
   }
   g_documents.clear();
@@ -135,20 +196,110 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     Napi::Function::New(env, GetPageCount));
   exports.Set("saveDocument",
     Napi::Function::New(env, SaveDocument));
+  exports.Set("saveDocumentToFile",
+    Napi::Function::New(env, SaveDocumentToFile));
+
+  // Thumbnails
+  exports.Set("getThumbnails",
+    Napi::Function::New(env, GetThumbnails));
+
+  // Outline
+  exports.Set("getOutlineChildren",
+    Napi::Function::New(env, GetOutlineChildren));
+
+  // Signatures
+  exports.Set("prepareSignature",
+    Napi::Function::New(env, PrepareSignature));
+  exports.Set("embedSignature",
+    Napi::Function::New(env, EmbedSignature));
 
   // Rendering
   exports.Set("renderPage",
     Napi::Function::New(env, RenderPage));
+  exports.Set("compositeLayers",
+    Napi::Function::New(env, CompositeLayers));
+  exports.Set("rotateBitmap",
+    Napi::Function::New(env, RotateBitmap));
+  exports.Set("filterBitmap",
+    Napi::Function::New(env, FilterBitmap));
+
+  // Text geometry
+  exports.Set("getCharGeometry",
+    Napi::Function::New(env, GetCharGeometry));
 
   // Object inspection & editing
   exports.Set("listPageObjects",
     Napi::Function::New(env, ListPageObjects));
   exports.Set("editTextObject",
     Napi::Function::New(env, EditTextObject));
+  exports.Set("measureText",
+    Napi::Function::New(env, MeasureText));
+  exports.Set("loadFont",
+    Napi::Function::New(env, LoadFont));
+  exports.Set("transformObject",
+    Napi::Function::New(env, TransformObject));
   exports.Set("replaceImageObject",
     Napi::Function::New(env, ReplaceImageObject));
   exports.Set("replaceImageObjectBitmap",
     Napi::Function::New(env, ReplaceImageObjectBitmap));
+  exports.Set("getImageFingerprint",
+    Napi::Function::New(env, GetImageFingerprint));
+  exports.Set("getImagePreview",
+    Napi::Function::New(env, GetImagePreview));
+  exports.Set("prefetchImagePreviews",
+    Napi::Function::New(env, PrefetchImagePreviews));
+
+  // Layered drag previews
+  exports.Set("beginObjectDrag",
+    Napi::Function::New(env, BeginObjectDrag));
+  exports.Set("previewObjectDrag",
+    Napi::Function::New(env, PreviewObjectDrag));
+  exports.Set("endObjectDrag",
+    Napi::Function::New(env, EndObjectDrag));
+
+  // Ink capture & annotation editing
+  exports.Set("beginInk",
+    Napi::Function::New(env, BeginInk));
+  exports.Set("appendInk",
+    Napi::Function::New(env, AppendInk));
+  exports.Set("endInk",
+    Napi::Function::New(env, EndInk));
+  exports.Set("addInkAnnotation",
+    Napi::Function::New(env, AddInkAnnotation));
+  exports.Set("listAnnotations",
+    Napi::Function::New(env, ListAnnotations));
+  exports.Set("updateAnnotations",
+    Napi::Function::New(env, UpdateAnnotations));
+  exports.Set("removeAnnotation",
+    Napi::Function::New(env, RemoveAnnotation));
+
+  // Background document passes
+  exports.Set("flattenDocument",
+    Napi::Function::New(env, FlattenDocument));
+  exports.Set("redactDocument",
+    Napi::Function::New(env, RedactDocument));
+  exports.Set("findReplace",
+    Napi::Function::New(env, FindReplace));
+  exports.Set("profilePages",
+    Napi::Function::New(env, ProfilePages));
+  exports.Set("rasterizePages",
+    Napi::Function::New(env, RasterizePages));
+  exports.Set("analyzeFiles",
+    Napi::Function::New(env, AnalyzeFiles));
+  exports.Set("extractImages",
+    Napi::Function::New(env, ExtractImages));
+  exports.Set("buildThumbnails",
+    Napi::Function::New(env, BuildThumbnails));
+  exports.Set("mailMerge",
+    Napi::Function::New(env, MailMerge));
+  exports.Set("compareDocuments",
+    Napi::Function::New(env, CompareDocuments));
+  exports.Set("renderOcrPages",
+    Napi::Function::New(env, RenderOcrPages));
+  exports.Set("addTextLayer",
+    Napi::Function::New(env, AddTextLayer));
+  exports.Set("cancelJob",
+    Napi::Function::New(env, CancelJob));
 
   // Register cleanup hook for process exit
   napi_add_env_cleanup_hook(env, Cleanup, nullptr);
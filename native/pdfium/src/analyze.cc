@@ -0,0 +1,546 @@
+/**
+ * analyze.cc — analyzeFiles: inventories, stream hashes and content
+ * complexity for many files at once, without PDFium.
+ *
+ * Work is split at two levels.  Files are handed out to up to `threads`
+ * workers; each file then splits its own object pass (inventories and
+ * hashes) and page pass (operator counts) over the threads the file
+ * level leaves idle, so one huge file still uses every core.  Every
+ * worker writes only to its own slot and slots are merged afterwards,
+ * so the passes share nothing but the read-only PdfFile.
+ */
+
+#include "common.h"
+#include "analyze.h"
+#include "jobs.h"
+#include "pdfscan.h"
+#include "sha256.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/** Objects handed to a worker at a time in the object pass. */
+constexpr size_t OBJECT_CHUNK = 256;
+/** Decoded content larger than this is not scanned. */
+constexpr size_t MAX_CONTENT_BYTES = 256u << 20;
+/** Form XObjects nested deeper than this are not followed. */
+constexpr int MAX_FORM_DEPTH = 8;
+
+struct ImageInfo {
+  int object = 0;
+  int width = 0;
+  int height = 0;
+  int bitsPerComponent = 0;
+  std::string colorSpace;   ///< empty for stencil masks
+  std::string filter;       ///< last filter of the chain; empty if none
+  uint64_t bytes = 0;       ///< encoded size
+};
+
+struct FontInfo {
+  int object = 0;
+  std::string baseFont;
+  std::string subtype;
+  bool embedded = false;
+};
+
+struct StreamHash {
+  int object = 0;
+  std::string hash;
+};
+
+/** Object-pass totals of one worker, merged once the pass ends. */
+struct ObjectTally {
+  uint32_t objects = 0;
+  uint32_t streams = 0;
+  uint64_t streamBytes = 0;
+  std::map<std::string, uint32_t> filters;
+  std::vector<ImageInfo> images;
+  std::vector<FontInfo> fonts;
+  std::vector<StreamHash> hashes;
+};
+
+struct FileAnalysis {
+  std::string path;
+  std::string error;
+  std::string version;
+  uint64_t fileSize = 0;
+  XrefSource xref = XrefSource::Table;
+  bool encrypted = false;
+  ObjectTally tally;
+  std::vector<ContentStats> pages;
+};
+
+/**
+ * Run fn(index, worker) for every index in [0, count) on up to
+ * `threads` threads, the calling thread included.  The first exception
+ * stops the remaining work and is rethrown here.
+ */
+template <typename Fn>
+void ParallelFor(size_t count, int threads, Fn fn) {
+  const int n = static_cast<int>(std::max<size_t>(1, std::min<size_t>(threads, count)));
+  std::atomic<size_t> next{0};
+  std::exception_ptr failure;
+  std::mutex failureMutex;
+
+  auto worker = [&](int w) {
+    try {
+      for (size_t i; (i = next.fetch_add(1)) < count;) fn(i, w);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(failureMutex);
+      if (!failure) failure = std::current_exception();
+      next = count;
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int w = 1; w < n; w++) pool.emplace_back(worker, w);
+  worker(0);
+  for (auto& t : pool) t.join();
+  if (failure) std::rethrow_exception(failure);
+}
+
+int IntEntry(const PdfFile& file, const PdfObject& dict, const char* key) {
+  const PdfObject* v = dict.Get(key);
+  return v ? file.Resolve(*v).Int(0) : 0;
+}
+
+std::string NameEntry(const PdfObject& dict, const char* key) {
+  const PdfObject* v = dict.Get(key);
+  return v && v->type == PdfObject::Name ? v->text : std::string();
+}
+
+// ── Object pass ─────────────────────────────────────────────────────
+
+ImageInfo DescribeImage(const PdfFile& file, int num, const PdfObject& dict,
+                        ByteSpan raw) {
+  ImageInfo info;
+  info.object = num;
+  info.width = IntEntry(file, dict, "Width");
+  info.height = IntEntry(file, dict, "Height");
+  info.bitsPerComponent = IntEntry(file, dict, "BitsPerComponent");
+  info.bytes = raw.size;
+
+  const PdfObject* mask = dict.Get("ImageMask");
+  if (!(mask && mask->type == PdfObject::Bool && mask->boolean)) {
+    const PdfObject* cs = dict.Get("ColorSpace");
+    PdfObject space = cs ? file.Resolve(*cs) : PdfObject();
+    if (space.type == PdfObject::Name) {
+      info.colorSpace = space.text;
+    } else if (space.type == PdfObject::Array && !space.items.empty() &&
+               space.items[0].type == PdfObject::Name) {
+      info.colorSpace = space.items[0].text;   // ICCBased, Indexed, ...
+    }
+  }
+
+  std::vector<std::string> filters = StreamFilters(dict);
+  if (!filters.empty()) info.filter = filters.back();
+  return info;
+}
+
+FontInfo DescribeFont(const PdfFile& file, int num, const PdfObject& dict) {
+  FontInfo info;
+  info.object = num;
+  info.baseFont = NameEntry(dict, "BaseFont");
+  info.subtype = NameEntry(dict, "Subtype");
+
+  // Type 3 glyphs are content streams in the file itself.
+  if (info.subtype == "Type3") {
+    info.embedded = true;
+    return info;
+  }
+
+  PdfObject descriptor;
+  if (info.subtype == "Type0") {
+    const PdfObject* kids = dict.Get("DescendantFonts");
+    PdfObject list = kids ? file.Resolve(*kids) : PdfObject();
+    if (list.type == PdfObject::Array && !list.items.empty()) {
+      PdfObject cidFont = file.Resolve(list.items[0]);
+      const PdfObject* fd = cidFont.Get("FontDescriptor");
+      if (fd) descriptor = file.Resolve(*fd);
+    }
+  } else {
+    const PdfObject* fd = dict.Get("FontDescriptor");
+    if (fd) descriptor = file.Resolve(*fd);
+  }
+  info.embedded = descriptor.Get("FontFile") || descriptor.Get("FontFile2") ||
+                  descriptor.Get("FontFile3");
+  return info;
+}
+
+void InspectObject(const PdfFile& file, int num, bool hashStreams,
+                   ObjectTally& tally) {
+  const XrefEntry& entry = file.Entry(num);
+  if (!entry.known || entry.type == 0) return;
+
+  PdfObject obj;
+  ByteSpan raw;
+  if (!file.Load(num, obj, &raw)) return;
+  tally.objects++;
+  if (obj.type != PdfObject::Dict) return;
+
+  const PdfObject* type = obj.Get("Type");
+  const PdfObject* subtype = obj.Get("Subtype");
+
+  if (raw.data) {
+    tally.streams++;
+    tally.streamBytes += raw.size;
+    for (const auto& name : StreamFilters(obj)) tally.filters[name]++;
+
+    if (hashStreams) {
+      Sha256 hash;
+      hash.Update(raw.data, raw.size);
+      tally.hashes.push_back({num, hash.FinalHex()});
+    }
+    if (subtype && subtype->IsName("Image")) {
+      tally.images.push_back(DescribeImage(file, num, obj, raw));
+    }
+    return;
+  }
+
+  // CID fonts are listed through the Type 0 font that uses them.
+  if (type && type->IsName("Font") && subtype && subtype->type == PdfObject::Name &&
+      subtype->text.compare(0, 11, "CIDFontType") != 0) {
+    tally.fonts.push_back(DescribeFont(file, num, obj));
+  }
+}
+
+void MergeTally(ObjectTally& into, ObjectTally& from) {
+  into.objects += from.objects;
+  into.streams += from.streams;
+  into.streamBytes += from.streamBytes;
+  for (const auto& [name, count] : from.filters) into.filters[name] += count;
+  std::move(from.images.begin(), from.images.end(), std::back_inserter(into.images));
+  std::move(from.fonts.begin(), from.fonts.end(), std::back_inserter(into.fonts));
+  std::move(from.hashes.begin(), from.hashes.end(), std::back_inserter(into.hashes));
+}
+
+// ── Page pass ───────────────────────────────────────────────────────
+
+/** What one Do of an XObject adds, by object number. */
+using XObjectCosts = std::map<int, ContentStats>;
+
+/**
+ * Count the operators of `content`, plus those of every form XObject
+ * it draws — once per Do, since each draw is rendered again.
+ */
+ContentStats ScanWithResources(const PdfFile& file, const std::vector<uint8_t>& content,
+                               const PdfObject& resources, XObjectCosts& costs,
+                               int depth) {
+  ContentStats stats;
+  std::vector<std::string> names;
+  ScanContent(content.data(), content.size(), stats, names);
+  if (names.empty()) return stats;
+
+  PdfObject res = file.Resolve(resources);
+  const PdfObject* x = res.Get("XObject");
+  PdfObject xobjects = x ? file.Resolve(*x) : PdfObject();
+
+  for (const auto& name : names) {
+    const PdfObject* ref = xobjects.Get(name.c_str());
+    if (!ref || ref->type != PdfObject::Ref) continue;
+
+    auto it = costs.find(ref->num);
+    if (it != costs.end()) {
+      stats.Add(it->second);
+      continue;
+    }
+
+    // Placeholder first, so a form that draws itself terminates.
+    costs[ref->num] = ContentStats();
+    ContentStats drawn;
+    PdfObject dict;
+    ByteSpan raw;
+    if (file.Load(ref->num, dict, &raw)) {
+      const PdfObject* subtype = dict.Get("Subtype");
+      std::vector<uint8_t> data;
+      if (subtype && subtype->IsName("Image")) {
+        drawn.images = 1;
+      } else if (subtype && subtype->IsName("Form") && depth < MAX_FORM_DEPTH &&
+                 file.DecodeStream(dict, raw, data, MAX_CONTENT_BYTES)) {
+        const PdfObject* formResources = dict.Get("Resources");
+        drawn = ScanWithResources(file, data, formResources ? *formResources : resources,
+                                  costs, depth + 1);
+      }
+    }
+    costs[ref->num] = drawn;
+    stats.Add(drawn);
+  }
+  return stats;
+}
+
+ContentStats ScanPage(const PdfFile& file, const PdfPageRef& page) {
+  // Operators may straddle the streams of a Contents array, so the
+  // streams are joined before scanning.
+  std::vector<int> streams;
+  PdfObject contents = page.contents;
+  if (contents.type == PdfObject::Ref) {
+    PdfObject target;
+    ByteSpan raw;
+    if (file.Load(contents.num, target, &raw) && target.type == PdfObject::Array) {
+      contents = std::move(target);
+    }
+  }
+  if (contents.type == PdfObject::Ref) streams.push_back(contents.num);
+  if (contents.type == PdfObject::Array) {
+    for (const auto& item : contents.items) {
+      if (item.type == PdfObject::Ref) streams.push_back(item.num);
+    }
+  }
+
+  std::vector<uint8_t> content;
+  for (int num : streams) {
+    PdfObject dict;
+    ByteSpan raw;
+    std::vector<uint8_t> data;
+    if (!file.Load(num, dict, &raw) || !raw.data) continue;
+    if (!file.DecodeStream(dict, raw, data, MAX_CONTENT_BYTES)) continue;
+    if (content.size() + data.size() > MAX_CONTENT_BYTES) break;
+    content.insert(content.end(), data.begin(), data.end());
+    content.push_back('\n');
+  }
+
+  XObjectCosts costs;
+  return ScanWithResources(file, content, page.resources, costs, 0);
+}
+
+// ── One file ────────────────────────────────────────────────────────
+
+FileAnalysis AnalyzeFile(const std::string& path, bool hashStreams, int threads,
+                         const std::function<bool()>& cancelled) {
+  FileAnalysis a;
+  a.path = path;
+
+  try {
+    PdfFile file;
+    if (!file.Open(path, a.error)) return a;
+    a.version = file.Version();
+    a.fileSize = file.FileSize();
+    a.xref = file.Source();
+    a.encrypted = file.Encrypted();
+
+    const size_t limit = static_cast<size_t>(file.ObjectLimit());
+    std::vector<ObjectTally> tallies(threads);
+    ParallelFor((limit + OBJECT_CHUNK - 1) / OBJECT_CHUNK, threads, [&](size_t chunk, int w) {
+      if (cancelled()) return;
+      const size_t end = std::min(limit, (chunk + 1) * OBJECT_CHUNK);
+      for (size_t num = chunk * OBJECT_CHUNK; num < end; num++) {
+        InspectObject(file, static_cast<int>(num), hashStreams, tallies[w]);
+      }
+    });
+    for (auto& t : tallies) MergeTally(a.tally, t);
+
+    auto byObject = [](const auto& x, const auto& y) { return x.object < y.object; };
+    std::sort(a.tally.images.begin(), a.tally.images.end(), byObject);
+    std::sort(a.tally.fonts.begin(), a.tally.fonts.end(), byObject);
+    std::sort(a.tally.hashes.begin(), a.tally.hashes.end(), byObject);
+
+    // Encrypted content streams are ciphertext; their pages count zero.
+    std::vector<PdfPageRef> pages = file.Pages();
+    a.pages.resize(pages.size());
+    if (!a.encrypted) {
+      ParallelFor(pages.size(), threads, [&](size_t i, int) {
+        if (!cancelled()) a.pages[i] = ScanPage(file, pages[i]);
+      });
+    }
+  } catch (const std::exception& e) {
+    a.error = path + ": " + e.what();
+  }
+  return a;
+}
+
+// ── AnalyzeJob ──────────────────────────────────────────────────────
+
+const char* XrefName(XrefSource source) {
+  switch (source) {
+    case XrefSource::Table:   return "table";
+    case XrefSource::Stream:  return "stream";
+    case XrefSource::Rebuilt: return "rebuilt";
+  }
+  return "table";
+}
+
+Napi::Uint32Array PageColumn(Napi::Env env, const std::vector<ContentStats>& pages,
+                             uint32_t ContentStats::*field) {
+  auto out = Napi::Uint32Array::New(env, pages.size());
+  for (size_t i = 0; i < pages.size(); i++) out[i] = pages[i].*field;
+  return out;
+}
+
+class AnalyzeJob : public Job {
+ public:
+  AnalyzeJob(Napi::Env env, std::vector<std::string> paths, int threads,
+             bool hashStreams, Napi::Value onProgress)
+    : Job(env, onProgress),
+      paths_(std::move(paths)),
+      threads_(threads),
+      hashStreams_(hashStreams) {}
+
+ protected:
+  void Execute(const ExecutionProgress& progress) override {
+    const int total = static_cast<int>(paths_.size());
+    const int fileThreads = std::max(1, std::min(threads_, total));
+    const int innerThreads = std::max(1, threads_ / fileThreads);
+
+    files_.resize(paths_.size());
+    std::atomic<int> done{0};
+    std::mutex progressMutex;
+    auto cancelled = [this] { return CancelRequested(); };
+
+    ParallelFor(paths_.size(), fileThreads, [&](size_t i, int) {
+      if (CancelRequested()) return;
+      files_[i] = AnalyzeFile(paths_[i], hashStreams_, innerThreads, cancelled);
+
+      std::lock_guard<std::mutex> lock(progressMutex);
+      JobProgress p = { ++done, total };
+      progress.Send(&p, 1);
+    });
+
+    if (CancelRequested()) MarkCancelled();
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Array files = Napi::Array::New(env);
+    uint32_t n = 0;
+    for (const FileAnalysis& a : files_) {
+      if (a.path.empty()) continue;  // not reached before cancellation
+      files[n++] = ToObject(env, a);
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("files", files);
+    return result;
+  }
+
+ private:
+  Napi::Object ToObject(Napi::Env env, const FileAnalysis& a) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("path", a.path);
+    if (!a.error.empty()) {
+      out.Set("error", a.error);
+      return out;
+    }
+
+    const ObjectTally& t = a.tally;
+    out.Set("version", a.version);
+    out.Set("fileSize", Napi::Number::New(env, static_cast<double>(a.fileSize)));
+    out.Set("xref", XrefName(a.xref));
+    out.Set("encrypted", Napi::Boolean::New(env, a.encrypted));
+    out.Set("objects", Napi::Number::New(env, t.objects));
+    out.Set("streams", Napi::Number::New(env, t.streams));
+    out.Set("streamBytes", Napi::Number::New(env, static_cast<double>(t.streamBytes)));
+
+    Napi::Object filters = Napi::Object::New(env);
+    for (const auto& [name, count] : t.filters) {
+      filters.Set(name, Napi::Number::New(env, count));
+    }
+    out.Set("filters", filters);
+
+    Napi::Array images = Napi::Array::New(env, t.images.size());
+    for (size_t i = 0; i < t.images.size(); i++) {
+      const ImageInfo& img = t.images[i];
+      Napi::Object o = Napi::Object::New(env);
+      o.Set("object", Napi::Number::New(env, img.object));
+      o.Set("width", Napi::Number::New(env, img.width));
+      o.Set("height", Napi::Number::New(env, img.height));
+      o.Set("bitsPerComponent", Napi::Number::New(env, img.bitsPerComponent));
+      o.Set("colorSpace", img.colorSpace);
+      o.Set("filter", img.filter);
+      o.Set("bytes", Napi::Number::New(env, static_cast<double>(img.bytes)));
+      images[static_cast<uint32_t>(i)] = o;
+    }
+    out.Set("images", images);
+
+    Napi::Array fonts = Napi::Array::New(env, t.fonts.size());
+    for (size_t i = 0; i < t.fonts.size(); i++) {
+      const FontInfo& font = t.fonts[i];
+      Napi::Object o = Napi::Object::New(env);
+      o.Set("object", Napi::Number::New(env, font.object));
+      o.Set("baseFont", font.baseFont);
+      o.Set("subtype", font.subtype);
+      o.Set("embedded", Napi::Boolean::New(env, font.embedded));
+      fonts[static_cast<uint32_t>(i)] = o;
+    }
+    out.Set("fonts", fonts);
+
+    if (hashStreams_) {
+      Napi::Array hashes = Napi::Array::New(env, t.hashes.size());
+      for (size_t i = 0; i < t.hashes.size(); i++) {
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("object", Napi::Number::New(env, t.hashes[i].object));
+        o.Set("hash", t.hashes[i].hash);
+        hashes[static_cast<uint32_t>(i)] = o;
+      }
+      out.Set("streamHashes", hashes);
+    }
+
+    out.Set("pageCount", Napi::Number::New(env, static_cast<double>(a.pages.size())));
+    Napi::Object pages = Napi::Object::New(env);
+    pages.Set("operators", PageColumn(env, a.pages, &ContentStats::operators));
+    pages.Set("pathSegments", PageColumn(env, a.pages, &ContentStats::pathSegments));
+    pages.Set("paints", PageColumn(env, a.pages, &ContentStats::paints));
+    pages.Set("textShows", PageColumn(env, a.pages, &ContentStats::textShows));
+    pages.Set("images", PageColumn(env, a.pages, &ContentStats::images));
+    out.Set("pages", pages);
+    return out;
+  }
+
+  const std::vector<std::string> paths_;
+  const int threads_;
+  const bool hashStreams_;
+  std::vector<FileAnalysis> files_;
+};
+
+} // namespace
+
+// ── analyzeFiles ────────────────────────────────────────────────────
+
+Napi::Value AnalyzeFiles(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  // No PdfiumLock: nothing here or in the job calls into PDFium.
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env,
+      "analyzeFiles: requires (paths: string[], options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Array pathsArr = info[0].As<Napi::Array>();
+  Napi::Value options    = info.Length() > 1 ? info[1] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 2 ? info[2] : env.Undefined();
+
+  std::vector<std::string> paths(pathsArr.Length());
+  for (uint32_t i = 0; i < pathsArr.Length(); i++) {
+    Napi::Value p = pathsArr.Get(i);
+    if (!p.IsString()) {
+      Napi::TypeError::New(env, "analyzeFiles: paths must be file paths")
+        .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    paths[i] = p.As<Napi::String>().Utf8Value();
+  }
+
+  const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  double threads = GetNumberOption(options, "threads", cores);
+  if (!(threads >= 1)) {
+    Napi::RangeError::New(env, "analyzeFiles: threads must be >= 1")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto* job = new AnalyzeJob(env, std::move(paths),
+                             static_cast<int>(std::min<double>(threads, 256)),
+                             GetBoolOption(options, "hashStreams", false),
+                             onProgress);
+  return job->Start();
+}
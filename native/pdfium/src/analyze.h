@@ -0,0 +1,25 @@
+/**
+ * analyze.h — Structural analysis of PDF files across all cores.
+ */
+#ifndef PDFIUM_ADDON_ANALYZE_H
+#define PDFIUM_ADDON_ANALYZE_H
+
+#include <napi.h>
+
+/**
+ * analyzeFiles(paths: string[], options?, onProgress?) → { jobId, done }
+ *
+ * options: { threads?: number, hashStreams?: boolean }
+ *
+ * Reads each file with pdfscan.h rather than PDFium, so it never takes
+ * g_pdfiumMutex: files are spread over `threads` worker threads (all
+ * cores by default), and a file's objects and pages are split among the
+ * threads left over.  `done` resolves with { files, cancelled }; each
+ * file carries either an `error` or its version, xref kind, object and
+ * stream counts, filter histogram, image and font inventories, optional
+ * SHA-256 of every raw stream, and per-page operator counts as columns.
+ * Progress counts files.
+ */
+Napi::Value AnalyzeFiles(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_ANALYZE_H
@@ -0,0 +1,299 @@
+/**
+ * annotations.cc — Bulk annotation listing and editing.
+ */
+
+#include "common.h"
+#include "annotations.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_annot.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+/** Rows of listAnnotations, column by column. */
+struct AnnotationColumns {
+  std::vector<uint32_t> pages;
+  std::vector<uint32_t> indices;
+  std::vector<uint8_t> subtypes;
+  std::vector<FS_RECTF> rects;
+  std::vector<uint32_t> flags;
+  std::vector<uint8_t> colors;
+  std::u16string contents;
+  std::vector<uint32_t> contentsOffsets{0};
+};
+
+static_assert(sizeof(FS_RECTF) == 4 * sizeof(float),
+              "FS_RECTF is copied into a Float32Array as four floats");
+
+void CollectPage(FPDF_PAGE page, int pageIndex, std::vector<FPDF_WCHAR>& scratch,
+                 AnnotationColumns& out) {
+  const int count = FPDFPage_GetAnnotCount(page);
+  for (int i = 0; i < count; ++i) {
+    FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, i);
+    if (!annot) continue;
+
+    FS_RECTF rect{0, 0, 0, 0};
+    FPDFAnnot_GetRect(annot, &rect);
+    unsigned int r = 0, g = 0, b = 0, a = 0;
+    if (!FPDFAnnot_GetColor(annot, FPDFANNOT_COLORTYPE_Color, &r, &g, &b, &a)) {
+      r = g = b = a = 0;
+    }
+
+    out.pages.push_back(static_cast<uint32_t>(pageIndex));
+    out.indices.push_back(static_cast<uint32_t>(i));
+    out.subtypes.push_back(static_cast<uint8_t>(FPDFAnnot_GetSubtype(annot)));
+    out.rects.push_back(rect);
+    out.flags.push_back(static_cast<uint32_t>(FPDFAnnot_GetFlags(annot)));
+    out.colors.insert(out.colors.end(), {static_cast<uint8_t>(r), static_cast<uint8_t>(g),
+                                         static_cast<uint8_t>(b), static_cast<uint8_t>(a)});
+    AppendUtf16([annot](FPDF_WCHAR* buf, unsigned long bytes) {
+      return FPDFAnnot_GetStringValue(annot, "Contents", buf, bytes);
+    }, scratch, out.contents);
+    out.contentsOffsets.push_back(static_cast<uint32_t>(out.contents.size()));
+    FPDFPage_CloseAnnot(annot);
+  }
+}
+
+/** Apply one update's fields; false if any given field failed. */
+bool ApplyUpdate(FPDF_ANNOTATION annot, const Napi::Object& update) {
+  bool ok = true;
+
+  Napi::Value rect = update.Get("rect");
+  if (rect.IsArray()) {
+    Napi::Array arr = rect.As<Napi::Array>();
+    FS_RECTF r;
+    float* fields[] = {&r.left, &r.top, &r.right, &r.bottom};
+    for (uint32_t i = 0; i < 4; ++i) {
+      Napi::Value v = arr.Get(i);
+      ok = ok && v.IsNumber();
+      *fields[i] = ok ? v.As<Napi::Number>().FloatValue() : 0.0f;
+    }
+    ok = ok && FPDFAnnot_SetRect(annot, &r);
+  }
+
+  Napi::Value flags = update.Get("flags");
+  if (flags.IsNumber()) {
+    ok = FPDFAnnot_SetFlags(annot, flags.As<Napi::Number>().Int32Value()) && ok;
+  }
+
+  Napi::Value color = update.Get("color");
+  if (color.IsArray()) {
+    Napi::Array arr = color.As<Napi::Array>();
+    unsigned int c[4] = {0, 0, 0, 255};
+    for (uint32_t i = 0; i < 4 && i < arr.Length(); ++i) {
+      Napi::Value v = arr.Get(i);
+      if (v.IsNumber()) c[i] = v.As<Napi::Number>().Uint32Value() & 0xFF;
+    }
+    ok = FPDFAnnot_SetColor(annot, FPDFANNOT_COLORTYPE_Color, c[0], c[1], c[2], c[3]) && ok;
+  }
+
+  Napi::Value contents = update.Get("contents");
+  if (contents.IsString()) {
+    std::u16string text = contents.As<Napi::String>().Utf16Value();
+    ok = FPDFAnnot_SetStringValue(annot, "Contents",
+                                  reinterpret_cast<FPDF_WIDESTRING>(text.c_str())) && ok;
+  }
+  return ok;
+}
+
+}  // namespace
+
+// ── listAnnotations ─────────────────────────────────────────────────
+
+Napi::Value ListAnnotations(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 1 || !info[0].IsNumber() ||
+      (info.Length() > 1 && !info[1].IsArray() && !info[1].IsUndefined())) {
+    Napi::TypeError::New(env, "listAnnotations: requires (handle, pages?)")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  const int pageCount = FPDF_GetPageCount(doc);
+  std::vector<int> pages;
+  if (info.Length() > 1 && info[1].IsArray()) {
+    Napi::Array arr = info[1].As<Napi::Array>();
+    for (uint32_t i = 0; i < arr.Length(); ++i) {
+      Napi::Value v = arr.Get(i);
+      int p = v.IsNumber() ? v.As<Napi::Number>().Int32Value() : -1;
+      if (p < 0 || p >= pageCount) {
+        Napi::RangeError::New(env, "listAnnotations: page out of range")
+          .ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      pages.push_back(p);
+    }
+  } else {
+    for (int p = 0; p < pageCount; ++p) pages.push_back(p);
+  }
+
+  AnnotationColumns columns;
+  std::vector<FPDF_WCHAR> scratch(256);
+  for (int pageIndex : pages) {
+    bool fromCache = false;
+    FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+    if (!page) {
+      Napi::Error::New(env,
+        "listAnnotations: failed to load page " + std::to_string(pageIndex)
+      ).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    CollectPage(page, pageIndex, scratch, columns);
+    ReleasePage(handle, pageIndex, page, fromCache);
+  }
+
+  const size_t count = columns.pages.size();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+  result.Set("pages", ToTypedArray<Napi::Uint32Array>(env, columns.pages, count));
+  result.Set("indices", ToTypedArray<Napi::Uint32Array>(env, columns.indices, count));
+  result.Set("subtypes", ToTypedArray<Napi::Uint8Array>(env, columns.subtypes, count));
+  result.Set("rects", ToTypedArray<Napi::Float32Array>(env, columns.rects, count * 4));
+  result.Set("flags", ToTypedArray<Napi::Uint32Array>(env, columns.flags, count));
+  result.Set("colors", ToTypedArray<Napi::Uint8Array>(env, columns.colors, count * 4));
+  result.Set("contents", Napi::String::New(env, columns.contents.data(),
+                                           columns.contents.size()));
+  result.Set("contentsOffsets",
+             ToTypedArray<Napi::Uint32Array>(env, columns.contentsOffsets, count + 1));
+  return result;
+}
+
+// ── updateAnnotations ───────────────────────────────────────────────
+
+Napi::Value UpdateAnnotations(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsArray()) {
+    Napi::TypeError::New(env, "updateAnnotations: requires (handle, updates[])")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  Napi::Array updates = info[1].As<Napi::Array>();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  // Group by page so each page is loaded once.
+  const int pageCount = FPDF_GetPageCount(doc);
+  std::map<int, std::vector<uint32_t>> byPage;
+  std::vector<uint32_t> failed;
+  for (uint32_t i = 0; i < updates.Length(); ++i) {
+    // Entries that are not update objects fail here, so the loop below
+    // only ever sees objects.
+    Napi::Value v = updates.Get(i);
+    if (!v.IsObject()) {
+      failed.push_back(i);
+      continue;
+    }
+    Napi::Value pageIndex = v.As<Napi::Object>().Get("pageIndex");
+    int p = pageIndex.IsNumber() ? pageIndex.As<Napi::Number>().Int32Value() : -1;
+    if (p < 0 || p >= pageCount) {
+      failed.push_back(i);
+      continue;
+    }
+    byPage[p].push_back(i);
+  }
+
+  uint32_t updated = 0;
+  for (const auto& [pageIndex, positions] : byPage) {
+    bool fromCache = false;
+    FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+    const int annotCount = page ? FPDFPage_GetAnnotCount(page) : 0;
+    bool touched = false;
+
+    for (uint32_t pos : positions) {
+      Napi::Object update = updates.Get(pos).As<Napi::Object>();
+      Napi::Value index = update.Get("index");
+      int a = index.IsNumber() ? index.As<Napi::Number>().Int32Value() : -1;
+      FPDF_ANNOTATION annot = (a >= 0 && a < annotCount) ? FPDFPage_GetAnnot(page, a) : nullptr;
+      const bool ok = annot && ApplyUpdate(annot, update);
+      touched = touched || annot;
+      if (annot) FPDFPage_CloseAnnot(annot);
+      if (ok) {
+        ++updated;
+      } else {
+        failed.push_back(pos);
+      }
+    }
+    if (page) ReleasePage(handle, pageIndex, page, fromCache);
+    // A failed update may still have set some fields.  Annotations show
+    // in thumbnails, so any change makes the page a new version.
+    if (touched) InvalidateTextPageData(handle, pageIndex);
+  }
+
+  Napi::Array failedArr = Napi::Array::New(env, failed.size());
+  std::sort(failed.begin(), failed.end());
+  for (uint32_t i = 0; i < failed.size(); ++i) {
+    failedArr.Set(i, Napi::Number::New(env, failed[i]));
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("updated", Napi::Number::New(env, updated));
+  result.Set("failed", failedArr);
+  return result;
+}
+
+// ── removeAnnotation ────────────────────────────────────────────────
+
+void RemoveAnnotation(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      !info[2].IsNumber()) {
+    Napi::TypeError::New(env,
+      "removeAnnotation: requires (handle, pageIndex, annotIndex)"
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  int handle     = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex  = info[1].As<Napi::Number>().Int32Value();
+  int annotIndex = info[2].As<Napi::Number>().Int32Value();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return;
+
+  if (pageIndex < 0 || pageIndex >= FPDF_GetPageCount(doc)) {
+    Napi::RangeError::New(env,
+      "removeAnnotation: pageIndex " + std::to_string(pageIndex) + " out of range"
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  bool fromCache = false;
+  FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+  if (!page) {
+    Napi::Error::New(env,
+      "removeAnnotation: failed to load page " + std::to_string(pageIndex)
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  const bool inRange = annotIndex >= 0 && annotIndex < FPDFPage_GetAnnotCount(page);
+  const bool ok = inRange && FPDFPage_RemoveAnnot(page, annotIndex);
+  ReleasePage(handle, pageIndex, page, fromCache);
+  if (ok) InvalidateTextPageData(handle, pageIndex);
+
+  if (!ok) {
+    Napi::RangeError::New(env,
+      "removeAnnotation: annotation " + std::to_string(annotIndex) + " not found"
+    ).ThrowAsJavaScriptException();
+  }
+}
@@ -0,0 +1,44 @@
+/**
+ * annotations.h — Bulk annotation listing and editing.
+ */
+#ifndef PDFIUM_ADDON_ANNOTATIONS_H
+#define PDFIUM_ADDON_ANNOTATIONS_H
+
+#include <napi.h>
+
+/**
+ * listAnnotations(handle, pages?: number[])
+ * → { count, pages: Uint32Array, indices: Uint32Array, subtypes: Uint8Array,
+ *     rects: Float32Array, flags: Uint32Array, colors: Uint8Array,
+ *     contents: string, contentsOffsets: Uint32Array }
+ *
+ * Every annotation of `pages` (default: all) as columns, one row per
+ * annotation: page and index on that page, FPDF_ANNOT_* subtype, rect
+ * (left, top, right, bottom in PDF points), FPDF_ANNOT_FLAG_* flags and
+ * RGBA colour (alpha 0 when PDFium cannot report it, e.g. the
+ * appearance stream fixes it).  Contents strings are concatenated in
+ * `contents`; row i is contents.slice(contentsOffsets[i], contentsOffsets[i + 1]).
+ */
+Napi::Value ListAnnotations(const Napi::CallbackInfo& info);
+
+/**
+ * updateAnnotations(handle, updates: Array<{ pageIndex, index, rect?,
+ *                   flags?, color?, contents? }>)
+ * → { updated, failed: number[] }
+ *
+ * Applies the given fields to each annotation, loading each page once.
+ * `failed` lists the positions in `updates` that could not be applied
+ * in full, including entries that are not objects.  Colours cannot be changed on annotations whose appearance
+ * stream defines them.
+ */
+Napi::Value UpdateAnnotations(const Napi::CallbackInfo& info);
+
+/**
+ * removeAnnotation(handle, pageIndex, annotIndex) → void
+ *
+ * Removes an annotation from the page.  Later annotations shift down
+ * by one index.
+ */
+void RemoveAnnotation(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_ANNOTATIONS_H
@@ -6,7 +6,11 @@
 
 #include <napi.h>
 #include <fpdfview.h>
+#include <cstring>
 #include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
 // ── Global document registry ────────────────────────────────────────
 
@@ -19,6 +23,17 @@ extern int g_nextHandle;
 /** Whether FPDF_InitLibraryWithConfig has been called. */
 extern bool g_initialized;
 
+// ── PDFium serialisation ────────────────────────────────────────────
+
+/**
+ * PDFium is not thread-safe.  Every call into it — from the JS thread
+ * or from a background job (jobs.h) — must hold this lock.  Jobs take
+ * it per page, so synchronous calls wait at most one page of work.
+ */
+extern std::mutex g_pdfiumMutex;
+
+using PdfiumLock = std::lock_guard<std::mutex>;
+
 // ── Page cache ──────────────────────────────────────────────────────
 
 /**
@@ -72,6 +87,14 @@ void ReleasePage(int handle, int pageIndex, FPDF_PAGE page, bool fromCache);
  */
 void CachePageDirty(int handle, int pageIndex, FPDF_PAGE page);
 
+/**
+ * Generate content for a single cached page (if dirty), close it and
+ * drop it from the cache, so the next FPDF_LoadPage sees the edits in
+ * the page's content stream.  No-op when the page is not cached.
+ * Returns false if FPDFPage_GenerateContent fails.
+ */
+bool FlushCachedPage(int handle, int pageIndex);
+
 /**
  * Call FPDFPage_GenerateContent on every dirty cached page for the
  * given document handle, then close all cached pages.
@@ -85,5 +108,39 @@ bool FlushAndCloseCachedPages(int handle);
  */
 void DiscardCachedPages(int handle);
 
+/**
+ * Read an optional field from a JS options object, falling back when
+ * the object or field is missing or of the wrong type.
+ */
+bool GetBoolOption(Napi::Value options, const char* key, bool fallback);
+double GetNumberOption(Napi::Value options, const char* key, double fallback);
+
+/** The first `length` values as a new typed array (ArrayT::New). */
+template <typename ArrayT, typename T>
+ArrayT ToTypedArray(Napi::Env env, const std::vector<T>& values, size_t length) {
+  auto out = ArrayT::New(env, length);
+  if (length) std::memcpy(out.Data(), values.data(), length * sizeof(*out.Data()));
+  return out;
+}
+
+/**
+ * Append a string from a PDFium UTF-16LE getter, called as
+ * get(buffer, bufferBytes) → bytes needed including the NUL, to
+ * `table`.  `scratch` is reused across calls so most strings cost a
+ * single PDFium call.
+ */
+template <typename Getter>
+void AppendUtf16(Getter get, std::vector<FPDF_WCHAR>& scratch, std::u16string& table) {
+  unsigned long bytes = get(scratch.data(), scratch.size() * sizeof(FPDF_WCHAR));
+  if (bytes > scratch.size() * sizeof(FPDF_WCHAR)) {
+    scratch.resize(bytes / sizeof(FPDF_WCHAR) + 1);
+    bytes = get(scratch.data(), scratch.size() * sizeof(FPDF_WCHAR));
+  }
+  const size_t chars = bytes / sizeof(FPDF_WCHAR);
+  if (chars > 1) {
+    table.append(reinterpret_cast<const char16_t*>(scratch.data()), chars - 1);
+  }
+}
+
 #endif // PDFIUM_ADDON_COMMON_H
 
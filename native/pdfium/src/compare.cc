@@ -0,0 +1,498 @@
+/**
+ * compare.cc — Visual comparison of two documents, page by page.
+ *
+ * A page pair is diffed in three steps, all outside g_pdfiumMutex:
+ * the largest channel difference per pixel (SSE2 / NEON, with equal
+ * rows skipped by memcmp), a grid of CELL × CELL cells holding the
+ * changed pixels, and connected components of that grid, where cells
+ * within the merge distance count as neighbours — so an edited word
+ * is one box rather than one per glyph.
+ */
+
+#include "common.h"
+#include "compare.h"
+#include "jobs.h"
+
+#include <fpdfview.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COMPARE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define COMPARE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr double DEFAULT_COMPARE_DPI = 96.0;
+constexpr double POINTS_PER_INCH = 72.0;
+constexpr int DEFAULT_THRESHOLD = 32;
+constexpr double DEFAULT_MERGE_POINTS = 6.0;
+
+/** Largest page pair raster, in pixels per page; the dpi drops beyond it. */
+constexpr double MAX_COMPARE_PIXELS = 32.0 * 1024 * 1024;
+
+/** Grouping and heatmap cell edge, in pixels. */
+constexpr int CELL = 4;
+
+/** As printed: annotations are part of what reviewers compare. */
+constexpr int COMPARE_RENDER_FLAGS = FPDF_ANNOT | FPDF_PRINTING;
+
+struct PagePair {
+  int a;
+  int b;
+};
+
+/** Tightly packed BGRA render of one page. */
+struct Raster {
+  std::vector<uint8_t> pixels;
+  int width = 0;
+  int height = 0;
+};
+
+struct PageDiff {
+  int pageA = -1;
+  int pageB = -1;
+  uint64_t changedPixels = 0;
+  std::vector<float> boxes;
+  std::vector<uint32_t> boxPixels;
+  std::vector<uint8_t> heatmap;
+  int heatmapWidth = 0;
+  int heatmapHeight = 0;
+  float cellPoints = 0;
+};
+
+// ── Pixel difference ────────────────────────────────────────────────
+
+/** out[i] = largest |a − b| over the B, G, R channels of pixel i. */
+void DiffRow(const uint8_t* a, const uint8_t* b, int n, uint8_t* out) {
+  int i = 0;
+
+#if defined(COMPARE_SSE2)
+  const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+  const __m128i low = _mm_set1_epi32(0xFF);
+  for (; i + 16 <= n; i += 16) {
+    __m128i m[4];
+    for (int k = 0; k < 4; ++k) {
+      __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + (i + 4 * k) * 4));
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + (i + 4 * k) * 4));
+      __m128i d = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+      d = _mm_and_si128(d, rgb);
+      // Fold channels 1 and 2 onto channel 0.
+      d = _mm_max_epu8(d, _mm_srli_epi32(d, 8));
+      d = _mm_max_epu8(d, _mm_srli_epi32(d, 16));
+      m[k] = _mm_and_si128(d, low);
+    }
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(m[0], m[1]),
+                                      _mm_packs_epi32(m[2], m[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+  }
+#elif defined(COMPARE_NEON)
+  for (; i + 16 <= n; i += 16) {
+    uint8x16x4_t va = vld4q_u8(a + i * 4);
+    uint8x16x4_t vb = vld4q_u8(b + i * 4);
+    uint8x16_t d = vmaxq_u8(vabdq_u8(va.val[0], vb.val[0]),
+                            vmaxq_u8(vabdq_u8(va.val[1], vb.val[1]),
+                                     vabdq_u8(va.val[2], vb.val[2])));
+    vst1q_u8(out + i, d);
+  }
+#endif
+
+  for (; i < n; ++i) {
+    const uint8_t* pa = a + i * 4;
+    const uint8_t* pb = b + i * 4;
+    int d = 0;
+    for (int c = 0; c < 3; ++c) d = std::max(d, std::abs(pa[c] - pb[c]));
+    out[i] = static_cast<uint8_t>(d);
+  }
+}
+
+// ── Change regions ──────────────────────────────────────────────────
+
+/**
+ * Diff two renders at the same scale, aligned at the top-left corner.
+ * Area covered by only one of them counts as changed.  `heightPt` is the
+ * reference page height in points, for the bottom-left box origin.
+ */
+void DiffRasters(const Raster& ra, const Raster& rb, double scale, double heightPt,
+                 int threshold, int mergeCells, bool heatmap, PageDiff& out) {
+  const int w = std::max(ra.width, rb.width);
+  const int h = std::max(ra.height, rb.height);
+  const int gw = (w + CELL - 1) / CELL;
+  const int gh = (h + CELL - 1) / CELL;
+
+  std::vector<uint32_t> cellChanged(static_cast<size_t>(gw) * gh, 0);
+  std::vector<uint8_t> cellMax(heatmap ? cellChanged.size() : 0, 0);
+  std::vector<uint8_t> diff(w);
+
+  for (int y = 0; y < h; ++y) {
+    const uint8_t* rowA = y < ra.height ? ra.pixels.data() + static_cast<size_t>(y) * ra.width * 4 : nullptr;
+    const uint8_t* rowB = y < rb.height ? rb.pixels.data() + static_cast<size_t>(y) * rb.width * 4 : nullptr;
+    const int common = rowA && rowB ? std::min(ra.width, rb.width) : 0;
+
+    // Most rows of a revision are untouched.
+    if (ra.width == rb.width && common == w &&
+        std::memcmp(rowA, rowB, static_cast<size_t>(w) * 4) == 0) {
+      continue;
+    }
+    if (common > 0) DiffRow(rowA, rowB, common, diff.data());
+    std::fill(diff.begin() + common, diff.end(), uint8_t{255});
+
+    uint32_t* cells = cellChanged.data() + static_cast<size_t>(y / CELL) * gw;
+    uint8_t* maxes = heatmap ? cellMax.data() + static_cast<size_t>(y / CELL) * gw : nullptr;
+    for (int x = 0; x < w; ++x) {
+      const uint8_t d = diff[x];
+      if (d <= threshold) continue;
+      cells[x / CELL]++;
+      if (maxes) maxes[x / CELL] = std::max(maxes[x / CELL], d);
+    }
+  }
+
+  // Label cells: breadth-first over changed cells, where any changed
+  // cell within `mergeCells` (Chebyshev distance) is a neighbour.
+  std::vector<int32_t> label(cellChanged.size(), -1);
+  std::deque<int> queue;
+  int32_t next = 0;
+  for (int start = 0; start < static_cast<int>(cellChanged.size()); ++start) {
+    if (!cellChanged[start] || label[start] >= 0) continue;
+
+    int x0 = start % gw, x1 = x0, y0 = start / gw, y1 = y0;
+    uint64_t pixels = 0;
+    label[start] = next;
+    queue.push_back(start);
+    while (!queue.empty()) {
+      const int cell = queue.front();
+      queue.pop_front();
+      const int cx = cell % gw, cy = cell / gw;
+      x0 = std::min(x0, cx); x1 = std::max(x1, cx);
+      y0 = std::min(y0, cy); y1 = std::max(y1, cy);
+      pixels += cellChanged[cell];
+
+      for (int ny = std::max(0, cy - mergeCells); ny <= std::min(gh - 1, cy + mergeCells); ++ny) {
+        for (int nx = std::max(0, cx - mergeCells); nx <= std::min(gw - 1, cx + mergeCells); ++nx) {
+          const int n = ny * gw + nx;
+          if (cellChanged[n] && label[n] < 0) {
+            label[n] = next;
+            queue.push_back(n);
+          }
+        }
+      }
+    }
+    ++next;
+
+    const double left = x0 * CELL / scale;
+    const double right = std::min((x1 + 1) * CELL, w) / scale;
+    const double top = y0 * CELL / scale;
+    const double bottom = std::min((y1 + 1) * CELL, h) / scale;
+    out.boxes.insert(out.boxes.end(), {
+      static_cast<float>(left), static_cast<float>(heightPt - top),
+      static_cast<float>(right), static_cast<float>(heightPt - bottom),
+    });
+    out.boxPixels.push_back(static_cast<uint32_t>(pixels));
+    out.changedPixels += pixels;
+  }
+
+  if (heatmap) {
+    out.heatmap = std::move(cellMax);
+    out.heatmapWidth = gw;
+    out.heatmapHeight = gh;
+    out.cellPoints = static_cast<float>(CELL / scale);
+  }
+}
+
+// ── Rendering ───────────────────────────────────────────────────────
+
+bool RenderInto(FPDF_PAGE page, double scale, Raster& out) {
+  out.width = std::max(1, static_cast<int>(std::ceil(FPDF_GetPageWidthF(page) * scale)));
+  out.height = std::max(1, static_cast<int>(std::ceil(FPDF_GetPageHeightF(page) * scale)));
+  out.pixels.assign(static_cast<size_t>(out.width) * out.height * 4, 0);
+
+  FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(out.width, out.height, FPDFBitmap_BGRA,
+                                           out.pixels.data(), out.width * 4);
+  if (!bitmap) return false;
+  FPDFBitmap_FillRect(bitmap, 0, 0, out.width, out.height, 0xFFFFFFFF);
+  FPDF_RenderPageBitmap(bitmap, page, 0, 0, out.width, out.height, 0,
+                        COMPARE_RENDER_FLAGS);
+  FPDFBitmap_Destroy(bitmap);
+  return true;
+}
+
+/** Page size in points without loading the page; false when absent. */
+bool PageSize(FPDF_DOCUMENT doc, int pageIndex, FS_SIZEF& size) {
+  return pageIndex >= 0 && FPDF_GetPageSizeByIndexF(doc, pageIndex, &size);
+}
+
+Napi::Object DiffToObject(Napi::Env env, PageDiff& diff, bool withHeatmap) {
+  const size_t count = diff.boxPixels.size();
+  auto boxes = Napi::Float32Array::New(env, count * 4);
+  auto boxPixels = Napi::Uint32Array::New(env, count);
+  if (count) {
+    std::memcpy(boxes.Data(), diff.boxes.data(), count * 4 * sizeof(float));
+    std::memcpy(boxPixels.Data(), diff.boxPixels.data(), count * sizeof(uint32_t));
+  }
+
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("pageA", Napi::Number::New(env, diff.pageA));
+  obj.Set("pageB", Napi::Number::New(env, diff.pageB));
+  obj.Set("changedPixels", Napi::Number::New(env, static_cast<double>(diff.changedPixels)));
+  obj.Set("boxes", boxes);
+  obj.Set("boxPixels", boxPixels);
+  if (withHeatmap) {
+    auto heatmap = Napi::Uint8Array::New(env, diff.heatmap.size());
+    if (!diff.heatmap.empty()) {
+      std::memcpy(heatmap.Data(), diff.heatmap.data(), diff.heatmap.size());
+    }
+    obj.Set("heatmap", heatmap);
+    obj.Set("heatmapWidth", Napi::Number::New(env, diff.heatmapWidth));
+    obj.Set("heatmapHeight", Napi::Number::New(env, diff.heatmapHeight));
+    obj.Set("cellSize", Napi::Number::New(env, CELL));
+    obj.Set("cellPoints", Napi::Number::New(env, diff.cellPoints));
+    // Streamed once; only the boxes are kept for `done`.
+    std::vector<uint8_t>().swap(diff.heatmap);
+  }
+  return obj;
+}
+
+// ── CompareJob ──────────────────────────────────────────────────────
+
+class CompareJob : public Job {
+ public:
+  CompareJob(Napi::Env env, int handleA, int handleB, std::vector<PagePair> pairs,
+             Napi::Value onProgress, double dpi, int threshold, double mergePoints)
+    : Job(env, onProgress),
+      handleA_(handleA),
+      handleB_(handleB),
+      pairs_(std::move(pairs)),
+      dpi_(dpi),
+      threshold_(threshold),
+      mergePoints_(mergePoints) {}
+
+ protected:
+  void Execute(const ExecutionProgress& progress) override {
+    const int total = static_cast<int>(pairs_.size());
+    const bool heatmaps = HasProgressListener();
+
+    for (int i = 0; i < total; ++i) {
+      if (CancelRequested()) {
+        MarkCancelled();
+        break;
+      }
+
+      const PagePair pair = pairs_[i];
+      PageDiff diff;
+      diff.pageA = pair.a;
+      diff.pageB = pair.b;
+      Raster ra, rb;
+      double scale = 0, heightPt = 0;
+      {
+        PdfiumLock lock(g_pdfiumMutex);
+        auto a = g_documents.find(handleA_);
+        auto b = g_documents.find(handleB_);
+        if (a == g_documents.end() || b == g_documents.end()) {
+          SetError("document was closed while the comparison was running");
+          return;
+        }
+        std::string error;
+        if (!RenderPair(a->second, b->second, pair, ra, rb, scale, heightPt, diff, error)) {
+          SetError(error);
+          return;
+        }
+      }
+
+      // A page on one side only was reported whole by RenderPair.
+      if (pair.a >= 0 && pair.b >= 0) {
+        const int mergeCells =
+          static_cast<int>(std::ceil(mergePoints_ * scale / CELL));
+        DiffRasters(ra, rb, scale, heightPt, threshold_, mergeCells, heatmaps, diff);
+      }
+
+      {
+        std::lock_guard<std::mutex> guard(resultsMutex_);
+        results_.push_back(std::move(diff));
+        unsent_.push_back(results_.size() - 1);
+      }
+      JobProgress p = { i + 1, total };
+      progress.Send(&p, 1);
+    }
+  }
+
+  Napi::Value ProgressDetail(Napi::Env env) override {
+    std::lock_guard<std::mutex> guard(resultsMutex_);
+    Napi::Array pages = Napi::Array::New(env, unsent_.size());
+    for (size_t i = 0; i < unsent_.size(); ++i) {
+      pages[static_cast<uint32_t>(i)] = DiffToObject(env, results_[unsent_[i]], true);
+    }
+    unsent_.clear();
+    return pages;
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    std::lock_guard<std::mutex> guard(resultsMutex_);
+    Napi::Array pages = Napi::Array::New(env, results_.size());
+    int changedPages = 0;
+    for (size_t i = 0; i < results_.size(); ++i) {
+      pages[static_cast<uint32_t>(i)] = DiffToObject(env, results_[i], false);
+      if (results_[i].changedPixels > 0) ++changedPages;
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("pages", pages);
+    result.Set("changedPages", Napi::Number::New(env, changedPages));
+    return result;
+  }
+
+ private:
+  /**
+   * Render both pages of `pair` at one scale (dpi, lowered for huge
+   * pages).  A page missing on one side is reported as one box over
+   * the other without rendering.  Caller holds g_pdfiumMutex.
+   */
+  bool RenderPair(FPDF_DOCUMENT docA, FPDF_DOCUMENT docB, const PagePair& pair,
+                  Raster& ra, Raster& rb, double& scale, double& heightPt,
+                  PageDiff& diff, std::string& error) {
+    FS_SIZEF sizeA{0, 0}, sizeB{0, 0};
+    const bool hasA = PageSize(docA, pair.a, sizeA);
+    const bool hasB = PageSize(docB, pair.b, sizeB);
+    if (!hasA && !hasB) {
+      error = "page pair " + std::to_string(pair.a) + "/" + std::to_string(pair.b) +
+              " is out of range";
+      return false;
+    }
+    if (!hasA || !hasB) {
+      const FS_SIZEF& size = hasA ? sizeA : sizeB;
+      diff.pageA = hasA ? pair.a : -1;
+      diff.pageB = hasB ? pair.b : -1;
+      diff.boxes = {0.0f, size.height, size.width, 0.0f};
+      const double px = dpi_ / POINTS_PER_INCH;
+      diff.boxPixels = {static_cast<uint32_t>(size.width * px * size.height * px)};
+      diff.changedPixels = diff.boxPixels[0];
+      return true;
+    }
+
+    const double w = std::max(sizeA.width, sizeB.width);
+    const double h = std::max(sizeA.height, sizeB.height);
+    scale = dpi_ / POINTS_PER_INCH;
+    if (w * h * scale * scale > MAX_COMPARE_PIXELS) {
+      scale = std::sqrt(MAX_COMPARE_PIXELS / (w * h));
+    }
+    heightPt = sizeA.height;
+
+    bool fromCacheA = false, fromCacheB = false;
+    FPDF_PAGE pageA = AcquirePage(handleA_, docA, pair.a, fromCacheA);
+    FPDF_PAGE pageB = pageA ? AcquirePage(handleB_, docB, pair.b, fromCacheB) : nullptr;
+    bool ok = pageA && pageB && RenderInto(pageA, scale, ra) && RenderInto(pageB, scale, rb);
+    if (!ok) {
+      error = "failed to render page pair " + std::to_string(pair.a) + "/" +
+              std::to_string(pair.b);
+    }
+    if (pageB) ReleasePage(handleB_, pair.b, pageB, fromCacheB);
+    if (pageA) ReleasePage(handleA_, pair.a, pageA, fromCacheA);
+    return ok;
+  }
+
+  const int handleA_;
+  const int handleB_;
+  const std::vector<PagePair> pairs_;
+  const double dpi_;
+  const int threshold_;
+  const double mergePoints_;
+
+  /** Written by the worker, read by ProgressDetail / Result. */
+  std::mutex resultsMutex_;
+  std::vector<PageDiff> results_;
+  std::vector<size_t> unsent_;
+};
+
+/** Parse options.pairs, or pair page i with page i. */
+bool ReadPairs(Napi::Env env, Napi::Value options, int countA, int countB,
+               std::vector<PagePair>& out) {
+  Napi::Value pairs = options.IsObject() ? options.As<Napi::Object>().Get("pairs")
+                                         : env.Undefined();
+  if (pairs.IsUndefined() || pairs.IsNull()) {
+    for (int i = 0; i < std::max(countA, countB); ++i) {
+      out.push_back({i < countA ? i : -1, i < countB ? i : -1});
+    }
+    return true;
+  }
+
+  if (pairs.IsArray()) {
+    Napi::Array arr = pairs.As<Napi::Array>();
+    for (uint32_t i = 0; i < arr.Length(); ++i) {
+      Napi::Value v = arr.Get(i);
+      if (!v.IsArray()) break;
+      Napi::Array pair = v.As<Napi::Array>();
+      Napi::Value a = pair.Get(0u), b = pair.Get(1u);
+      if (!a.IsNumber() || !b.IsNumber()) break;
+      const int pa = a.As<Napi::Number>().Int32Value();
+      const int pb = b.As<Napi::Number>().Int32Value();
+      if (pa < -1 || pa >= countA || pb < -1 || pb >= countB || (pa < 0 && pb < 0)) {
+        Napi::RangeError::New(env,
+          "compareDocuments: page pair " + std::to_string(i) + " out of range"
+        ).ThrowAsJavaScriptException();
+        return false;
+      }
+      out.push_back({pa, pb});
+    }
+    if (out.size() == arr.Length()) return true;
+  }
+
+  Napi::TypeError::New(env,
+    "compareDocuments: pairs must be an array of [pageA, pageB]"
+  ).ThrowAsJavaScriptException();
+  return false;
+}
+
+}  // namespace
+
+// ── compareDocuments ────────────────────────────────────────────────
+
+Napi::Value CompareDocuments(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env,
+      "compareDocuments: requires (handleA, handleB, options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const int handleA = info[0].As<Napi::Number>().Int32Value();
+  const int handleB = info[1].As<Napi::Number>().Int32Value();
+  Napi::Value options = info.Length() > 2 ? info[2] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 3 ? info[3] : env.Undefined();
+
+  FPDF_DOCUMENT docA = RequireDocument(env, handleA);
+  if (!docA) return env.Undefined();
+  FPDF_DOCUMENT docB = RequireDocument(env, handleB);
+  if (!docB) return env.Undefined();
+
+  const double dpi = GetNumberOption(options, "dpi", DEFAULT_COMPARE_DPI);
+  const double threshold = GetNumberOption(options, "threshold", DEFAULT_THRESHOLD);
+  const double mergePoints = GetNumberOption(options, "mergeDistance", DEFAULT_MERGE_POINTS);
+  if (!(dpi > 0.0) || !(threshold >= 0.0 && threshold <= 255.0) || !(mergePoints >= 0.0)) {
+    Napi::RangeError::New(env,
+      "compareDocuments: dpi must be > 0, threshold 0-255 and mergeDistance >= 0"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<PagePair> pairs;
+  if (!ReadPairs(env, options, FPDF_GetPageCount(docA), FPDF_GetPageCount(docB), pairs)) {
+    return env.Undefined();
+  }
+
+  auto* job = new CompareJob(env, handleA, handleB, std::move(pairs), onProgress,
+                             dpi, static_cast<int>(threshold), mergePoints);
+  return job->Start();
+}
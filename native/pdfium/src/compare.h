@@ -0,0 +1,40 @@
+/**
+ * compare.h — Visual comparison of two documents, page by page.
+ */
+#ifndef PDFIUM_ADDON_COMPARE_H
+#define PDFIUM_ADDON_COMPARE_H
+
+#include <napi.h>
+
+/**
+ * compareDocuments(handleA, handleB, options?, onProgress?)
+ * → { jobId, done: Promise<{ pages: PageDiff[], changedPages: number }> }
+ *
+ * options: { dpi?: number = 96, pairs?: Array<[a, b]>,
+ *            threshold?: number = 32, mergeDistance?: number = 6 }
+ *
+ * Renders page a of A and page b of B for each pair (by default page i
+ * with page i; -1 on one side for a page only the other document has)
+ * and reports where they differ:
+ *
+ *   PageDiff = { pageA, pageB, changedPixels,
+ *                boxes: Float32Array, boxPixels: Uint32Array }
+ *
+ * A pixel changed when a colour channel differs by more than
+ * `threshold` (0–255), which ignores anti-aliasing noise.  Changed
+ * areas closer than `mergeDistance` points are grouped into one box:
+ * left, top, right, bottom in PDF points of page a (of page b when a is
+ * -1); `boxPixels` counts the changed pixels in each.
+ *
+ * onProgress(done, total, pages) streams the PageDiffs finished since
+ * the last call, each with a `heatmap`: Uint8Array of the largest
+ * channel difference per `cellSize`-pixel cell (`heatmapWidth` ×
+ * `heatmapHeight`, cells of `cellPoints` points).  Heatmaps are only
+ * computed when onProgress is given and are not kept for `done`.
+ *
+ * Both pages of a pair are rendered in one hold of g_pdfiumMutex; the
+ * diff runs outside it.
+ */
+Napi::Value CompareDocuments(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_COMPARE_H
@@ -0,0 +1,204 @@
+/**
+ * deflate.cc — zlib encoder (RFC 1950, RFC 1951).
+ *
+ * One final block with the fixed Huffman code: no code-length header to
+ * tune, so output streams straight out of the match loop.  Matches come
+ * from 3-byte hash chains over a 32 KiB window, searched MAX_CHAIN deep.
+ */
+
+#include "deflate.h"
+
+namespace {
+
+constexpr int WINDOW = 32768;
+constexpr int HASH_BITS = 15;
+constexpr int MIN_MATCH = 3;
+constexpr int MAX_MATCH = 258;
+constexpr int MAX_CHAIN = 32;
+
+// ── Bit writer ──────────────────────────────────────────────────────
+
+/** LSB-first bit writer appending to a byte vector. */
+class BitWriter {
+ public:
+  explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+  void Put(uint32_t value, int n) {
+    bits_ |= static_cast<uint64_t>(value) << count_;
+    count_ += n;
+    while (count_ >= 8) {
+      out_.push_back(static_cast<uint8_t>(bits_));
+      bits_ >>= 8;
+      count_ -= 8;
+    }
+  }
+
+  /** Huffman codes go out MSB first. */
+  void PutCode(uint32_t code, int n) {
+    uint32_t reversed = 0;
+    for (int b = 0; b < n; b++) reversed |= ((code >> b) & 1) << (n - 1 - b);
+    Put(reversed, n);
+  }
+
+  void Flush() {
+    if (count_ > 0) out_.push_back(static_cast<uint8_t>(bits_));
+    bits_ = 0;
+    count_ = 0;
+  }
+
+ private:
+  std::vector<uint8_t>& out_;
+  uint64_t bits_ = 0;
+  int count_ = 0;
+};
+
+// ── Fixed code ──────────────────────────────────────────────────────
+
+const uint16_t LEN_BASE[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+const uint8_t LEN_EXTRA[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+const uint16_t DIST_BASE[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577,
+};
+const uint8_t DIST_EXTRA[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+
+/** Length → length symbol (0-based, add 257) for every match length. */
+struct LengthCodes {
+  uint8_t symbol[MAX_MATCH + 1];
+
+  LengthCodes() {
+    int s = 0;
+    for (int len = MIN_MATCH; len <= MAX_MATCH; len++) {
+      while (s < 28 && LEN_BASE[s + 1] <= len) s++;
+      symbol[len] = static_cast<uint8_t>(s);
+    }
+  }
+};
+
+const LengthCodes& Lengths() {
+  static const LengthCodes codes;
+  return codes;
+}
+
+int DistanceSymbol(int distance) {
+  int s = 29;
+  while (DIST_BASE[s] > distance) s--;
+  return s;
+}
+
+void Literal(BitWriter& bw, int sym) {
+  if (sym < 144) {
+    bw.PutCode(0x30 + sym, 8);
+  } else if (sym < 256) {
+    bw.PutCode(0x190 + (sym - 144), 9);
+  } else if (sym < 280) {
+    bw.PutCode(sym - 256, 7);
+  } else {
+    bw.PutCode(0xc0 + (sym - 280), 8);
+  }
+}
+
+void Match(BitWriter& bw, int length, int distance) {
+  const int ls = Lengths().symbol[length];
+  Literal(bw, 257 + ls);
+  bw.Put(length - LEN_BASE[ls], LEN_EXTRA[ls]);
+
+  const int ds = DistanceSymbol(distance);
+  bw.PutCode(ds, 5);
+  bw.Put(distance - DIST_BASE[ds], DIST_EXTRA[ds]);
+}
+
+uint32_t Hash(const uint8_t* p) {
+  const uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+} // namespace
+
+uint32_t Adler32(const uint8_t* data, size_t size) {
+  uint32_t a = 1, b = 0;
+  while (size > 0) {
+    // 5552 is the most bytes before b can overflow 32 bits.
+    size_t n = size < 5552 ? size : 5552;
+    size -= n;
+    while (n--) {
+      a += *data++;
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+  }
+  return (b << 16) | a;
+}
+
+void Deflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+  out.push_back(0x78);   // deflate, 32 KiB window
+  out.push_back(0x5e);   // "fast" level; header check bits
+
+  BitWriter bw(out);
+  bw.Put(1, 1);          // BFINAL
+  bw.Put(1, 2);          // fixed Huffman
+
+  // head[h]: latest position with hash h; prev[pos % WINDOW]: the one
+  // before it.  Positions are stored +1 so 0 means empty.
+  std::vector<uint32_t> head(size_t(1) << HASH_BITS, 0);
+  std::vector<uint32_t> prev(WINDOW, 0);
+  auto insert = [&](size_t pos) {
+    const uint32_t h = Hash(data + pos);
+    prev[pos % WINDOW] = head[h];
+    head[h] = static_cast<uint32_t>(pos + 1);
+  };
+
+  size_t i = 0;
+  while (i < size) {
+    int bestLen = 0;
+    size_t bestDist = 0;
+
+    if (i + MIN_MATCH <= size) {
+      const size_t maxLen = size - i < MAX_MATCH ? size - i : MAX_MATCH;
+      size_t candidate = head[Hash(data + i)];
+      for (int depth = 0; candidate && depth < MAX_CHAIN; depth++) {
+        const size_t j = candidate - 1;
+        // A slot reused by a newer position breaks the chain's order.
+        if (j >= i || i - j > WINDOW) break;
+        size_t len = 0;
+        while (len < maxLen && data[j + len] == data[i + len]) len++;
+        if (static_cast<int>(len) > bestLen) {
+          bestLen = static_cast<int>(len);
+          bestDist = i - j;
+          if (len == maxLen) break;
+        }
+        candidate = prev[j % WINDOW];
+      }
+      insert(i);
+    }
+
+    if (bestLen >= MIN_MATCH) {
+      Match(bw, bestLen, static_cast<int>(bestDist));
+      for (size_t k = i + 1; k < i + bestLen && k + MIN_MATCH <= size; k++) insert(k);
+      i += bestLen;
+    } else {
+      Literal(bw, data[i]);
+      i++;
+    }
+  }
+
+  Literal(bw, 256);      // end of block
+  bw.Flush();
+
+  const uint32_t adler = Adler32(data, size);
+  out.push_back(static_cast<uint8_t>(adler >> 24));
+  out.push_back(static_cast<uint8_t>(adler >> 16));
+  out.push_back(static_cast<uint8_t>(adler >> 8));
+  out.push_back(static_cast<uint8_t>(adler));
+}
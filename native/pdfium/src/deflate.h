@@ -0,0 +1,22 @@
+/**
+ * deflate.h — Encoder for zlib (RFC 1950) data.
+ *
+ * The counterpart of inflate.h, for output written without PDFium (PNG
+ * files from extractImages).  Single-block, fixed-Huffman deflate with
+ * a hash-chain match finder: it trades a few percent of ratio against
+ * zlib for speed and size.  No global state; safe on any thread.
+ */
+#ifndef PDFIUM_ADDON_DEFLATE_H
+#define PDFIUM_ADDON_DEFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Compress `size` bytes into a zlib stream, appending to `out`. */
+void Deflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+/** Adler-32 checksum of `size` bytes, as ending a zlib stream. */
+uint32_t Adler32(const uint8_t* data, size_t size);
+
+#endif // PDFIUM_ADDON_DEFLATE_H
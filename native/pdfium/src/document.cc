@@ -4,11 +4,21 @@
 
 #include "common.h"
 #include "document.h"
+#include "drag.h"
+#include "fonts.h"
+#include "ink.h"
+#include "measure.h"
+#include "outline.h"
+#include "thumbnails.h"
+#include "previews.h"
+#include "textpage.h"
 
 #include <fpdfview.h>
 #include <fpdf_save.h>
 
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <string>
 #include <vector>
 
@@ -31,6 +41,7 @@ static const char* GetPdfiumErrorMessage(unsigned long err) {
 
 Napi::Value OpenDocument(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
   EnsurePdfiumInit();
 
   // Validate: first argument must be a Buffer
@@ -72,6 +83,7 @@ Napi::Value OpenDocument(const Napi::CallbackInfo& info) {
 
 void CloseDocument(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
 
   if (info.Length() < 1 || !info[0].IsNumber()) {
     Napi::TypeError::New(env,
@@ -92,6 +104,14 @@ void CloseDocument(const Napi::CallbackInfo& info) {
 
   // Discard any cached pages for this document before closing it.
   DiscardCachedPages(handle);
+  DiscardTextPageData(handle);
+  DiscardDragSessions(handle);
+  DiscardInkSessions(handle);
+  DiscardMeasureCache(handle);
+  DiscardImagePreviews(handle);
+  DiscardFonts(handle);
+  DiscardOutline(handle);
+  DiscardThumbnails(handle);
 
   FPDF_CloseDocument(it->second);
   g_documents.erase(it);
@@ -101,6 +121,7 @@ void CloseDocument(const Napi::CallbackInfo& info) {
 
 Napi::Value GetPageCount(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
 
   if (info.Length() < 1 || !info[0].IsNumber()) {
     Napi::TypeError::New(env,
@@ -137,6 +158,7 @@ static int WriteBlockCallback(
 
 Napi::Value SaveDocument(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
 
   if (info.Length() < 1 || !info[0].IsNumber()) {
     Napi::TypeError::New(env,
@@ -173,3 +195,88 @@ Napi::Value SaveDocument(const Napi::CallbackInfo& info) {
     env, writer.data.data(), writer.data.size()
   );
 }
+
+// ── saveDocumentToFile ──────────────────────────────────────────────
+
+/** Streams FPDF_SaveAsCopy output straight to an open file. */
+struct FileWriter {
+  FPDF_FILEWRITE fileWrite;
+  std::ofstream* out;
+  const SaveBlockTap* tap;
+};
+
+static int WriteFileBlockCallback(
+  FPDF_FILEWRITE* pThis,
+  const void* pData,
+  unsigned long size
+) {
+  auto* writer = reinterpret_cast<FileWriter*>(pThis);
+  if (*writer->tap) {
+    (*writer->tap)(static_cast<const uint8_t*>(pData), size);
+  }
+  writer->out->write(static_cast<const char*>(pData),
+                     static_cast<std::streamsize>(size));
+  return writer->out->good() ? 1 : 0;
+}
+
+bool StreamDocumentToFile(FPDF_DOCUMENT doc, const std::string& path,
+                          std::string& error, const SaveBlockTap& tap) {
+  std::ofstream out(std::filesystem::u8path(path),
+                    std::ios::binary | std::ios::trunc);
+  if (!out) {
+    error = "could not open " + path + " for writing";
+    return false;
+  }
+
+  FileWriter writer;
+  writer.fileWrite.version = 1;
+  writer.fileWrite.WriteBlock = WriteFileBlockCallback;
+  writer.out = &out;
+  writer.tap = &tap;
+
+  if (!FPDF_SaveAsCopy(doc, &writer.fileWrite, 0)) {
+    error = "FPDF_SaveAsCopy failed";
+    return false;
+  }
+
+  out.close();
+  if (out.fail()) {
+    error = "failed writing " + path;
+    return false;
+  }
+  return true;
+}
+
+bool WriteDocumentToFile(int handle, FPDF_DOCUMENT doc,
+                         const std::string& path, std::string& error,
+                         const SaveBlockTap& tap) {
+  if (!FlushAndCloseCachedPages(handle)) {
+    error = "FPDFPage_GenerateContent failed for a dirty page";
+    return false;
+  }
+  return StreamDocumentToFile(doc, path, error, tap);
+}
+
+void SaveDocumentToFile(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
+    Napi::TypeError::New(env,
+      "saveDocumentToFile: requires (handle: number, path: string)"
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  std::string path = info[1].As<Napi::String>().Utf8Value();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return;
+
+  std::string error;
+  if (!WriteDocumentToFile(handle, doc, path, error)) {
+    Napi::Error::New(env, "saveDocumentToFile: " + error)
+      .ThrowAsJavaScriptException();
+  }
+}
@@ -5,6 +5,12 @@
 #define PDFIUM_ADDON_DOCUMENT_H
 
 #include <napi.h>
+#include <fpdfview.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
 
 /** openDocument(data: Buffer, password?: string): number */
 Napi::Value OpenDocument(const Napi::CallbackInfo& info);
@@ -18,4 +24,30 @@ Napi::Value GetPageCount(const Napi::CallbackInfo& info);
 /** saveDocument(handle: number): Buffer */
 Napi::Value SaveDocument(const Napi::CallbackInfo& info);
 
+/**
+ * saveDocumentToFile(handle: number, path: string): void
+ * Streams FPDF_SaveAsCopy output to disk instead of the JS heap.
+ */
+void SaveDocumentToFile(const Napi::CallbackInfo& info);
+
+/** Sees every block FPDF_SaveAsCopy writes, in order (e.g. to hash it). */
+using SaveBlockTap = std::function<void(const uint8_t* data, size_t size)>;
+
+/**
+ * Stream `doc` to `path` (UTF-8) with FPDF_SaveAsCopy.  Does not touch
+ * the page cache, so it also suits documents that were never
+ * registered.  Caller holds g_pdfiumMutex.
+ */
+bool StreamDocumentToFile(FPDF_DOCUMENT doc, const std::string& path,
+                          std::string& error,
+                          const SaveBlockTap& tap = nullptr);
+
+/**
+ * Flush cached pages and stream the document to `path` (UTF-8).
+ * Caller holds g_pdfiumMutex.  Returns false and fills `error` on failure.
+ */
+bool WriteDocumentToFile(int handle, FPDF_DOCUMENT doc,
+                         const std::string& path, std::string& error,
+                         const SaveBlockTap& tap = nullptr);
+
 #endif // PDFIUM_ADDON_DOCUMENT_H
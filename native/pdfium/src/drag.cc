@@ -0,0 +1,351 @@
+/**
+ * drag.cc — Layered previews for dragging and resizing a page object.
+ *
+ * Moving an object for real means mutating it and re-rendering the
+ * page on every mouse move.  Instead, a drag renders two layers once:
+ * the page without the object, and the object alone on a transparent
+ * sprite.  Each preview then only blends the sprite over the base in
+ * the rectangle that changed; the object itself is transformed once,
+ * on drop (transformObject).
+ */
+
+#include "common.h"
+#include "drag.h"
+#include "layers.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+/** Base layer: same flags as renderPage. */
+constexpr int BASE_RENDER_FLAGS = FPDF_ANNOT | FPDF_PRINTING | FPDF_LCD_TEXT;
+
+/** Sprite: no annotations, and no LCD text on a transparent bitmap. */
+constexpr int SPRITE_RENDER_FLAGS = FPDF_PRINTING;
+
+/** Pixels added around the sprite for anti-aliasing and stroke caps. */
+constexpr int SPRITE_PADDING = 2;
+
+constexpr size_t BYTES_PER_PIXEL = 4;
+
+struct DragSession {
+  int handle;
+  int pageIndex;
+  int objectId;
+  double scale;
+  double pageHeight;              ///< Points.
+  int width, height;              ///< Page pixels.
+  std::vector<uint8_t> base;      ///< RGBA, page without the object.
+  PixelRect sprite;               ///< Sprite's original page-pixel rect.
+  std::vector<uint8_t> pixels;    ///< RGBA sprite, straight alpha.
+  PixelRect last;                 ///< Rect of the previous preview.
+};
+
+std::map<int, DragSession> g_dragSessions;
+int g_nextDragSession = 1;
+
+// ── Layer rendering ─────────────────────────────────────────────────
+
+/**
+ * Render the `target` page-pixel rect of `page` at `scale` into
+ * tightly packed RGBA.  `background` is an ARGB fill.
+ */
+bool RenderLayer(FPDF_PAGE page, double scale, const PixelRect& target,
+                 FPDF_DWORD background, int flags, std::vector<uint8_t>& out) {
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(target.width, target.height, 1);
+  if (!bitmap) return false;
+  FPDFBitmap_FillRect(bitmap, 0, 0, target.width, target.height, background);
+
+  const FS_MATRIX matrix = {
+    static_cast<float>(scale), 0, 0, static_cast<float>(scale),
+    static_cast<float>(-target.x), static_cast<float>(-target.y)};
+  const FS_RECTF clip = {0, 0, static_cast<float>(target.width),
+                         static_cast<float>(target.height)};
+  FPDF_RenderPageBitmapWithMatrix(bitmap, page, &matrix, &clip, flags);
+
+  out.resize(static_cast<size_t>(target.width) * target.height * BYTES_PER_PIXEL);
+  CopyBitmapToRgba(bitmap, target.width, target.height, out.data());
+  FPDFBitmap_Destroy(bitmap);
+  return true;
+}
+
+/**
+ * Render both layers from `page`, a throwaway instance: the base with
+ * `selected` removed, then the sprite with every other object removed.
+ * Objects are only taken out of this instance, which is closed without
+ * generating content, so the document and the cached page never see
+ * it.  Takes `selected` back into the page, which frees it on close.
+ */
+bool RenderLayers(FPDF_PAGE page, FPDF_PAGEOBJECT selected,
+                  DragSession& session) {
+  const PixelRect pageRect{0, 0, session.width, session.height};
+
+  if (!FPDFPage_RemoveObject(page, selected)) return false;
+  const bool base = RenderLayer(page, session.scale, pageRect, 0xFFFFFFFF,
+                                BASE_RENDER_FLAGS, session.base);
+
+  for (int i = FPDFPage_CountObjects(page) - 1; i >= 0; i--) {
+    FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i);
+    if (FPDFPage_RemoveObject(page, obj)) FPDFPageObj_Destroy(obj);
+  }
+  FPDFPage_InsertObject(page, selected);
+  return base && RenderLayer(page, session.scale, session.sprite, 0x00000000,
+                             SPRITE_RENDER_FLAGS, session.pixels);
+}
+
+DragSession* RequireSession(Napi::Env env, const Napi::CallbackInfo& info,
+                            const char* fn) {
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, std::string(fn) + ": requires a numeric sessionId")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  auto it = g_dragSessions.find(info[0].As<Napi::Number>().Int32Value());
+  if (it == g_dragSessions.end()) {
+    Napi::Error::New(env, std::string(fn) + ": unknown drag session")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  return &it->second;
+}
+
+Napi::Object RectObject(Napi::Env env, const PixelRect& r) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("x", Napi::Number::New(env, r.x));
+  obj.Set("y", Napi::Number::New(env, r.y));
+  obj.Set("width", Napi::Number::New(env, r.width));
+  obj.Set("height", Napi::Number::New(env, r.height));
+  return obj;
+}
+
+}  // namespace
+
+// ── beginObjectDrag ─────────────────────────────────────────────────
+
+Napi::Value BeginObjectDrag(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 4 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      !info[2].IsNumber() || !info[3].IsNumber()) {
+    Napi::TypeError::New(env,
+      "beginObjectDrag: requires (handle, pageIndex, objectId, scale)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle    = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex = info[1].As<Napi::Number>().Int32Value();
+  int objectId  = info[2].As<Napi::Number>().Int32Value();
+  double scale  = info[3].As<Napi::Number>().DoubleValue();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  if (pageIndex < 0 || pageIndex >= FPDF_GetPageCount(doc) || scale <= 0.0) {
+    Napi::RangeError::New(env, "beginObjectDrag: pageIndex or scale out of range")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Pending edits are written out first: the layers come from a fresh
+  // instance of the page (see RenderLayers), which parses the content
+  // stream.
+  if (!FlushCachedPage(handle, pageIndex)) {
+    Napi::Error::New(env,
+      "beginObjectDrag: FPDFPage_GenerateContent failed for page " +
+      std::to_string(pageIndex)
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+  if (!page) {
+    Napi::Error::New(env,
+      "beginObjectDrag: failed to load page " + std::to_string(pageIndex)
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  FPDF_PAGEOBJECT obj = nullptr;
+  float left = 0, bottom = 0, right = 0, top = 0;
+  if (objectId >= 0 && objectId < FPDFPage_CountObjects(page)) {
+    obj = FPDFPage_GetObject(page, objectId);
+  }
+  if (!obj || !FPDFPageObj_GetBounds(obj, &left, &bottom, &right, &top)) {
+    FPDF_ClosePage(page);
+    Napi::RangeError::New(env,
+      "beginObjectDrag: objectId " + std::to_string(objectId) + " not found"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  DragSession session;
+  session.handle     = handle;
+  session.pageIndex  = pageIndex;
+  session.objectId   = objectId;
+  session.scale      = scale;
+  session.pageHeight = FPDF_GetPageHeightF(page);
+  session.width  = static_cast<int>(FPDF_GetPageWidthF(page) * scale + 0.5);
+  session.height = static_cast<int>(session.pageHeight * scale + 0.5);
+
+  int x0 = static_cast<int>(std::floor(left * scale)) - SPRITE_PADDING;
+  int y0 = static_cast<int>(std::floor((session.pageHeight - top) * scale)) - SPRITE_PADDING;
+  int x1 = static_cast<int>(std::ceil(right * scale)) + SPRITE_PADDING;
+  int y1 = static_cast<int>(std::ceil((session.pageHeight - bottom) * scale)) + SPRITE_PADDING;
+  session.sprite = Intersect({x0, y0, x1 - x0, y1 - y0},
+                             {0, 0, session.width, session.height});
+  session.last = session.sprite;
+
+  const bool ok = session.width > 0 && session.height > 0 &&
+                  !session.sprite.Empty() && RenderLayers(page, obj, session);
+  FPDF_ClosePage(page);
+  if (!ok) {
+    Napi::Error::New(env, "beginObjectDrag: could not render the drag layers")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const int sessionId = g_nextDragSession++;
+  DragSession& stored = g_dragSessions[sessionId] = std::move(session);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("sessionId", Napi::Number::New(env, sessionId));
+  result.Set("data", Napi::Buffer<uint8_t>::Copy(env, stored.base.data(),
+                                                 stored.base.size()));
+  result.Set("width", Napi::Number::New(env, stored.width));
+  result.Set("height", Napi::Number::New(env, stored.height));
+  result.Set("sprite", RectObject(env, stored.sprite));
+  return result;
+}
+
+// ── previewObjectDrag ───────────────────────────────────────────────
+
+Napi::Value PreviewObjectDrag(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  DragSession* session = RequireSession(env, info, "previewObjectDrag");
+  if (!session) return env.Undefined();
+
+  if (info.Length() < 5 || !info[1].IsNumber() || !info[2].IsNumber() ||
+      !info[3].IsNumber() || !info[4].IsNumber()) {
+    Napi::TypeError::New(env,
+      "previewObjectDrag: requires (sessionId, x, y, width, height)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const PixelRect target{info[1].As<Napi::Number>().Int32Value(),
+                    info[2].As<Napi::Number>().Int32Value(),
+                    info[3].As<Napi::Number>().Int32Value(),
+                    info[4].As<Napi::Number>().Int32Value()};
+  if (target.Empty()) {
+    Napi::RangeError::New(env, "previewObjectDrag: width and height must be > 0")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const PixelRect pageRect{0, 0, session->width, session->height};
+  const PixelRect patch = Intersect(Union(session->last, target), pageRect);
+  session->last = target;
+
+  Napi::Object result = RectObject(env, patch.Empty() ? PixelRect{} : patch);
+  if (patch.Empty()) {
+    result.Set("data", Napi::Buffer<uint8_t>::New(env, 0));
+    return result;
+  }
+
+  // Base layer under the patch…
+  const size_t patchStride = static_cast<size_t>(patch.width) * BYTES_PER_PIXEL;
+  auto data = Napi::Buffer<uint8_t>::New(env, patchStride * patch.height);
+  for (int y = 0; y < patch.height; ++y) {
+    std::memcpy(data.Data() + y * patchStride,
+                session->base.data() +
+                  (static_cast<size_t>(patch.y + y) * session->width + patch.x) *
+                  BYTES_PER_PIXEL,
+                patchStride);
+  }
+
+  // …then the sprite, nearest-sampled when resized.
+  const PixelRect drawn = Intersect(target, patch);
+  const PixelRect& sprite = session->sprite;
+  const bool resized = target.width != sprite.width || target.height != sprite.height;
+  std::vector<int> columns(drawn.Empty() ? 0 : drawn.width);
+  std::vector<uint8_t> row(columns.size() * BYTES_PER_PIXEL);
+  for (int x = 0; x < drawn.width; ++x) {
+    columns[x] = static_cast<int>(
+      (static_cast<int64_t>(drawn.x + x - target.x) * sprite.width) / target.width);
+  }
+
+  for (int y = 0; y < drawn.height; ++y) {
+    const int sy = static_cast<int>(
+      (static_cast<int64_t>(drawn.y + y - target.y) * sprite.height) / target.height);
+    const uint8_t* spriteRow =
+      session->pixels.data() + static_cast<size_t>(sy) * sprite.width * BYTES_PER_PIXEL;
+
+    const uint8_t* src;
+    if (resized) {
+      for (int x = 0; x < drawn.width; ++x) {
+        std::memcpy(&row[x * BYTES_PER_PIXEL],
+                    spriteRow + columns[x] * BYTES_PER_PIXEL, BYTES_PER_PIXEL);
+      }
+      src = row.data();
+    } else {
+      src = spriteRow + static_cast<size_t>(columns[0]) * BYTES_PER_PIXEL;
+    }
+
+    uint8_t* dst = data.Data() + (drawn.y - patch.y + y) * patchStride +
+                   static_cast<size_t>(drawn.x - patch.x) * BYTES_PER_PIXEL;
+    BlendRowOver(dst, src, drawn.width);
+  }
+
+  result.Set("data", data);
+  return result;
+}
+
+// ── endObjectDrag ───────────────────────────────────────────────────
+
+Napi::Value EndObjectDrag(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  DragSession* session = RequireSession(env, info, "endObjectDrag");
+  if (!session) return env.Undefined();
+
+  const PixelRect from = session->sprite;
+  const PixelRect to = session->last;
+  const double s = session->scale;
+  const double h = session->pageHeight;
+  g_dragSessions.erase(info[0].As<Napi::Number>().Int32Value());
+
+  if (to.x == from.x && to.y == from.y &&
+      to.width == from.width && to.height == from.height) {
+    return env.Null();
+  }
+
+  // Map the sprite's rectangle onto the target's, in PDF space (y up).
+  const double sx = static_cast<double>(to.width) / from.width;
+  const double sy = static_cast<double>(to.height) / from.height;
+  const double matrix[6] = {
+    sx, 0, 0, sy,
+    to.x / s - (from.x / s) * sx,
+    h - to.y / s - (h - from.y / s) * sy,
+  };
+
+  Napi::Array result = Napi::Array::New(env, 6);
+  for (uint32_t i = 0; i < 6; ++i) result.Set(i, Napi::Number::New(env, matrix[i]));
+  return result;
+}
+
+void DiscardDragSessions(int handle) {
+  for (auto it = g_dragSessions.begin(); it != g_dragSessions.end();) {
+    it = it->second.handle == handle ? g_dragSessions.erase(it) : std::next(it);
+  }
+}
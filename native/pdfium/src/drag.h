@@ -0,0 +1,42 @@
+/**
+ * drag.h — Layered previews for dragging and resizing a page object.
+ */
+#ifndef PDFIUM_ADDON_DRAG_H
+#define PDFIUM_ADDON_DRAG_H
+
+#include <napi.h>
+
+/**
+ * beginObjectDrag(handle, pageIndex, objectId, scale)
+ * → { sessionId, data: Buffer (RGBA), width, height,
+ *     sprite: { x, y, width, height } }
+ *
+ * Renders the page once without the object (`data`, the base layer)
+ * and the object alone into a sprite whose page-pixel rectangle is
+ * `sprite`.  The document is left unchanged.
+ */
+Napi::Value BeginObjectDrag(const Napi::CallbackInfo& info);
+
+/**
+ * previewObjectDrag(sessionId, x, y, width, height)
+ * → { data: Buffer (RGBA), x, y, width, height }
+ *
+ * Composites the sprite, scaled to the given page-pixel rectangle,
+ * over the base layer.  Returns only the patch that changed since the
+ * previous preview (the union of the old and new rectangles).
+ */
+Napi::Value PreviewObjectDrag(const Napi::CallbackInfo& info);
+
+/**
+ * endObjectDrag(sessionId) → [a, b, c, d, e, f] | null
+ *
+ * Ends the session and returns the PDF-space matrix that moves the
+ * object to the last previewed rectangle (null if it never moved).
+ * Apply it with transformObject to commit the drop.
+ */
+Napi::Value EndObjectDrag(const Napi::CallbackInfo& info);
+
+/** Drop the drag sessions of a closed document. */
+void DiscardDragSessions(int handle);
+
+#endif // PDFIUM_ADDON_DRAG_H
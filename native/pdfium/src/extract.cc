@@ -0,0 +1,656 @@
+/**
+ * extract.cc — Writing a document's images out as files.
+ *
+ * Extracting thousands of scanned photos should cost about what copying
+ * their bytes costs.  Most PDF images are JPEG (DCTDecode) streams that
+ * are already a valid .jpg, so the only PDFium work per image is reading
+ * the still-encoded stream and its filter list under the lock.  Flate
+ * samples are checked against PDFium's decoding there, and kept as PNG
+ * rows only when they match it.  Encoding is done by a pool of writer
+ * threads that also do the file I/O, fed from a bounded queue so a fast
+ * page reader cannot outrun the disk unchecked.
+ */
+
+#include "common.h"
+#include "extract.h"
+#include "deflate.h"
+#include "inflate.h"
+#include "jobs.h"
+#include "pdfscan.h"
+#include "png.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/** Encoded bytes allowed in flight between the page reader and writers. */
+constexpr size_t MAX_QUEUED_BYTES = 256u * 1024 * 1024;
+
+/** Cap on any one inflated stream, against decompression bombs. */
+constexpr size_t MAX_DECODED_BYTES = 1024u * 1024 * 1024;
+
+// ── Tasks ───────────────────────────────────────────────────────────
+
+/** One image read from a page, waiting for a writer thread. */
+struct ImageTask {
+  enum Kind {
+    Encoded,   ///< DCT / JPX stream, possibly under FlateDecode layers
+    Samples,   ///< gray or RGB sample rows, laid out as `rows` says
+    Pixels,    ///< decoded by PDFium into a bitmap
+  };
+
+  enum Rows {
+    Plain,     ///< packed sample rows
+    Filtered,  ///< rows each led by a PNG filter type byte
+    Idat,      ///< Filtered rows still in their one zlib layer
+  };
+
+  int pageIndex = 0;
+  int objectIndex = 0;
+  Kind kind = Pixels;
+  std::vector<uint8_t> data;
+  int inflate = 0;            ///< Encoded: FlateDecode layers to undo
+  const char* ext = "png";    ///< Encoded
+  int width = 0;
+  int height = 0;
+  PngColor color = PngColor::Gray;   ///< Samples
+  int bitDepth = 8;                  ///< Samples
+  Rows rows = Plain;                 ///< Samples
+  int bitmapFormat = 0;              ///< Pixels
+  size_t stride = 0;                 ///< Pixels
+};
+
+struct ExtractedImage {
+  int pageIndex;
+  int objectIndex;
+  std::string path;
+  const char* format;
+  bool passthrough;   ///< written without decoding or re-encoding
+};
+
+struct ExtractFailure {
+  int pageIndex;
+  int objectIndex;   ///< -1 when the whole page failed
+  std::string error;
+};
+
+/**
+ * FIFO between the page reader and the writers.  Push blocks while more
+ * than `budget` bytes are queued (an oversized task is still let through
+ * an empty queue); Pop blocks until a task arrives or Close is called.
+ */
+class TaskQueue {
+ public:
+  explicit TaskQueue(size_t budget) : budget_(budget) {}
+
+  void Push(ImageTask task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notFull_.wait(lock, [&] { return tasks_.empty() || bytes_ < budget_; });
+    bytes_ += task.data.size();
+    tasks_.push_back(std::move(task));
+    notEmpty_.notify_one();
+  }
+
+  /** False once the queue is closed and drained. */
+  bool Pop(ImageTask& task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notEmpty_.wait(lock, [&] { return !tasks_.empty() || closed_; });
+    if (tasks_.empty()) return false;
+    task = std::move(tasks_.front());
+    tasks_.pop_front();
+    bytes_ -= task.data.size();
+    notFull_.notify_one();
+    return true;
+  }
+
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    notEmpty_.notify_all();
+  }
+
+ private:
+  const size_t budget_;
+  std::mutex mutex_;
+  std::condition_variable notEmpty_;
+  std::condition_variable notFull_;
+  std::deque<ImageTask> tasks_;
+  size_t bytes_ = 0;
+  bool closed_ = false;
+};
+
+// ── Reading (g_pdfiumMutex held) ────────────────────────────────────
+
+std::vector<std::string> ImageFilters(FPDF_PAGEOBJECT obj) {
+  std::vector<std::string> filters;
+  const int count = FPDFImageObj_GetImageFilterCount(obj);
+  for (int i = 0; i < count; i++) {
+    unsigned long len = FPDFImageObj_GetImageFilter(obj, i, nullptr, 0);
+    std::string name(len, '\0');
+    if (len) FPDFImageObj_GetImageFilter(obj, i, &name[0], len);
+    while (!name.empty() && name.back() == '\0') name.pop_back();
+    filters.push_back(std::move(name));
+  }
+  return filters;
+}
+
+bool IsFlate(const std::string& f) { return f == "FlateDecode" || f == "Fl"; }
+
+/**
+ * Guess a PNG layout from an image's colour space and depth, or false
+ * when PNG cannot hold its samples unconverted (CMYK, Lab, Indexed,
+ * DeviceN, stencil masks).  It is only a guess: bits_per_pixel is the
+ * depth of PDFium's decoded bitmap, so 16-bit RGB reads as 24 and 2- or
+ * 4-bit gray as 8, and ICCBased spaces are taken by component count.
+ * ReadSamples confirms it against PDFium's own decoding.
+ */
+bool PngLayout(const FPDF_IMAGEOBJ_METADATA& meta, PngColor& color, int& bitDepth) {
+  int components;
+  switch (meta.colorspace) {
+    case FPDF_COLORSPACE_DEVICEGRAY:
+    case FPDF_COLORSPACE_CALGRAY:
+      components = 1;
+      break;
+    case FPDF_COLORSPACE_DEVICERGB:
+    case FPDF_COLORSPACE_CALRGB:
+      components = 3;
+      break;
+    case FPDF_COLORSPACE_ICCBASED:
+      components = meta.bits_per_pixel % 3 == 0 ? 3 : 1;
+      break;
+    default:
+      return false;
+  }
+
+  bitDepth = static_cast<int>(meta.bits_per_pixel) / components;
+  color = components == 1 ? PngColor::Gray : PngColor::Rgb;
+  if (components == 3) return bitDepth == 8 || bitDepth == 16;
+  return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 ||
+         bitDepth == 8 || bitDepth == 16;
+}
+
+void ReadRaw(FPDF_PAGEOBJECT obj, std::vector<uint8_t>& out) {
+  out.resize(FPDFImageObj_GetImageDataRaw(obj, nullptr, 0));
+  if (!out.empty()) {
+    FPDFImageObj_GetImageDataRaw(obj, out.data(),
+                                 static_cast<unsigned long>(out.size()));
+  }
+}
+
+/** Undo `layers` FlateDecode filters; false if any layer is corrupt. */
+bool Unwrap(std::vector<uint8_t>& data, int layers, size_t limit) {
+  for (int i = 0; i < layers; i++) {
+    std::vector<uint8_t> out;
+    if (!Inflate(data.data(), data.size(), out, limit)) return false;
+    data.swap(out);
+  }
+  return true;
+}
+
+/** True if every row of `data` starts with a PNG filter type (0–4). */
+bool HasRowFilters(const std::vector<uint8_t>& data, size_t rowBytes, int height) {
+  for (int y = 0; y < height; y++) {
+    if (data[static_cast<size_t>(y) * (rowBytes + 1)] > 4) return false;
+  }
+  return true;
+}
+
+/**
+ * True if packed sample rows, laid out as `task` says, hold the colours
+ * of PDFium's decoded `bitmap`.  PDFium applies everything the stream
+ * dictionary asks for (predictors, /Decode arrays) and the public API
+ * exposes neither, so this comparison is the only proof that the rows
+ * show what PDFium would.  Depths below 8 are scaled to 0–255, and
+ * 16-bit samples keep their high byte, as PDFium does.
+ */
+bool SamplesMatchBitmap(const std::vector<uint8_t>& rows, const ImageTask& task,
+                        FPDF_BITMAP bitmap) {
+  if (FPDFBitmap_GetWidth(bitmap) != task.width ||
+      FPDFBitmap_GetHeight(bitmap) != task.height) {
+    return false;
+  }
+  int pixelBytes;
+  switch (FPDFBitmap_GetFormat(bitmap)) {
+    case FPDFBitmap_Gray: pixelBytes = 1; break;
+    case FPDFBitmap_BGR:  pixelBytes = 3; break;
+    case FPDFBitmap_BGRx:
+    case FPDFBitmap_BGRA: pixelBytes = 4; break;
+    default: return false;
+  }
+  const int channels = task.color == PngColor::Rgb ? 3 : 1;
+  if (pixelBytes == 1 && channels != 1) return false;
+
+  const int depth = task.bitDepth;
+  const unsigned maxSample = depth >= 8 ? 255 : (1u << depth) - 1;
+  const size_t rowBytes =
+    (static_cast<size_t>(task.width) * channels * depth + 7) / 8;
+  const size_t stride = static_cast<size_t>(FPDFBitmap_GetStride(bitmap));
+  const auto* buffer = static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+
+  for (int y = 0; y < task.height; y++) {
+    const uint8_t* row = rows.data() + static_cast<size_t>(y) * rowBytes;
+    const uint8_t* px = buffer + static_cast<size_t>(y) * stride;
+    for (int x = 0; x < task.width; x++, px += pixelBytes) {
+      for (int c = 0; c < channels; c++) {
+        const size_t sample = static_cast<size_t>(x) * channels + c;
+        unsigned v;
+        if (depth == 16) {
+          v = row[sample * 2];
+        } else if (depth == 8) {
+          v = row[sample];
+        } else {
+          const size_t bit = sample * depth;
+          v = (row[bit / 8] >> (8 - depth - bit % 8)) & maxSample;
+          v = v * 255 / maxSample;
+        }
+        // BGR order; a gray sample is expected in all three channels.
+        if (channels == 3 && px[2 - c] != v) return false;
+        if (channels == 1 && (px[0] != v || (pixelBytes > 1 &&
+                              (px[1] != v || px[2] != v)))) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Read the sample rows of an image whose layout PngLayout guessed into
+ * `task`, keeping them only if the decoded stream is exactly as long as
+ * that layout's rows, with or without PNG predictor bytes, and the rows
+ * match `bitmap`, PDFium's decoding of the same image.  Anything else
+ * (a TIFF predictor, a /Decode array, another bit depth, a corrupt
+ * stream) returns false so the image is written from the bitmap
+ * instead.  The Flate layers are undone here, under the lock, because
+ * only here can a mismatch still fall back; PNG encoding is left to the
+ * writers.
+ */
+bool ReadSamples(FPDF_PAGEOBJECT obj, int layers, FPDF_BITMAP bitmap,
+                 ImageTask& task) {
+  const int channels = task.color == PngColor::Rgb ? 3 : 1;
+  const size_t rowBytes =
+    (static_cast<size_t>(task.width) * channels * task.bitDepth + 7) / 8;
+  const size_t plain = rowBytes * task.height;
+  const size_t predicted = (rowBytes + 1) * task.height;
+
+  std::vector<uint8_t> raw;
+  ReadRaw(obj, raw);
+  std::vector<uint8_t> samples = raw;
+  if (!Unwrap(samples, layers, std::min(predicted, MAX_DECODED_BYTES))) return false;
+
+  // PDF's PNG predictors are PNG's own row filters: with one Flate layer
+  // the stream is a ready-made IDAT.  Nothing says which predictor was
+  // used, but the length tells a predicted stream from a plain one, and
+  // undoing the filters must give PDFium's pixels.
+  if (layers > 0 && samples.size() == predicted &&
+      HasRowFilters(samples, rowBytes, task.height)) {
+    std::vector<uint8_t> rows = samples;
+    if (!UndoPngPredictor(rows, channels, task.bitDepth, task.width) ||
+        !SamplesMatchBitmap(rows, task, bitmap)) {
+      return false;
+    }
+    task.rows = layers == 1 ? ImageTask::Idat : ImageTask::Filtered;
+    task.data = layers == 1 ? std::move(raw) : std::move(samples);
+    return true;
+  }
+  if (samples.size() == plain && SamplesMatchBitmap(samples, task, bitmap)) {
+    task.rows = ImageTask::Plain;
+    task.data = std::move(samples);
+    return true;
+  }
+  return false;
+}
+
+/** Fill `task` from an image object; false (with `error`) to skip it. */
+bool ReadImage(FPDF_PAGEOBJECT obj, FPDF_PAGE page, ImageTask& task,
+               std::string& error) {
+  const std::vector<std::string> filters = ImageFilters(obj);
+  const int flate = static_cast<int>(
+    std::find_if_not(filters.begin(), filters.end(), IsFlate) - filters.begin());
+  const int count = static_cast<int>(filters.size());
+
+  if (count > 0 && flate == count - 1) {
+    const std::string& last = filters.back();
+    if (last == "DCTDecode" || last == "DCT" || last == "JPXDecode") {
+      task.kind = ImageTask::Encoded;
+      task.ext = last == "JPXDecode" ? "jp2" : "jpg";
+      task.inflate = flate;
+      ReadRaw(obj, task.data);
+      return true;
+    }
+  }
+
+  // CCITT, JBIG2, LZW, RunLength and colour spaces PNG has no room for
+  // are written from PDFium's bitmap.  So are Flate samples that are not
+  // what the bitmap shows.
+  FPDF_BITMAP bitmap = FPDFImageObj_GetBitmap(obj);
+  if (!bitmap) {
+    error = "image could not be decoded";
+    return false;
+  }
+
+  FPDF_IMAGEOBJ_METADATA meta = {};
+  if (flate == count && FPDFImageObj_GetImageMetadata(obj, page, &meta) &&
+      meta.width > 0 && meta.height > 0 &&
+      PngLayout(meta, task.color, task.bitDepth)) {
+    task.width = static_cast<int>(meta.width);
+    task.height = static_cast<int>(meta.height);
+    if (ReadSamples(obj, flate, bitmap, task)) {
+      FPDFBitmap_Destroy(bitmap);
+      task.kind = ImageTask::Samples;
+      return true;
+    }
+  }
+
+  task.kind = ImageTask::Pixels;
+  task.width = FPDFBitmap_GetWidth(bitmap);
+  task.height = FPDFBitmap_GetHeight(bitmap);
+  task.stride = static_cast<size_t>(FPDFBitmap_GetStride(bitmap));
+  task.bitmapFormat = FPDFBitmap_GetFormat(bitmap);
+  const auto* buffer = static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+  task.data.assign(buffer, buffer + task.stride * task.height);
+  FPDFBitmap_Destroy(bitmap);
+  return true;
+}
+
+// ── Writing (any thread, no lock) ───────────────────────────────────
+
+/** Encode gray or RGB sample rows as PNG; `passthrough` if the stream was reused. */
+void SamplesToPng(const ImageTask& task, std::vector<uint8_t>& file, bool& passthrough) {
+  switch (task.rows) {
+    case ImageTask::Idat:
+      WrapPng(task.data.data(), task.data.size(), task.width, task.height,
+              task.color, task.bitDepth, file);
+      passthrough = true;
+      break;
+    case ImageTask::Filtered: {
+      std::vector<uint8_t> zlib;
+      Deflate(task.data.data(), task.data.size(), zlib);
+      WrapPng(zlib.data(), zlib.size(), task.width, task.height,
+              task.color, task.bitDepth, file);
+      break;
+    }
+    case ImageTask::Plain: {
+      const int channels = task.color == PngColor::Rgb ? 3 : 1;
+      const size_t rowBytes =
+        (static_cast<size_t>(task.width) * channels * task.bitDepth + 7) / 8;
+      EncodePng(task.data.data(), rowBytes, task.width, task.height,
+                task.color, task.bitDepth, file);
+      break;
+    }
+  }
+}
+
+/** Encode a PDFium bitmap (Gray, BGR, BGRx or BGRA) as PNG. */
+void PixelsToPng(const ImageTask& task, std::vector<uint8_t>& file) {
+  if (task.bitmapFormat == FPDFBitmap_Gray) {
+    EncodePng(task.data.data(), task.stride, task.width, task.height,
+              PngColor::Gray, 8, file);
+    return;
+  }
+
+  const bool alpha = task.bitmapFormat == FPDFBitmap_BGRA;
+  const int in = task.bitmapFormat == FPDFBitmap_BGR ? 3 : 4;
+  const int out = alpha ? 4 : 3;
+  std::vector<uint8_t> rgb(static_cast<size_t>(task.width) * out * task.height);
+  uint8_t* dst = rgb.data();
+  for (int y = 0; y < task.height; y++) {
+    const uint8_t* src = task.data.data() + static_cast<size_t>(y) * task.stride;
+    for (int x = 0; x < task.width; x++, src += in, dst += out) {
+      dst[0] = src[2];
+      dst[1] = src[1];
+      dst[2] = src[0];
+      if (alpha) dst[3] = src[3];
+    }
+  }
+  EncodePng(rgb.data(), static_cast<size_t>(task.width) * out, task.width,
+            task.height, alpha ? PngColor::Rgba : PngColor::Rgb, 8, file);
+}
+
+// ── ExtractJob ──────────────────────────────────────────────────────
+
+class ExtractJob : public Job {
+ public:
+  ExtractJob(Napi::Env env, int handle, std::vector<int> pages,
+             std::string outDir, int threads, Napi::Value onProgress)
+    : Job(env, onProgress),
+      handle_(handle),
+      pages_(std::move(pages)),
+      outDir_(std::move(outDir)),
+      threads_(threads) {}
+
+ protected:
+  void Execute(const ExecutionProgress& progress) override {
+    TaskQueue queue(MAX_QUEUED_BYTES);
+    std::vector<std::thread> writers;
+    for (int w = 0; w < threads_; w++) {
+      writers.emplace_back([&] {
+        // Keep draining after a cancel so a blocked Push can return.
+        for (ImageTask task; queue.Pop(task);) {
+          if (CancelRequested()) continue;
+          try {
+            Write(task);
+          } catch (const std::exception& e) {
+            Fail(task.pageIndex, task.objectIndex, e.what());
+          }
+        }
+      });
+    }
+
+    const int total = static_cast<int>(pages_.size());
+    int done = 0;
+    std::string error;
+    for (int pageIndex : pages_) {
+      if (CancelRequested()) break;
+
+      std::vector<ImageTask> tasks;
+      {
+        PdfiumLock lock(g_pdfiumMutex);
+        auto it = g_documents.find(handle_);
+        if (it == g_documents.end()) {
+          error = "document was closed while the job was running";
+          break;
+        }
+        ReadPage(it->second, pageIndex, tasks);
+      }
+      for (ImageTask& task : tasks) queue.Push(std::move(task));
+
+      JobProgress p = { ++done, total };
+      progress.Send(&p, 1);
+    }
+
+    queue.Close();
+    for (auto& t : writers) t.join();
+
+    if (!error.empty()) {
+      SetError(error);
+    } else if (CancelRequested()) {
+      MarkCancelled();
+    }
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    auto byPosition = [](const auto& a, const auto& b) {
+      return std::make_pair(a.pageIndex, a.objectIndex) <
+             std::make_pair(b.pageIndex, b.objectIndex);
+    };
+    std::sort(files_.begin(), files_.end(), byPosition);
+    std::sort(failed_.begin(), failed_.end(), byPosition);
+
+    Napi::Array files = Napi::Array::New(env, files_.size());
+    for (size_t i = 0; i < files_.size(); i++) {
+      const ExtractedImage& f = files_[i];
+      Napi::Object o = Napi::Object::New(env);
+      o.Set("pageIndex", Napi::Number::New(env, f.pageIndex));
+      o.Set("objectIndex", Napi::Number::New(env, f.objectIndex));
+      o.Set("path", f.path);
+      o.Set("format", f.format);
+      o.Set("passthrough", Napi::Boolean::New(env, f.passthrough));
+      files[static_cast<uint32_t>(i)] = o;
+    }
+
+    Napi::Array failed = Napi::Array::New(env, failed_.size());
+    for (size_t i = 0; i < failed_.size(); i++) {
+      const ExtractFailure& f = failed_[i];
+      Napi::Object o = Napi::Object::New(env);
+      o.Set("pageIndex", Napi::Number::New(env, f.pageIndex));
+      o.Set("objectIndex", Napi::Number::New(env, f.objectIndex));
+      o.Set("error", f.error);
+      failed[static_cast<uint32_t>(i)] = o;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("files", files);
+    result.Set("failed", failed);
+    return result;
+  }
+
+ private:
+  void ReadPage(FPDF_DOCUMENT doc, int pageIndex, std::vector<ImageTask>& tasks) {
+    bool fromCache = false;
+    FPDF_PAGE page = AcquirePage(handle_, doc, pageIndex, fromCache);
+    if (!page) {
+      Fail(pageIndex, -1, "failed to load page");
+      return;
+    }
+
+    const int count = FPDFPage_CountObjects(page);
+    for (int i = 0; i < count; i++) {
+      FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i);
+      if (FPDFPageObj_GetType(obj) != FPDF_PAGEOBJ_IMAGE) continue;
+
+      ImageTask task;
+      task.pageIndex = pageIndex;
+      task.objectIndex = i;
+      std::string error;
+      if (ReadImage(obj, page, task, error)) {
+        tasks.push_back(std::move(task));
+      } else {
+        Fail(pageIndex, i, error);
+      }
+    }
+    ReleasePage(handle_, pageIndex, page, fromCache);
+  }
+
+  void Write(const ImageTask& task) {
+    std::vector<uint8_t> file;
+    const char* ext = "png";
+    bool passthrough = false;
+    std::string error;
+
+    switch (task.kind) {
+      case ImageTask::Encoded:
+        file = task.data;
+        if (!Unwrap(file, task.inflate, MAX_DECODED_BYTES)) {
+          error = "image data is corrupt";
+        }
+        ext = task.ext;
+        passthrough = task.inflate == 0;
+        break;
+      case ImageTask::Samples:
+        SamplesToPng(task, file, passthrough);
+        break;
+      case ImageTask::Pixels:
+        PixelsToPng(task, file);
+        break;
+    }
+    if (!error.empty()) {
+      Fail(task.pageIndex, task.objectIndex, error);
+      return;
+    }
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "page%04d-obj%d.%s",
+                  task.pageIndex + 1, task.objectIndex, ext);
+    const std::filesystem::path path = std::filesystem::u8path(outDir_) / name;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(file.data()),
+              static_cast<std::streamsize>(file.size()));
+    out.close();
+    if (!out) {
+      Fail(task.pageIndex, task.objectIndex, "could not write " + path.u8string());
+      return;
+    }
+
+    const char* format = std::strcmp(ext, "jpg") == 0 ? "jpeg" : ext;
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    files_.push_back({ task.pageIndex, task.objectIndex, path.u8string(),
+                       format, passthrough });
+  }
+
+  void Fail(int pageIndex, int objectIndex, std::string error) {
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    failed_.push_back({ pageIndex, objectIndex, std::move(error) });
+  }
+
+  const int handle_;
+  const std::vector<int> pages_;
+  const std::string outDir_;
+  const int threads_;
+
+  std::mutex resultsMutex_;
+  std::vector<ExtractedImage> files_;
+  std::vector<ExtractFailure> failed_;
+};
+
+} // namespace
+
+// ── extractImages ───────────────────────────────────────────────────
+
+Napi::Value ExtractImages(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
+    Napi::TypeError::New(env,
+      "extractImages: requires (handle: number, outDir: string, options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  std::string outDir = info[1].As<Napi::String>().Utf8Value();
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  Napi::Value options    = info.Length() > 2 ? info[2] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 3 ? info[3] : env.Undefined();
+
+  std::vector<int> pages;
+  Napi::Value pagesArg = options.IsObject()
+    ? options.As<Napi::Object>().Get("pages")
+    : env.Undefined();
+  if (!ReadPageList(env, pagesArg, FPDF_GetPageCount(doc), "extractImages", pages)) {
+    return env.Undefined();
+  }
+
+  const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  double threads = GetNumberOption(options, "threads", cores);
+  if (!(threads >= 1)) {
+    Napi::RangeError::New(env, "extractImages: threads must be >= 1")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto* job = new ExtractJob(env, handle, std::move(pages), std::move(outDir),
+                             static_cast<int>(std::min<double>(threads, 256)),
+                             onProgress);
+  return job->Start();
+}
@@ -0,0 +1,28 @@
+/**
+ * extract.h — Image extraction to files.
+ */
+#ifndef PDFIUM_ADDON_EXTRACT_H
+#define PDFIUM_ADDON_EXTRACT_H
+
+#include <napi.h>
+
+/**
+ * extractImages(handle, outDir, options?, onProgress?) → { jobId, done }
+ *
+ * options: { pages?: number[], threads?: number }
+ *
+ * Writes every image object on the listed pages (all by default) into
+ * `outDir`, which must exist, as page<NNNN>-obj<M>.<ext>.  Images are
+ * read still encoded: a DCTDecode or JPXDecode stream is written as-is
+ * (.jpg / .jp2), and a FlateDecode one in gray or RGB becomes a PNG —
+ * re-using the compressed data when it already carries PNG predictors.
+ * Flate samples are inflated while the page is read, under the lock, to
+ * confirm their bit depth by length; other encodings, and samples that
+ * do not match, go through PDFium's decoder.  PNG encoding and file I/O
+ * run on `threads` writer threads (all cores by default) outside
+ * g_pdfiumMutex; pages are read under the lock one at a time.  `done`
+ * resolves with { files, failed }; progress counts pages.
+ */
+Napi::Value ExtractImages(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_EXTRACT_H
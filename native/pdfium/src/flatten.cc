@@ -0,0 +1,164 @@
+/**
+ * flatten.cc — Bake annotation and form-field appearances into page
+ * content with FPDFPage_Flatten.
+ *
+ * Flattening draws each annotation's appearance stream into the page
+ * content and removes the page's /Annots array, so later renders no
+ * longer pay for per-annotation appearance processing (FPDF_ANNOT).
+ */
+
+#include "common.h"
+#include "flatten.h"
+#include "jobs.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_annot.h>
+#include <fpdf_flatten.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+class FlattenJob : public PageJob {
+ public:
+  FlattenJob(Napi::Env env, int handle, std::vector<int> pages,
+             Napi::Value onProgress, bool annotations, bool forms,
+             int flattenMode)
+    : PageJob(env, handle, std::move(pages), onProgress),
+      annotations_(annotations),
+      forms_(forms),
+      flattenMode_(flattenMode) {}
+
+ protected:
+  bool ProcessPage(FPDF_DOCUMENT doc, int pageIndex,
+                   std::string& error) override {
+    // FPDFPage_Flatten rewrites the page dictionary, not the in-memory
+    // objects of an open page.  Write any cached edits into the content
+    // stream first and drop the cached page so it reloads flattened.
+    if (!FlushCachedPage(handle_, pageIndex)) {
+      error = "flattenDocument: FPDFPage_GenerateContent failed for page " +
+              std::to_string(pageIndex);
+      return false;
+    }
+
+    FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+    if (!page) {
+      failed_.push_back(pageIndex);
+      return true;
+    }
+
+    if (!IsEligible(page)) {
+      skipped_.push_back(pageIndex);
+    } else {
+      switch (FPDFPage_Flatten(page, flattenMode_)) {
+        case FLATTEN_SUCCESS:     flattened_++;                  break;
+        case FLATTEN_NOTHINGTODO: unchanged_++;                  break;
+        default:                  failed_.push_back(pageIndex);  break;
+      }
+    }
+
+    FPDF_ClosePage(page);
+    // Baked widget and FreeText appearances now contribute page text.
+    InvalidateTextPageData(handle_, pageIndex);
+    return true;
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("flattened", Napi::Number::New(env, flattened_));
+    result.Set("unchanged", Napi::Number::New(env, unchanged_));
+    result.Set("skipped",   ToArray(env, skipped_));
+    result.Set("failed",    ToArray(env, failed_));
+    return result;
+  }
+
+ private:
+  /**
+   * FPDFPage_Flatten cannot pick annotation kinds: it bakes everything
+   * it can draw and drops /Annots wholesale.  A page is only flattened
+   * when every annotation on it belongs to a requested class; pages
+   * holding an excluded kind are left untouched and reported as skipped.
+   */
+  bool IsEligible(FPDF_PAGE page) const {
+    int count = FPDFPage_GetAnnotCount(page);
+    for (int i = 0; i < count; i++) {
+      FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, i);
+      if (!annot) continue;
+      FPDF_ANNOTATION_SUBTYPE subtype = FPDFAnnot_GetSubtype(annot);
+      FPDFPage_CloseAnnot(annot);
+
+      bool isField = subtype == FPDF_ANNOT_WIDGET ||
+                     subtype == FPDF_ANNOT_XFAWIDGET;
+      if (isField ? !forms_ : !annotations_) return false;
+    }
+    return true;
+  }
+
+  static Napi::Array ToArray(Napi::Env env, const std::vector<int>& v) {
+    Napi::Array arr = Napi::Array::New(env, v.size());
+    for (size_t i = 0; i < v.size(); i++) {
+      arr[static_cast<uint32_t>(i)] = Napi::Number::New(env, v[i]);
+    }
+    return arr;
+  }
+
+  const bool annotations_;
+  const bool forms_;
+  const int  flattenMode_;
+
+  int flattened_ = 0;
+  int unchanged_ = 0;
+  std::vector<int> skipped_;
+  std::vector<int> failed_;
+};
+
+} // namespace
+
+// ── flattenDocument ─────────────────────────────────────────────────
+
+Napi::Value FlattenDocument(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env,
+      "flattenDocument: requires (handle: number, options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  Napi::Value options    = info.Length() > 1 ? info[1] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 2 ? info[2] : env.Undefined();
+
+  bool annotations = GetBoolOption(options, "annotations", true);
+  bool forms       = GetBoolOption(options, "forms", true);
+  bool print       = GetBoolOption(options, "print", false);
+
+  if (!annotations && !forms) {
+    Napi::RangeError::New(env,
+      "flattenDocument: at least one of annotations/forms must be true"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<int> pages;
+  Napi::Value pagesArg = options.IsObject()
+    ? options.As<Napi::Object>().Get("pages")
+    : env.Undefined();
+  if (!ReadPageList(env, pagesArg, FPDF_GetPageCount(doc),
+                    "flattenDocument", pages)) {
+    return env.Undefined();
+  }
+
+  auto* job = new FlattenJob(env, handle, std::move(pages), onProgress,
+                             annotations, forms,
+                             print ? FLAT_PRINT : FLAT_NORMALDISPLAY);
+  return job->Start();
+}
@@ -0,0 +1,18 @@
+/**
+ * flatten.h — Annotation and form-field flattening.
+ */
+#ifndef PDFIUM_ADDON_FLATTEN_H
+#define PDFIUM_ADDON_FLATTEN_H
+
+#include <napi.h>
+
+/**
+ * flattenDocument(handle, options?, onProgress?)
+ * → { jobId, done: Promise<{ flattened, unchanged, skipped, failed }> }
+ *
+ * options: { annotations?: boolean = true, forms?: boolean = true,
+ *            print?: boolean = false, pages?: number[] }
+ */
+Napi::Value FlattenDocument(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_FLATTEN_H
@@ -0,0 +1,94 @@
+/**
+ * fonts.cc — Font loading cache for text edits.
+ */
+
+#include "common.h"
+#include "fonts.h"
+#include "sha256.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+
+#include <map>
+#include <string>
+
+namespace {
+
+/** handle → (font identity → loaded font). */
+std::map<int, std::map<std::string, FPDF_FONT>> g_fonts;
+
+/** Prefix of references to fonts loaded from data. */
+constexpr char DATA_FONT_PREFIX[] = "font:";
+
+FPDF_FONT FindFont(int handle, const std::string& key) {
+  auto docIt = g_fonts.find(handle);
+  if (docIt == g_fonts.end()) return nullptr;
+  auto it = docIt->second.find(key);
+  return it == docIt->second.end() ? nullptr : it->second;
+}
+
+}  // namespace
+
+FPDF_FONT ResolveFont(int handle, FPDF_DOCUMENT doc, const std::string& fontRef) {
+  if (fontRef.empty()) return nullptr;
+  if (FPDF_FONT font = FindFont(handle, fontRef)) return font;
+
+  // Data fonts only come from loadFont; anything else is a standard name.
+  if (fontRef.rfind(DATA_FONT_PREFIX, 0) == 0) return nullptr;
+
+  FPDF_FONT font = FPDFText_LoadStandardFont(doc, fontRef.c_str());
+  if (font) g_fonts[handle][fontRef] = font;
+  return font;
+}
+
+// ── loadFont ────────────────────────────────────────────────────────
+
+Napi::Value LoadFont(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBuffer()) {
+    Napi::TypeError::New(env,
+      "loadFont: requires (handle: number, data: Buffer, options?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  auto data  = info[1].As<Napi::Buffer<uint8_t>>();
+  bool cid   = GetBoolOption(info.Length() > 2 ? info[2] : env.Undefined(), "cid", false);
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  if (data.Length() == 0) {
+    Napi::RangeError::New(env, "loadFont: font data is empty")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Identity is the font program itself, plus how it is encoded.
+  Sha256 hash;
+  hash.Update(data.Data(), data.Length());
+  std::string fontRef = DATA_FONT_PREFIX + hash.FinalHex() + (cid ? ":cid" : "");
+
+  if (!FindFont(handle, fontRef)) {
+    FPDF_FONT font = FPDFText_LoadFont(doc, data.Data(),
+                                       static_cast<unsigned int>(data.Length()),
+                                       FPDF_FONT_TRUETYPE, cid);
+    if (!font) {
+      Napi::Error::New(env, "loadFont: PDFium could not load the font data")
+        .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    g_fonts[handle][fontRef] = font;
+  }
+  return Napi::String::New(env, fontRef);
+}
+
+void DiscardFonts(int handle) {
+  auto docIt = g_fonts.find(handle);
+  if (docIt == g_fonts.end()) return;
+  for (auto& [key, font] : docIt->second) FPDFFont_Close(font);
+  g_fonts.erase(docIt);
+}
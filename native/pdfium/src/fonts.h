@@ -0,0 +1,39 @@
+/**
+ * fonts.h — Per-document cache of fonts used by text edits.
+ *
+ * FPDFText_LoadStandardFont and FPDFText_LoadFont add a new font
+ * dictionary (and, for TrueType, a new embedded font program) to the
+ * document on every call.  Fonts are therefore loaded once per
+ * document and identity, and every edit shares the same resources.
+ */
+#ifndef PDFIUM_ADDON_FONTS_H
+#define PDFIUM_ADDON_FONTS_H
+
+#include <napi.h>
+#include <fpdfview.h>
+
+#include <string>
+
+/**
+ * Return the font for `fontRef` — a standard-14 name ("Helvetica",
+ * "Times-Bold", …) or a reference returned by loadFont — loading
+ * standard fonts on first use.  nullptr if the reference is unknown.
+ * The caller must hold g_pdfiumMutex; the font stays owned by the cache.
+ */
+FPDF_FONT ResolveFont(int handle, FPDF_DOCUMENT doc, const std::string& fontRef);
+
+/**
+ * loadFont(handle, data: Buffer, options?) → fontRef: string
+ *
+ * Loads TrueType/OpenType font data into the document once; loading
+ * the same bytes again returns the same reference.  Use the reference
+ * as editTextObject's fontName.
+ *
+ * options: { cid?: boolean = false }  (CID-keyed, for non-Latin text)
+ */
+Napi::Value LoadFont(const Napi::CallbackInfo& info);
+
+/** Close the cached fonts of a document; call before closing it. */
+void DiscardFonts(int handle);
+
+#endif // PDFIUM_ADDON_FONTS_H
@@ -0,0 +1,294 @@
+/**
+ * inflate.cc — zlib / deflate decoder (RFC 1950, RFC 1951).
+ *
+ * Huffman codes are decoded through a 2^10-entry table; the rare longer
+ * codes fall back to a canonical walk over the code counts.
+ */
+
+#include "inflate.h"
+
+namespace {
+
+constexpr int MAX_BITS = 15;
+constexpr int FAST_BITS = 10;
+constexpr int MAX_LIT_CODES = 288;
+constexpr int MAX_DIST_CODES = 30;
+
+// ── Bit reader ──────────────────────────────────────────────────────
+
+/**
+ * LSB-first bit reader.  Past the end of the input it feeds zero bytes
+ * and counts them, so Overrun() tells a real decode from one that ran
+ * off the end.
+ */
+class BitReader {
+ public:
+  BitReader(const uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+  uint32_t Peek(int n) {
+    if (count_ < n) Refill();
+    return static_cast<uint32_t>(bits_ & ((uint64_t(1) << n) - 1));
+  }
+
+  void Drop(int n) {
+    bits_ >>= n;
+    count_ -= n;
+  }
+
+  uint32_t Take(int n) {
+    uint32_t v = Peek(n);
+    Drop(n);
+    return v;
+  }
+
+  /** Skip to the next byte boundary (stored blocks). */
+  void Align() { Drop(count_ & 7); }
+
+  bool Overrun() const { return padding_ * 8 > count_; }
+
+ private:
+  void Refill() {
+    while (count_ <= 56) {
+      uint64_t byte = 0;
+      if (p_ < end_) {
+        byte = *p_++;
+      } else {
+        padding_++;
+      }
+      bits_ |= byte << count_;
+      count_ += 8;
+    }
+  }
+
+  const uint8_t* p_;
+  const uint8_t* end_;
+  uint64_t bits_ = 0;
+  int count_ = 0;
+  int padding_ = 0;
+};
+
+// ── Huffman tables ──────────────────────────────────────────────────
+
+class Huffman {
+ public:
+  /** False if the lengths over-subscribe the code space. */
+  bool Build(const uint8_t* lengths, int n) {
+    for (auto& c : count_) c = 0;
+    for (int i = 0; i < n; i++) count_[lengths[i]]++;
+    count_[0] = 0;
+
+    int left = 1;
+    for (int len = 1; len <= MAX_BITS; len++) {
+      left <<= 1;
+      left -= count_[len];
+      if (left < 0) return false;
+    }
+
+    uint16_t offs[MAX_BITS + 1];
+    offs[1] = 0;
+    for (int len = 1; len < MAX_BITS; len++) offs[len + 1] = offs[len] + count_[len];
+    for (int i = 0; i < n; i++) {
+      if (lengths[i]) symbol_[offs[lengths[i]]++] = static_cast<uint16_t>(i);
+    }
+
+    // Canonical codes in symbol order; the stream stores them MSB first,
+    // so the fast table is indexed by the bit-reversed code.
+    for (auto& e : fast_) e = 0;
+    int code = 0;
+    int index = 0;
+    for (int len = 1; len <= MAX_BITS; len++) {
+      for (int k = 0; k < count_[len]; k++, code++, index++) {
+        if (len > FAST_BITS) continue;
+        int reversed = 0;
+        for (int b = 0; b < len; b++) reversed |= ((code >> b) & 1) << (len - 1 - b);
+        for (int j = reversed; j < (1 << FAST_BITS); j += 1 << len) {
+          fast_[j] = static_cast<uint16_t>((len << 9) | symbol_[index]);
+        }
+      }
+      code <<= 1;
+    }
+    return true;
+  }
+
+  /** Next symbol, or -1 for a code that is not in the table. */
+  int Decode(BitReader& br) const {
+    uint32_t bits = br.Peek(MAX_BITS);
+    uint16_t entry = fast_[bits & ((1 << FAST_BITS) - 1)];
+    if (entry) {
+      br.Drop(entry >> 9);
+      return entry & 0x1ff;
+    }
+
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len <= MAX_BITS; len++) {
+      code |= (bits >> (len - 1)) & 1;
+      int n = count_[len];
+      if (code - n < first) {
+        br.Drop(len);
+        return symbol_[index + (code - first)];
+      }
+      index += n;
+      first = (first + n) << 1;
+      code <<= 1;
+    }
+    return -1;
+  }
+
+ private:
+  uint16_t fast_[1 << FAST_BITS];   ///< (length << 9) | symbol; 0 = long code
+  uint16_t count_[MAX_BITS + 1];
+  uint16_t symbol_[MAX_LIT_CODES];
+};
+
+struct FixedTables {
+  Huffman lit;
+  Huffman dist;
+
+  FixedTables() {
+    uint8_t lengths[MAX_LIT_CODES];
+    for (int i = 0; i < 144; i++) lengths[i] = 8;
+    for (int i = 144; i < 256; i++) lengths[i] = 9;
+    for (int i = 256; i < 280; i++) lengths[i] = 7;
+    for (int i = 280; i < MAX_LIT_CODES; i++) lengths[i] = 8;
+    lit.Build(lengths, MAX_LIT_CODES);
+    for (int i = 0; i < MAX_DIST_CODES; i++) lengths[i] = 5;
+    dist.Build(lengths, MAX_DIST_CODES);
+  }
+};
+
+const FixedTables& Fixed() {
+  static const FixedTables tables;
+  return tables;
+}
+
+// ── Blocks ──────────────────────────────────────────────────────────
+
+const uint16_t LEN_BASE[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+const uint8_t LEN_EXTRA[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+const uint16_t DIST_BASE[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577,
+};
+const uint8_t DIST_EXTRA[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+
+bool Stored(BitReader& br, std::vector<uint8_t>& out, size_t limit) {
+  br.Align();
+  uint32_t len = br.Take(16);
+  uint32_t nlen = br.Take(16);
+  if (len != (~nlen & 0xffff)) return false;
+  for (uint32_t i = 0; i < len; i++) out.push_back(static_cast<uint8_t>(br.Take(8)));
+  return !br.Overrun() && out.size() <= limit;
+}
+
+bool Codes(BitReader& br, const Huffman& lit, const Huffman& dist,
+           std::vector<uint8_t>& out, size_t limit) {
+  for (;;) {
+    if (br.Overrun() || out.size() > limit) return false;
+
+    int sym = lit.Decode(br);
+    if (sym < 0) return false;
+    if (sym < 256) {
+      out.push_back(static_cast<uint8_t>(sym));
+      continue;
+    }
+    if (sym == 256) return true;
+
+    sym -= 257;
+    if (sym >= 29) return false;
+    size_t len = LEN_BASE[sym] + br.Take(LEN_EXTRA[sym]);
+
+    int dsym = dist.Decode(br);
+    if (dsym < 0 || dsym >= MAX_DIST_CODES) return false;
+    size_t distance = DIST_BASE[dsym] + br.Take(DIST_EXTRA[dsym]);
+    if (distance > out.size()) return false;
+
+    // Byte by byte: the source may overlap what is being written.
+    size_t from = out.size() - distance;
+    for (size_t i = 0; i < len; i++) out.push_back(out[from + i]);
+  }
+}
+
+bool Dynamic(BitReader& br, std::vector<uint8_t>& out, size_t limit) {
+  static const uint8_t ORDER[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+  };
+
+  int nlen = static_cast<int>(br.Take(5)) + 257;
+  int ndist = static_cast<int>(br.Take(5)) + 1;
+  int ncode = static_cast<int>(br.Take(4)) + 4;
+  if (nlen > 286 || ndist > MAX_DIST_CODES) return false;
+
+  uint8_t lengths[MAX_LIT_CODES + MAX_DIST_CODES] = {};
+  for (int i = 0; i < ncode; i++) lengths[ORDER[i]] = static_cast<uint8_t>(br.Take(3));
+
+  Huffman lencode;
+  if (!lencode.Build(lengths, 19)) return false;
+
+  int index = 0;
+  while (index < nlen + ndist) {
+    int sym = lencode.Decode(br);
+    if (sym < 0 || br.Overrun()) return false;
+    if (sym < 16) {
+      lengths[index++] = static_cast<uint8_t>(sym);
+      continue;
+    }
+
+    uint8_t value = 0;
+    int repeat;
+    if (sym == 16) {
+      if (index == 0) return false;
+      value = lengths[index - 1];
+      repeat = 3 + static_cast<int>(br.Take(2));
+    } else if (sym == 17) {
+      repeat = 3 + static_cast<int>(br.Take(3));
+    } else {
+      repeat = 11 + static_cast<int>(br.Take(7));
+    }
+    if (index + repeat > nlen + ndist) return false;
+    while (repeat--) lengths[index++] = value;
+  }
+  if (lengths[256] == 0) return false;  // no end-of-block code
+
+  Huffman lit, dist;
+  if (!lit.Build(lengths, nlen)) return false;
+  if (!dist.Build(lengths + nlen, ndist)) return false;
+  return Codes(br, lit, dist, out, limit);
+}
+
+} // namespace
+
+bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+             size_t limit) {
+  // zlib header, unless the writer emitted bare deflate.
+  if (size >= 2 && (data[0] & 0x0f) == 8 && ((data[0] << 8) | data[1]) % 31 == 0) {
+    if (data[1] & 0x20) return false;  // preset dictionary
+    data += 2;
+    size -= 2;
+  }
+
+  BitReader br(data, size);
+  limit = limit > SIZE_MAX - out.size() ? SIZE_MAX : out.size() + limit;
+  bool last;
+  do {
+    last = br.Take(1) != 0;
+    bool ok;
+    switch (br.Take(2)) {
+      case 0:  ok = Stored(br, out, limit); break;
+      case 1:  ok = Codes(br, Fixed().lit, Fixed().dist, out, limit); break;
+      case 2:  ok = Dynamic(br, out, limit); break;
+      default: ok = false; break;
+    }
+    if (!ok || br.Overrun()) return false;
+  } while (!last);
+  return true;
+}
@@ -0,0 +1,24 @@
+/**
+ * inflate.h — Decoder for FlateDecode (zlib / raw deflate) data.
+ *
+ * PDFium keeps its zlib private and the structure scanner (pdfscan.h)
+ * runs without PDFium, so this is a small self-contained RFC 1950/1951
+ * decoder.  It holds no global state and is safe on any thread.
+ */
+#ifndef PDFIUM_ADDON_INFLATE_H
+#define PDFIUM_ADDON_INFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Decode `size` bytes of zlib-wrapped (or bare deflate) data, appending
+ * to `out`.  Returns false on corrupt or truncated input, or once more
+ * than `limit` bytes have been produced; `out` keeps whatever was
+ * decoded before that point, as PDF readers commonly accept.
+ */
+bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+             size_t limit);
+
+#endif // PDFIUM_ADDON_INFLATE_H
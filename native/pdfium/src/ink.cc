@@ -0,0 +1,388 @@
+/**
+ * ink.cc — Freehand ink capture.
+ *
+ * Rendering a live stroke through PDFium would re-rasterise the page on
+ * every pointer event.  Instead, an ink session keeps the raster that is
+ * already on screen and a per-pixel stroke coverage mask: appending
+ * points stamps anti-aliased round segments into the mask and returns
+ * only the rectangle they touched, blended over the base.  The stroke
+ * becomes an ink annotation once, when it ends (addInkAnnotation).
+ */
+
+#include "common.h"
+#include "ink.h"
+#include "layers.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_annot.h>
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t BYTES_PER_PIXEL = 4;
+
+/** Default stroke width, in points. */
+constexpr float DEFAULT_INK_WIDTH = 2.0f;
+
+struct InkStyle {
+  uint8_t color[4] = {0, 0, 0, 255};
+  float width = DEFAULT_INK_WIDTH;
+};
+
+struct InkSession {
+  int handle;
+  int pageIndex;
+  double scale;
+  double pageHeight;              ///< Points.
+  int width, height;              ///< Page pixels.
+  InkStyle style;
+  std::vector<uint8_t> base;      ///< RGBA raster the stroke is drawn over.
+  std::vector<uint8_t> coverage;  ///< Stroke coverage per pixel, 0–255.
+  std::vector<FS_POINTF> points;  ///< Page pixels.
+};
+
+std::map<int, InkSession> g_inkSessions;
+int g_nextInkSession = 1;
+
+/** Read `{ color?: [r, g, b, a], width? }`; bad fields keep defaults. */
+InkStyle ParseInkStyle(Napi::Value options) {
+  InkStyle style;
+  style.width = static_cast<float>(GetNumberOption(options, "width", DEFAULT_INK_WIDTH));
+  if (!(style.width > 0.0f)) style.width = DEFAULT_INK_WIDTH;
+  if (!options.IsObject()) return style;
+
+  Napi::Value color = options.As<Napi::Object>().Get("color");
+  if (color.IsArray()) {
+    Napi::Array components = color.As<Napi::Array>();
+    for (uint32_t i = 0; i < 4 && i < components.Length(); ++i) {
+      Napi::Value c = components.Get(i);
+      if (c.IsNumber()) {
+        style.color[i] = static_cast<uint8_t>(
+          std::clamp(c.As<Napi::Number>().Int32Value(), 0, 255));
+      }
+    }
+  }
+  return style;
+}
+
+bool IsFloat32Array(const Napi::Value& v) {
+  return v.IsTypedArray() &&
+         v.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array;
+}
+
+/**
+ * Stamp the round-capped segment a→b into the coverage mask.  Coverage
+ * is kept as a per-pixel maximum, so overlapping segments and joins do
+ * not darken.  Returns the rect touched.
+ */
+PixelRect StampSegment(InkSession& s, FS_POINTF a, FS_POINTF b) {
+  const float r = std::max(0.5f, static_cast<float>(s.style.width * s.scale / 2.0));
+  const PixelRect reach{
+    static_cast<int>(std::floor(std::min(a.x, b.x) - r - 1.0f)),
+    static_cast<int>(std::floor(std::min(a.y, b.y) - r - 1.0f)),
+    static_cast<int>(std::ceil(std::fabs(b.x - a.x) + 2.0f * r + 3.0f)),
+    static_cast<int>(std::ceil(std::fabs(b.y - a.y) + 2.0f * r + 3.0f))};
+  const PixelRect area = Intersect(reach, {0, 0, s.width, s.height});
+  if (area.Empty()) return {};
+
+  const float dx = b.x - a.x, dy = b.y - a.y;
+  const float len2 = dx * dx + dy * dy;
+  for (int y = area.y; y < area.Bottom(); ++y) {
+    const float py = y + 0.5f;
+    uint8_t* row = s.coverage.data() + static_cast<size_t>(y) * s.width;
+    for (int x = area.x; x < area.Right(); ++x) {
+      const float px = x + 0.5f;
+      float t = len2 > 0.0f ? ((px - a.x) * dx + (py - a.y) * dy) / len2 : 0.0f;
+      t = std::clamp(t, 0.0f, 1.0f);
+      const float ex = px - (a.x + t * dx), ey = py - (a.y + t * dy);
+      const float c = r + 0.5f - std::sqrt(ex * ex + ey * ey);
+      if (c <= 0.0f) continue;
+      const uint8_t cov = c >= 1.0f ? 255 : static_cast<uint8_t>(c * 255.0f + 0.5f);
+      row[x] = std::max(row[x], cov);
+    }
+  }
+  return area;
+}
+
+/** RGBA pixels of `patch`: the base with the stroke blended in. */
+void ComposePatch(const InkSession& s, const PixelRect& patch, uint8_t* out) {
+  const uint8_t* color = s.style.color;
+  for (int y = 0; y < patch.height; ++y) {
+    const size_t row = static_cast<size_t>(patch.y + y) * s.width + patch.x;
+    const uint8_t* src = s.base.data() + row * BYTES_PER_PIXEL;
+    const uint8_t* cov = s.coverage.data() + row;
+    for (int x = 0; x < patch.width; ++x, src += BYTES_PER_PIXEL, out += BYTES_PER_PIXEL) {
+      const int a = (cov[x] * color[3] + 127) / 255;
+      for (int c = 0; c < 3; ++c) {
+        out[c] = static_cast<uint8_t>((color[c] * a + src[c] * (255 - a) + 127) / 255);
+      }
+      out[3] = src[3];
+    }
+  }
+}
+
+Napi::Array ColorArray(Napi::Env env, const uint8_t color[4]) {
+  Napi::Array arr = Napi::Array::New(env, 4);
+  for (uint32_t i = 0; i < 4; ++i) arr.Set(i, Napi::Number::New(env, color[i]));
+  return arr;
+}
+
+InkSession* RequireSession(Napi::Env env, const Napi::CallbackInfo& info,
+                           const char* fn) {
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, std::string(fn) + ": requires a numeric sessionId")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  auto it = g_inkSessions.find(info[0].As<Napi::Number>().Int32Value());
+  if (it == g_inkSessions.end()) {
+    Napi::Error::New(env, std::string(fn) + ": unknown ink session")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  return &it->second;
+}
+
+}  // namespace
+
+// ── beginInk ────────────────────────────────────────────────────────
+
+Napi::Value BeginInk(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 6 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      !info[2].IsNumber() || !info[3].IsBuffer() || !info[4].IsNumber() ||
+      !info[5].IsNumber()) {
+    Napi::TypeError::New(env,
+      "beginInk: requires (handle, pageIndex, scale, base, width, height, style?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle    = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex = info[1].As<Napi::Number>().Int32Value();
+  double scale  = info[2].As<Napi::Number>().DoubleValue();
+  auto base     = info[3].As<Napi::Buffer<uint8_t>>();
+  int width     = info[4].As<Napi::Number>().Int32Value();
+  int height    = info[5].As<Napi::Number>().Int32Value();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  FS_SIZEF size;
+  if (pageIndex < 0 || pageIndex >= FPDF_GetPageCount(doc) || scale <= 0.0 ||
+      !FPDF_GetPageSizeByIndexF(doc, pageIndex, &size)) {
+    Napi::RangeError::New(env, "beginInk: pageIndex or scale out of range")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (width <= 0 || height <= 0 ||
+      base.Length() != static_cast<size_t>(width) * height * BYTES_PER_PIXEL) {
+    Napi::RangeError::New(env, "beginInk: base must be width × height RGBA")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const int sessionId = g_nextInkSession++;
+  InkSession& session = g_inkSessions[sessionId];
+  session.handle     = handle;
+  session.pageIndex  = pageIndex;
+  session.scale      = scale;
+  session.pageHeight = size.height;
+  session.width      = width;
+  session.height     = height;
+  session.style      = ParseInkStyle(info.Length() > 6 ? info[6] : env.Undefined());
+  session.base.assign(base.Data(), base.Data() + base.Length());
+  session.coverage.assign(static_cast<size_t>(width) * height, 0);
+
+  return Napi::Number::New(env, sessionId);
+}
+
+// ── appendInk ───────────────────────────────────────────────────────
+
+Napi::Value AppendInk(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  InkSession* session = RequireSession(env, info, "appendInk");
+  if (!session) return env.Undefined();
+
+  if (info.Length() < 2 || !IsFloat32Array(info[1])) {
+    Napi::TypeError::New(env, "appendInk: requires (sessionId, points: Float32Array)")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto coords = info[1].As<Napi::Float32Array>();
+  PixelRect dirty;
+  for (size_t i = 0; i + 1 < coords.ElementLength(); i += 2) {
+    const FS_POINTF p{coords[i], coords[i + 1]};
+    if (!std::isfinite(p.x) || !std::isfinite(p.y)) continue;
+    const FS_POINTF from = session->points.empty() ? p : session->points.back();
+    session->points.push_back(p);
+    dirty = Union(dirty, StampSegment(*session, from, p));
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("x", Napi::Number::New(env, dirty.Empty() ? 0 : dirty.x));
+  result.Set("y", Napi::Number::New(env, dirty.Empty() ? 0 : dirty.y));
+  result.Set("width", Napi::Number::New(env, dirty.Empty() ? 0 : dirty.width));
+  result.Set("height", Napi::Number::New(env, dirty.Empty() ? 0 : dirty.height));
+  if (dirty.Empty()) {
+    result.Set("data", Napi::Buffer<uint8_t>::New(env, 0));
+    return result;
+  }
+
+  auto data = Napi::Buffer<uint8_t>::New(
+    env, static_cast<size_t>(dirty.width) * dirty.height * BYTES_PER_PIXEL);
+  ComposePatch(*session, dirty, data.Data());
+  result.Set("data", data);
+  return result;
+}
+
+// ── endInk ──────────────────────────────────────────────────────────
+
+Napi::Value EndInk(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  InkSession* session = RequireSession(env, info, "endInk");
+  if (!session) return env.Undefined();
+
+  const int sessionId = info[0].As<Napi::Number>().Int32Value();
+  if (session->points.empty()) {
+    g_inkSessions.erase(sessionId);
+    return env.Null();
+  }
+
+  const double s = session->scale;
+  const double h = session->pageHeight;
+  auto points = Napi::Float32Array::New(env, session->points.size() * 2);
+  for (size_t i = 0; i < session->points.size(); ++i) {
+    points[2 * i]     = static_cast<float>(session->points[i].x / s);
+    points[2 * i + 1] = static_cast<float>(h - session->points[i].y / s);
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("points", points);
+  result.Set("color", ColorArray(env, session->style.color));
+  result.Set("width", Napi::Number::New(env, session->style.width));
+  g_inkSessions.erase(sessionId);
+  return result;
+}
+
+// ── addInkAnnotation ────────────────────────────────────────────────
+
+Napi::Value AddInkAnnotation(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      !IsFloat32Array(info[2])) {
+    Napi::TypeError::New(env,
+      "addInkAnnotation: requires (handle, pageIndex, points: Float32Array, style?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle    = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex = info[1].As<Napi::Number>().Int32Value();
+  auto coords   = info[2].As<Napi::Float32Array>();
+  InkStyle style = ParseInkStyle(info.Length() > 3 ? info[3] : env.Undefined());
+
+  std::vector<FS_POINTF> points;
+  points.reserve(coords.ElementLength() / 2);
+  for (size_t i = 0; i + 1 < coords.ElementLength(); i += 2) {
+    points.push_back({coords[i], coords[i + 1]});
+  }
+  if (points.empty()) {
+    Napi::RangeError::New(env, "addInkAnnotation: the stroke has no points")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  if (pageIndex < 0 || pageIndex >= FPDF_GetPageCount(doc)) {
+    Napi::RangeError::New(env,
+      "addInkAnnotation: pageIndex " + std::to_string(pageIndex) + " out of range"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  bool fromCache = false;
+  FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+  if (!page) {
+    Napi::Error::New(env,
+      "addInkAnnotation: failed to load page " + std::to_string(pageIndex)
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Appearance: the stroke as one round-capped, round-joined path.
+  FPDF_PAGEOBJECT path = FPDFPageObj_CreateNewPath(points[0].x, points[0].y);
+  bool ok = path != nullptr;
+  for (size_t i = 1; ok && i < points.size(); ++i) {
+    ok = FPDFPath_LineTo(path, points[i].x, points[i].y);
+  }
+  if (ok && points.size() == 1) ok = FPDFPath_LineTo(path, points[0].x, points[0].y);
+  ok = ok &&
+       FPDFPageObj_SetStrokeColor(path, style.color[0], style.color[1],
+                                  style.color[2], style.color[3]) &&
+       FPDFPageObj_SetStrokeWidth(path, style.width) &&
+       FPDFPageObj_SetLineCap(path, FPDF_LINECAP_ROUND) &&
+       FPDFPageObj_SetLineJoin(path, FPDF_LINEJOIN_ROUND) &&
+       FPDFPath_SetDrawMode(path, FPDF_FILLMODE_NONE, true);
+
+  float left = points[0].x, right = left, bottom = points[0].y, top = bottom;
+  for (const FS_POINTF& p : points) {
+    left = std::min(left, p.x);
+    right = std::max(right, p.x);
+    bottom = std::min(bottom, p.y);
+    top = std::max(top, p.y);
+  }
+  const float pad = style.width / 2.0f + 1.0f;
+  const FS_RECTF rect{left - pad, top + pad, right + pad, bottom - pad};
+
+  FPDF_ANNOTATION annot = ok ? FPDFPage_CreateAnnot(page, FPDF_ANNOT_INK) : nullptr;
+  int annotIndex = -1;
+  if (annot) {
+    ok = FPDFAnnot_SetRect(annot, &rect) &&
+         FPDFAnnot_SetColor(annot, FPDFANNOT_COLORTYPE_Color, style.color[0],
+                            style.color[1], style.color[2], style.color[3]) &&
+         FPDFAnnot_SetBorder(annot, 0.0f, 0.0f, style.width) &&
+         FPDFAnnot_SetFlags(annot, FPDF_ANNOT_FLAG_PRINT) &&
+         FPDFAnnot_AddInkStroke(annot, points.data(), points.size()) >= 0 &&
+         FPDFAnnot_AppendObject(annot, path);
+    if (ok) path = nullptr;  // owned by the annotation now
+    annotIndex = FPDFPage_GetAnnotIndex(page, annot);
+    FPDFPage_CloseAnnot(annot);
+    if (!ok && annotIndex >= 0) FPDFPage_RemoveAnnot(page, annotIndex);
+  }
+  if (path) FPDFPageObj_Destroy(path);
+  ReleasePage(handle, pageIndex, page, fromCache);
+  // The new annotation shows in the page's thumbnail.
+  if (ok && annot) InvalidateTextPageData(handle, pageIndex);
+
+  if (!ok || !annot) {
+    Napi::Error::New(env, "addInkAnnotation: could not create the ink annotation")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return Napi::Number::New(env, annotIndex);
+}
+
+void DiscardInkSessions(int handle) {
+  for (auto it = g_inkSessions.begin(); it != g_inkSessions.end();) {
+    it = it->second.handle == handle ? g_inkSessions.erase(it) : std::next(it);
+  }
+}
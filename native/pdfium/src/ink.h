@@ -0,0 +1,50 @@
+/**
+ * ink.h — Freehand ink capture with incremental stroke previews.
+ */
+#ifndef PDFIUM_ADDON_INK_H
+#define PDFIUM_ADDON_INK_H
+
+#include <napi.h>
+
+/**
+ * beginInk(handle, pageIndex, scale, base: Buffer, width, height,
+ *          style?: { color?: [r, g, b, a], width? })
+ * → sessionId
+ *
+ * Starts a stroke over `base`, the RGBA page raster already on screen
+ * (width × height at `scale`).  `style.width` is in points (default 2),
+ * colour components are 0–255 (default opaque black).
+ */
+Napi::Value BeginInk(const Napi::CallbackInfo& info);
+
+/**
+ * appendInk(sessionId, points: Float32Array) → { data: Buffer (RGBA), x, y, width, height }
+ *
+ * Appends page-pixel points (x, y pairs) to the stroke and returns the
+ * patch of the page they changed, already composited over the base.
+ * Does not touch PDFium, so it never waits on background jobs.
+ */
+Napi::Value AppendInk(const Napi::CallbackInfo& info);
+
+/**
+ * endInk(sessionId) → { points: Float32Array, color: [r, g, b, a], width } | null
+ *
+ * Ends the session and returns the stroke in PDF points (null if no
+ * point was appended).  Commit it with addInkAnnotation.
+ */
+Napi::Value EndInk(const Napi::CallbackInfo& info);
+
+/**
+ * addInkAnnotation(handle, pageIndex, points: Float32Array,
+ *                  style?: { color?, width? }) → annotIndex
+ *
+ * Adds an ink annotation holding one stroke (PDF points).  The stroke
+ * is stored both as /InkList and as a round-capped path in the
+ * annotation's appearance stream.
+ */
+Napi::Value AddInkAnnotation(const Napi::CallbackInfo& info);
+
+/** Drop the ink sessions of a closed document. */
+void DiscardInkSessions(int handle);
+
+#endif // PDFIUM_ADDON_INK_H
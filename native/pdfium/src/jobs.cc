@@ -0,0 +1,190 @@
+/**
+ * jobs.cc — Job and PageJob base classes, job registry and cancelJob.
+ */
+
+#include "common.h"
+#include "jobs.h"
+
+#include <map>
+#include <string>
+#include <utility>
+
+// ── Job registry ────────────────────────────────────────────────────
+
+/**
+ * jobId → running job.  Only touched on the JS thread (Start, OnOK,
+ * OnError, cancelJob), so it needs no lock of its own.
+ */
+static std::map<int, Job*> g_jobs;
+static int g_nextJobId = 1;
+
+// ── Job ─────────────────────────────────────────────────────────────
+
+Job::Job(Napi::Env env, Napi::Value onProgress)
+  : Napi::AsyncProgressQueueWorker<JobProgress>(env),
+    jobId_(g_nextJobId++),
+    deferred_(Napi::Promise::Deferred::New(env)) {
+  if (onProgress.IsFunction()) {
+    onProgress_ = Napi::Persistent(onProgress.As<Napi::Function>());
+    hasListener_ = true;
+  }
+}
+
+Job::~Job() = default;
+
+Napi::Value Job::Start() {
+  Napi::Env env = Env();
+  g_jobs[jobId_] = this;
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("jobId", Napi::Number::New(env, jobId_));
+  result.Set("done",  deferred_.Promise());
+
+  Queue();
+  return result;
+}
+
+void Job::OnProgress(const JobProgress* data, size_t count) {
+  if (onProgress_.IsEmpty() || count == 0) return;
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  // Only the latest record matters; earlier ones may have been batched.
+  const JobProgress& last = data[count - 1];
+  Napi::Value detail = ProgressDetail(env);
+  if (detail.IsUndefined()) {
+    onProgress_.Call({
+      Napi::Number::New(env, last.done),
+      Napi::Number::New(env, last.total),
+    });
+  } else {
+    onProgress_.Call({
+      Napi::Number::New(env, last.done),
+      Napi::Number::New(env, last.total),
+      detail,
+    });
+  }
+}
+
+void Job::OnOK() {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+  g_jobs.erase(jobId_);
+
+  Napi::Object result = Result(env);
+  result.Set("cancelled", Napi::Boolean::New(env, cancelled_));
+  deferred_.Resolve(result);
+}
+
+void Job::OnError(const Napi::Error& e) {
+  Napi::HandleScope scope(Env());
+  g_jobs.erase(jobId_);
+  deferred_.Reject(e.Value());
+}
+
+// ── PageJob ─────────────────────────────────────────────────────────
+
+PageJob::PageJob(Napi::Env env, int handle, std::vector<int> pages,
+                 Napi::Value onProgress)
+  : Job(env, onProgress),
+    handle_(handle),
+    pages_(std::move(pages)) {}
+
+void PageJob::Execute(const ExecutionProgress& progress) {
+  const int total = static_cast<int>(pages_.size());
+  std::string error;
+
+  for (int pageIndex : pages_) {
+    if (CancelRequested()) {
+      MarkCancelled();
+      break;
+    }
+
+    {
+      PdfiumLock lock(g_pdfiumMutex);
+      // Re-check the handle every page: the document may have been
+      // closed from the JS thread while we were waiting for the lock.
+      auto it = g_documents.find(handle_);
+      if (it == g_documents.end()) {
+        SetError("document was closed while the job was running");
+        return;
+      }
+      if (!ProcessPage(it->second, pageIndex, error)) {
+        SetError(error);
+        return;
+      }
+    }
+
+    pagesDone_++;
+    JobProgress p = { pagesDone_, total };
+    progress.Send(&p, 1);
+  }
+
+  PdfiumLock lock(g_pdfiumMutex);
+  auto it = g_documents.find(handle_);
+  if (it == g_documents.end()) {
+    SetError("document was closed while the job was running");
+    return;
+  }
+  if (!Finish(it->second, error)) {
+    SetError(error);
+  }
+}
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+bool ReadPageList(Napi::Env env, Napi::Value value, int pageCount,
+                  const char* fnName, std::vector<int>& out) {
+  out.clear();
+
+  if (value.IsUndefined() || value.IsNull()) {
+    out.reserve(static_cast<size_t>(pageCount));
+    for (int i = 0; i < pageCount; i++) out.push_back(i);
+    return true;
+  }
+
+  if (!value.IsArray()) {
+    Napi::TypeError::New(env,
+      std::string(fnName) + ": pages must be an array of page indices"
+    ).ThrowAsJavaScriptException();
+    return false;
+  }
+
+  Napi::Array arr = value.As<Napi::Array>();
+  out.reserve(arr.Length());
+  for (uint32_t i = 0; i < arr.Length(); i++) {
+    Napi::Value v = arr.Get(i);
+    int pageIndex = v.IsNumber() ? v.As<Napi::Number>().Int32Value() : -1;
+    if (pageIndex < 0 || pageIndex >= pageCount) {
+      Napi::RangeError::New(env,
+        std::string(fnName) + ": page index out of range [0, " +
+        std::to_string(pageCount - 1) + "]"
+      ).ThrowAsJavaScriptException();
+      return false;
+    }
+    out.push_back(pageIndex);
+  }
+  return true;
+}
+
+// ── cancelJob ───────────────────────────────────────────────────────
+
+Napi::Value CancelJob(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env,
+      "cancelJob: argument must be a numeric job id"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int jobId = info[0].As<Napi::Number>().Int32Value();
+  auto it = g_jobs.find(jobId);
+  if (it == g_jobs.end()) {
+    return Napi::Boolean::New(env, false);
+  }
+
+  it->second->RequestCancel();
+  return Napi::Boolean::New(env, true);
+}
@@ -0,0 +1,129 @@
+/**
+ * jobs.h — Background page passes on the libuv thread pool.
+ *
+ * A PageJob visits a list of pages off the JS thread.  Each page step
+ * runs under g_pdfiumMutex, so synchronous addon calls (render, list,
+ * edit) interleave between pages instead of waiting for the whole pass.
+ * Jobs that are not page passes derive from Job directly.
+ *
+ * From JS a job looks like:
+ *   { jobId: number, done: Promise<result> }
+ * with an optional onProgress(done, total, detail?) callback, and can be
+ * stopped between units of work via cancelJob(jobId).  Jobs that stream
+ * partial results pass them as `detail`.
+ */
+#ifndef PDFIUM_ADDON_JOBS_H
+#define PDFIUM_ADDON_JOBS_H
+
+#include <napi.h>
+#include <fpdfview.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/** Progress record posted from the worker thread to JS. */
+struct JobProgress {
+  int done;
+  int total;
+};
+
+/**
+ * Base of every background job: registry entry, cancellation, progress
+ * relay and the `done` promise.  Subclasses implement Execute().
+ */
+class Job : public Napi::AsyncProgressQueueWorker<JobProgress> {
+ public:
+  /**
+   * Queue the job and return { jobId, done } to JS.
+   * Ownership passes to the N-API runtime, which deletes the worker
+   * once `done` has settled.
+   */
+  Napi::Value Start();
+
+  /** Request cancellation; honoured before the next unit of work. */
+  void RequestCancel() { cancel_.store(true); }
+
+ protected:
+  /** @param onProgress JS function (done, total) or undefined */
+  Job(Napi::Env env, Napi::Value onProgress);
+  ~Job() override;
+
+  bool CancelRequested() const { return cancel_.load(); }
+  /** Record that Execute stopped early because of RequestCancel. */
+  void MarkCancelled() { cancelled_ = true; }
+
+  /** Build the value `done` resolves with.  Runs on the JS thread. */
+  virtual Napi::Object Result(Napi::Env env) = 0;
+
+  /**
+   * Third onProgress argument: whatever the worker has produced since
+   * the last call (progress records can be batched), or undefined for
+   * none.  Runs on the JS thread.
+   */
+  virtual Napi::Value ProgressDetail(Napi::Env env) { return env.Undefined(); }
+
+  /** Whether anyone receives progress; set at construction, any thread. */
+  bool HasProgressListener() const { return hasListener_; }
+
+ private:
+  void OnProgress(const JobProgress* data, size_t count) override;
+  void OnOK() override;
+  void OnError(const Napi::Error& e) override;
+
+  const int jobId_;
+  std::atomic<bool> cancel_{false};
+  bool cancelled_ = false;
+  bool hasListener_ = false;
+  Napi::Promise::Deferred deferred_;
+  Napi::FunctionReference onProgress_;
+};
+
+/** A job that visits a list of pages of one open document. */
+class PageJob : public Job {
+ protected:
+  /**
+   * @param handle     document handle from openDocument
+   * @param pages      page indices to visit, in order
+   * @param onProgress JS function (done, total) or undefined
+   */
+  PageJob(Napi::Env env, int handle, std::vector<int> pages,
+          Napi::Value onProgress);
+
+  /**
+   * Process one page.  Runs on the worker thread with g_pdfiumMutex held.
+   * Return false (and fill `error`) to abort the whole job.
+   */
+  virtual bool ProcessPage(FPDF_DOCUMENT doc, int pageIndex,
+                           std::string& error) = 0;
+
+  /**
+   * Called with g_pdfiumMutex held after the last page (or after
+   * cancellation), e.g. to save output.  Return false to fail the job.
+   */
+  virtual bool Finish(FPDF_DOCUMENT /*doc*/, std::string& /*error*/) {
+    return true;
+  }
+
+  const int handle_;
+  const std::vector<int> pages_;
+
+  /** Number of pages fully processed (valid in Finish / Result). */
+  int pagesDone_ = 0;
+
+ private:
+  void Execute(const ExecutionProgress& progress) override;
+};
+
+/**
+ * Parse an optional page list argument.
+ * Accepts undefined (all pages) or an array of page indices; throws a JS
+ * RangeError and returns false if any index is out of range.
+ */
+bool ReadPageList(Napi::Env env, Napi::Value value, int pageCount,
+                  const char* fnName, std::vector<int>& out);
+
+/** cancelJob(jobId: number): boolean — false if the job already ended. */
+Napi::Value CancelJob(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_JOBS_H
@@ -0,0 +1,462 @@
+/**
+ * layers.cc — Layer rendering and compositing helpers.
+ */
+
+#include "layers.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LAYER_BLEND_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LAYER_BLEND_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+/** Rotation tile edge in pixels: a 64×64 RGBA tile is 16 KiB. */
+constexpr int ROTATE_TILE = 64;
+
+/** Dark mode: white paper becomes this grey, black ink this one. */
+constexpr int DARK_BACKGROUND = 30;
+constexpr int DARK_FOREGROUND = 224;
+constexpr int DARK_SPAN = DARK_FOREGROUND - DARK_BACKGROUND;
+
+/** High contrast: gain about mid grey, in sixteenths (2.5×). */
+constexpr int CONTRAST_GAIN_16 = 40;
+
+inline void CopyPixel(uint8_t* dst, const uint8_t* src) {
+  std::memcpy(dst, src, 4);
+}
+
+/**
+ * Quarter turn (1 = 90° clockwise, 3 = 270°) of the 4×4 block whose
+ * top-left source pixel is (x, y).  Source row r becomes destination
+ * column h − 1 − r (clockwise) or r (counter-clockwise), so each
+ * transposed column is stored as one destination row segment.
+ */
+inline void RotateBlock4(const uint8_t* src, int w, int h, int x, int y,
+                         int turns, uint8_t* dst) {
+  const size_t srcStride = static_cast<size_t>(w) * 4;
+  const size_t dstStride = static_cast<size_t>(h) * 4;
+  const uint8_t* s = src + y * srcStride + static_cast<size_t>(x) * 4;
+  auto rowAt = [&](int k) {
+    // Destination row and column of transposed source column x + k.
+    return turns == 1
+      ? dst + static_cast<size_t>(x + k) * dstStride + static_cast<size_t>(h - 4 - y) * 4
+      : dst + static_cast<size_t>(w - 1 - x - k) * dstStride + static_cast<size_t>(y) * 4;
+  };
+
+#if defined(LAYER_BLEND_SSE2)
+  __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+  __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + srcStride));
+  __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2 * srcStride));
+  __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 3 * srcStride));
+  __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+  __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+  __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+  __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+  __m128i c[4] = {
+    _mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+    _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3),
+  };
+  for (int k = 0; k < 4; ++k) {
+    // Clockwise, source row 0 lands rightmost: reverse the lanes.
+    __m128i v = turns == 1 ? _mm_shuffle_epi32(c[k], 0x1B) : c[k];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rowAt(k)), v);
+  }
+#elif defined(LAYER_BLEND_NEON)
+  uint32x4_t r0 = vreinterpretq_u32_u8(vld1q_u8(s));
+  uint32x4_t r1 = vreinterpretq_u32_u8(vld1q_u8(s + srcStride));
+  uint32x4_t r2 = vreinterpretq_u32_u8(vld1q_u8(s + 2 * srcStride));
+  uint32x4_t r3 = vreinterpretq_u32_u8(vld1q_u8(s + 3 * srcStride));
+  uint32x4x2_t t01 = vtrnq_u32(r0, r1);
+  uint32x4x2_t t23 = vtrnq_u32(r2, r3);
+  uint32x4_t c[4] = {
+    vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0])),
+    vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1])),
+    vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])),
+    vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])),
+  };
+  for (int k = 0; k < 4; ++k) {
+    uint32x4_t v = c[k];
+    if (turns == 1) {
+      v = vrev64q_u32(v);
+      v = vcombine_u32(vget_high_u32(v), vget_low_u32(v));
+    }
+    vst1q_u8(rowAt(k), vreinterpretq_u8_u32(v));
+  }
+#else
+  for (int k = 0; k < 4; ++k) {
+    uint8_t* d = rowAt(k);
+    for (int r = 0; r < 4; ++r) {
+      CopyPixel(d + (turns == 1 ? 3 - r : r) * 4,
+                s + r * srcStride + static_cast<size_t>(k) * 4);
+    }
+  }
+#endif
+}
+
+/** Quarter turn of a single pixel (the ragged edge of a tile). */
+inline void RotatePixel(const uint8_t* src, int w, int h, int x, int y,
+                        int turns, uint8_t* dst) {
+  const size_t di = turns == 1
+    ? static_cast<size_t>(x) * h + (h - 1 - y)
+    : static_cast<size_t>(w - 1 - x) * h + y;
+  CopyPixel(dst + di * 4, src + (static_cast<size_t>(y) * w + x) * 4);
+}
+
+/** Half turn of one row: reversed into the mirrored destination row. */
+void ReverseRow(const uint8_t* src, int n, uint8_t* dst) {
+  int i = 0;
+#if defined(LAYER_BLEND_SSE2)
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (n - 4 - i) * 4),
+                     _mm_shuffle_epi32(v, 0x1B));
+  }
+#elif defined(LAYER_BLEND_NEON)
+  for (; i + 4 <= n; i += 4) {
+    uint32x4_t v = vrev64q_u32(vreinterpretq_u32_u8(vld1q_u8(src + i * 4)));
+    v = vcombine_u32(vget_high_u32(v), vget_low_u32(v));
+    vst1q_u8(dst + (n - 4 - i) * 4, vreinterpretq_u8_u32(v));
+  }
+#endif
+  for (; i < n; ++i) CopyPixel(dst + (n - 1 - i) * 4, src + i * 4);
+}
+
+}  // namespace
+
+// ── Rects ───────────────────────────────────────────────────────────
+
+PixelRect Union(const PixelRect& a, const PixelRect& b) {
+  if (a.Empty()) return b;
+  if (b.Empty()) return a;
+  int x = std::min(a.x, b.x), y = std::min(a.y, b.y);
+  return {x, y, std::max(a.Right(), b.Right()) - x,
+          std::max(a.Bottom(), b.Bottom()) - y};
+}
+
+PixelRect Intersect(const PixelRect& a, const PixelRect& b) {
+  int x = std::max(a.x, b.x), y = std::max(a.y, b.y);
+  return {x, y, std::min(a.Right(), b.Right()) - x,
+          std::min(a.Bottom(), b.Bottom()) - y};
+}
+
+// ── Blending ────────────────────────────────────────────────────────
+
+// dst = (src·a + dst·(255 − a)) / 255, rounded exactly.
+void BlendRowOver(uint8_t* dst, const uint8_t* src, int n) {
+  int i = 0;
+
+#if defined(LAYER_BLEND_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i full = _mm_set1_epi16(255);
+  const __m128i half = _mm_set1_epi16(128);
+  const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i * 4));
+
+    __m128i out[2];
+    for (int h = 0; h < 2; ++h) {
+      __m128i s16 = h ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+      __m128i d16 = h ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+      // Broadcast each pixel's alpha (lane 3 / 7) across its channels.
+      __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, 0xFF), 0xFF);
+      __m128i t = _mm_add_epi16(_mm_mullo_epi16(s16, a),
+                                _mm_mullo_epi16(d16, _mm_sub_epi16(full, a)));
+      // Exact t / 255 with rounding: (t + 128 + ((t + 128) >> 8)) >> 8.
+      t = _mm_add_epi16(t, half);
+      out[h] = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    }
+    __m128i result = _mm_or_si128(_mm_packus_epi16(out[0], out[1]), opaque);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), result);
+  }
+#elif defined(LAYER_BLEND_NEON)
+  for (; i + 8 <= n; i += 8) {
+    uint8x8x4_t s = vld4_u8(src + i * 4);
+    uint8x8x4_t d = vld4_u8(dst + i * 4);
+    const uint8x8_t a = s.val[3];
+    const uint8x8_t inv = vmvn_u8(a);
+    for (int c = 0; c < 3; ++c) {
+      uint16x8_t t = vmlal_u8(vmull_u8(s.val[c], a), d.val[c], inv);
+      d.val[c] = vrshrn_n_u16(vrsraq_n_u16(t, t, 8), 8);
+    }
+    d.val[3] = vdup_n_u8(255);
+    vst4_u8(dst + i * 4, d);
+  }
+#endif
+
+  for (; i < n; ++i) {
+    const uint8_t* s = src + i * 4;
+    uint8_t* d = dst + i * 4;
+    const unsigned a = s[3];
+    for (int c = 0; c < 3; ++c) {
+      unsigned t = s[c] * a + d[c] * (255 - a) + 128;
+      d[c] = static_cast<uint8_t>((t + (t >> 8)) >> 8);
+    }
+    d[3] = 255;
+  }
+}
+
+// ── Reading-mode filters ────────────────────────────────────────────
+
+namespace {
+
+// Dark: adding 255 − max − min to every channel turns HSL lightness
+// L into 255 − L and keeps hue and saturation (no channel leaves
+// 0–255).  The result is then squeezed into DARK_BACKGROUND …
+// DARK_FOREGROUND so paper is not pure black nor ink glaring white.
+void DarkRow(const uint8_t* src, int n, uint8_t* dst) {
+  int i = 0;
+
+#if defined(LAYER_BLEND_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lowByte = _mm_set1_epi32(0xFF);
+  const __m128i full = _mm_set1_epi16(255);
+  const __m128i half = _mm_set1_epi16(128);
+  const __m128i span = _mm_set1_epi16(DARK_SPAN);
+  const __m128i base = _mm_set1_epi16(DARK_BACKGROUND);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    // max and min of R, G, B in the low byte of each pixel.
+    __m128i g = _mm_srli_epi32(v, 8);
+    __m128i b = _mm_srli_epi32(v, 16);
+    __m128i mx = _mm_and_si128(_mm_max_epu8(v, _mm_max_epu8(g, b)), lowByte);
+    __m128i mn = _mm_and_si128(_mm_min_epu8(v, _mm_min_epu8(g, b)), lowByte);
+    __m128i sum = _mm_add_epi32(mx, mn);
+
+    __m128i out[2];
+    for (int h = 0; h < 2; ++h) {
+      // Broadcast each pixel's max + min across its four 16-bit lanes.
+      __m128i s2 = h ? _mm_unpackhi_epi32(sum, sum) : _mm_unpacklo_epi32(sum, sum);
+      s2 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s2, 0x00), 0x00);
+      __m128i c = h ? _mm_unpackhi_epi8(v, zero) : _mm_unpacklo_epi8(v, zero);
+      __m128i t = _mm_sub_epi16(_mm_add_epi16(c, full), s2);
+      // floor + t · span / 255, rounded exactly as in BlendRowOver.
+      t = _mm_add_epi16(_mm_mullo_epi16(t, span), half);
+      t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+      out[h] = _mm_add_epi16(t, base);
+    }
+    __m128i result = _mm_or_si128(
+      _mm_andnot_si128(alpha, _mm_packus_epi16(out[0], out[1])),
+      _mm_and_si128(v, alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), result);
+  }
+#elif defined(LAYER_BLEND_NEON)
+  for (; i + 8 <= n; i += 8) {
+    uint8x8x4_t p = vld4_u8(src + i * 4);
+    const uint8x8_t mx = vmax_u8(vmax_u8(p.val[0], p.val[1]), p.val[2]);
+    const uint8x8_t mn = vmin_u8(vmin_u8(p.val[0], p.val[1]), p.val[2]);
+    const uint16x8_t sum = vaddl_u8(mx, mn);
+    for (int c = 0; c < 3; ++c) {
+      uint16x8_t t = vsubq_u16(vaddw_u8(vdupq_n_u16(255), p.val[c]), sum);
+      t = vmulq_n_u16(t, DARK_SPAN);
+      p.val[c] = vadd_u8(vrshrn_n_u16(vrsraq_n_u16(t, t, 8), 8),
+                         vdup_n_u8(DARK_BACKGROUND));
+    }
+    vst4_u8(dst + i * 4, p);
+  }
+#endif
+
+  for (; i < n; ++i) {
+    const uint8_t* s = src + i * 4;
+    uint8_t* d = dst + i * 4;
+    const int shift = 255 - std::max({s[0], s[1], s[2]}) - std::min({s[0], s[1], s[2]});
+    for (int c = 0; c < 3; ++c) {
+      unsigned t = static_cast<unsigned>(s[c] + shift) * DARK_SPAN + 128;
+      d[c] = static_cast<uint8_t>(DARK_BACKGROUND + ((t + (t >> 8)) >> 8));
+    }
+    d[3] = s[3];
+  }
+}
+
+// Contrast: 128 + (c − 128) · gain, clamped to 0–255.
+void ContrastRow(const uint8_t* src, int n, uint8_t* dst) {
+  int i = 0;
+
+#if defined(LAYER_BLEND_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i mid = _mm_set1_epi16(128);
+  const __m128i gain = _mm_set1_epi16(CONTRAST_GAIN_16);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    __m128i out[2];
+    for (int h = 0; h < 2; ++h) {
+      __m128i c = h ? _mm_unpackhi_epi8(v, zero) : _mm_unpacklo_epi8(v, zero);
+      __m128i t = _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(c, mid), gain), 4);
+      out[h] = _mm_add_epi16(t, mid);
+    }
+    // packus clamps to 0–255.
+    __m128i result = _mm_or_si128(
+      _mm_andnot_si128(alpha, _mm_packus_epi16(out[0], out[1])),
+      _mm_and_si128(v, alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), result);
+  }
+#elif defined(LAYER_BLEND_NEON)
+  for (; i + 8 <= n; i += 8) {
+    uint8x8x4_t p = vld4_u8(src + i * 4);
+    for (int c = 0; c < 3; ++c) {
+      int16x8_t t = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(p.val[c])), vdupq_n_s16(128));
+      t = vaddq_s16(vshrq_n_s16(vmulq_n_s16(t, CONTRAST_GAIN_16), 4), vdupq_n_s16(128));
+      p.val[c] = vqmovun_s16(t);
+    }
+    vst4_u8(dst + i * 4, p);
+  }
+#endif
+
+  for (; i < n; ++i) {
+    const uint8_t* s = src + i * 4;
+    uint8_t* d = dst + i * 4;
+    for (int c = 0; c < 3; ++c) {
+      // Arithmetic shift, as _mm_srai_epi16 / vshrq_n_s16 do.
+      int t = 128 + (((s[c] - 128) * CONTRAST_GAIN_16) >> 4);
+      d[c] = static_cast<uint8_t>(std::clamp(t, 0, 255));
+    }
+    d[3] = s[3];
+  }
+}
+
+void InvertRow(const uint8_t* src, int n, uint8_t* dst) {
+  int i = 0;
+
+#if defined(LAYER_BLEND_SSE2)
+  const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_xor_si128(v, rgb));
+  }
+#elif defined(LAYER_BLEND_NEON)
+  const uint8x16_t rgb = vreinterpretq_u8_u32(vdupq_n_u32(0x00FFFFFFu));
+  for (; i + 4 <= n; i += 4) {
+    vst1q_u8(dst + i * 4, veorq_u8(vld1q_u8(src + i * 4), rgb));
+  }
+#endif
+
+  for (; i < n; ++i) {
+    const uint8_t* s = src + i * 4;
+    uint8_t* d = dst + i * 4;
+    for (int c = 0; c < 3; ++c) d[c] = static_cast<uint8_t>(255 - s[c]);
+    d[3] = s[3];
+  }
+}
+
+}  // namespace
+
+void FilterPixels(const uint8_t* src, int n, ViewFilter filter, uint8_t* dst) {
+  switch (filter) {
+    case ViewFilter::Invert:   InvertRow(src, n, dst); break;
+    case ViewFilter::Dark:     DarkRow(src, n, dst); break;
+    case ViewFilter::Contrast: ContrastRow(src, n, dst); break;
+  }
+}
+
+// ── Rotation ────────────────────────────────────────────────────────
+
+void RotatePixels(const uint8_t* src, int width, int height, int quarterTurns,
+                  uint8_t* dst) {
+  const size_t rowBytes = static_cast<size_t>(width) * 4;
+  if (quarterTurns == 2) {
+    for (int y = 0; y < height; ++y) {
+      ReverseRow(src + y * rowBytes, width,
+                 dst + static_cast<size_t>(height - 1 - y) * rowBytes);
+    }
+    return;
+  }
+  if (quarterTurns != 1 && quarterTurns != 3) {
+    std::memcpy(dst, src, rowBytes * height);
+    return;
+  }
+
+  // A transpose reads rows and writes columns; tiling keeps both the
+  // source rows and the destination rows of a tile in cache.
+  for (int ty = 0; ty < height; ty += ROTATE_TILE) {
+    const int yEnd = std::min(ty + ROTATE_TILE, height);
+    for (int tx = 0; tx < width; tx += ROTATE_TILE) {
+      const int xEnd = std::min(tx + ROTATE_TILE, width);
+      int y = ty;
+      for (; y + 4 <= yEnd; y += 4) {
+        int x = tx;
+        for (; x + 4 <= xEnd; x += 4) {
+          RotateBlock4(src, width, height, x, y, quarterTurns, dst);
+        }
+        for (; x < xEnd; ++x) {
+          for (int r = 0; r < 4; ++r) {
+            RotatePixel(src, width, height, x, y + r, quarterTurns, dst);
+          }
+        }
+      }
+      for (; y < yEnd; ++y) {
+        for (int x = tx; x < xEnd; ++x) {
+          RotatePixel(src, width, height, x, y, quarterTurns, dst);
+        }
+      }
+    }
+  }
+}
+
+// ── Bitmap conversion ───────────────────────────────────────────────
+
+void CopyBitmapToRgba(FPDF_BITMAP bitmap, int width, int height, uint8_t* dst) {
+  const auto* src = static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+  const int stride = FPDFBitmap_GetStride(bitmap);
+  for (int y = 0; y < height; ++y) {
+    const uint8_t* s = src + static_cast<size_t>(y) * stride;
+    uint8_t* d = dst + static_cast<size_t>(y) * width * 4;
+    for (int x = 0; x < width; ++x, s += 4, d += 4) {
+      d[0] = s[2];
+      d[1] = s[1];
+      d[2] = s[0];
+      d[3] = s[3];
+    }
+  }
+}
+
+void DownsamplePixels(const uint8_t* src, size_t stride, int bpp, bool alpha,
+                      int sw, int sh, int dw, int dh, uint8_t* dst) {
+  std::vector<uint64_t> sum(static_cast<size_t>(dw) * 4);
+  std::vector<int> x0(dw + 1);
+  for (int x = 0; x <= dw; x++) x0[x] = static_cast<int>(static_cast<int64_t>(x) * sw / dw);
+
+  for (int y = 0; y < dh; y++) {
+    const int y0 = static_cast<int>(static_cast<int64_t>(y) * sh / dh);
+    const int y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(y + 1) * sh / dh));
+    std::fill(sum.begin(), sum.end(), 0);
+
+    for (int sy = y0; sy < y1; sy++) {
+      const uint8_t* row = src + static_cast<size_t>(sy) * stride;
+      for (int x = 0; x < dw; x++) {
+        uint64_t* s = &sum[static_cast<size_t>(x) * 4];
+        const int end = std::max(x0[x] + 1, x0[x + 1]);
+        for (int sx = x0[x]; sx < end; sx++) {
+          const uint8_t* p = row + static_cast<size_t>(sx) * bpp;
+          if (bpp == 1) {
+            s[0] += p[0]; s[1] += p[0]; s[2] += p[0];
+          } else {
+            s[0] += p[2]; s[1] += p[1]; s[2] += p[0];
+          }
+          s[3] += alpha ? p[3] : 255;
+        }
+      }
+    }
+
+    uint8_t* d = dst + static_cast<size_t>(y) * dw * 4;
+    for (int x = 0; x < dw; x++) {
+      const uint64_t n = static_cast<uint64_t>(y1 - y0) *
+                         static_cast<uint64_t>(std::max(x0[x] + 1, x0[x + 1]) - x0[x]);
+      for (int c = 0; c < 4; c++) {
+        d[x * 4 + c] = static_cast<uint8_t>((sum[static_cast<size_t>(x) * 4 + c] + n / 2) / n);
+      }
+    }
+  }
+}
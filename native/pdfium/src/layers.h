@@ -0,0 +1,73 @@
+/**
+ * layers.h — Helpers for rendering a page in layers and compositing
+ * them (drag previews, the separately cached annotation layer), and
+ * the pixel conversions they share with image previews.
+ */
+#ifndef PDFIUM_ADDON_LAYERS_H
+#define PDFIUM_ADDON_LAYERS_H
+
+#include <fpdfview.h>
+
+#include <cstdint>
+
+/** Rectangle in page pixels, top-left origin. */
+struct PixelRect {
+  int x = 0, y = 0, width = 0, height = 0;
+
+  int Right() const { return x + width; }
+  int Bottom() const { return y + height; }
+  bool Empty() const { return width <= 0 || height <= 0; }
+};
+
+/** Smallest rect holding both; an empty rect is ignored. */
+PixelRect Union(const PixelRect& a, const PixelRect& b);
+
+/** Overlap of two rects (Empty() when they do not meet). */
+PixelRect Intersect(const PixelRect& a, const PixelRect& b);
+
+/**
+ * Blend `n` straight-alpha RGBA pixels from `src` over opaque RGBA
+ * `dst`, in place.  Vectorised with SSE2 or NEON where available.
+ */
+void BlendRowOver(uint8_t* dst, const uint8_t* src, int n);
+
+/** Reading-mode filters applied to a finished raster (filterBitmap). */
+enum class ViewFilter {
+  Invert,    // every channel c → 255 − c
+  Dark,      // lightness inverted with hue kept, on a dark grey
+  Contrast,  // channels pushed away from mid grey
+};
+
+/**
+ * Apply `filter` to `n` RGBA pixels from `src` into `dst`, which may be
+ * `src` itself; alpha is unchanged.  Each pixel maps on its own, so a
+ * patch of a raster filters to the same pixels as the whole.
+ * Vectorised with SSE2 or NEON where available.
+ */
+void FilterPixels(const uint8_t* src, int n, ViewFilter filter, uint8_t* dst);
+
+/**
+ * Rotate a tightly packed `width` × `height` RGBA bitmap clockwise by
+ * `quarterTurns` (1–3) quarter turns into `dst`, which must not overlap
+ * `src`.  Odd turns swap the dimensions.  Quarter turns walk the bitmap
+ * in cache-sized tiles, transposing 4×4 pixel blocks in registers with
+ * SSE2 or NEON where available.
+ */
+void RotatePixels(const uint8_t* src, int width, int height, int quarterTurns,
+                  uint8_t* dst);
+
+/** Copy a BGRA PDFium bitmap into tightly packed RGBA. */
+void CopyBitmapToRgba(FPDF_BITMAP bitmap, int width, int height, uint8_t* dst);
+
+/**
+ * Box-filter `sw` × `sh` pixels, each row `stride` bytes after the last,
+ * down to `dw` × `dh` tightly packed RGBA.  Source pixels are `bpp`
+ * bytes: 1 for gray, 3 or 4 for BGR, with alpha in the fourth byte only
+ * when `alpha` (otherwise opaque).  Each destination pixel is the
+ * rounded mean of the source box it covers; sums are 64-bit, so a box
+ * may hold any number of pixels.
+ */
+void DownsamplePixels(const uint8_t* src, size_t stride, int bpp, bool alpha,
+                      int sw, int sh, int dw, int dh, uint8_t* dst);
+
+#endif // PDFIUM_ADDON_LAYERS_H
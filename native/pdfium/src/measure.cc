@@ -0,0 +1,278 @@
+/**
+ * measure.cc — Glyph-advance cache and measureText.
+ */
+
+#include "common.h"
+#include "measure.h"
+#include "fonts.h"
+#include "sha256.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/** Advances and vertical metrics of one font, at size 1. */
+struct FontMetrics {
+  std::unordered_map<uint32_t, float> advances;
+  float ascent = 0.0f;
+  float descent = 0.0f;
+};
+
+/** What measuring in a text object's font needs, per page version. */
+struct ObjectFont {
+  uint32_t version;
+  std::string identity;
+  float size;
+  float scaleX;       ///< Horizontal scale of the object's matrix.
+};
+
+/** handle → (font identity → metrics). */
+std::map<int, std::unordered_map<std::string, FontMetrics>> g_metrics;
+
+/** (handle, pageIndex, objectId) → font of that object. */
+std::map<std::tuple<int, int, int>, ObjectFont> g_objectFonts;
+
+/** Code points filled on a font's first use: ASCII and Latin-1. */
+constexpr uint32_t PREFILL_RANGES[][2] = { { 0x20, 0x7E }, { 0xA0, 0xFF } };
+
+float Advance(FPDF_FONT font, uint32_t cp) {
+  float width = 0.0f;
+  return FPDFFont_GetGlyphWidth(font, cp, 1.0f, &width) ? width : 0.0f;
+}
+
+/**
+ * Identity of a font drawn by page content.  FPDF_FONT pointers of
+ * page objects die with their page and the API exposes no object
+ * number for the font dictionary, so a font is identified by what
+ * decides its metrics: the descriptor, the embedded program, and the
+ * advances its /Widths and encoding give the prefilled range.  Name,
+ * flags and weight alone collide across subsets of one face.
+ */
+std::string ContentFontIdentity(FPDF_FONT font) {
+  Sha256 hash;
+  char name[256] = {};
+  FPDFFont_GetBaseFontName(font, name, sizeof(name));
+  hash.Update(name, sizeof(name));
+
+  int italicAngle = 0;
+  FPDFFont_GetItalicAngle(font, &italicAngle);
+  const int fields[] = {
+    FPDFFont_GetFlags(font), FPDFFont_GetWeight(font),
+    FPDFFont_GetIsEmbedded(font), italicAngle,
+  };
+  hash.Update(fields, sizeof(fields));
+
+  size_t programSize = 0;
+  if (FPDFFont_GetFontData(font, nullptr, 0, &programSize) && programSize > 0) {
+    std::vector<uint8_t> program(programSize);
+    if (FPDFFont_GetFontData(font, program.data(), program.size(), &programSize)) {
+      hash.Update(program.data(), programSize);
+    }
+  }
+
+  for (const auto& range : PREFILL_RANGES) {
+    for (uint32_t cp = range[0]; cp <= range[1]; cp++) {
+      const float advance = Advance(font, cp);
+      hash.Update(&advance, sizeof(advance));
+    }
+  }
+  return "obj:" + hash.FinalHex();
+}
+
+FontMetrics& MetricsFor(int handle, const std::string& identity, FPDF_FONT font,
+                        bool& created) {
+  auto& fonts = g_metrics[handle];
+  auto it = fonts.find(identity);
+  created = it == fonts.end();
+  if (!created) return it->second;
+
+  FontMetrics& m = fonts[identity];
+  FPDFFont_GetAscent(font, 1.0f, &m.ascent);
+  FPDFFont_GetDescent(font, 1.0f, &m.descent);
+  for (const auto& range : PREFILL_RANGES) {
+    for (uint32_t cp = range[0]; cp <= range[1]; cp++) m.advances[cp] = Advance(font, cp);
+  }
+  return m;
+}
+
+/** Decode UTF-16 into code points, one slot per code unit (0 after a pair). */
+std::vector<uint32_t> CodePoints(const std::u16string& text) {
+  std::vector<uint32_t> cps(text.size(), 0);
+  for (size_t i = 0; i < text.size(); i++) {
+    uint32_t c = text[i];
+    if (c >= 0xD800 && c < 0xDC00 && i + 1 < text.size() &&
+        text[i + 1] >= 0xDC00 && text[i + 1] < 0xE000) {
+      cps[i] = 0x10000 + ((c - 0xD800) << 10) + (text[i + 1] - 0xDC00);
+      i++;
+    } else {
+      cps[i] = c;
+    }
+  }
+  return cps;
+}
+
+bool HasMisses(const FontMetrics* m, const std::vector<uint32_t>& cps) {
+  if (!m) return true;
+  for (uint32_t cp : cps) {
+    if (cp && !m->advances.count(cp)) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+// ── measureText ─────────────────────────────────────────────────────
+
+Napi::Value MeasureText(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 4 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      !(info[2].IsNumber() || info[2].IsString()) || !info[3].IsString()) {
+    Napi::TypeError::New(env,
+      "measureText: requires (handle, pageIndex, objectId | fontRef, text, size?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle    = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex = info[1].As<Napi::Number>().Int32Value();
+  std::vector<uint32_t> cps = CodePoints(info[3].As<Napi::String>().Utf16Value());
+  float size = 0.0f;
+  if (info.Length() > 4 && info[4].IsNumber()) {
+    size = info[4].As<Napi::Number>().FloatValue();
+  }
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  FontMetrics* metrics = nullptr;
+  float scaleX = 1.0f;
+
+  if (info[2].IsString()) {
+    // ── Font reference: no page involved ──────────────────────────
+    std::string fontRef = info[2].As<Napi::String>().Utf8Value();
+    std::string identity = "ref:" + fontRef;
+    auto docIt = g_metrics.find(handle);
+    if (docIt != g_metrics.end()) {
+      auto it = docIt->second.find(identity);
+      if (it != docIt->second.end()) metrics = &it->second;
+    }
+    if (HasMisses(metrics, cps)) {
+      FPDF_FONT font = ResolveFont(handle, doc, fontRef);
+      if (!font) {
+        Napi::Error::New(env, "measureText: unknown font '" + fontRef + "'")
+          .ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      bool created = false;
+      metrics = &MetricsFor(handle, identity, font, created);
+      for (uint32_t cp : cps) {
+        if (cp && !metrics->advances.count(cp)) metrics->advances[cp] = Advance(font, cp);
+      }
+    }
+    if (size <= 0.0f) {
+      Napi::RangeError::New(env, "measureText: size must be > 0 for a font reference")
+        .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  } else {
+    // ── Text object: cached per page version ──────────────────────
+    int objectId = info[2].As<Napi::Number>().Int32Value();
+    const auto key = std::make_tuple(handle, pageIndex, objectId);
+    const uint32_t version = GetPageVersion(handle, pageIndex);
+
+    auto objIt = g_objectFonts.find(key);
+    if (objIt != g_objectFonts.end() && objIt->second.version != version) {
+      g_objectFonts.erase(objIt);
+      objIt = g_objectFonts.end();
+    }
+    if (objIt != g_objectFonts.end()) {
+      auto& fonts = g_metrics[handle];
+      auto it = fonts.find(objIt->second.identity);
+      if (it != fonts.end()) metrics = &it->second;
+    }
+
+    if (objIt == g_objectFonts.end() || HasMisses(metrics, cps)) {
+      if (pageIndex < 0 || pageIndex >= FPDF_GetPageCount(doc)) {
+        Napi::RangeError::New(env,
+          "measureText: pageIndex " + std::to_string(pageIndex) + " out of range"
+        ).ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+
+      bool fromCache = false;
+      FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+      if (!page) {
+        Napi::Error::New(env,
+          "measureText: failed to load page " + std::to_string(pageIndex)
+        ).ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+
+      FPDF_PAGEOBJECT obj = (objectId >= 0 && objectId < FPDFPage_CountObjects(page))
+        ? FPDFPage_GetObject(page, objectId) : nullptr;
+      FPDF_FONT font = (obj && FPDFPageObj_GetType(obj) == FPDF_PAGEOBJ_TEXT)
+        ? FPDFTextObj_GetFont(obj) : nullptr;
+      float objSize = 0.0f;
+      FS_MATRIX matrix;
+      if (!font || !FPDFTextObj_GetFontSize(obj, &objSize) ||
+          !FPDFPageObj_GetMatrix(obj, &matrix)) {
+        ReleasePage(handle, pageIndex, page, fromCache);
+        Napi::RangeError::New(env,
+          "measureText: object " + std::to_string(objectId) + " is not a text object"
+        ).ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+
+      ObjectFont& entry = g_objectFonts[key] = {
+        version, ContentFontIdentity(font), objSize,
+        static_cast<float>(std::hypot(matrix.a, matrix.b)),
+      };
+      objIt = g_objectFonts.find(key);
+
+      bool created = false;
+      metrics = &MetricsFor(handle, entry.identity, font, created);
+      for (uint32_t cp : cps) {
+        if (cp && !metrics->advances.count(cp)) metrics->advances[cp] = Advance(font, cp);
+      }
+      ReleasePage(handle, pageIndex, page, fromCache);
+    }
+
+    if (size <= 0.0f) size = objIt->second.size;
+    scaleX = objIt->second.scaleX;
+  }
+
+  // ── Sum from the cache ────────────────────────────────────────────
+  const float unit = size * scaleX;
+  auto advances = Napi::Float32Array::New(env, cps.size());
+  double width = 0.0;
+  for (size_t i = 0; i < cps.size(); i++) {
+    float a = cps[i] ? metrics->advances[cps[i]] * unit : 0.0f;
+    advances[i] = a;
+    width += a;
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("width", Napi::Number::New(env, width));
+  result.Set("ascent", Napi::Number::New(env, metrics->ascent * size));
+  result.Set("descent", Napi::Number::New(env, metrics->descent * size));
+  result.Set("advances", advances);
+  return result;
+}
+
+void DiscardMeasureCache(int handle) {
+  g_metrics.erase(handle);
+  g_objectFonts.erase(g_objectFonts.lower_bound(std::make_tuple(handle, 0, 0)),
+                      g_objectFonts.lower_bound(std::make_tuple(handle + 1, 0, 0)));
+}
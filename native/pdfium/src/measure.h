@@ -0,0 +1,30 @@
+/**
+ * measure.h — Text measurement for the editor, from cached glyph
+ * advances.
+ */
+#ifndef PDFIUM_ADDON_MEASURE_H
+#define PDFIUM_ADDON_MEASURE_H
+
+#include <napi.h>
+
+/**
+ * measureText(handle, pageIndex, target: objectId | fontRef, text, size?)
+ * → { width, ascent, descent, advances: Float32Array }
+ *
+ * Measures `text` in the font of text object `objectId`, or in
+ * `fontRef` (a standard-14 name or a loadFont reference), at `size`
+ * points (default: the object's font size).  For an object, results
+ * include the horizontal scale of its matrix, so they compare directly
+ * with its bounds.  `advances` holds one entry per UTF-16 code unit
+ * (0 for trailing surrogates).  Kerning and char/word spacing are not
+ * applied.
+ *
+ * Advances are cached per document and font; the page is only loaded
+ * when a glyph or object has not been seen before.
+ */
+Napi::Value MeasureText(const Napi::CallbackInfo& info);
+
+/** Drop the measurement caches of a closed document. */
+void DiscardMeasureCache(int handle);
+
+#endif // PDFIUM_ADDON_MEASURE_H
@@ -0,0 +1,423 @@
+/**
+ * merge.cc — Fill one AcroForm template with many records.
+ *
+ * The template bytes are copied into the job once and its form is
+ * indexed once: which page and annotation index hold each field, and
+ * which pages carry widgets at all.  Each record then reloads the
+ * template from memory — PDFium parses lazily, so only the trailer and
+ * the pages that hold a filled field are touched — fills fields through
+ * the form-fill API so appearance streams are regenerated, and streams
+ * the copy straight to its output file.
+ */
+
+#include "common.h"
+#include "merge.h"
+#include "document.h"
+#include "jobs.h"
+
+#include <fpdfview.h>
+#include <fpdf_annot.h>
+#include <fpdf_flatten.h>
+#include <fpdf_formfill.h>
+
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/** Character code FORM_OnChar uses to toggle a focused check box. */
+constexpr int TOGGLE_CHAR = ' ';
+
+struct FieldValue {
+  std::u16string text;
+  bool isBool = false;
+  bool checked = false;
+};
+
+using MergeRecord = std::vector<std::pair<std::u16string, FieldValue>>;
+
+/** Where one widget of a field lives in the template. */
+struct FieldSlot {
+  int pageIndex;
+  int annotIndex;
+  int type;  ///< FPDF_FORMFIELD_*
+};
+
+/** Read a UTF-16LE string from a PDFium (buffer, length) getter. */
+template <typename Getter>
+std::u16string ReadUtf16(Getter get) {
+  unsigned long bytes = get(nullptr, 0);
+  if (bytes <= sizeof(FPDF_WCHAR)) return {};
+  std::vector<FPDF_WCHAR> buf(bytes / sizeof(FPDF_WCHAR));
+  get(buf.data(), bytes);
+  return std::u16string(reinterpret_cast<const char16_t*>(buf.data()),
+                        buf.size() - 1);
+}
+
+class MergeJob : public Job {
+ public:
+  MergeJob(Napi::Env env, std::vector<uint8_t> templateBytes,
+           std::string password, std::vector<MergeRecord> records,
+           std::vector<std::string> outputs, bool flatten,
+           Napi::Value onProgress)
+    : Job(env, onProgress),
+      template_(std::move(templateBytes)),
+      password_(std::move(password)),
+      records_(std::move(records)),
+      outputs_(std::move(outputs)),
+      flatten_(flatten) {}
+
+ protected:
+  void Execute(const ExecutionProgress& progress) override {
+    const int total = static_cast<int>(records_.size());
+    std::string error;
+
+    {
+      PdfiumLock lock(g_pdfiumMutex);
+      if (!IndexTemplate(error)) {
+        SetError(error);
+        return;
+      }
+    }
+
+    for (size_t i = 0; i < records_.size(); i++) {
+      if (CancelRequested()) {
+        MarkCancelled();
+        break;
+      }
+
+      {
+        PdfiumLock lock(g_pdfiumMutex);
+        error.clear();
+        if (FillRecord(records_[i], outputs_[i], error)) {
+          written_++;
+        } else {
+          failed_.emplace_back(static_cast<int>(i), error);
+        }
+      }
+
+      JobProgress p = { static_cast<int>(i + 1), total };
+      progress.Send(&p, 1);
+    }
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("written", Napi::Number::New(env, written_));
+
+    Napi::Array failed = Napi::Array::New(env, failed_.size());
+    for (size_t i = 0; i < failed_.size(); i++) {
+      Napi::Object entry = Napi::Object::New(env);
+      entry.Set("record", Napi::Number::New(env, failed_[i].first));
+      entry.Set("error",  Napi::String::New(env, failed_[i].second));
+      failed[static_cast<uint32_t>(i)] = entry;
+    }
+    result.Set("failed", failed);
+
+    // Keys no template field matched, most likely typos in the data.
+    std::set<std::u16string> unknown;
+    for (const MergeRecord& record : records_) {
+      for (const auto& [name, value] : record) {
+        if (fields_.count(name) == 0) unknown.insert(name);
+      }
+    }
+    Napi::Array unknownArr = Napi::Array::New(env, unknown.size());
+    uint32_t k = 0;
+    for (const std::u16string& name : unknown) {
+      unknownArr[k++] = Napi::String::New(env, name);
+    }
+    result.Set("unknownFields", unknownArr);
+    return result;
+  }
+
+ private:
+  FPDF_DOCUMENT LoadTemplate() const {
+    return FPDF_LoadMemDocument(template_.data(),
+                                static_cast<int>(template_.size()),
+                                password_.empty() ? nullptr : password_.c_str());
+  }
+
+  /** Record where every field's widgets live.  Runs once per job. */
+  bool IndexTemplate(std::string& error) {
+    FPDF_DOCUMENT doc = LoadTemplate();
+    if (!doc) {
+      error = "mailMerge: template could not be opened";
+      return false;
+    }
+
+    FPDF_FORMFILLINFO formInfo;
+    std::memset(&formInfo, 0, sizeof(formInfo));
+    formInfo.version = 1;
+    FPDF_FORMHANDLE form = FPDFDOC_InitFormFillEnvironment(doc, &formInfo);
+
+    int pageCount = FPDF_GetPageCount(doc);
+    for (int pageIndex = 0; pageIndex < pageCount; pageIndex++) {
+      FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+      if (!page) continue;
+
+      bool hasWidget = false;
+      int annotCount = FPDFPage_GetAnnotCount(page);
+      for (int a = 0; a < annotCount; a++) {
+        FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, a);
+        if (!annot) continue;
+        if (FPDFAnnot_GetSubtype(annot) == FPDF_ANNOT_WIDGET) {
+          hasWidget = true;
+          std::u16string name = ReadUtf16(
+            [&](FPDF_WCHAR* buf, unsigned long len) {
+              return FPDFAnnot_GetFormFieldName(form, annot, buf, len);
+            });
+          if (!name.empty()) {
+            fields_[name].push_back(
+              { pageIndex, a, FPDFAnnot_GetFormFieldType(form, annot) });
+          }
+        }
+        FPDFPage_CloseAnnot(annot);
+      }
+
+      if (hasWidget) widgetPages_.push_back(pageIndex);
+      FPDF_ClosePage(page);
+    }
+
+    FPDFDOC_ExitFormFillEnvironment(form);
+    FPDF_CloseDocument(doc);
+
+    if (fields_.empty()) {
+      error = "mailMerge: template has no form fields";
+      return false;
+    }
+    return true;
+  }
+
+  bool FillRecord(const MergeRecord& record, const std::string& output,
+                  std::string& error) {
+    // Only pages holding a field this record sets need loading, plus
+    // every widget page when the output is flattened.
+    std::map<int, std::vector<std::pair<const FieldSlot*, const FieldValue*>>>
+      edits;
+    for (const auto& [name, value] : record) {
+      auto it = fields_.find(name);
+      if (it == fields_.end()) continue;
+      for (const FieldSlot& slot : it->second) {
+        edits[slot.pageIndex].emplace_back(&slot, &value);
+      }
+    }
+    if (flatten_) {
+      for (int pageIndex : widgetPages_) edits[pageIndex];
+    }
+
+    FPDF_DOCUMENT doc = LoadTemplate();
+    if (!doc) {
+      error = "template could not be reopened";
+      return false;
+    }
+
+    FPDF_FORMFILLINFO formInfo;
+    std::memset(&formInfo, 0, sizeof(formInfo));
+    formInfo.version = 1;
+    FPDF_FORMHANDLE form = FPDFDOC_InitFormFillEnvironment(doc, &formInfo);
+
+    bool ok = true;
+    for (const auto& [pageIndex, pageEdits] : edits) {
+      FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+      if (!page) {
+        error = "failed to load page " + std::to_string(pageIndex);
+        ok = false;
+        break;
+      }
+      FORM_OnAfterLoadPage(page, form);
+
+      for (const auto& [slot, value] : pageEdits) {
+        FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, slot->annotIndex);
+        if (!annot) continue;
+        SetField(form, page, annot, slot->type, *value);
+        FPDFPage_CloseAnnot(annot);
+      }
+
+      // Killing focus commits the last edited field's value.
+      FORM_ForceToKillFocus(form);
+      FORM_OnBeforeClosePage(page, form);
+
+      if (flatten_ && FPDFPage_Flatten(page, FLAT_NORMALDISPLAY) == FLATTEN_FAIL) {
+        error = "FPDFPage_Flatten failed for page " + std::to_string(pageIndex);
+        ok = false;
+      }
+      FPDF_ClosePage(page);
+      if (!ok) break;
+    }
+
+    FPDFDOC_ExitFormFillEnvironment(form);
+    if (ok) ok = StreamDocumentToFile(doc, output, error);
+    FPDF_CloseDocument(doc);
+    return ok;
+  }
+
+  static void SetField(FPDF_FORMHANDLE form, FPDF_PAGE page,
+                       FPDF_ANNOTATION annot, int type,
+                       const FieldValue& value) {
+    auto replaceText = [&]() {
+      FORM_SetFocusedAnnot(form, annot);
+      FORM_SelectAllText(form, page);
+      FORM_ReplaceSelection(form, page,
+        reinterpret_cast<FPDF_WIDESTRING>(value.text.c_str()));
+    };
+
+    switch (type) {
+      case FPDF_FORMFIELD_TEXTFIELD:
+        replaceText();
+        break;
+
+      case FPDF_FORMFIELD_COMBOBOX:
+      case FPDF_FORMFIELD_LISTBOX: {
+        int index = FindOption(form, annot, value.text);
+        if (index >= 0) {
+          FORM_SetFocusedAnnot(form, annot);
+          FORM_SetIndexSelected(form, page, index, true);
+        } else if (type == FPDF_FORMFIELD_COMBOBOX) {
+          replaceText();  // editable combo boxes take free text
+        }
+        break;
+      }
+
+      case FPDF_FORMFIELD_CHECKBOX:
+      case FPDF_FORMFIELD_RADIOBUTTON: {
+        bool want = value.isBool
+          ? value.checked
+          : value.text == ReadUtf16([&](FPDF_WCHAR* buf, unsigned long len) {
+              return FPDFAnnot_GetFormFieldExportValue(form, annot, buf, len);
+            });
+        bool isChecked = FPDFAnnot_IsChecked(form, annot) != 0;
+        // A radio button is cleared by checking a sibling, never directly.
+        if (want != isChecked && (want || type == FPDF_FORMFIELD_CHECKBOX)) {
+          FORM_SetFocusedAnnot(form, annot);
+          FORM_OnChar(form, page, TOGGLE_CHAR, 0);
+        }
+        break;
+      }
+
+      default:
+        break;  // push buttons and signatures carry no value
+    }
+  }
+
+  static int FindOption(FPDF_FORMHANDLE form, FPDF_ANNOTATION annot,
+                        const std::u16string& label) {
+    int count = FPDFAnnot_GetOptionCount(form, annot);
+    for (int i = 0; i < count; i++) {
+      std::u16string option = ReadUtf16(
+        [&](FPDF_WCHAR* buf, unsigned long len) {
+          return FPDFAnnot_GetOptionLabel(form, annot, i, buf, len);
+        });
+      if (option == label) return i;
+    }
+    return -1;
+  }
+
+  const std::vector<uint8_t> template_;
+  const std::string password_;
+  const std::vector<MergeRecord> records_;
+  const std::vector<std::string> outputs_;
+  const bool flatten_;
+
+  std::map<std::u16string, std::vector<FieldSlot>> fields_;
+  std::vector<int> widgetPages_;
+
+  int written_ = 0;
+  std::vector<std::pair<int, std::string>> failed_;  ///< (record, error)
+};
+
+/** Convert one JS record object; throws a TypeError and returns false on bad input. */
+bool ReadRecord(Napi::Env env, Napi::Value value, MergeRecord& out) {
+  if (!value.IsObject() || value.IsArray()) {
+    Napi::TypeError::New(env, "mailMerge: each record must be an object")
+      .ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Object obj = value.As<Napi::Object>();
+  Napi::Array keys = obj.GetPropertyNames();
+  out.reserve(keys.Length());
+
+  for (uint32_t i = 0; i < keys.Length(); i++) {
+    Napi::Value key = keys.Get(i);
+    Napi::Value v = obj.Get(key.ToString().Utf8Value());
+    FieldValue field;
+    if (v.IsBoolean()) {
+      field.isBool = true;
+      field.checked = v.As<Napi::Boolean>().Value();
+    } else if (v.IsString() || v.IsNumber()) {
+      field.text = v.ToString().Utf16Value();
+    } else if (v.IsUndefined() || v.IsNull()) {
+      continue;
+    } else {
+      Napi::TypeError::New(env,
+        "mailMerge: record values must be strings, numbers or booleans"
+      ).ThrowAsJavaScriptException();
+      return false;
+    }
+    out.emplace_back(key.ToString().Utf16Value(), std::move(field));
+  }
+  return true;
+}
+
+} // namespace
+
+// ── mailMerge ───────────────────────────────────────────────────────
+
+Napi::Value MailMerge(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+  EnsurePdfiumInit();
+
+  if (info.Length() < 3 || !info[0].IsBuffer() || !info[1].IsArray() ||
+      !info[2].IsArray()) {
+    Napi::TypeError::New(env,
+      "mailMerge: requires (template: Buffer, records: object[], "
+      "outputs: string[], options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto buffer = info[0].As<Napi::Buffer<uint8_t>>();
+  Napi::Array recordsArr = info[1].As<Napi::Array>();
+  Napi::Array outputsArr = info[2].As<Napi::Array>();
+  Napi::Value options    = info.Length() > 3 ? info[3] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 4 ? info[4] : env.Undefined();
+
+  if (recordsArr.Length() != outputsArr.Length()) {
+    Napi::RangeError::New(env,
+      "mailMerge: records and outputs must have the same length"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<MergeRecord> records(recordsArr.Length());
+  std::vector<std::string> outputs(outputsArr.Length());
+  for (uint32_t i = 0; i < recordsArr.Length(); i++) {
+    if (!ReadRecord(env, recordsArr.Get(i), records[i])) return env.Undefined();
+    Napi::Value out = outputsArr.Get(i);
+    if (!out.IsString()) {
+      Napi::TypeError::New(env, "mailMerge: outputs must be file paths")
+        .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    outputs[i] = out.As<Napi::String>().Utf8Value();
+  }
+
+  bool flatten = GetBoolOption(options, "flatten", false);
+  std::string password;
+  if (options.IsObject()) {
+    Napi::Value pw = options.As<Napi::Object>().Get("password");
+    if (pw.IsString()) password = pw.As<Napi::String>().Utf8Value();
+  }
+
+  std::vector<uint8_t> templateBytes(buffer.Data(),
+                                     buffer.Data() + buffer.Length());
+
+  auto* job = new MergeJob(env, std::move(templateBytes), std::move(password),
+                           std::move(records), std::move(outputs), flatten,
+                           onProgress);
+  return job->Start();
+}
@@ -0,0 +1,25 @@
+/**
+ * merge.h — Form-field mail merge.
+ */
+#ifndef PDFIUM_ADDON_MERGE_H
+#define PDFIUM_ADDON_MERGE_H
+
+#include <napi.h>
+
+/**
+ * mailMerge(template: Buffer, records: object[], outputs: string[],
+ *           options?: { flatten?: boolean, password?: string },
+ *           onProgress?): { jobId, done }
+ *
+ * Fills the template's AcroForm once per record through the form-fill
+ * API and streams each filled copy to outputs[i].  Record keys are
+ * fully-qualified field names; values are strings (text, choice and
+ * radio export values) or booleans (check boxes).
+ *
+ * `done` resolves with
+ *   { written, failed: [{ record, error }], unknownFields: string[],
+ *     cancelled }.
+ */
+Napi::Value MailMerge(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_MERGE_H
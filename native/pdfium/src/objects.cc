@@ -1,14 +1,19 @@
 /**
- * objects.cc — Page object listing, text editing, image replacement.
+ * objects.cc — Page object listing, text editing, transforms, image
+ * replacement, image fingerprints.
  */
 
 #include "common.h"
 #include "objects.h"
+#include "fonts.h"
+#include "previews.h"
 
 #include <fpdfview.h>
 #include <fpdf_edit.h>
 #include <fpdf_text.h>
 
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -30,6 +35,7 @@ static const char* GetObjectTypeName(int type) {
 
 Napi::Value ListPageObjects(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
 
   if (info.Length() < 2 ||
       !info[0].IsNumber() ||
@@ -105,8 +111,169 @@ Napi::Value ListPageObjects(const Napi::CallbackInfo& info) {
 
 // ── editTextObject ──────────────────────────────────────────────────
 
+/**
+ * A mark name or parameter key read through one of the FPDFPageObjMark
+ * UTF-16 getters, as the byte string the setters take.  False for
+ * anything outside ASCII, which PDF names practically never are.
+ */
+template <typename Getter>
+static bool GetMarkAscii(Getter get, std::string& out) {
+  unsigned long bytes = 0;
+  if (!get(nullptr, 0, &bytes) || bytes < sizeof(FPDF_WCHAR)) return false;
+  std::vector<FPDF_WCHAR> buf(bytes / sizeof(FPDF_WCHAR));
+  if (!get(buf.data(), bytes, &bytes)) return false;
+  out.clear();
+  for (FPDF_WCHAR c : buf) {
+    if (c == 0) break;
+    if (c >= 0x80) return false;
+    out += static_cast<char>(c);
+  }
+  return !out.empty();
+}
+
+/**
+ * Copy the marked-content marks of `from` (/Span, /Artifact, tagged
+ * PDF's MCID…) onto `to`.  Integer, string and name parameters carry
+ * over; array and dictionary parameters have no setter and are dropped.
+ */
+static void CopyContentMarks(FPDF_DOCUMENT doc, FPDF_PAGEOBJECT from,
+                             FPDF_PAGEOBJECT to) {
+  const int markCount = FPDFPageObj_CountMarks(from);
+  for (int m = 0; m < markCount; m++) {
+    FPDF_PAGEOBJECTMARK mark = FPDFPageObj_GetMark(from, static_cast<unsigned long>(m));
+    std::string name;
+    if (!mark || !GetMarkAscii([&](FPDF_WCHAR* buf, unsigned long len, unsigned long* out) {
+          return FPDFPageObjMark_GetName(mark, buf, len, out);
+        }, name)) {
+      continue;
+    }
+    FPDF_PAGEOBJECTMARK copy = FPDFPageObj_AddMark(to, name.c_str());
+    if (!copy) continue;
+
+    const int paramCount = FPDFPageObjMark_CountParams(mark);
+    for (int p = 0; p < paramCount; p++) {
+      std::string key;
+      if (!GetMarkAscii([&](FPDF_WCHAR* buf, unsigned long len, unsigned long* out) {
+            return FPDFPageObjMark_GetParamKey(mark, static_cast<unsigned long>(p), buf, len, out);
+          }, key)) {
+        continue;
+      }
+      switch (FPDFPageObjMark_GetParamValueType(mark, key.c_str())) {
+        case FPDF_OBJECT_NUMBER: {
+          int value = 0;
+          if (FPDFPageObjMark_GetParamIntValue(mark, key.c_str(), &value)) {
+            FPDFPageObjMark_SetIntParam(doc, to, copy, key.c_str(), value);
+          }
+          break;
+        }
+        case FPDF_OBJECT_STRING: {
+          // Raw bytes both ways, so PDFDocEncoding and UTF-16BE text
+          // (an /ActualText, say) survive unchanged.
+          unsigned long len = 0;
+          if (!FPDFPageObjMark_GetParamBlobValue(mark, key.c_str(), nullptr, 0, &len)) break;
+          std::vector<unsigned char> value(len);
+          if (len == 0 ||
+              FPDFPageObjMark_GetParamBlobValue(mark, key.c_str(), value.data(), len, &len)) {
+            FPDFPageObjMark_SetBlobParam(doc, to, copy, key.c_str(), value.data(), len);
+          }
+          break;
+        }
+        case FPDF_OBJECT_NAME: {
+          std::string value;
+          if (GetMarkAscii([&](FPDF_WCHAR* buf, unsigned long len, unsigned long* out) {
+                return FPDFPageObjMark_GetParamStringValue(mark, key.c_str(), buf, len, out);
+              }, value)) {
+            FPDFPageObjMark_SetStringParam(doc, to, copy, key.c_str(), value.c_str());
+          }
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+}
+
+/** Copy the stroke state that stroked render modes draw with. */
+static void CopyStrokeState(FPDF_PAGEOBJECT from, FPDF_PAGEOBJECT to) {
+  float width = 0.0f;
+  if (FPDFPageObj_GetStrokeWidth(from, &width)) FPDFPageObj_SetStrokeWidth(to, width);
+  const int join = FPDFPageObj_GetLineJoin(from);
+  if (join >= 0) FPDFPageObj_SetLineJoin(to, join);
+  const int cap = FPDFPageObj_GetLineCap(from);
+  if (cap >= 0) FPDFPageObj_SetLineCap(to, cap);
+
+  const int dashCount = FPDFPageObj_GetDashCount(from);
+  float phase = 0.0f;
+  if (dashCount > 0 && FPDFPageObj_GetDashPhase(from, &phase)) {
+    std::vector<float> dashes(static_cast<size_t>(dashCount));
+    if (FPDFPageObj_GetDashArray(from, dashes.data(), dashes.size())) {
+      FPDFPageObj_SetDashArray(to, dashes.data(), dashes.size(), phase);
+    }
+  }
+}
+
+/**
+ * Replace text object `obj` (at `objectId`) with one showing `text` in
+ * `fontName` (empty = keep the font) at `fontSize` (0 = keep the size).
+ * The new object keeps the matrix, colours, render mode, stroke state
+ * and marked content, and the same index, so object ids stay stable.
+ *
+ * The object's clip path is lost: PDFium can read it but has no call
+ * to set one on a single object, so the new text is unclipped.  So are
+ * the blend mode and soft mask of its graphics state, which PDFium does
+ * not expose for reading.  Returns false with the page unchanged on
+ * failure.
+ */
+static bool RebuildTextObject(int handle, FPDF_DOCUMENT doc, FPDF_PAGE page,
+                              int objectId, FPDF_PAGEOBJECT obj,
+                              const std::u16string& text,
+                              const std::string& fontName, float fontSize) {
+  FPDF_FONT font = fontName.empty() ? FPDFTextObj_GetFont(obj)
+                                    : ResolveFont(handle, doc, fontName);
+  float size = fontSize;
+  if (size <= 0.0f && !FPDFTextObj_GetFontSize(obj, &size)) return false;
+  FS_MATRIX matrix;
+  if (!font || !FPDFPageObj_GetMatrix(obj, &matrix)) return false;
+
+  FPDF_PAGEOBJECT copy = FPDFPageObj_CreateTextObj(doc, font, size);
+  if (!copy) return false;
+  if (!FPDFText_SetText(copy, reinterpret_cast<FPDF_WIDESTRING>(text.c_str()))) {
+    FPDFPageObj_Destroy(copy);
+    return false;
+  }
+
+  FPDFPageObj_SetMatrix(copy, &matrix);
+  unsigned int r = 0, g = 0, b = 0, a = 255;
+  if (FPDFPageObj_GetFillColor(obj, &r, &g, &b, &a)) {
+    FPDFPageObj_SetFillColor(copy, r, g, b, a);
+  }
+  if (FPDFPageObj_GetStrokeColor(obj, &r, &g, &b, &a)) {
+    FPDFPageObj_SetStrokeColor(copy, r, g, b, a);
+  }
+  FPDF_TEXT_RENDERMODE mode = FPDFTextObj_GetTextRenderMode(obj);
+  if (mode != FPDF_TEXTRENDERMODE_UNKNOWN) {
+    FPDFTextObj_SetTextRenderMode(copy, mode);
+  }
+  CopyStrokeState(obj, copy);
+  CopyContentMarks(doc, obj, copy);
+
+  if (!FPDFPage_RemoveObject(page, obj)) {
+    FPDFPageObj_Destroy(copy);
+    return false;
+  }
+  if (!FPDFPage_InsertObjectAtIndex(page, copy, static_cast<size_t>(objectId))) {
+    FPDFPage_InsertObjectAtIndex(page, obj, static_cast<size_t>(objectId));
+    FPDFPageObj_Destroy(copy);
+    return false;
+  }
+  FPDFPageObj_Destroy(obj);
+  return true;
+}
+
 void EditTextObject(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
 
   // editTextObject(handle, pageIndex, objectId, newText [, fontName, fontSize])
   if (info.Length() < 4 ||
@@ -127,6 +294,17 @@ void EditTextObject(const Napi::CallbackInfo& info) {
   // Get text as UTF-16LE for PDFium's FPDF_WIDESTRING
   std::u16string newText = info[3].As<Napi::String>().Utf16Value();
 
+  // Optional font change: a standard-14 name or a loadFont reference,
+  // and/or a new size.
+  std::string fontName;
+  if (info.Length() > 4 && info[4].IsString()) {
+    fontName = info[4].As<Napi::String>().Utf8Value();
+  }
+  float fontSize = 0.0f;
+  if (info.Length() > 5 && info[5].IsNumber()) {
+    fontSize = info[5].As<Napi::Number>().FloatValue();
+  }
+
   FPDF_DOCUMENT doc = RequireDocument(env, handle);
   if (!doc) return;
 
@@ -162,16 +340,20 @@ void EditTextObject(const Napi::CallbackInfo& info) {
     return;
   }
 
-  // Set text content (FPDF_WIDESTRING = const unsigned short* or const wchar_t*)
-  FPDF_BOOL ok = FPDFText_SetText(
-    obj,
-    reinterpret_cast<FPDF_WIDESTRING>(newText.c_str())
-  );
+  // Set text content (FPDF_WIDESTRING = const unsigned short* or const wchar_t*).
+  // PDFium cannot change the font of an existing text object, so a font
+  // or size change rebuilds the object in place with the cached font.
+  const bool rebuild = !fontName.empty() || fontSize > 0.0f;
+  FPDF_BOOL ok = rebuild
+    ? RebuildTextObject(handle, doc, page, objectId, obj, newText, fontName, fontSize)
+    : FPDFText_SetText(obj, reinterpret_cast<FPDF_WIDESTRING>(newText.c_str()));
 
   if (!ok) {
     ReleasePage(handle, pageIndex, page, fromCache);
-    Napi::Error::New(env, "editTextObject: FPDFText_SetText failed")
-      .ThrowAsJavaScriptException();
+    Napi::Error::New(env, rebuild
+      ? "editTextObject: cannot set the text in font '" + fontName + "'"
+      : std::string("editTextObject: FPDFText_SetText failed")
+    ).ThrowAsJavaScriptException();
     return;
   }
 
@@ -183,6 +365,70 @@ void EditTextObject(const Napi::CallbackInfo& info) {
   CachePageDirty(handle, pageIndex, page);
 }
 
+// ── transformObject ─────────────────────────────────────────────────
+
+void TransformObject(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  // transformObject(handle, pageIndex, objectId, [a, b, c, d, e, f])
+  if (info.Length() < 4 ||
+      !info[0].IsNumber() ||
+      !info[1].IsNumber() ||
+      !info[2].IsNumber() ||
+      !info[3].IsArray() ||
+      info[3].As<Napi::Array>().Length() != 6) {
+    Napi::TypeError::New(env,
+      "transformObject: requires (handle, pageIndex, objectId, matrix[6])"
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  int handle      = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex   = info[1].As<Napi::Number>().Int32Value();
+  int objectId    = info[2].As<Napi::Number>().Int32Value();
+
+  Napi::Array arr = info[3].As<Napi::Array>();
+  double m[6];
+  for (uint32_t i = 0; i < 6; ++i) {
+    Napi::Value v = arr.Get(i);
+    if (!v.IsNumber()) {
+      Napi::TypeError::New(env, "transformObject: matrix entries must be numbers")
+        .ThrowAsJavaScriptException();
+      return;
+    }
+    m[i] = v.As<Napi::Number>().DoubleValue();
+  }
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return;
+
+  bool fromCache = false;
+  FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+  if (!page) {
+    Napi::Error::New(env,
+      "transformObject: failed to load page " + std::to_string(pageIndex)
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  int objCount = FPDFPage_CountObjects(page);
+  if (objectId < 0 || objectId >= objCount) {
+    ReleasePage(handle, pageIndex, page, fromCache);
+    Napi::RangeError::New(env,
+      "transformObject: objectId " + std::to_string(objectId) +
+      " out of range [0, " + std::to_string(objCount - 1) + "]"
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  FPDFPageObj_Transform(FPDFPage_GetObject(page, objectId),
+                        m[0], m[1], m[2], m[3], m[4], m[5]);
+
+  // Content is regenerated at save time, as for editTextObject.
+  CachePageDirty(handle, pageIndex, page);
+}
+
 // ── replaceImageObject ──────────────────────────────────────────────
 
 /**
@@ -209,6 +455,7 @@ static int BufferReadBlock(
 
 void ReplaceImageObject(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
 
   // replaceImageObject(handle, pageIndex, objectId, imageData, format)
   if (info.Length() < 5 ||
@@ -294,6 +541,7 @@ void ReplaceImageObject(const Napi::CallbackInfo& info) {
     return;
   }
 
+  InvalidateImagePreview(handle, pageIndex, objectId);
   // Defer FPDFPage_GenerateContent to save time.
   CachePageDirty(handle, pageIndex, page);
 }
@@ -307,6 +555,7 @@ void ReplaceImageObject(const Napi::CallbackInfo& info) {
  */
 void ReplaceImageObjectBitmap(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
 
   // replaceImageObjectBitmap(handle, pageIndex, objectId, bgraData, width, height)
   if (info.Length() < 6 ||
@@ -404,6 +653,88 @@ void ReplaceImageObjectBitmap(const Napi::CallbackInfo& info) {
     return;
   }
 
+  InvalidateImagePreview(handle, pageIndex, objectId);
   // Defer FPDFPage_GenerateContent to save time.
   CachePageDirty(handle, pageIndex, page);
 }
+
+// ── getImageFingerprint ─────────────────────────────────────────────
+
+/** FNV-1a, 64-bit: cheap and stable across runs and platforms. */
+static uint64_t Fnv1a64(const uint8_t* data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+uint64_t ImageStreamHash(FPDF_PAGEOBJECT obj) {
+  // Hash the still-encoded stream: identical logos embedded by the same
+  // producer hash identically without decoding a single pixel.
+  std::vector<uint8_t> raw(FPDFImageObj_GetImageDataRaw(obj, nullptr, 0));
+  if (!raw.empty()) {
+    FPDFImageObj_GetImageDataRaw(obj, raw.data(),
+                                 static_cast<unsigned long>(raw.size()));
+  }
+  return Fnv1a64(raw.data(), raw.size());
+}
+
+Napi::Value GetImageFingerprint(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 3 ||
+      !info[0].IsNumber() ||
+      !info[1].IsNumber() ||
+      !info[2].IsNumber()) {
+    Napi::TypeError::New(env,
+      "getImageFingerprint: requires (handle, pageIndex, objectId)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle    = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex = info[1].As<Napi::Number>().Int32Value();
+  int objectId  = info[2].As<Napi::Number>().Int32Value();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  bool fromCache = false;
+  FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+  if (!page) {
+    Napi::Error::New(env,
+      "getImageFingerprint: failed to load page " + std::to_string(pageIndex)
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int objCount = FPDFPage_CountObjects(page);
+  FPDF_PAGEOBJECT obj = (objectId >= 0 && objectId < objCount)
+    ? FPDFPage_GetObject(page, objectId) : nullptr;
+  if (!obj || FPDFPageObj_GetType(obj) != FPDF_PAGEOBJ_IMAGE) {
+    ReleasePage(handle, pageIndex, page, fromCache);
+    Napi::TypeError::New(env,
+      "getImageFingerprint: object " + std::to_string(objectId) +
+      " is not an image object"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  unsigned int width = 0, height = 0;
+  FPDFImageObj_GetImagePixelSize(obj, &width, &height);
+
+  const uint64_t hash = ImageStreamHash(obj);
+  ReleasePage(handle, pageIndex, page, fromCache);
+
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("pixelWidth",  Napi::Number::New(env, width));
+  result.Set("pixelHeight", Napi::Number::New(env, height));
+  result.Set("hash",        Napi::String::New(env, hex));
+  return result;
+}
@@ -5,6 +5,9 @@
 #define PDFIUM_ADDON_OBJECTS_H
 
 #include <napi.h>
+#include <fpdfview.h>
+
+#include <cstdint>
 
 /**
  * listPageObjects(handle, pageIndex)
@@ -15,9 +18,20 @@ Napi::Value ListPageObjects(const Napi::CallbackInfo& info);
 /**
  * editTextObject(handle, pageIndex, objectId, newText, fontName?, fontSize?)
  * → void
+ * `fontName` is a standard-14 name or a loadFont reference (fonts.h);
+ * giving it or `fontSize` rebuilds the object with that font, at the
+ * same object id.  A rebuilt object loses its clip path and blend mode,
+ * which PDFium cannot copy; see RebuildTextObject.
  */
 void EditTextObject(const Napi::CallbackInfo& info);
 
+/**
+ * transformObject(handle, pageIndex, objectId, matrix: [a, b, c, d, e, f])
+ * → void
+ * Concatenates `matrix` (PDF space) onto the object's transform.
+ */
+void TransformObject(const Napi::CallbackInfo& info);
+
 /**
  * replaceImageObject(handle, pageIndex, objectId, imageData, format)
  * → void
@@ -31,4 +45,19 @@ void ReplaceImageObject(const Napi::CallbackInfo& info);
  */
 void ReplaceImageObjectBitmap(const Napi::CallbackInfo& info);
 
+/**
+ * getImageFingerprint(handle, pageIndex, objectId)
+ * → { pixelWidth, pixelHeight, hash }
+ * `hash` is a hex digest of the image's encoded stream, for matching
+ * the same image across documents.
+ */
+Napi::Value GetImageFingerprint(const Napi::CallbackInfo& info);
+
+/**
+ * 64-bit hash of an image object's encoded stream — the identity behind
+ * getImageFingerprint, and the base of the preview cache's key
+ * (previews.cc).  Caller holds g_pdfiumMutex.
+ */
+uint64_t ImageStreamHash(FPDF_PAGEOBJECT obj);
+
 #endif // PDFIUM_ADDON_OBJECTS_H
@@ -0,0 +1,484 @@
+/**
+ * ocr.cc — Rendering pages for OCR and writing its words back.
+ *
+ * OCR images are written as binary PGM: one grey byte per pixel after
+ * a short header, which OCR engines read directly.  Writing one costs
+ * what copying it costs, so the render thread hands a page to the
+ * engines as fast as the disk takes it.
+ */
+
+#include "common.h"
+#include "ocr.h"
+#include "fonts.h"
+#include "jobs.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr double DEFAULT_OCR_DPI = 300.0;
+constexpr double POINTS_PER_INCH = 72.0;
+
+/** Largest OCR raster, in pixels; the dpi drops beyond it. */
+constexpr double MAX_OCR_PIXELS = 64.0 * 1024 * 1024;
+
+/** As printed, without LCD text, whose colour fringes read as noise. */
+constexpr int OCR_RENDER_FLAGS = FPDF_ANNOT | FPDF_PRINTING;
+
+/** Words whose box is thinner than this, in points, are dropped. */
+constexpr double MIN_WORD_POINTS = 0.5;
+
+constexpr char DEFAULT_OCR_FONT[] = "Helvetica";
+
+struct GreyRaster {
+  std::vector<uint8_t> pixels;
+  int width = 0;
+  int height = 0;
+};
+
+struct OcrImage {
+  int pageIndex;
+  std::string path;
+  int width;
+  int height;
+};
+
+struct OcrFailure {
+  int pageIndex;
+  std::string error;
+};
+
+/** Count text and image objects, looking inside form XObjects. */
+void CountContent(FPDF_PAGEOBJECT obj, int& text, int& images) {
+  switch (FPDFPageObj_GetType(obj)) {
+    case FPDF_PAGEOBJ_TEXT:
+      text++;
+      break;
+    case FPDF_PAGEOBJ_IMAGE:
+      images++;
+      break;
+    case FPDF_PAGEOBJ_FORM: {
+      const int count = FPDFFormObj_CountObjects(obj);
+      for (int i = 0; i < count && text == 0; ++i) {
+        CountContent(FPDFFormObj_GetObject(obj, static_cast<unsigned long>(i)),
+                     text, images);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/** A scan: images, and no text yet (not even an earlier OCR layer). */
+bool ImageOnly(FPDF_PAGE page) {
+  int text = 0, images = 0;
+  const int count = FPDFPage_CountObjects(page);
+  for (int i = 0; i < count && text == 0; ++i) {
+    CountContent(FPDFPage_GetObject(page, i), text, images);
+  }
+  return text == 0 && images > 0;
+}
+
+/**
+ * Render `page` upright, as displayed, in grey at `dpi` (lowered for
+ * huge pages).  Caller holds g_pdfiumMutex.
+ */
+bool RenderGrey(FPDF_PAGE page, double dpi, GreyRaster& out) {
+  const double w = std::max(1.0f, FPDF_GetPageWidthF(page));
+  const double h = std::max(1.0f, FPDF_GetPageHeightF(page));
+  double scale = dpi / POINTS_PER_INCH;
+  if (w * h * scale * scale > MAX_OCR_PIXELS) {
+    scale = std::sqrt(MAX_OCR_PIXELS / (w * h));
+  }
+  out.width = std::max(1, static_cast<int>(std::lround(w * scale)));
+  out.height = std::max(1, static_cast<int>(std::lround(h * scale)));
+
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(out.width, out.height, /*alpha=*/0);
+  if (!bitmap) return false;
+  FPDFBitmap_FillRect(bitmap, 0, 0, out.width, out.height, 0xFFFFFFFF);
+  FPDF_RenderPageBitmap(bitmap, page, 0, 0, out.width, out.height, 0,
+                        OCR_RENDER_FLAGS);
+
+  // BGRx → grey with Rec. 601 weights in 8-bit fixed point.
+  const uint8_t* src = static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+  const int stride = FPDFBitmap_GetStride(bitmap);
+  out.pixels.resize(static_cast<size_t>(out.width) * out.height);
+  uint8_t* dst = out.pixels.data();
+  for (int y = 0; y < out.height; ++y) {
+    const uint8_t* s = src + static_cast<size_t>(y) * stride;
+    for (int x = 0; x < out.width; ++x, s += 4) {
+      *dst++ = static_cast<uint8_t>((s[2] * 77 + s[1] * 150 + s[0] * 29 + 128) >> 8);
+    }
+  }
+  FPDFBitmap_Destroy(bitmap);
+  return true;
+}
+
+bool WritePgm(const std::filesystem::path& path, const GreyRaster& raster) {
+  const std::string header = "P5\n" + std::to_string(raster.width) + " " +
+                             std::to_string(raster.height) + "\n255\n";
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(header.data(), static_cast<std::streamsize>(header.size()));
+  out.write(reinterpret_cast<const char*>(raster.pixels.data()),
+            static_cast<std::streamsize>(raster.pixels.size()));
+  out.close();
+  return static_cast<bool>(out);
+}
+
+// ── OcrRenderJob ────────────────────────────────────────────────────
+
+class OcrRenderJob : public Job {
+ public:
+  OcrRenderJob(Napi::Env env, int handle, std::vector<int> pages,
+               std::string outDir, double dpi, bool all, Napi::Value onProgress)
+    : Job(env, onProgress),
+      handle_(handle),
+      pages_(std::move(pages)),
+      outDir_(std::move(outDir)),
+      dpi_(dpi),
+      all_(all) {}
+
+ protected:
+  void Execute(const ExecutionProgress& progress) override {
+    const int total = static_cast<int>(pages_.size());
+
+    for (int i = 0; i < total; ++i) {
+      if (CancelRequested()) {
+        MarkCancelled();
+        break;
+      }
+
+      const int pageIndex = pages_[i];
+      GreyRaster raster;
+      bool render = false;
+      {
+        PdfiumLock lock(g_pdfiumMutex);
+        auto it = g_documents.find(handle_);
+        if (it == g_documents.end()) {
+          SetError("document was closed while pages were rendered for OCR");
+          return;
+        }
+        bool fromCache = false;
+        FPDF_PAGE page = AcquirePage(handle_, it->second, pageIndex, fromCache);
+        if (!page) {
+          Fail(pageIndex, "failed to load page");
+        } else {
+          if (!all_ && !ImageOnly(page)) {
+            skipped_++;
+          } else if (RenderGrey(page, dpi_, raster)) {
+            render = true;
+          } else {
+            Fail(pageIndex, "failed to render page");
+          }
+          ReleasePage(handle_, pageIndex, page, fromCache);
+        }
+      }
+
+      if (render) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "page-%05d.pgm", pageIndex);
+        const std::filesystem::path path = std::filesystem::u8path(outDir_) / name;
+        if (WritePgm(path, raster)) {
+          std::lock_guard<std::mutex> guard(resultsMutex_);
+          images_.push_back({ pageIndex, path.u8string(), raster.width, raster.height });
+          if (HasProgressListener()) unsent_.push_back(images_.size() - 1);
+        } else {
+          Fail(pageIndex, "could not write " + path.u8string());
+        }
+      }
+
+      JobProgress p = { i + 1, total };
+      progress.Send(&p, 1);
+    }
+  }
+
+  Napi::Value ProgressDetail(Napi::Env env) override {
+    std::lock_guard<std::mutex> guard(resultsMutex_);
+    Napi::Array images = Napi::Array::New(env, unsent_.size());
+    for (size_t i = 0; i < unsent_.size(); ++i) {
+      images[static_cast<uint32_t>(i)] = ImageToObject(env, images_[unsent_[i]]);
+    }
+    unsent_.clear();
+    return images;
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    std::lock_guard<std::mutex> guard(resultsMutex_);
+    Napi::Array images = Napi::Array::New(env, images_.size());
+    for (size_t i = 0; i < images_.size(); ++i) {
+      images[static_cast<uint32_t>(i)] = ImageToObject(env, images_[i]);
+    }
+    Napi::Array failed = Napi::Array::New(env, failed_.size());
+    for (size_t i = 0; i < failed_.size(); ++i) {
+      Napi::Object o = Napi::Object::New(env);
+      o.Set("pageIndex", Napi::Number::New(env, failed_[i].pageIndex));
+      o.Set("error", failed_[i].error);
+      failed[static_cast<uint32_t>(i)] = o;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("images", images);
+    result.Set("skipped", Napi::Number::New(env, skipped_));
+    result.Set("failed", failed);
+    return result;
+  }
+
+ private:
+  static Napi::Object ImageToObject(Napi::Env env, const OcrImage& image) {
+    Napi::Object o = Napi::Object::New(env);
+    o.Set("pageIndex", Napi::Number::New(env, image.pageIndex));
+    o.Set("path", image.path);
+    o.Set("width", Napi::Number::New(env, image.width));
+    o.Set("height", Napi::Number::New(env, image.height));
+    return o;
+  }
+
+  void Fail(int pageIndex, std::string error) {
+    std::lock_guard<std::mutex> guard(resultsMutex_);
+    failed_.push_back({ pageIndex, std::move(error) });
+  }
+
+  const int handle_;
+  const std::vector<int> pages_;
+  const std::string outDir_;
+  const double dpi_;
+  const bool all_;
+
+  int skipped_ = 0;
+
+  /** Written by the worker, read by ProgressDetail / Result. */
+  std::mutex resultsMutex_;
+  std::vector<OcrImage> images_;
+  std::vector<size_t> unsent_;
+  std::vector<OcrFailure> failed_;
+};
+
+// ── Text layer ──────────────────────────────────────────────────────
+
+struct PagePoint {
+  double x;
+  double y;
+};
+
+/** Page space point of a device pixel of a width × height render. */
+PagePoint DeviceToPage(FPDF_PAGE page, int width, int height, float x, float y) {
+  PagePoint p{0, 0};
+  FPDF_DeviceToPage(page, 0, 0, width, height, 0,
+                    static_cast<int>(std::lround(x)), static_cast<int>(std::lround(y)),
+                    &p.x, &p.y);
+  return p;
+}
+
+bool IsBlank(const std::u16string& word) {
+  return std::all_of(word.begin(), word.end(), [](char16_t c) {
+    return c == u' ' || c == u'\t' || c == u'\n' || c == u'\r' || c == 0x00A0;
+  });
+}
+
+/**
+ * An invisible text object whose glyph box is mapped onto the word box
+ * with corners `origin` (bottom left), + `across` and + `up`.  nullptr
+ * when the font cannot show the word.
+ */
+FPDF_PAGEOBJECT CreateWord(FPDF_DOCUMENT doc, FPDF_FONT font,
+                           const std::u16string& word, PagePoint origin,
+                           PagePoint across, PagePoint up) {
+  FPDF_PAGEOBJECT obj = FPDFPageObj_CreateTextObj(doc, font, 1.0f);
+  if (!obj) return nullptr;
+
+  float left = 0, bottom = 0, right = 0, top = 0;
+  if (!FPDFText_SetText(obj, reinterpret_cast<FPDF_WIDESTRING>(word.c_str())) ||
+      !FPDFPageObj_GetBounds(obj, &left, &bottom, &right, &top) ||
+      !(right > left) || !(top > bottom)) {
+    FPDFPageObj_Destroy(obj);
+    return nullptr;
+  }
+
+  // Text space glyph box (left, bottom)–(right, top) → the word box.
+  const double sx = 1.0 / (right - left);
+  const double sy = 1.0 / (top - bottom);
+  FS_MATRIX m;
+  m.a = static_cast<float>(across.x * sx);
+  m.b = static_cast<float>(across.y * sx);
+  m.c = static_cast<float>(up.x * sy);
+  m.d = static_cast<float>(up.y * sy);
+  m.e = static_cast<float>(origin.x - m.a * left - m.c * bottom);
+  m.f = static_cast<float>(origin.y - m.b * left - m.d * bottom);
+  FPDFPageObj_SetMatrix(obj, &m);
+  FPDFTextObj_SetTextRenderMode(obj, FPDF_TEXTRENDERMODE_INVISIBLE);
+  return obj;
+}
+
+}  // namespace
+
+// ── renderOcrPages ──────────────────────────────────────────────────
+
+Napi::Value RenderOcrPages(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
+    Napi::TypeError::New(env,
+      "renderOcrPages: requires (handle: number, dir: string, options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  std::string outDir = info[1].As<Napi::String>().Utf8Value();
+  Napi::Value options    = info.Length() > 2 ? info[2] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 3 ? info[3] : env.Undefined();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  const double dpi = GetNumberOption(options, "dpi", DEFAULT_OCR_DPI);
+  if (!(dpi > 0.0)) {
+    Napi::RangeError::New(env, "renderOcrPages: dpi must be > 0")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<int> pages;
+  Napi::Value pagesArg = options.IsObject()
+    ? options.As<Napi::Object>().Get("pages")
+    : env.Undefined();
+  if (!ReadPageList(env, pagesArg, FPDF_GetPageCount(doc), "renderOcrPages", pages)) {
+    return env.Undefined();
+  }
+
+  auto* job = new OcrRenderJob(env, handle, std::move(pages), std::move(outDir), dpi,
+                               GetBoolOption(options, "all", false), onProgress);
+  return job->Start();
+}
+
+// ── addTextLayer ────────────────────────────────────────────────────
+
+Napi::Value AddTextLayer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      !info[2].IsObject()) {
+    Napi::TypeError::New(env,
+      "addTextLayer: requires (handle: number, pageIndex: number, layer: object, options?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle    = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex = info[1].As<Napi::Number>().Int32Value();
+  Napi::Object layer  = info[2].As<Napi::Object>();
+  Napi::Value options = info.Length() > 3 ? info[3] : env.Undefined();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  if (pageIndex < 0 || pageIndex >= FPDF_GetPageCount(doc)) {
+    Napi::RangeError::New(env,
+      "addTextLayer: pageIndex " + std::to_string(pageIndex) + " out of range"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Value boxesArg   = layer.Get("boxes");
+  Napi::Value textArg    = layer.Get("text");
+  Napi::Value offsetsArg = layer.Get("offsets");
+  if (!boxesArg.IsTypedArray() ||
+      boxesArg.As<Napi::TypedArray>().TypedArrayType() != napi_float32_array ||
+      !offsetsArg.IsTypedArray() ||
+      offsetsArg.As<Napi::TypedArray>().TypedArrayType() != napi_uint32_array ||
+      !textArg.IsString()) {
+    Napi::TypeError::New(env,
+      "addTextLayer: layer needs boxes: Float32Array, text: string, offsets: Uint32Array"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const double width  = GetNumberOption(layer, "width", 0);
+  const double height = GetNumberOption(layer, "height", 0);
+  auto boxes   = boxesArg.As<Napi::Float32Array>();
+  auto offsets = offsetsArg.As<Napi::Uint32Array>();
+  const std::u16string text = textArg.As<Napi::String>().Utf16Value();
+  const size_t count = offsets.ElementLength() > 0 ? offsets.ElementLength() - 1 : 0;
+
+  bool valid = width >= 1 && height >= 1 && offsets.ElementLength() > 0 &&
+               boxes.ElementLength() == count * 4 &&
+               offsets[count] <= text.size();
+  for (size_t i = 0; valid && i < count; ++i) valid = offsets[i] <= offsets[i + 1];
+  if (!valid) {
+    Napi::RangeError::New(env,
+      "addTextLayer: layer needs width, height >= 1, four box values per word "
+      "and ascending offsets within text"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::string fontRef = DEFAULT_OCR_FONT;
+  if (options.IsObject() && options.As<Napi::Object>().Get("font").IsString()) {
+    fontRef = options.As<Napi::Object>().Get("font").As<Napi::String>().Utf8Value();
+  }
+  FPDF_FONT font = ResolveFont(handle, doc, fontRef);
+  if (!font) {
+    Napi::Error::New(env, "addTextLayer: unknown font '" + fontRef + "'")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  bool fromCache = false;
+  FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+  if (!page) {
+    Napi::Error::New(env,
+      "addTextLayer: failed to load page " + std::to_string(pageIndex)
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const int w = static_cast<int>(width), h = static_cast<int>(height);
+  int added = 0;
+  for (size_t i = 0; i < count; ++i) {
+    std::u16string word = text.substr(offsets[i], offsets[i + 1] - offsets[i]);
+    if (IsBlank(word)) continue;
+
+    const float left = boxes[i * 4], top = boxes[i * 4 + 1];
+    const float right = boxes[i * 4 + 2], bottom = boxes[i * 4 + 3];
+    if (!(right > left) || !(bottom > top)) continue;
+
+    // The render may be rotated against page space: map three corners.
+    const PagePoint origin = DeviceToPage(page, w, h, left, bottom);
+    const PagePoint lowerRight = DeviceToPage(page, w, h, right, bottom);
+    const PagePoint upperLeft = DeviceToPage(page, w, h, left, top);
+    const PagePoint across{lowerRight.x - origin.x, lowerRight.y - origin.y};
+    const PagePoint up{upperLeft.x - origin.x, upperLeft.y - origin.y};
+    if (std::hypot(across.x, across.y) < MIN_WORD_POINTS ||
+        std::hypot(up.x, up.y) < MIN_WORD_POINTS) {
+      continue;
+    }
+
+    FPDF_PAGEOBJECT obj = CreateWord(doc, font, word, origin, across, up);
+    if (!obj) continue;
+    FPDFPage_InsertObject(page, obj);
+    added++;
+  }
+
+  if (added > 0) {
+    // Content is regenerated at save time, as for editTextObject.
+    CachePageDirty(handle, pageIndex, page);
+  } else {
+    ReleasePage(handle, pageIndex, page, fromCache);
+  }
+  return Napi::Number::New(env, added);
+}
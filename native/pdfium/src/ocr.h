@@ -0,0 +1,48 @@
+/**
+ * ocr.h — The addon's half of OCR: page images out, a text layer in.
+ *
+ * Recognition runs in OCR engine processes started by main/ocr.ts;
+ * PDFium is single-threaded, so the addon only renders the pages that
+ * need it and writes the recognised words back as invisible text.
+ */
+#ifndef PDFIUM_ADDON_OCR_H
+#define PDFIUM_ADDON_OCR_H
+
+#include <napi.h>
+
+/**
+ * renderOcrPages(handle, dir, options?, onProgress?)
+ * → { jobId, done: Promise<{ images, skipped, failed }> }
+ *
+ * options: { dpi?: number = 300, pages?: number[], all?: boolean = false }
+ *
+ * Render each image-only page (images but no text objects, so a
+ * previous OCR pass counts as text) to an 8-bit grey PGM file
+ * `dir/page-<index>.pgm` on a background thread: rendered under
+ * g_pdfiumMutex, written outside it.  `all` renders every page.  The
+ * dpi drops for pages too large to render whole.
+ * onProgress(done, total, images) streams the files written since the
+ * last call as [{ pageIndex, path, width, height }], so recognition can
+ * start while later pages render; `images` lists them all again.
+ * failed: [{ pageIndex, error }].
+ */
+Napi::Value RenderOcrPages(const Napi::CallbackInfo& info);
+
+/**
+ * addTextLayer(handle, pageIndex, layer, options?) → number
+ *
+ * layer:   { width, height, boxes: Float32Array, text: string,
+ *            offsets: Uint32Array }
+ * options: { font?: string = 'Helvetica' }
+ *
+ * Add one invisible text object per word and return how many were
+ * added.  Word i is text.slice(offsets[i], offsets[i + 1]) and fills
+ * boxes[4i .. 4i + 3] (left, top, right, bottom) of a width × height
+ * render of the page, such as renderOcrPages wrote.  Each word is
+ * stretched over its box, so search hits and selections cover the
+ * scanned glyphs.  `font` is a standard-14 name or a loadFont reference
+ * (load a CID font for scripts outside Latin-1).
+ */
+Napi::Value AddTextLayer(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_OCR_H
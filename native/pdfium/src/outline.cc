@@ -0,0 +1,194 @@
+/**
+ * outline.cc — Lazily expanded document outline (bookmarks).
+ *
+ * Nodes are numbered as they are first seen; node 0 is the root.  A
+ * node's child list is walked once, when it is first expanded, and its
+ * destination is resolved once, when it is first returned — named
+ * destinations cost a name-tree lookup each.
+ */
+
+#include "common.h"
+#include "outline.h"
+
+#include <fpdfview.h>
+#include <fpdf_doc.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t OUTLINE_HAS_CHILDREN = 1;
+constexpr uint8_t OUTLINE_OPEN = 2;
+constexpr uint8_t OUTLINE_EXTERNAL = 4;
+
+constexpr uint32_t DEFAULT_BATCH = 512;
+
+struct OutlineNode {
+  FPDF_BOOKMARK bookmark = nullptr;
+  bool expanded = false;
+  std::vector<uint32_t> children;
+
+  bool resolved = false;
+  uint8_t flags = 0;
+  int32_t page = -1;
+  float point[3];
+};
+
+struct Outline {
+  std::vector<OutlineNode> nodes;
+};
+
+/** Outline cache per document handle; guarded by g_pdfiumMutex. */
+std::map<int, Outline> g_outlines;
+
+/** Walk the node's sibling chain of children once. */
+void Expand(FPDF_DOCUMENT doc, Outline& outline, uint32_t ref) {
+  if (outline.nodes[ref].expanded) return;
+  outline.nodes[ref].expanded = true;
+
+  std::vector<uint32_t> children;
+  // Malformed files can link siblings into a loop.
+  std::unordered_set<FPDF_BOOKMARK> seen;
+  FPDF_BOOKMARK child = FPDFBookmark_GetFirstChild(doc, outline.nodes[ref].bookmark);
+  while (child && seen.insert(child).second) {
+    OutlineNode node;
+    node.bookmark = child;
+    children.push_back(static_cast<uint32_t>(outline.nodes.size()));
+    outline.nodes.push_back(node);
+    child = FPDFBookmark_GetNextSibling(doc, child);
+  }
+  // push_back may have moved the nodes: index afresh.
+  outline.nodes[ref].children = std::move(children);
+}
+
+void Resolve(FPDF_DOCUMENT doc, OutlineNode& node) {
+  if (node.resolved) return;
+  node.resolved = true;
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  node.point[0] = node.point[1] = node.point[2] = nan;
+
+  // /Count: positive when open, negative when closed, 0 for a leaf.
+  const int count = FPDFBookmark_GetCount(node.bookmark);
+  if (count != 0 || FPDFBookmark_GetFirstChild(doc, node.bookmark)) {
+    node.flags |= OUTLINE_HAS_CHILDREN;
+  }
+  if (count > 0) node.flags |= OUTLINE_OPEN;
+
+  FPDF_DEST dest = FPDFBookmark_GetDest(doc, node.bookmark);
+  if (!dest) {
+    FPDF_ACTION action = FPDFBookmark_GetAction(node.bookmark);
+    if (action) {
+      const unsigned long type = FPDFAction_GetType(action);
+      if (type == PDFACTION_GOTO) {
+        dest = FPDFAction_GetDest(doc, action);
+      } else if (type != PDFACTION_UNSUPPORTED) {
+        node.flags |= OUTLINE_EXTERNAL;
+      }
+    }
+  }
+  if (!dest) return;
+
+  node.page = FPDFDest_GetDestPageIndex(doc, dest);
+  FPDF_BOOL hasX = false, hasY = false, hasZoom = false;
+  FS_FLOAT x = 0, y = 0, zoom = 0;
+  if (FPDFDest_GetLocationInPage(dest, &hasX, &hasY, &hasZoom, &x, &y, &zoom)) {
+    if (hasX) node.point[0] = x;
+    if (hasY) node.point[1] = y;
+    if (hasZoom && zoom > 0) node.point[2] = zoom;
+  }
+}
+
+}  // namespace
+
+// ── getOutlineChildren ──────────────────────────────────────────────
+
+Napi::Value GetOutlineChildren(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env,
+      "getOutlineChildren: requires (handle: number, nodeRef: number)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  int64_t nodeRef = info[1].As<Napi::Number>().Int64Value();
+
+  uint32_t start = 0;
+  uint32_t limit = DEFAULT_BATCH;
+  if (info.Length() > 2 && info[2].IsObject()) {
+    Napi::Object options = info[2].As<Napi::Object>();
+    start = static_cast<uint32_t>(std::max(0.0, GetNumberOption(options, "start", 0)));
+    limit = static_cast<uint32_t>(std::max(1.0, GetNumberOption(options, "limit", DEFAULT_BATCH)));
+  }
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  Outline& outline = g_outlines[handle];
+  if (outline.nodes.empty()) outline.nodes.emplace_back();  // root
+
+  if (nodeRef < 0 || nodeRef >= static_cast<int64_t>(outline.nodes.size())) {
+    Napi::RangeError::New(env,
+      "getOutlineChildren: unknown node " + std::to_string(nodeRef)
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const uint32_t ref = static_cast<uint32_t>(nodeRef);
+  Expand(doc, outline, ref);
+
+  const std::vector<uint32_t>& children = outline.nodes[ref].children;
+  const uint32_t total = static_cast<uint32_t>(children.size());
+  const uint32_t first = std::min(start, total);
+  const uint32_t count = std::min(limit, total - first);
+
+  std::vector<uint32_t> ids(children.begin() + first, children.begin() + first + count);
+  std::vector<uint8_t> flags;
+  std::vector<int32_t> pages;
+  std::vector<float> points;
+  std::u16string titles;
+  std::vector<uint32_t> titleOffsets{0};
+  std::vector<FPDF_WCHAR> scratch(128);
+  flags.reserve(count);
+  pages.reserve(count);
+  points.reserve(count * 3);
+
+  for (uint32_t id : ids) {
+    OutlineNode& node = outline.nodes[id];
+    Resolve(doc, node);
+    flags.push_back(node.flags);
+    pages.push_back(node.page);
+    points.insert(points.end(), node.point, node.point + 3);
+    AppendUtf16([&node](FPDF_WCHAR* buf, unsigned long bytes) {
+      return FPDFBookmark_GetTitle(node.bookmark, buf, bytes);
+    }, scratch, titles);
+    titleOffsets.push_back(static_cast<uint32_t>(titles.size()));
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("total", Napi::Number::New(env, total));
+  result.Set("start", Napi::Number::New(env, first));
+  result.Set("count", Napi::Number::New(env, count));
+  result.Set("ids", ToTypedArray<Napi::Uint32Array>(env, ids, count));
+  result.Set("flags", ToTypedArray<Napi::Uint8Array>(env, flags, count));
+  result.Set("pages", ToTypedArray<Napi::Int32Array>(env, pages, count));
+  result.Set("points", ToTypedArray<Napi::Float32Array>(env, points, count * 3));
+  result.Set("titles", Napi::String::New(env, titles.data(), titles.size()));
+  result.Set("titleOffsets", ToTypedArray<Napi::Uint32Array>(env, titleOffsets, count + 1));
+  return result;
+}
+
+void DiscardOutline(int handle) {
+  g_outlines.erase(handle);
+}
@@ -0,0 +1,34 @@
+/**
+ * outline.h — Lazily expanded document outline (bookmarks).
+ */
+#ifndef PDFIUM_ADDON_OUTLINE_H
+#define PDFIUM_ADDON_OUTLINE_H
+
+#include <napi.h>
+
+/**
+ * getOutlineChildren(handle, nodeRef, options?)
+ * → { total, start, count, ids: Uint32Array, flags: Uint8Array,
+ *     pages: Int32Array, points: Float32Array, titles: string,
+ *     titleOffsets: Uint32Array }
+ *
+ * options: { start?: number = 0, limit?: number = 512 }
+ *
+ * Children `start` .. `start + count` of outline node `nodeRef` (0 is
+ * the root), as columns.  `total` is the node's child count.  `ids`
+ * are node refs to pass back; `flags` are OUTLINE_* bits (has children,
+ * initially open, external action); `pages` is the destination page or
+ * -1; `points` holds x, y, zoom per row, NaN where the destination
+ * leaves them unchanged.  Titles are concatenated in `titles`; row i is
+ * titles.slice(titleOffsets[i], titleOffsets[i + 1]).
+ *
+ * Only the requested node is expanded, so the cost is independent of
+ * the outline's size.  Child lists and resolved destinations are kept
+ * per document; asking again, or for the next batch, walks nothing.
+ */
+Napi::Value GetOutlineChildren(const Napi::CallbackInfo& info);
+
+/** Drop the outline cache of a closed document. */
+void DiscardOutline(int handle);
+
+#endif // PDFIUM_ADDON_OUTLINE_H
@@ -0,0 +1,1196 @@
+/**
+ * pdfscan.cc — Memory-mapped PDF tokenizer, cross-reference reader and
+ * content-stream operator scanner.
+ *
+ * Nothing here touches PDFium or any global state.
+ */
+
+#include "pdfscan.h"
+#include "inflate.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/** Object numbers above this are treated as corrupt. */
+constexpr int64_t MAX_OBJECTS = 1 << 24;
+/** Parse nesting limit for arrays and dictionaries. */
+constexpr int MAX_DEPTH = 64;
+/** Decoded size limits for xref and object streams. */
+constexpr size_t MAX_XREF_BYTES = 64u << 20;
+constexpr size_t MAX_OBJSTM_BYTES = 64u << 20;
+/** Page tree bounds. */
+constexpr size_t MAX_PAGES = 1u << 20;
+constexpr int MAX_TREE_DEPTH = 64;
+
+bool IsWhite(uint8_t c) {
+  return c == 0 || c == '\t' || c == '\n' || c == '\f' || c == '\r' || c == ' ';
+}
+
+bool IsDelimiter(uint8_t c) {
+  return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' ||
+         c == ']' || c == '{' || c == '}' || c == '/' || c == '%';
+}
+
+bool IsRegular(uint8_t c) { return !IsWhite(c) && !IsDelimiter(c); }
+
+int HexValue(uint8_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/** Parse a PDF number (no exponent form exists in PDF). */
+bool ParseNumber(const uint8_t* p, size_t n, PdfToken& token) {
+  size_t i = 0;
+  bool negative = false;
+  if (i < n && (p[i] == '+' || p[i] == '-')) negative = p[i++] == '-';
+
+  double value = 0;
+  double scale = 0;
+  bool digits = false;
+  for (; i < n; i++) {
+    uint8_t c = p[i];
+    if (c >= '0' && c <= '9') {
+      digits = true;
+      if (scale == 0) {
+        value = value * 10 + (c - '0');
+      } else {
+        value += (c - '0') * scale;
+        scale /= 10;
+      }
+    } else if (c == '.' && scale == 0) {
+      scale = 0.1;
+    } else {
+      return false;
+    }
+  }
+  if (!digits) return false;
+
+  token.number = negative ? -value : value;
+  token.integer = scale == 0;
+  return true;
+}
+
+const uint8_t* FindBytes(const uint8_t* begin, const uint8_t* end,
+                         const char* needle) {
+  size_t n = std::strlen(needle);
+  const uint8_t* hit = std::search(begin, end, needle, needle + n);
+  return hit == end ? nullptr : hit;
+}
+
+} // namespace
+
+// ── MappedFile ──────────────────────────────────────────────────────
+
+#ifdef _WIN32
+
+MappedFile::~MappedFile() {
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+  if (file_) CloseHandle(file_);
+}
+
+bool MappedFile::Open(const std::string& path, std::string& error) {
+  int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  std::wstring wpath(wlen > 0 ? wlen : 1, L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wpath[0], wlen);
+
+  HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    error = "could not open " + path;
+    return false;
+  }
+  file_ = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    error = "could not stat " + path;
+    return false;
+  }
+  if (size.QuadPart == 0) return true;
+  if (static_cast<uint64_t>(size.QuadPart) > SIZE_MAX) {
+    error = path + " is too large to map";
+    return false;
+  }
+
+  mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping_) {
+    error = "could not map " + path;
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(
+    MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!data_) {
+    error = "could not map " + path;
+    return false;
+  }
+  size_ = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+#else
+
+MappedFile::~MappedFile() {
+  if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+bool MappedFile::Open(const std::string& path, std::string& error) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    error = "could not open " + path;
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    error = "could not stat " + path;
+    return false;
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    return true;
+  }
+  if (static_cast<uint64_t>(st.st_size) > SIZE_MAX) {
+    close(fd);
+    error = path + " is too large to map";
+    return false;
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping keeps the file alive
+  if (data == MAP_FAILED) {
+    error = "could not map " + path;
+    return false;
+  }
+
+  data_ = static_cast<const uint8_t*>(data);
+  size_ = size;
+  return true;
+}
+
+#endif
+
+// ── Tokenizer ───────────────────────────────────────────────────────
+
+bool PdfToken::Is(const char* keyword) const {
+  size_t n = std::strlen(keyword);
+  return type == PdfTokenType::Keyword && rawSize == n &&
+         std::memcmp(raw, keyword, n) == 0;
+}
+
+void PdfLexer::SkipWhitespace() {
+  while (pos_ < size_) {
+    uint8_t c = data_[pos_];
+    if (IsWhite(c)) {
+      pos_++;
+    } else if (c == '%') {
+      while (pos_ < size_ && data_[pos_] != '\r' && data_[pos_] != '\n') pos_++;
+    } else {
+      break;
+    }
+  }
+}
+
+bool PdfLexer::Next(PdfToken& token) {
+  SkipWhitespace();
+  token = PdfToken();
+  token.start = pos_;
+  if (pos_ >= size_) return false;
+
+  const uint8_t c = data_[pos_];
+  const size_t begin = pos_;
+  auto single = [&](PdfTokenType type) {
+    token.type = type;
+    token.raw = data_ + pos_;
+    token.rawSize = 1;
+    pos_++;
+    return true;
+  };
+
+  switch (c) {
+    case '/': {
+      size_t s = ++pos_;
+      while (pos_ < size_ && IsRegular(data_[pos_])) pos_++;
+      token.type = PdfTokenType::Name;
+      token.raw = data_ + s;
+      token.rawSize = pos_ - s;
+      return true;
+    }
+
+    case '(': {
+      size_t s = ++pos_;
+      int depth = 1;
+      while (pos_ < size_) {
+        uint8_t ch = data_[pos_];
+        if (ch == '\\') {
+          pos_ += 2;
+          continue;
+        }
+        if (ch == '(') {
+          depth++;
+        } else if (ch == ')' && --depth == 0) {
+          break;
+        }
+        pos_++;
+      }
+      pos_ = std::min(pos_, size_);
+      token.type = PdfTokenType::String;
+      token.raw = data_ + s;
+      token.rawSize = pos_ - s;
+      if (pos_ < size_) pos_++;  // closing ')'
+      return true;
+    }
+
+    case '<': {
+      if (pos_ + 1 < size_ && data_[pos_ + 1] == '<') {
+        pos_ += 2;
+        token.type = PdfTokenType::DictOpen;
+        token.raw = data_ + begin;
+        token.rawSize = 2;
+        return true;
+      }
+      size_t s = ++pos_;
+      while (pos_ < size_ && data_[pos_] != '>') pos_++;
+      token.type = PdfTokenType::HexString;
+      token.raw = data_ + s;
+      token.rawSize = pos_ - s;
+      if (pos_ < size_) pos_++;
+      return true;
+    }
+
+    case '>':
+      if (pos_ + 1 < size_ && data_[pos_ + 1] == '>') {
+        pos_ += 2;
+        token.type = PdfTokenType::DictClose;
+        token.raw = data_ + begin;
+        token.rawSize = 2;
+        return true;
+      }
+      return single(PdfTokenType::Keyword);
+
+    case '[': return single(PdfTokenType::ArrayOpen);
+    case ']': return single(PdfTokenType::ArrayClose);
+    case '{':
+    case '}':
+    case ')': return single(PdfTokenType::Keyword);
+
+    default: {
+      while (pos_ < size_ && IsRegular(data_[pos_])) pos_++;
+      token.raw = data_ + begin;
+      token.rawSize = pos_ - begin;
+      token.type = ParseNumber(token.raw, token.rawSize, token)
+        ? PdfTokenType::Number
+        : PdfTokenType::Keyword;
+      return true;
+    }
+  }
+}
+
+void PdfLexer::SkipInlineImage() {
+  if (pos_ < size_ && IsWhite(data_[pos_])) pos_++;
+
+  // The data has no length; EI must stand alone between whitespace.
+  for (size_t i = pos_; i + 1 < size_; i++) {
+    if (data_[i] != 'E' || data_[i + 1] != 'I') continue;
+    if (i > pos_ && !IsWhite(data_[i - 1])) continue;
+    if (i + 2 < size_ && IsRegular(data_[i + 2])) continue;
+    pos_ = i + 2;
+    return;
+  }
+  pos_ = size_;
+}
+
+std::string DecodeName(const PdfToken& token) {
+  std::string out;
+  out.reserve(token.rawSize);
+  for (size_t i = 0; i < token.rawSize; i++) {
+    uint8_t c = token.raw[i];
+    if (c == '#' && i + 2 < token.rawSize &&
+        HexValue(token.raw[i + 1]) >= 0 && HexValue(token.raw[i + 2]) >= 0) {
+      out += static_cast<char>(HexValue(token.raw[i + 1]) * 16 +
+                               HexValue(token.raw[i + 2]));
+      i += 2;
+    } else {
+      out += static_cast<char>(c);
+    }
+  }
+  return out;
+}
+
+std::string DecodeString(const PdfToken& token) {
+  const uint8_t* p = token.raw;
+  const size_t n = token.rawSize;
+  std::string out;
+
+  if (token.type == PdfTokenType::HexString) {
+    int high = -1;
+    for (size_t i = 0; i < n; i++) {
+      int v = HexValue(p[i]);
+      if (v < 0) continue;
+      if (high < 0) {
+        high = v;
+      } else {
+        out += static_cast<char>(high * 16 + v);
+        high = -1;
+      }
+    }
+    if (high >= 0) out += static_cast<char>(high * 16);
+    return out;
+  }
+
+  out.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    uint8_t c = p[i];
+    if (c != '\\') {
+      out += static_cast<char>(c);
+      continue;
+    }
+    if (++i >= n) break;
+    c = p[i];
+    switch (c) {
+      case 'n': out += '\n'; break;
+      case 'r': out += '\r'; break;
+      case 't': out += '\t'; break;
+      case 'b': out += '\b'; break;
+      case 'f': out += '\f'; break;
+      case '\r':
+        if (i + 1 < n && p[i + 1] == '\n') i++;
+        break;
+      case '\n':
+        break;  // line continuation
+      default:
+        if (c >= '0' && c <= '7') {
+          int v = c - '0';
+          for (int k = 0; k < 2 && i + 1 < n && p[i + 1] >= '0' && p[i + 1] <= '7'; k++) {
+            v = v * 8 + (p[++i] - '0');
+          }
+          out += static_cast<char>(v & 0xff);
+        } else {
+          out += static_cast<char>(c);
+        }
+    }
+  }
+  return out;
+}
+
+// ── Objects ─────────────────────────────────────────────────────────
+
+const PdfObject* PdfObject::Get(const char* key) const {
+  if (type != Dict) return nullptr;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (keys[i] == key) return &items[i];
+  }
+  return nullptr;
+}
+
+int PdfObject::Int(int fallback) const {
+  if (type != Number) return fallback;
+  if (number > 2147483647.0 || number < -2147483648.0) return fallback;
+  return static_cast<int>(number);
+}
+
+namespace {
+
+bool ParseValue(PdfLexer& lexer, const PdfToken& token, PdfObject& out,
+                int depth) {
+  if (depth > MAX_DEPTH) return false;
+
+  switch (token.type) {
+    case PdfTokenType::Number: {
+      out.type = PdfObject::Number;
+      out.number = token.number;
+      if (!token.integer) return true;
+
+      // "n g R" — look two tokens ahead, rewind if it is not a reference.
+      size_t mark = lexer.Pos();
+      PdfToken gen, r;
+      if (lexer.Next(gen) && gen.type == PdfTokenType::Number && gen.integer &&
+          lexer.Next(r) && r.Is("R")) {
+        out.type = PdfObject::Ref;
+        out.num = static_cast<int>(std::min<double>(token.number, MAX_OBJECTS));
+        out.gen = static_cast<int>(std::min<double>(gen.number, 65535));
+        return true;
+      }
+      lexer.Seek(mark);
+      return true;
+    }
+
+    case PdfTokenType::Name:
+      out.type = PdfObject::Name;
+      out.text = DecodeName(token);
+      return true;
+
+    case PdfTokenType::String:
+    case PdfTokenType::HexString:
+      out.type = PdfObject::String;
+      out.text = DecodeString(token);
+      return true;
+
+    case PdfTokenType::ArrayOpen:
+      out.type = PdfObject::Array;
+      for (;;) {
+        PdfToken t;
+        if (!lexer.Next(t)) return false;
+        if (t.type == PdfTokenType::ArrayClose) return true;
+        out.items.emplace_back();
+        if (!ParseValue(lexer, t, out.items.back(), depth + 1)) return false;
+      }
+
+    case PdfTokenType::DictOpen:
+      out.type = PdfObject::Dict;
+      for (;;) {
+        PdfToken key;
+        if (!lexer.Next(key)) return false;
+        if (key.type == PdfTokenType::DictClose) return true;
+        if (key.type != PdfTokenType::Name) return false;
+
+        out.keys.push_back(DecodeName(key));
+        out.items.emplace_back();
+        PdfToken value;
+        if (!lexer.Next(value)) return false;
+        if (value.type == PdfTokenType::DictClose) return true;  // key without value
+        if (!ParseValue(lexer, value, out.items.back(), depth + 1)) return false;
+      }
+
+    case PdfTokenType::Keyword:
+      if (token.Is("true") || token.Is("false")) {
+        out.type = PdfObject::Bool;
+        out.boolean = token.Is("true");
+        return true;
+      }
+      return token.Is("null");
+
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+bool ParseObject(PdfLexer& lexer, PdfObject& out) {
+  PdfToken token;
+  return lexer.Next(token) && ParseValue(lexer, token, out, 0);
+}
+
+// ── Stream filters ──────────────────────────────────────────────────
+
+namespace {
+
+/** Undo a PNG (10–15) predictor in place; TIFF predictors are unsupported. */
+bool ApplyPredictor(const PdfObject& params, std::vector<uint8_t>& data) {
+  const PdfObject* p = params.Get("Predictor");
+  int predictor = p ? p->Int(1) : 1;
+  if (predictor < 10) return predictor == 1;
+
+  const PdfObject* c = params.Get("Colors");
+  const PdfObject* b = params.Get("BitsPerComponent");
+  const PdfObject* w = params.Get("Columns");
+  return UndoPngPredictor(data, c ? c->Int(1) : 1, b ? b->Int(8) : 8,
+                          w ? w->Int(1) : 1);
+}
+
+} // namespace
+
+bool UndoPngPredictor(std::vector<uint8_t>& data, int colors, int bpc, int columns) {
+  colors = std::clamp(colors, 1, 32);
+  bpc = std::clamp(bpc, 1, 16);
+  columns = std::clamp(columns, 1, 1 << 20);
+
+  const size_t bpp = std::max(1, (colors * bpc + 7) / 8);
+  const size_t rowBytes = (static_cast<size_t>(colors) * bpc * columns + 7) / 8;
+
+  std::vector<uint8_t> out;
+  out.reserve(data.size());
+  std::vector<uint8_t> prev(rowBytes, 0), cur(rowBytes, 0);
+
+  for (size_t pos = 0; pos < data.size(); pos += rowBytes + 1) {
+    const uint8_t tag = data[pos];
+    const size_t n = std::min(rowBytes, data.size() - pos - 1);
+    const uint8_t* row = data.data() + pos + 1;
+
+    for (size_t i = 0; i < n; i++) {
+      int left = i >= bpp ? cur[i - bpp] : 0;
+      int up = prev[i];
+      int upLeft = i >= bpp ? prev[i - bpp] : 0;
+      int v = row[i];
+      switch (tag) {
+        case 0: break;
+        case 1: v += left; break;
+        case 2: v += up; break;
+        case 3: v += (left + up) / 2; break;
+        case 4: {
+          int pa = std::abs(up - upLeft);
+          int pb = std::abs(left - upLeft);
+          int pc = std::abs(left + up - 2 * upLeft);
+          v += (pa <= pb && pa <= pc) ? left : (pb <= pc ? up : upLeft);
+          break;
+        }
+        default: return false;
+      }
+      cur[i] = static_cast<uint8_t>(v);
+    }
+    out.insert(out.end(), cur.begin(), cur.begin() + n);
+    std::swap(prev, cur);
+  }
+
+  data = std::move(out);
+  return true;
+}
+
+std::vector<std::string> StreamFilters(const PdfObject& dict) {
+  std::vector<std::string> names;
+  const PdfObject* f = dict.Get("Filter");
+  if (!f) return names;
+  if (f->type == PdfObject::Name) names.push_back(f->text);
+  if (f->type == PdfObject::Array) {
+    for (const auto& item : f->items) {
+      if (item.type == PdfObject::Name) names.push_back(item.text);
+    }
+  }
+  return names;
+}
+
+bool PdfFile::DecodeStream(const PdfObject& dict, ByteSpan raw,
+                           std::vector<uint8_t>& out, size_t limit) const {
+  std::vector<std::string> filters = StreamFilters(dict);
+  if (filters.empty()) {
+    if (raw.size > limit) return false;
+    out.assign(raw.data, raw.data + raw.size);
+    return true;
+  }
+
+  const PdfObject* parms = dict.Get("DecodeParms");
+  std::vector<uint8_t> buffer;
+  const uint8_t* data = raw.data;
+  size_t size = raw.size;
+
+  for (size_t i = 0; i < filters.size(); i++) {
+    if (filters[i] != "FlateDecode" && filters[i] != "Fl") return false;
+
+    // Truncated streams are common; keep what decoded.
+    std::vector<uint8_t> next;
+    if (!Inflate(data, size, next, limit) && (next.empty() || next.size() > limit)) {
+      return false;
+    }
+
+    const PdfObject* p = parms;
+    if (p && p->type == PdfObject::Array) {
+      p = i < p->items.size() ? &p->items[i] : nullptr;
+    }
+    if (p && p->type == PdfObject::Ref) {
+      PdfObject resolved = Resolve(*p);
+      if (resolved.type == PdfObject::Dict && !ApplyPredictor(resolved, next)) return false;
+    } else if (p && p->type == PdfObject::Dict && !ApplyPredictor(*p, next)) {
+      return false;
+    }
+
+    buffer = std::move(next);
+    data = buffer.data();
+    size = buffer.size();
+  }
+
+  out = std::move(buffer);
+  return true;
+}
+
+// ── PdfFile: opening ────────────────────────────────────────────────
+
+bool PdfFile::Open(const std::string& path, std::string& error) {
+  if (!file_.Open(path, error)) return false;
+
+  const uint8_t* d = file_.Data();
+  const size_t size = file_.Size();
+  const uint8_t* header = FindBytes(d, d + std::min<size_t>(size, 1024), "%PDF-");
+  if (header) {
+    for (const uint8_t* p = header + 5;
+         p < d + size && p < header + 12 && ((*p >= '0' && *p <= '9') || *p == '.'); p++) {
+      version_ += static_cast<char>(*p);
+    }
+  }
+
+  std::vector<int> streams;
+  if (ReadXref()) {
+    for (const auto& e : entries_) {
+      if (e.known && e.type == 2) streams.push_back(static_cast<int>(e.stream));
+    }
+  } else {
+    streams = Rebuild();
+  }
+
+  if (!trailer_.Get("Root")) {
+    error = size == 0 ? path + " is empty" : path + " has no document catalog";
+    return false;
+  }
+  if (!Encrypted()) LoadObjectStreams(std::move(streams));
+  return true;
+}
+
+void PdfFile::SetEntry(int num, const XrefEntry& entry) {
+  if (num < 0 || num >= MAX_OBJECTS) return;
+  if (static_cast<size_t>(num) >= entries_.size()) entries_.resize(num + 1);
+  // Sections are read newest first, so the first entry seen wins.
+  if (!entries_[num].known) {
+    entries_[num] = entry;
+    entries_[num].known = true;
+  }
+}
+
+bool PdfFile::ReadXref() {
+  const uint8_t* d = file_.Data();
+  const size_t size = file_.Size();
+  if (size < 9) return false;
+
+  // startxref sits in the last kilobyte; take the last one.
+  const size_t from = size > 1024 ? size - 1024 : 0;
+  const uint8_t* startxref = nullptr;
+  for (const uint8_t* p = d + from;
+       (p = FindBytes(p, d + size, "startxref")) != nullptr; p++) {
+    startxref = p;
+  }
+  if (!startxref) return false;
+
+  PdfLexer lexer(d, size, startxref - d + 9);
+  PdfToken t;
+  if (!lexer.Next(t) || t.type != PdfTokenType::Number || !t.integer || t.number < 0) {
+    return false;
+  }
+
+  std::set<uint64_t> seen;
+  uint64_t offset = static_cast<uint64_t>(t.number);
+  bool first = true;
+  while (offset < size && seen.insert(offset).second) {
+    PdfObject trailer;
+    Entries found;
+    if (!ReadSection(offset, trailer, found)) {
+      if (first) return false;
+      break;
+    }
+
+    // Hybrid files: the compressed objects of this update live in the
+    // stream named by /XRefStm and take precedence over the table.
+    const PdfObject* stm = trailer.Get("XRefStm");
+    if (stm && stm->type == PdfObject::Number && stm->number >= 0) {
+      PdfObject ignored;
+      Entries hybrid;
+      if (ReadXrefStream(static_cast<uint64_t>(stm->number), ignored, hybrid)) {
+        for (const auto& [num, e] : hybrid) SetEntry(num, e);
+      }
+    }
+    for (const auto& [num, e] : found) SetEntry(num, e);
+
+    const PdfObject* prev = trailer.Get("Prev");
+    const bool more = prev && prev->type == PdfObject::Number && prev->number >= 0;
+    if (more) offset = static_cast<uint64_t>(prev->number);
+    if (first) {
+      trailer_ = std::move(trailer);
+      first = false;
+    }
+    if (!more) break;
+  }
+
+  return !first && trailer_.Get("Root") != nullptr;
+}
+
+bool PdfFile::ReadSection(uint64_t offset, PdfObject& trailer, Entries& found) {
+  PdfLexer lexer(file_.Data(), file_.Size(), offset);
+  PdfToken t;
+  if (!lexer.Next(t)) return false;
+
+  // The newest section decides how the file reports its xref.
+  const bool newest = trailer_.type == PdfObject::Null;
+  if (t.Is("xref")) {
+    if (!ReadTable(lexer, trailer, found)) return false;
+    if (newest) source_ = XrefSource::Table;
+    return true;
+  }
+  if (t.type == PdfTokenType::Number && t.integer) {
+    if (!ReadXrefStream(offset, trailer, found)) return false;
+    if (newest) source_ = XrefSource::Stream;
+    return true;
+  }
+  return false;
+}
+
+bool PdfFile::ReadTable(PdfLexer& lexer, PdfObject& trailer, Entries& found) {
+  for (;;) {
+    PdfToken t;
+    if (!lexer.Next(t)) return false;
+    if (t.Is("trailer")) return ParseObject(lexer, trailer) && trailer.type == PdfObject::Dict;
+
+    PdfToken c;
+    if (t.type != PdfTokenType::Number || !t.integer || !lexer.Next(c) ||
+        c.type != PdfTokenType::Number || !c.integer) {
+      return false;
+    }
+    const int64_t start = static_cast<int64_t>(t.number);
+    const int64_t count = static_cast<int64_t>(c.number);
+    if (start < 0 || count < 0 || start + count > MAX_OBJECTS) return false;
+
+    for (int64_t i = 0; i < count; i++) {
+      PdfToken off, gen, kind;
+      if (!lexer.Next(off) || !lexer.Next(gen) || !lexer.Next(kind) ||
+          off.type != PdfTokenType::Number || gen.type != PdfTokenType::Number ||
+          !(kind.Is("n") || kind.Is("f"))) {
+        return false;
+      }
+      XrefEntry e;
+      e.type = kind.Is("n") ? 1 : 0;
+      e.gen = static_cast<uint32_t>(gen.number);
+      e.offset = static_cast<uint64_t>(off.number);
+      found.emplace_back(static_cast<int>(start + i), e);
+    }
+  }
+}
+
+bool PdfFile::ReadXrefStream(uint64_t offset, PdfObject& trailer, Entries& found) {
+  PdfObject dict;
+  ByteSpan raw;
+  if (!ParseIndirect(offset, -1, dict, &raw, 0)) return false;
+  const PdfObject* type = dict.Get("Type");
+  if (!type || !type->IsName("XRef")) return false;
+
+  const PdfObject* w = dict.Get("W");
+  if (!w || w->type != PdfObject::Array || w->items.size() < 3) return false;
+  int widths[3];
+  for (int i = 0; i < 3; i++) {
+    widths[i] = w->items[i].Int(-1);
+    if (widths[i] < 0 || widths[i] > 8) return false;
+  }
+  const size_t rowSize = widths[0] + widths[1] + widths[2];
+  if (rowSize == 0) return false;
+
+  std::vector<uint8_t> rows;
+  if (!DecodeStream(dict, raw, rows, MAX_XREF_BYTES)) return false;
+
+  std::vector<int64_t> index;
+  const PdfObject* idx = dict.Get("Index");
+  if (idx && idx->type == PdfObject::Array) {
+    for (const auto& item : idx->items) index.push_back(item.Int(-1));
+  } else {
+    const PdfObject* sz = dict.Get("Size");
+    index = {0, sz ? sz->Int(0) : 0};
+  }
+
+  size_t pos = 0;
+  for (size_t s = 0; s + 1 < index.size(); s += 2) {
+    const int64_t start = index[s];
+    const int64_t count = index[s + 1];
+    if (start < 0 || count < 0 || start + count > MAX_OBJECTS) return false;
+
+    for (int64_t i = 0; i < count && pos + rowSize <= rows.size(); i++) {
+      uint64_t field[3] = {0, 0, 0};
+      for (int f = 0; f < 3; f++) {
+        for (int k = 0; k < widths[f]; k++) field[f] = (field[f] << 8) | rows[pos++];
+      }
+      XrefEntry e;
+      e.type = static_cast<uint8_t>(widths[0] ? field[0] : 1);
+      if (e.type == 1) {
+        e.offset = field[1];
+        e.gen = static_cast<uint32_t>(field[2]);
+      } else if (e.type == 2) {
+        e.stream = static_cast<uint32_t>(field[1]);
+        e.index = static_cast<uint32_t>(field[2]);
+      } else {
+        e.type = 0;
+      }
+      found.emplace_back(static_cast<int>(start + i), e);
+    }
+  }
+
+  trailer = std::move(dict);
+  return true;
+}
+
+std::vector<int> PdfFile::Rebuild() {
+  source_ = XrefSource::Rebuilt;
+  entries_.clear();
+  trailer_ = PdfObject();
+
+  const uint8_t* d = file_.Data();
+  const size_t size = file_.Size();
+  auto isDigit = [](uint8_t c) { return c >= '0' && c <= '9'; };
+
+  // Every "n g obj" header; a later definition replaces an earlier one,
+  // as an incremental update would.
+  for (const uint8_t* p = d; (p = FindBytes(p, d + size, "obj")) != nullptr; p++) {
+    size_t at = p - d;
+    if (at + 3 < size && IsRegular(d[at + 3])) continue;
+
+    size_t q = at;
+    size_t ws = q;
+    while (q > 0 && IsWhite(d[q - 1])) q--;
+    if (q == ws) continue;
+    size_t genEnd = q;
+    while (q > 0 && isDigit(d[q - 1])) q--;
+    if (q == genEnd || genEnd - q > 5) continue;
+    size_t genStart = q;
+    ws = q;
+    while (q > 0 && IsWhite(d[q - 1])) q--;
+    if (q == ws) continue;
+    size_t numEnd = q;
+    while (q > 0 && isDigit(d[q - 1])) q--;
+    if (q == numEnd || numEnd - q > 8) continue;
+    if (q > 0 && IsRegular(d[q - 1])) continue;
+
+    int num = 0, gen = 0;
+    for (size_t i = q; i < numEnd; i++) num = num * 10 + (d[i] - '0');
+    for (size_t i = genStart; i < genEnd; i++) gen = gen * 10 + (d[i] - '0');
+    if (num <= 0 || num >= MAX_OBJECTS) continue;
+
+    if (static_cast<size_t>(num) >= entries_.size()) entries_.resize(num + 1);
+    XrefEntry& e = entries_[num];
+    e.known = true;
+    e.type = 1;
+    e.gen = static_cast<uint32_t>(gen);
+    e.offset = q;
+  }
+
+  // The last classic trailer with a catalog, if any survived.
+  for (const uint8_t* p = d; (p = FindBytes(p, d + size, "trailer")) != nullptr; p++) {
+    PdfLexer lexer(d, size, p - d + 7);
+    PdfObject trailer;
+    if (ParseObject(lexer, trailer) && trailer.Get("Root")) trailer_ = std::move(trailer);
+  }
+
+  std::vector<int> streams;
+  int catalog = 0;
+  PdfObject xrefDict;
+  for (size_t num = 1; num < entries_.size(); num++) {
+    if (!entries_[num].known) continue;
+    PdfObject obj;
+    if (!ParseIndirect(entries_[num].offset, static_cast<int>(num), obj, nullptr, 0)) {
+      entries_[num] = XrefEntry();
+      continue;
+    }
+    const PdfObject* type = obj.Get("Type");
+    if (!type) continue;
+    if (type->IsName("ObjStm")) {
+      streams.push_back(static_cast<int>(num));
+    } else if (type->IsName("Catalog")) {
+      catalog = static_cast<int>(num);
+    } else if (type->IsName("XRef") && obj.Get("Root")) {
+      xrefDict = std::move(obj);
+    }
+  }
+
+  if (!trailer_.Get("Root")) {
+    if (xrefDict.type == PdfObject::Dict) {
+      trailer_ = std::move(xrefDict);
+    } else if (catalog) {
+      PdfObject root;
+      root.type = PdfObject::Ref;
+      root.num = catalog;
+      trailer_.type = PdfObject::Dict;
+      trailer_.keys.push_back("Root");
+      trailer_.items.push_back(root);
+    }
+  }
+  return streams;
+}
+
+void PdfFile::LoadObjectStreams(std::vector<int> streams) {
+  std::sort(streams.begin(), streams.end());
+  streams.erase(std::unique(streams.begin(), streams.end()), streams.end());
+
+  for (int num : streams) {
+    if (num <= 0 || static_cast<size_t>(num) >= entries_.size() ||
+        entries_[num].type != 1) {
+      continue;
+    }
+
+    PdfObject dict;
+    ByteSpan raw;
+    if (!LoadAt(num, dict, &raw, 0)) continue;
+    const PdfObject* type = dict.Get("Type");
+    const PdfObject* n = dict.Get("N");
+    const PdfObject* first = dict.Get("First");
+    if (!type || !type->IsName("ObjStm") || !n || !first) continue;
+
+    ObjectStream os;
+    if (!DecodeStream(dict, raw, os.data, MAX_OBJSTM_BYTES)) continue;
+
+    const int count = std::clamp(n->Int(0), 0, 1 << 20);
+    const size_t base = static_cast<size_t>(std::max(0, first->Int(0)));
+    PdfLexer lexer(os.data.data(), os.data.size());
+    for (int i = 0; i < count; i++) {
+      PdfToken objNum, objOffset;
+      if (!lexer.Next(objNum) || !lexer.Next(objOffset) ||
+          objNum.type != PdfTokenType::Number || objOffset.type != PdfTokenType::Number) {
+        break;
+      }
+      os.offsets.emplace_back(static_cast<int>(objNum.number),
+                              base + static_cast<size_t>(std::max(0.0, objOffset.number)));
+    }
+
+    // After a rebuild nothing points into the stream yet.
+    if (source_ == XrefSource::Rebuilt) {
+      for (size_t i = 0; i < os.offsets.size(); i++) {
+        XrefEntry e;
+        e.type = 2;
+        e.stream = static_cast<uint32_t>(num);
+        e.index = static_cast<uint32_t>(i);
+        SetEntry(os.offsets[i].first, e);
+      }
+    }
+    objectStreams_.emplace(num, std::move(os));
+  }
+}
+
+// ── PdfFile: objects ────────────────────────────────────────────────
+
+bool PdfFile::ParseIndirect(uint64_t offset, int expectNum, PdfObject& out,
+                            ByteSpan* stream, int depth) const {
+  const uint8_t* d = file_.Data();
+  const size_t size = file_.Size();
+  if (offset >= size) return false;
+
+  PdfLexer lexer(d, size, static_cast<size_t>(offset));
+  PdfToken n, g, o;
+  if (!lexer.Next(n) || n.type != PdfTokenType::Number || !lexer.Next(g) ||
+      g.type != PdfTokenType::Number || !lexer.Next(o) || !o.Is("obj")) {
+    return false;
+  }
+  if (expectNum >= 0 && n.number != expectNum) return false;
+  if (!ParseObject(lexer, out)) return false;
+
+  if (stream) *stream = ByteSpan();
+  if (!stream || out.type != PdfObject::Dict) return true;
+
+  PdfToken s;
+  if (lexer.Next(s) && s.Is("stream")) {
+    size_t start = lexer.Pos();
+    if (start < size && d[start] == '\r') start++;
+    if (start < size && d[start] == '\n') start++;
+    *stream = StreamData(out, start, depth);
+  }
+  return true;
+}
+
+ByteSpan PdfFile::StreamData(const PdfObject& dict, size_t start, int depth) const {
+  const uint8_t* d = file_.Data();
+  const size_t size = file_.Size();
+
+  int64_t length = -1;
+  const PdfObject* len = dict.Get("Length");
+  if (len && len->type == PdfObject::Number) {
+    length = static_cast<int64_t>(len->number);
+  } else if (len && len->type == PdfObject::Ref && depth < 2) {
+    PdfObject value;
+    if (LoadAt(len->num, value, nullptr, depth + 1) && value.type == PdfObject::Number) {
+      length = static_cast<int64_t>(value.number);
+    }
+  }
+
+  // Trust /Length only if endstream follows it.
+  if (length >= 0 && static_cast<uint64_t>(length) <= size - start) {
+    size_t p = start + static_cast<size_t>(length);
+    while (p < size && IsWhite(d[p])) p++;
+    if (p + 9 <= size && std::memcmp(d + p, "endstream", 9) == 0) {
+      return ByteSpan{d + start, static_cast<size_t>(length)};
+    }
+  }
+
+  const uint8_t* hit = FindBytes(d + start, d + size, "endstream");
+  size_t end = hit ? static_cast<size_t>(hit - d) : size;
+  if (hit && end > start && d[end - 1] == '\n') end--;
+  if (hit && end > start && d[end - 1] == '\r') end--;
+  return ByteSpan{d + start, end - start};
+}
+
+bool PdfFile::LoadAt(int num, PdfObject& out, ByteSpan* stream, int depth) const {
+  if (stream) *stream = ByteSpan();
+  if (num <= 0 || static_cast<size_t>(num) >= entries_.size()) return false;
+  const XrefEntry& e = entries_[num];
+  if (!e.known) return false;
+
+  if (e.type == 1) return ParseIndirect(e.offset, num, out, stream, depth);
+  if (e.type != 2) return false;
+
+  auto it = objectStreams_.find(static_cast<int>(e.stream));
+  if (it == objectStreams_.end()) return false;
+  const ObjectStream& os = it->second;
+
+  size_t offset = 0;
+  bool found = false;
+  if (e.index < os.offsets.size() && os.offsets[e.index].first == num) {
+    offset = os.offsets[e.index].second;
+    found = true;
+  } else {
+    for (const auto& [n, off] : os.offsets) {
+      if (n == num) {
+        offset = off;
+        found = true;
+        break;
+      }
+    }
+  }
+  if (!found || offset >= os.data.size()) return false;
+
+  PdfLexer lexer(os.data.data(), os.data.size(), offset);
+  return ParseObject(lexer, out);
+}
+
+bool PdfFile::Load(int num, PdfObject& out, ByteSpan* stream) const {
+  return LoadAt(num, out, stream, 0);
+}
+
+PdfObject PdfFile::Resolve(const PdfObject& obj) const {
+  if (obj.type != PdfObject::Ref) return obj;
+  PdfObject out;
+  if (!Load(obj.num, out)) return PdfObject();
+  return out;
+}
+
+std::vector<PdfPageRef> PdfFile::Pages() const {
+  std::vector<PdfPageRef> pages;
+  const PdfObject* root = trailer_.Get("Root");
+  if (!root) return pages;
+  PdfObject catalog = Resolve(*root);
+  const PdfObject* tree = catalog.Get("Pages");
+  if (!tree) return pages;
+
+  struct Pending {
+    PdfObject node;
+    PdfObject resources;
+    int depth;
+  };
+  std::vector<Pending> stack;
+  stack.push_back({*tree, PdfObject(), 0});
+  std::set<int> visited;
+
+  while (!stack.empty() && pages.size() < MAX_PAGES) {
+    Pending pending = std::move(stack.back());
+    stack.pop_back();
+
+    int num = 0;
+    if (pending.node.type == PdfObject::Ref) {
+      num = pending.node.num;
+      if (!visited.insert(num).second) continue;
+    }
+    PdfObject node = Resolve(pending.node);
+    if (node.type != PdfObject::Dict) continue;
+
+    const PdfObject* res = node.Get("Resources");
+    PdfObject resources = res ? *res : std::move(pending.resources);
+
+    const PdfObject* type = node.Get("Type");
+    const PdfObject* kids = node.Get("Kids");
+    bool isTree = type ? type->IsName("Pages") : kids != nullptr;
+    if (!isTree) {
+      const PdfObject* contents = node.Get("Contents");
+      pages.push_back({num, std::move(resources), contents ? *contents : PdfObject()});
+      continue;
+    }
+    if (!kids || pending.depth >= MAX_TREE_DEPTH) continue;
+
+    PdfObject list = Resolve(*kids);
+    for (size_t i = list.items.size(); i-- > 0;) {
+      stack.push_back({list.items[i], resources, pending.depth + 1});
+    }
+  }
+  return pages;
+}
+
+// ── Content streams ─────────────────────────────────────────────────
+
+void ContentStats::Add(const ContentStats& o) {
+  operators += o.operators;
+  pathSegments += o.pathSegments;
+  paints += o.paints;
+  textShows += o.textShows;
+  images += o.images;
+}
+
+namespace {
+
+/** Operators of up to three bytes packed into an integer for switch. */
+constexpr uint32_t OpKey(const char* s) {
+  uint32_t key = 0;
+  for (int i = 0; i < 3 && s[i]; i++) key = (key << 8) | static_cast<uint8_t>(s[i]);
+  return key;
+}
+
+uint32_t OpKey(const PdfToken& t) {
+  if (t.rawSize == 0 || t.rawSize > 3) return 0;
+  uint32_t key = 0;
+  for (size_t i = 0; i < t.rawSize; i++) key = (key << 8) | t.raw[i];
+  return key;
+}
+
+} // namespace
+
+void ScanContent(const uint8_t* data, size_t size, ContentStats& stats,
+                 std::vector<std::string>& xobjects) {
+  PdfLexer lexer(data, size);
+  PdfToken t;
+  PdfToken lastName;
+  bool haveName = false;
+
+  while (lexer.Next(t)) {
+    if (t.type == PdfTokenType::Name) {
+      lastName = t;
+      haveName = true;
+      continue;
+    }
+    if (t.type != PdfTokenType::Keyword || t.Is("true") || t.Is("false") ||
+        t.Is("null")) {
+      continue;
+    }
+
+    stats.operators++;
+    switch (OpKey(t)) {
+      case OpKey("m"): case OpKey("l"): case OpKey("c"): case OpKey("v"):
+      case OpKey("y"): case OpKey("h"): case OpKey("re"):
+        stats.pathSegments++;
+        break;
+
+      case OpKey("S"): case OpKey("s"): case OpKey("f"): case OpKey("F"):
+      case OpKey("f*"): case OpKey("B"): case OpKey("B*"): case OpKey("b"):
+      case OpKey("b*"): case OpKey("sh"):
+        stats.paints++;
+        break;
+
+      case OpKey("Tj"): case OpKey("TJ"): case OpKey("'"): case OpKey("\""):
+        stats.textShows++;
+        break;
+
+      case OpKey("BI"):
+        stats.images++;
+        while (lexer.Next(t) && !t.Is("ID")) {}
+        lexer.SkipInlineImage();
+        break;
+
+      case OpKey("Do"):
+        if (haveName) xobjects.push_back(DecodeName(lastName));
+        break;
+
+      default:
+        break;
+    }
+    haveName = false;
+  }
+}
@@ -0,0 +1,263 @@
+/**
+ * pdfscan.h — Read-only PDF structure reader that does not use PDFium.
+ *
+ * Everything that goes through PDFium is serialised on g_pdfiumMutex.
+ * Analysis that only needs the file's structure (object statistics,
+ * image and font inventories, stream hashes, content complexity) uses
+ * this instead: a tokenizer, a cross-reference reader (tables, xref
+ * streams, object streams, and a rebuild scan for damaged files) and a
+ * content-stream operator scanner, all over a memory-mapped file.
+ *
+ * A PdfFile is immutable once Open() returns — object streams are
+ * decoded up front — so any number of threads may read it at once.
+ * Encrypted files open, but strings and stream data stay encrypted.
+ */
+#ifndef PDFIUM_ADDON_PDFSCAN_H
+#define PDFIUM_ADDON_PDFSCAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ── Memory-mapped file ──────────────────────────────────────────────
+
+/** A whole file mapped read-only.  Empty files map to size 0. */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  /** @param path UTF-8 file path */
+  bool Open(const std::string& path, std::string& error);
+
+  const uint8_t* Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
+
+/** A byte range inside a mapped file (or a decoded buffer). */
+struct ByteSpan {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+};
+
+// ── Tokenizer ───────────────────────────────────────────────────────
+
+enum class PdfTokenType {
+  End,
+  Number,
+  Name,        ///< raw excludes the leading '/'
+  String,      ///< literal (...) string; raw excludes the parentheses
+  HexString,   ///< <...> string; raw excludes the angle brackets
+  Keyword,     ///< operators, obj/endobj, R, true/false/null, { }
+  ArrayOpen,
+  ArrayClose,
+  DictOpen,
+  DictClose,
+};
+
+/**
+ * One token.  Names and strings are left undecoded (see DecodeName and
+ * DecodeString) so the content scanner never pays for text it skips.
+ */
+struct PdfToken {
+  PdfTokenType type = PdfTokenType::End;
+  const uint8_t* raw = nullptr;
+  size_t rawSize = 0;
+  double number = 0;
+  bool integer = false;
+  size_t start = 0;   ///< offset of the token's first byte
+
+  bool Is(const char* keyword) const;
+};
+
+class PdfLexer {
+ public:
+  PdfLexer(const uint8_t* data, size_t size, size_t pos = 0)
+    : data_(data), size_(size), pos_(pos < size ? pos : size) {}
+
+  /** Read the next token; false (and type End) at the end of input. */
+  bool Next(PdfToken& token);
+
+  size_t Pos() const { return pos_; }
+  void Seek(size_t pos) { pos_ = pos < size_ ? pos : size_; }
+
+  /**
+   * Skip the binary data of an inline image.  Call after the ID
+   * operator; leaves the lexer just past the matching EI.
+   */
+  void SkipInlineImage();
+
+  const uint8_t* Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+ private:
+  void SkipWhitespace();
+
+  const uint8_t* data_;
+  size_t size_;
+  size_t pos_;
+};
+
+/** Name with #xx escapes resolved. */
+std::string DecodeName(const PdfToken& token);
+
+/** String bytes with escapes (literal) or hex digits (hex) resolved. */
+std::string DecodeString(const PdfToken& token);
+
+// ── Objects ─────────────────────────────────────────────────────────
+
+struct PdfObject {
+  enum Type : uint8_t { Null, Bool, Number, String, Name, Array, Dict, Ref };
+
+  Type type = Null;
+  bool boolean = false;
+  double number = 0;
+  int num = 0, gen = 0;            ///< Ref
+  std::string text;                ///< String bytes or Name (no '/')
+  std::vector<std::string> keys;   ///< Dict keys, parallel to items
+  std::vector<PdfObject> items;    ///< Array elements or Dict values
+
+  /** Dict value for `key`, or nullptr. */
+  const PdfObject* Get(const char* key) const;
+  bool IsName(const char* name) const { return type == Name && text == name; }
+  int Int(int fallback = 0) const;
+};
+
+/**
+ * Parse one object at the lexer position, folding `n g R` into Ref.
+ * False on malformed input or nesting deeper than 64.
+ */
+bool ParseObject(PdfLexer& lexer, PdfObject& out);
+
+/** Names in a stream's /Filter entry, in decode order. */
+std::vector<std::string> StreamFilters(const PdfObject& dict);
+
+/**
+ * Undo PNG predictor row filters (Predictor >= 10) in place: each row
+ * of `columns` samples of `colors` components at `bpc` bits is led by
+ * a filter type byte.  False on a type PNG does not define.
+ */
+bool UndoPngPredictor(std::vector<uint8_t>& data, int colors, int bpc, int columns);
+
+// ── File ────────────────────────────────────────────────────────────
+
+enum class XrefSource { Table, Stream, Rebuilt };
+
+/** Where an object lives: at an offset, or inside an object stream. */
+struct XrefEntry {
+  bool known = false;
+  uint8_t type = 0;        ///< 0 free, 1 in file, 2 in object stream
+  uint32_t gen = 0;
+  uint64_t offset = 0;     ///< type 1
+  uint32_t stream = 0;     ///< type 2: object stream number
+  uint32_t index = 0;      ///< type 2: index within it
+};
+
+/** A leaf of the page tree, with its inherited resources. */
+struct PdfPageRef {
+  int num = 0;
+  PdfObject resources;
+  PdfObject contents;
+};
+
+class PdfFile {
+ public:
+  /** Map `path` and read its cross-reference data. */
+  bool Open(const std::string& path, std::string& error);
+
+  /** Header version, e.g. "1.7"; empty without a header. */
+  const std::string& Version() const { return version_; }
+  size_t FileSize() const { return file_.Size(); }
+  XrefSource Source() const { return source_; }
+  const PdfObject& Trailer() const { return trailer_; }
+  bool Encrypted() const { return trailer_.Get("Encrypt") != nullptr; }
+
+  /** One past the highest object number. */
+  int ObjectLimit() const { return static_cast<int>(entries_.size()); }
+  const XrefEntry& Entry(int num) const { return entries_[num]; }
+
+  /**
+   * Load object `num`.  For a stream, `out` is its dictionary and
+   * `stream` (if given) receives the raw, still-encoded bytes.
+   */
+  bool Load(int num, PdfObject& out, ByteSpan* stream = nullptr) const;
+
+  /** `obj` itself, or the object a Ref points to (Null if missing). */
+  PdfObject Resolve(const PdfObject& obj) const;
+
+  /**
+   * Decode `raw` through the stream's /Filter chain.  Only FlateDecode
+   * (with PNG predictors) is handled; other filters, or more output
+   * than `limit`, return false.
+   */
+  bool DecodeStream(const PdfObject& dict, ByteSpan raw,
+                    std::vector<uint8_t>& out, size_t limit) const;
+
+  /** Page tree leaves in document order; loops and bad nodes are skipped. */
+  std::vector<PdfPageRef> Pages() const;
+
+ private:
+  struct ObjectStream {
+    std::vector<uint8_t> data;
+    std::vector<std::pair<int, size_t>> offsets;   ///< (num, offset)
+  };
+
+  using Entries = std::vector<std::pair<int, XrefEntry>>;
+
+  bool ReadXref();
+  bool ReadSection(uint64_t offset, PdfObject& trailer, Entries& found);
+  bool ReadTable(PdfLexer& lexer, PdfObject& trailer, Entries& found);
+  bool ReadXrefStream(uint64_t offset, PdfObject& trailer, Entries& found);
+  /** Recover entries by scanning for "n g obj"; returns object streams. */
+  std::vector<int> Rebuild();
+  void LoadObjectStreams(std::vector<int> streams);
+  void SetEntry(int num, const XrefEntry& entry);
+
+  /** Parse "n g obj <object> [stream]" at `offset`. */
+  bool ParseIndirect(uint64_t offset, int expectNum, PdfObject& out,
+                     ByteSpan* stream, int depth) const;
+  bool LoadAt(int num, PdfObject& out, ByteSpan* stream, int depth) const;
+  ByteSpan StreamData(const PdfObject& dict, size_t start, int depth) const;
+
+  MappedFile file_;
+  std::string version_;
+  XrefSource source_ = XrefSource::Table;
+  PdfObject trailer_;
+  std::vector<XrefEntry> entries_;
+  std::map<int, ObjectStream> objectStreams_;
+};
+
+// ── Content streams ─────────────────────────────────────────────────
+
+/** Operator counts for one content stream (or page, summed). */
+struct ContentStats {
+  uint32_t operators = 0;
+  uint32_t pathSegments = 0;   ///< m l c v y h re
+  uint32_t paints = 0;         ///< S s f F f* B B* b b* sh
+  uint32_t textShows = 0;      ///< Tj TJ ' "
+  uint32_t images = 0;         ///< inline images and image XObjects drawn
+
+  void Add(const ContentStats& o);
+};
+
+/**
+ * Count the operators of one content stream.  The names passed to Do
+ * are appended to `xobjects` for the caller to resolve.
+ */
+void ScanContent(const uint8_t* data, size_t size, ContentStats& stats,
+                 std::vector<std::string>& xobjects);
+
+#endif // PDFIUM_ADDON_PDFSCAN_H
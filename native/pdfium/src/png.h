@@ -0,0 +1,34 @@
+/**
+ * png.h — PNG file writer.
+ *
+ * Used where image data leaves the process as a file (extractImages):
+ * rows are filtered per scanline and compressed with deflate.h.  Holds
+ * no global state beyond a constant CRC table; safe on any thread.
+ */
+#ifndef PDFIUM_ADDON_PNG_H
+#define PDFIUM_ADDON_PNG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** PNG colour types this writer emits. */
+enum class PngColor : uint8_t { Gray = 0, Rgb = 2, Rgba = 6 };
+
+/**
+ * Encode `height` rows, each starting `stride` bytes after the last, of
+ * packed samples at `bitDepth` bits (1, 2, 4 or 8; 16 big-endian; below
+ * 8 only for Gray).  Appends the whole file to `out`.
+ */
+void EncodePng(const uint8_t* pixels, size_t stride, int width, int height,
+               PngColor color, int bitDepth, std::vector<uint8_t>& out);
+
+/**
+ * Write a PNG around a zlib stream that already holds filtered scanlines
+ * in PNG layout — what a PDF FlateDecode stream with a PNG predictor is —
+ * without recompressing it.
+ */
+void WrapPng(const uint8_t* zlib, size_t size, int width, int height,
+             PngColor color, int bitDepth, std::vector<uint8_t>& out);
+
+#endif // PDFIUM_ADDON_PNG_H
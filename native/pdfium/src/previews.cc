@@ -0,0 +1,444 @@
+/**
+ * previews.cc — Byte-bounded LRU cache of image-object previews.
+ *
+ * Selecting a 40-megapixel scan to replace it should show the original
+ * at once.  Decoding it is the expensive part, and it does not depend on
+ * where the image is drawn, so previews come from the image's own
+ * pixels (FPDFImageObj_GetBitmap, not the placement-sized rendered
+ * bitmap) and are keyed by its encoded stream and decode parameters.
+ * A per-object slot remembers each object's key until its page is
+ * edited, so a repeat selection costs neither a page load nor a hash.
+ *
+ * All state is guarded by g_pdfiumMutex.
+ */
+
+#include "common.h"
+#include "previews.h"
+#include "jobs.h"
+#include "layers.h"
+#include "objects.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int DEFAULT_MAX_EDGE = 512;
+constexpr int MAX_MAX_EDGE = 4096;
+
+/** Pixel bytes kept across all previews; ~100 previews at 512². */
+constexpr size_t MAX_PREVIEW_BYTES = 96u * 1024 * 1024;
+
+/** How long the prefetch job waits before retrying a busy lock. */
+constexpr std::chrono::milliseconds IDLE_BACKOFF(10);
+
+using PreviewKey = std::pair<uint64_t, int>;          // (identity, maxEdge)
+using SlotKey = std::tuple<int, int, int>;            // (handle, page, object)
+
+struct Preview {
+  int width = 0;
+  int height = 0;
+  int pixelWidth = 0;
+  int pixelHeight = 0;
+  std::vector<uint8_t> rgba;
+  std::list<PreviewKey>::iterator lruPos;
+};
+
+/** Identity of an object, valid while its page version is unchanged. */
+struct Slot {
+  uint32_t version;
+  uint64_t hash;
+};
+
+/** Most-recently used key at the front. */
+std::list<PreviewKey> g_previewLru;
+std::map<PreviewKey, Preview> g_previews;
+size_t g_previewBytes = 0;
+
+std::map<SlotKey, Slot> g_previewSlots;
+
+// ── Cache ───────────────────────────────────────────────────────────
+
+void Erase(std::map<PreviewKey, Preview>::iterator it) {
+  g_previewBytes -= it->second.rgba.size();
+  g_previewLru.erase(it->second.lruPos);
+  g_previews.erase(it);
+}
+
+/** Cached preview for an object, without touching its page; or nullptr. */
+const Preview* Lookup(int handle, int pageIndex, int objectId, int maxEdge) {
+  auto slot = g_previewSlots.find(SlotKey(handle, pageIndex, objectId));
+  if (slot == g_previewSlots.end()) return nullptr;
+  if (slot->second.version != GetPageVersion(handle, pageIndex)) {
+    g_previewSlots.erase(slot);
+    return nullptr;
+  }
+
+  auto it = g_previews.find(PreviewKey(slot->second.hash, maxEdge));
+  if (it == g_previews.end()) return nullptr;
+  g_previewLru.splice(g_previewLru.begin(), g_previewLru, it->second.lruPos);
+  return &it->second;
+}
+
+/**
+ * Box-filter a PDFium bitmap (Gray, BGR, BGRx or BGRA) down to fit
+ * `maxEdge`, converting to RGBA.  Never scales up.
+ */
+bool Downsample(FPDF_BITMAP bitmap, int maxEdge, Preview& out) {
+  const int format = FPDFBitmap_GetFormat(bitmap);
+  const int bpp = format == FPDFBitmap_Gray ? 1
+                : format == FPDFBitmap_BGR ? 3
+                : format == FPDFBitmap_BGRx || format == FPDFBitmap_BGRA ? 4 : 0;
+  const int sw = FPDFBitmap_GetWidth(bitmap);
+  const int sh = FPDFBitmap_GetHeight(bitmap);
+  if (bpp == 0 || sw <= 0 || sh <= 0) return false;
+
+  const double scale = std::min(1.0, static_cast<double>(maxEdge) / std::max(sw, sh));
+  const int dw = std::max(1, static_cast<int>(sw * scale + 0.5));
+  const int dh = std::max(1, static_cast<int>(sh * scale + 0.5));
+
+  const auto* src = static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+  const size_t stride = static_cast<size_t>(FPDFBitmap_GetStride(bitmap));
+  const bool alpha = format == FPDFBitmap_BGRA;
+
+  out.width = dw;
+  out.height = dh;
+  out.pixelWidth = sw;
+  out.pixelHeight = sh;
+  out.rgba.resize(static_cast<size_t>(dw) * dh * 4);
+  DownsamplePixels(src, stride, bpp, alpha, sw, sh, dw, dh, out.rgba.data());
+  return true;
+}
+
+/**
+ * Cache identity of an image: its encoded stream, folded together with
+ * what decodes it.  The same bytes under another size, depth, colour
+ * space or filter chain (one stream shared by two image dictionaries)
+ * are different pixels.  Palettes and /Decode arrays are not reachable
+ * through the public API and are not part of it.
+ */
+uint64_t PreviewIdentity(FPDF_PAGEOBJECT obj, FPDF_PAGE page) {
+  uint64_t hash = ImageStreamHash(obj);
+  auto mix = [&hash](const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash ^= bytes[i];
+      hash *= 0x100000001b3ULL;  // FNV-1a, continuing the stream hash
+    }
+  };
+
+  FPDF_IMAGEOBJ_METADATA meta = {};
+  FPDFImageObj_GetImageMetadata(obj, page, &meta);
+  const int32_t fields[] = {
+    static_cast<int32_t>(meta.width), static_cast<int32_t>(meta.height),
+    static_cast<int32_t>(meta.bits_per_pixel), meta.colorspace,
+  };
+  mix(fields, sizeof(fields));
+
+  const int filters = FPDFImageObj_GetImageFilterCount(obj);
+  for (int i = 0; i < filters; i++) {
+    char name[64] = {};
+    FPDFImageObj_GetImageFilter(obj, i, name, sizeof(name));
+    mix(name, sizeof(name));
+  }
+  return hash;
+}
+
+/**
+ * Cached or freshly decoded preview of `obj`, recording its slot.
+ * nullptr if PDFium cannot decode the image.
+ */
+const Preview* Build(int handle, int pageIndex, int objectId, FPDF_PAGE page,
+                     FPDF_PAGEOBJECT obj, int maxEdge, bool& decoded) {
+  decoded = false;
+  const uint64_t hash = PreviewIdentity(obj, page);
+  g_previewSlots[SlotKey(handle, pageIndex, objectId)] =
+    { GetPageVersion(handle, pageIndex), hash };
+
+  const PreviewKey key(hash, maxEdge);
+  auto it = g_previews.find(key);
+  if (it != g_previews.end()) {
+    g_previewLru.splice(g_previewLru.begin(), g_previewLru, it->second.lruPos);
+    return &it->second;
+  }
+
+  FPDF_BITMAP bitmap = FPDFImageObj_GetBitmap(obj);
+  if (!bitmap) return nullptr;
+  Preview preview;
+  const bool ok = Downsample(bitmap, maxEdge, preview);
+  FPDFBitmap_Destroy(bitmap);
+  if (!ok) return nullptr;
+  decoded = true;
+
+  g_previewLru.push_front(key);
+  preview.lruPos = g_previewLru.begin();
+  g_previewBytes += preview.rgba.size();
+  Preview& stored = g_previews[key] = std::move(preview);
+
+  while (g_previewBytes > MAX_PREVIEW_BYTES && g_previews.size() > 1) {
+    Erase(g_previews.find(g_previewLru.back()));
+  }
+  return &stored;
+}
+
+Napi::Object ToObject(Napi::Env env, const Preview& p, bool cached) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("width", Napi::Number::New(env, p.width));
+  result.Set("height", Napi::Number::New(env, p.height));
+  result.Set("image", Napi::Buffer<uint8_t>::Copy(env, p.rgba.data(), p.rgba.size()));
+  result.Set("pixelWidth", Napi::Number::New(env, p.pixelWidth));
+  result.Set("pixelHeight", Napi::Number::New(env, p.pixelHeight));
+  result.Set("cached", Napi::Boolean::New(env, cached));
+  return result;
+}
+
+bool ReadMaxEdge(Napi::Env env, double value, const char* fnName, int& out) {
+  if (!(value >= 1 && value <= MAX_MAX_EDGE)) {
+    Napi::RangeError::New(env,
+      std::string(fnName) + ": maxEdge must be in [1, " +
+      std::to_string(MAX_MAX_EDGE) + "]"
+    ).ThrowAsJavaScriptException();
+    return false;
+  }
+  out = static_cast<int>(value);
+  return true;
+}
+
+// ── PrefetchJob ─────────────────────────────────────────────────────
+
+class PrefetchJob : public Job {
+ public:
+  PrefetchJob(Napi::Env env, int handle, std::vector<int> pages, int maxEdge,
+              Napi::Value onProgress)
+    : Job(env, onProgress),
+      handle_(handle),
+      pages_(std::move(pages)),
+      maxEdge_(maxEdge) {}
+
+ protected:
+  void Execute(const ExecutionProgress& progress) override {
+    const int total = static_cast<int>(pages_.size());
+    int done = 0;
+
+    for (int pageIndex : pages_) {
+      // One decode per lock hold: resume the page where the last one
+      // stopped until every object has been seen.
+      for (int next = 0; next >= 0;) {
+        std::unique_lock<std::mutex> lock(g_pdfiumMutex, std::defer_lock);
+        if (!LockWhenIdle(lock)) {
+          MarkCancelled();
+          return;
+        }
+        auto it = g_documents.find(handle_);
+        if (it == g_documents.end()) {
+          SetError("document was closed while the job was running");
+          return;
+        }
+        next = FillFrom(it->second, pageIndex, next);
+        lock.unlock();
+        std::this_thread::yield();
+      }
+
+      JobProgress p = { ++done, total };
+      progress.Send(&p, 1);
+    }
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("decoded", Napi::Number::New(env, decoded_));
+    return result;
+  }
+
+ private:
+  /**
+   * Take the lock only while it is free, so a render or edit never
+   * queues behind prefetching for more than the decode in progress.
+   * False if the job was cancelled while waiting.
+   */
+  bool LockWhenIdle(std::unique_lock<std::mutex>& lock) {
+    for (;;) {
+      if (CancelRequested()) return false;
+      if (lock.try_lock()) return true;
+      std::this_thread::sleep_for(IDLE_BACKOFF);
+    }
+  }
+
+  /**
+   * Visit objects from `first` until one preview has been decoded.
+   * Returns the object to resume at, or -1 when the page is finished.
+   */
+  int FillFrom(FPDF_DOCUMENT doc, int pageIndex, int first) {
+    bool fromCache = false;
+    FPDF_PAGE page = AcquirePage(handle_, doc, pageIndex, fromCache);
+    if (!page) return -1;
+
+    const int count = FPDFPage_CountObjects(page);
+    int i = first;
+    for (; i < count; i++) {
+      FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i);
+      if (FPDFPageObj_GetType(obj) != FPDF_PAGEOBJ_IMAGE) continue;
+      if (Lookup(handle_, pageIndex, i, maxEdge_)) continue;
+
+      bool decoded = false;
+      Build(handle_, pageIndex, i, page, obj, maxEdge_, decoded);
+      if (decoded) {
+        decoded_++;
+        i++;
+        break;
+      }
+    }
+    ReleasePage(handle_, pageIndex, page, fromCache);
+    return i < count ? i : -1;
+  }
+
+  const int handle_;
+  const std::vector<int> pages_;
+  const int maxEdge_;
+  int decoded_ = 0;
+};
+
+} // namespace
+
+// ── getImagePreview ─────────────────────────────────────────────────
+
+Napi::Value GetImagePreview(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 3 ||
+      !info[0].IsNumber() ||
+      !info[1].IsNumber() ||
+      !info[2].IsNumber()) {
+    Napi::TypeError::New(env,
+      "getImagePreview: requires (handle, pageIndex, objectId, maxEdge?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle    = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex = info[1].As<Napi::Number>().Int32Value();
+  int objectId  = info[2].As<Napi::Number>().Int32Value();
+  int maxEdge   = DEFAULT_MAX_EDGE;
+  if (info.Length() > 3 && info[3].IsNumber() &&
+      !ReadMaxEdge(env, info[3].As<Napi::Number>().DoubleValue(),
+                   "getImagePreview", maxEdge)) {
+    return env.Undefined();
+  }
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  if (const Preview* hit = Lookup(handle, pageIndex, objectId, maxEdge)) {
+    return ToObject(env, *hit, true);
+  }
+
+  bool fromCache = false;
+  FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+  if (!page) {
+    Napi::Error::New(env,
+      "getImagePreview: failed to load page " + std::to_string(pageIndex)
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int objCount = FPDFPage_CountObjects(page);
+  FPDF_PAGEOBJECT obj = (objectId >= 0 && objectId < objCount)
+    ? FPDFPage_GetObject(page, objectId) : nullptr;
+  if (!obj || FPDFPageObj_GetType(obj) != FPDF_PAGEOBJ_IMAGE) {
+    ReleasePage(handle, pageIndex, page, fromCache);
+    Napi::TypeError::New(env,
+      "getImagePreview: object " + std::to_string(objectId) +
+      " is not an image object"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  bool decoded = false;
+  const Preview* preview = Build(handle, pageIndex, objectId, page, obj, maxEdge, decoded);
+  ReleasePage(handle, pageIndex, page, fromCache);
+  if (!preview) {
+    Napi::Error::New(env, "getImagePreview: image could not be decoded")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return ToObject(env, *preview, !decoded);
+}
+
+// ── prefetchImagePreviews ───────────────────────────────────────────
+
+Napi::Value PrefetchImagePreviews(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env,
+      "prefetchImagePreviews: requires (handle: number, options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  Napi::Value options    = info.Length() > 1 ? info[1] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 2 ? info[2] : env.Undefined();
+
+  std::vector<int> pages;
+  Napi::Value pagesArg = options.IsObject()
+    ? options.As<Napi::Object>().Get("pages")
+    : env.Undefined();
+  if (!ReadPageList(env, pagesArg, FPDF_GetPageCount(doc),
+                    "prefetchImagePreviews", pages)) {
+    return env.Undefined();
+  }
+
+  int maxEdge = DEFAULT_MAX_EDGE;
+  if (!ReadMaxEdge(env, GetNumberOption(options, "maxEdge", DEFAULT_MAX_EDGE),
+                   "prefetchImagePreviews", maxEdge)) {
+    return env.Undefined();
+  }
+
+  auto* job = new PrefetchJob(env, handle, std::move(pages), maxEdge, onProgress);
+  return job->Start();
+}
+
+// ── Invalidation ────────────────────────────────────────────────────
+
+void InvalidateImagePreview(int handle, int pageIndex, int objectId) {
+  auto slot = g_previewSlots.find(SlotKey(handle, pageIndex, objectId));
+  if (slot == g_previewSlots.end()) return;
+
+  // The replaced stream is usually gone from the document: drop its
+  // previews now rather than leave them to age out of the LRU.
+  const uint64_t hash = slot->second.hash;
+  g_previewSlots.erase(slot);
+  auto it = g_previews.lower_bound(PreviewKey(hash, 0));
+  while (it != g_previews.end() && it->first.first == hash) {
+    auto next = std::next(it);
+    Erase(it);
+    it = next;
+  }
+}
+
+void DiscardImagePreviews(int handle) {
+  // Previews themselves are keyed by content and may serve other
+  // documents; the LRU bound retires them.
+  g_previewSlots.erase(g_previewSlots.lower_bound(SlotKey(handle, 0, 0)),
+                       g_previewSlots.lower_bound(SlotKey(handle + 1, 0, 0)));
+}
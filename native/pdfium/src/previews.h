@@ -0,0 +1,43 @@
+/**
+ * previews.h — Downsampled previews of image objects.
+ */
+#ifndef PDFIUM_ADDON_PREVIEWS_H
+#define PDFIUM_ADDON_PREVIEWS_H
+
+#include <napi.h>
+
+/**
+ * getImagePreview(handle, pageIndex, objectId, maxEdge?)
+ * → { width, height, image: Buffer, pixelWidth, pixelHeight, cached }
+ *
+ * The image object's own pixels (not as placed on the page), scaled
+ * down so neither side exceeds `maxEdge` (default 512), as tightly
+ * packed RGBA.  `pixelWidth`/`pixelHeight` are the full image size.
+ * Previews are cached by the image's encoded stream and its size,
+ * depth, colour space and filters, so every placement of the same
+ * image — on any page, in any open document — shares one; a hit on an
+ * unedited page does not load the page.
+ */
+Napi::Value GetImagePreview(const Napi::CallbackInfo& info);
+
+/**
+ * prefetchImagePreviews(handle, options?, onProgress?) → { jobId, done }
+ *
+ * options: { pages?: number[], maxEdge?: number }
+ *
+ * Fills the preview cache for every image object on the pages, at idle
+ * priority: the job only takes g_pdfiumMutex when no one else holds it
+ * and releases it after each decode.  `done` resolves with { decoded }.
+ */
+Napi::Value PrefetchImagePreviews(const Napi::CallbackInfo& info);
+
+/**
+ * Forget the preview of an image object whose stream is being replaced.
+ * Caller holds g_pdfiumMutex.
+ */
+void InvalidateImagePreview(int handle, int pageIndex, int objectId);
+
+/** Drop the preview bookkeeping of a closed document. */
+void DiscardImagePreviews(int handle);
+
+#endif // PDFIUM_ADDON_PREVIEWS_H
@@ -0,0 +1,278 @@
+/**
+ * rasterize.cc — Page profiling and rasterisation.
+ *
+ * Some pages (vendor drawings with hundreds of thousands of path
+ * segments) cost seconds per render in every viewer.  Rasterising
+ * them trades vector fidelity for a single image draw: the page is
+ * rendered once at the requested resolution and its content replaced
+ * by one image object.  The image is stored unfiltered and deflated
+ * on save, which suits line art better than JPEG.
+ */
+
+#include "common.h"
+#include "rasterize.h"
+#include "jobs.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr double DEFAULT_PROFILE_DPI = 36.0;
+constexpr double DEFAULT_RASTER_DPI = 150.0;
+constexpr double POINTS_PER_INCH = 72.0;
+
+/** Largest raster, in pixels; bigger pages get a lower resolution. */
+constexpr double MAX_RASTER_PIXELS = 64.0 * 1024 * 1024;
+
+/** Content only: annotations are rendered separately and stay live. */
+constexpr int RASTER_RENDER_FLAGS = FPDF_PRINTING;
+
+Napi::Array ToArray(Napi::Env env, const std::vector<int>& v) {
+  Napi::Array arr = Napi::Array::New(env, v.size());
+  for (size_t i = 0; i < v.size(); i++) {
+    arr[static_cast<uint32_t>(i)] = Napi::Number::New(env, v[i]);
+  }
+  return arr;
+}
+
+/** Pixel size of `page` at `dpi`, capped at MAX_RASTER_PIXELS. */
+void RasterSize(FPDF_PAGE page, double dpi, int& width, int& height) {
+  double scale = dpi / POINTS_PER_INCH;
+  const double w = FPDF_GetPageWidthF(page), h = FPDF_GetPageHeightF(page);
+  if (w * h * scale * scale > MAX_RASTER_PIXELS) {
+    scale = std::sqrt(MAX_RASTER_PIXELS / (w * h));
+  }
+  width = std::max(1, static_cast<int>(std::ceil(w * scale)));
+  height = std::max(1, static_cast<int>(std::ceil(h * scale)));
+}
+
+// ── ProfileJob ──────────────────────────────────────────────────────
+
+class ProfileJob : public PageJob {
+ public:
+  ProfileJob(Napi::Env env, int handle, std::vector<int> pages,
+             Napi::Value onProgress, double dpi)
+    : PageJob(env, handle, std::move(pages), onProgress), dpi_(dpi) {}
+
+ protected:
+  bool ProcessPage(FPDF_DOCUMENT doc, int pageIndex,
+                   std::string& /*error*/) override {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Time a cold load: that is what a viewer pays on open.
+    FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+    if (!page) return true;
+
+    int width = 0, height = 0;
+    RasterSize(page, dpi_, width, height);
+    FPDF_BITMAP bitmap = FPDFBitmap_Create(width, height, 0);
+    if (bitmap) {
+      FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0xFFFFFFFF);
+      FPDF_RenderPageBitmap(bitmap, page, 0, 0, width, height, 0,
+                            RASTER_RENDER_FLAGS);
+      FPDFBitmap_Destroy(bitmap);
+    }
+    FPDF_ClosePage(page);
+
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+    pages_.push_back(pageIndex);
+    ms_.push_back(elapsed.count());
+    return true;
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Array ms = Napi::Array::New(env, ms_.size());
+    for (size_t i = 0; i < ms_.size(); i++) {
+      ms[static_cast<uint32_t>(i)] = Napi::Number::New(env, ms_[i]);
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("pages", ToArray(env, pages_));
+    result.Set("ms", ms);
+    return result;
+  }
+
+ private:
+  const double dpi_;
+  std::vector<int> pages_;
+  std::vector<double> ms_;
+};
+
+// ── RasterizeJob ────────────────────────────────────────────────────
+
+class RasterizeJob : public PageJob {
+ public:
+  RasterizeJob(Napi::Env env, int handle, std::vector<int> pages,
+               Napi::Value onProgress, double dpi, bool gray)
+    : PageJob(env, handle, std::move(pages), onProgress),
+      dpi_(dpi),
+      gray_(gray) {}
+
+ protected:
+  bool ProcessPage(FPDF_DOCUMENT doc, int pageIndex,
+                   std::string& error) override {
+    // Write cached edits out first so the raster includes them, and
+    // drop the cached page: its objects are about to go away.
+    if (!FlushCachedPage(handle_, pageIndex)) {
+      error = "rasterizePages: FPDFPage_GenerateContent failed for page " +
+              std::to_string(pageIndex);
+      return false;
+    }
+
+    FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+    if (!page) {
+      failed_.push_back(pageIndex);
+      return true;
+    }
+
+    if (Rasterize(doc, page)) {
+      rasterized_.push_back(pageIndex);
+    } else {
+      failed_.push_back(pageIndex);
+    }
+    FPDF_ClosePage(page);
+    InvalidateTextPageData(handle_, pageIndex);
+    return true;
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("rasterized", ToArray(env, rasterized_));
+    result.Set("failed", ToArray(env, failed_));
+    return result;
+  }
+
+ private:
+  bool Rasterize(FPDF_DOCUMENT doc, FPDF_PAGE page) {
+    int width = 0, height = 0;
+    RasterSize(page, dpi_, width, height);
+
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(
+      width, height, gray_ ? FPDFBitmap_Gray : FPDFBitmap_BGR, nullptr, 0);
+    if (!bitmap) return false;
+    FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bitmap, page, 0, 0, width, height, 0,
+                          RASTER_RENDER_FLAGS | (gray_ ? FPDF_GRAYSCALE : 0));
+
+    // Image space is the unit square, y up; map it onto the rendered
+    // device rect in page space, which takes care of /Rotate and a
+    // MediaBox that does not start at the origin.
+    double ox, oy, rx, ry, tx, ty;
+    FPDF_DeviceToPage(page, 0, 0, width, height, 0, 0, height, &ox, &oy);
+    FPDF_DeviceToPage(page, 0, 0, width, height, 0, width, height, &rx, &ry);
+    FPDF_DeviceToPage(page, 0, 0, width, height, 0, 0, 0, &tx, &ty);
+
+    FPDF_PAGEOBJECT image = FPDFPageObj_NewImageObj(doc);
+    bool ok = image && FPDFImageObj_SetBitmap(&page, 1, image, bitmap) &&
+              FPDFImageObj_SetMatrix(image, rx - ox, ry - oy, tx - ox, ty - oy, ox, oy);
+    FPDFBitmap_Destroy(bitmap);
+    if (!ok) {
+      if (image) FPDFPageObj_Destroy(image);
+      return false;
+    }
+
+    for (int i = FPDFPage_CountObjects(page) - 1; i >= 0; --i) {
+      FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, i);
+      if (FPDFPage_RemoveObject(page, obj)) FPDFPageObj_Destroy(obj);
+    }
+    FPDFPage_InsertObject(page, image);
+    return FPDFPage_GenerateContent(page);
+  }
+
+  const double dpi_;
+  const bool gray_;
+
+  std::vector<int> rasterized_;
+  std::vector<int> failed_;
+};
+
+/** Shared argument handling: (handle, options?, onProgress?). */
+bool ReadJobArgs(const Napi::CallbackInfo& info, const char* fnName, int& handle,
+                 Napi::Value& options, Napi::Value& onProgress,
+                 std::vector<int>& pages) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env,
+      std::string(fnName) + ": requires (handle: number, options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return false;
+  }
+
+  handle = info[0].As<Napi::Number>().Int32Value();
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return false;
+
+  options    = info.Length() > 1 ? info[1] : env.Undefined();
+  onProgress = info.Length() > 2 ? info[2] : env.Undefined();
+
+  Napi::Value pagesArg = options.IsObject()
+    ? options.As<Napi::Object>().Get("pages")
+    : env.Undefined();
+  return ReadPageList(env, pagesArg, FPDF_GetPageCount(doc), fnName, pages);
+}
+
+} // namespace
+
+// ── profilePages ────────────────────────────────────────────────────
+
+Napi::Value ProfilePages(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  int handle = 0;
+  Napi::Value options, onProgress;
+  std::vector<int> pages;
+  if (!ReadJobArgs(info, "profilePages", handle, options, onProgress, pages)) {
+    return env.Undefined();
+  }
+
+  double dpi = GetNumberOption(options, "dpi", DEFAULT_PROFILE_DPI);
+  if (!(dpi > 0.0)) {
+    Napi::RangeError::New(env, "profilePages: dpi must be > 0")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto* job = new ProfileJob(env, handle, std::move(pages), onProgress, dpi);
+  return job->Start();
+}
+
+// ── rasterizePages ──────────────────────────────────────────────────
+
+Napi::Value RasterizePages(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  int handle = 0;
+  Napi::Value options, onProgress;
+  std::vector<int> pages;
+  if (!ReadJobArgs(info, "rasterizePages", handle, options, onProgress, pages)) {
+    return env.Undefined();
+  }
+
+  double dpi = GetNumberOption(options, "dpi", DEFAULT_RASTER_DPI);
+  std::string format = "color";
+  if (options.IsObject()) {
+    Napi::Value v = options.As<Napi::Object>().Get("format");
+    if (v.IsString()) format = v.As<Napi::String>().Utf8Value();
+  }
+  if (!(dpi > 0.0) || (format != "color" && format != "gray")) {
+    Napi::RangeError::New(env,
+      "rasterizePages: dpi must be > 0 and format 'color' or 'gray'"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto* job = new RasterizeJob(env, handle, std::move(pages), onProgress,
+                               dpi, format == "gray");
+  return job->Start();
+}
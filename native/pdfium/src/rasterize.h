@@ -0,0 +1,33 @@
+/**
+ * rasterize.h — Replace pathologically complex pages with a raster.
+ */
+#ifndef PDFIUM_ADDON_RASTERIZE_H
+#define PDFIUM_ADDON_RASTERIZE_H
+
+#include <napi.h>
+
+/**
+ * profilePages(handle, options?, onProgress?)
+ * → { jobId, done: Promise<{ pages: number[], ms: number[] }> }
+ *
+ * options: { pages?: number[], dpi?: number = 36 }
+ *
+ * Loads and renders each page once and reports the time it took, to
+ * pick the pages worth rasterising.
+ */
+Napi::Value ProfilePages(const Napi::CallbackInfo& info);
+
+/**
+ * rasterizePages(handle, options?, onProgress?)
+ * → { jobId, done: Promise<{ rasterized: number[], failed: number[] }> }
+ *
+ * options: { pages?: number[], dpi?: number = 150,
+ *            format?: 'color' | 'gray' = 'color' }
+ *
+ * Renders each page's content and replaces it with a single image
+ * object covering the page.  Annotations are not baked in and stay
+ * editable.  Text on rasterised pages is no longer extractable.
+ */
+Napi::Value RasterizePages(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_RASTERIZE_H
@@ -0,0 +1,453 @@
+/**
+ * redact.cc — Find term and pattern hits in page text and remove what
+ * lies beneath them: the glyphs of text objects and the pixels of image
+ * objects, with an opaque box drawn on top.
+ *
+ * Each page is visited once.  Its text comes from the text-page cache
+ * and its hits from redactmatch.h: all literal terms in one scan, each
+ * regex pattern through the windowed search over the same buffer.
+ */
+
+#include "common.h"
+#include "redact.h"
+#include "jobs.h"
+#include "redactmatch.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+
+#include <algorithm>
+#include <cmath>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/** Opaque black, ARGB. */
+constexpr FPDF_DWORD REDACT_FILL_ARGB = 0xFF000000;
+
+// ── Geometry helpers ────────────────────────────────────────────────
+
+FS_RECTF Normalise(const FS_RECTF& r) {
+  return { std::min(r.left, r.right), std::max(r.top, r.bottom),
+           std::max(r.left, r.right), std::min(r.top, r.bottom) };
+}
+
+bool HasArea(const FS_RECTF& r) {
+  return r.right > r.left && r.top > r.bottom;
+}
+
+bool Intersects(const FS_RECTF& a, const FS_RECTF& b) {
+  return a.left < b.right && b.left < a.right &&
+         a.bottom < b.top && b.bottom < a.top;
+}
+
+/** Boxes belong to the same line when their vertical centres are close. */
+bool SameLine(const FS_RECTF& a, const FS_RECTF& b) {
+  float ca = (a.top + a.bottom) * 0.5f;
+  float cb = (b.top + b.bottom) * 0.5f;
+  float h  = std::max(a.top - a.bottom, b.top - b.bottom);
+  return std::fabs(ca - cb) < h * 0.5f;
+}
+
+// ── Redaction spec ──────────────────────────────────────────────────
+
+struct RedactSpec {
+  std::vector<std::wstring> terms;
+  std::vector<std::wregex>  patterns;
+  bool caseSensitive = false;
+  bool wholeWord = false;
+  bool boxes = true;
+};
+
+// ── RedactJob ───────────────────────────────────────────────────────
+
+class RedactJob : public PageJob {
+ public:
+  RedactJob(Napi::Env env, int handle, std::vector<int> pages,
+            Napi::Value onProgress, RedactSpec spec)
+    : PageJob(env, handle, std::move(pages), onProgress),
+      boxes_(spec.boxes),
+      matcher_(spec.terms, std::move(spec.patterns), spec.caseSensitive,
+               spec.wholeWord) {}
+
+ protected:
+  bool ProcessPage(FPDF_DOCUMENT doc, int pageIndex,
+                   std::string& error) override {
+    // Redacted pages are regenerated and closed straight away rather
+    // than parked in the page cache: a 10,000-page pass cannot keep
+    // every page open.  Flush any pending edits first so they survive.
+    if (!FlushCachedPage(handle_, pageIndex)) {
+      error = "redactDocument: FPDFPage_GenerateContent failed for page " +
+              std::to_string(pageIndex);
+      return false;
+    }
+
+    FPDF_PAGE page = FPDF_LoadPage(doc, pageIndex);
+    if (!page) {
+      error = "redactDocument: failed to load page " + std::to_string(pageIndex);
+      return false;
+    }
+
+    auto text = GetTextPageData(handle_, pageIndex, page);
+    std::vector<RedactMatch> matches;
+    // Pattern matches too long to search are left in place and reported.
+    skipped_ += matcher_.FindAll(text->chars, matches);
+    if (matches.empty()) {
+      FPDF_ClosePage(page);
+      return true;
+    }
+
+    std::vector<bool> hit(text->chars.size(), false);
+    for (const RedactMatch& m : matches) {
+      std::fill(hit.begin() + m.start, hit.begin() + m.end, true);
+    }
+
+    std::vector<FS_RECTF> rects = HitRects(*text, hit);
+
+    std::vector<FPDF_PAGEOBJECT> objects(
+      static_cast<size_t>(FPDFPage_CountObjects(page)));
+    for (size_t i = 0; i < objects.size(); i++) {
+      objects[i] = FPDFPage_GetObject(page, static_cast<int>(i));
+    }
+
+    RemoveHitGlyphs(doc, page, *text, hit, objects);
+    ClipImages(page, objects, rects);
+
+    if (boxes_) {
+      for (const FS_RECTF& r : rects) {
+        FPDF_PAGEOBJECT box = FPDFPageObj_CreateNewRect(
+          r.left, r.bottom, r.right - r.left, r.top - r.bottom);
+        FPDFPageObj_SetFillColor(box, 0, 0, 0, 255);
+        FPDFPath_SetDrawMode(box, FPDF_FILLMODE_ALTERNATE, /*stroke=*/0);
+        FPDFPage_InsertObject(page, box);
+      }
+    }
+
+    bool generated = FPDFPage_GenerateContent(page) != 0;
+    FPDF_ClosePage(page);
+    InvalidateTextPageData(handle_, pageIndex);
+
+    if (!generated) {
+      error = "redactDocument: FPDFPage_GenerateContent failed for page " +
+              std::to_string(pageIndex);
+      return false;
+    }
+
+    totalMatches_ += matches.size();
+    pageHits_.emplace_back(pageIndex, static_cast<int>(matches.size()));
+    return true;
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("matches",
+      Napi::Number::New(env, static_cast<double>(totalMatches_)));
+    result.Set("textObjectsRemoved", Napi::Number::New(env, textObjectsRemoved_));
+    result.Set("imagesClipped",      Napi::Number::New(env, imagesClipped_));
+    result.Set("unremovedChars",     Napi::Number::New(env, unremovedChars_));
+    result.Set("skipped",
+      Napi::Number::New(env, static_cast<double>(skipped_)));
+
+    Napi::Array pages = Napi::Array::New(env, pageHits_.size());
+    for (size_t i = 0; i < pageHits_.size(); i++) {
+      Napi::Object entry = Napi::Object::New(env);
+      entry.Set("pageIndex", Napi::Number::New(env, pageHits_[i].first));
+      entry.Set("matches",   Napi::Number::New(env, pageHits_[i].second));
+      pages[static_cast<uint32_t>(i)] = entry;
+    }
+    result.Set("pages", pages);
+    return result;
+  }
+
+ private:
+  /** One rectangle per run of hit chars on the same line. */
+  static std::vector<FS_RECTF> HitRects(const TextPageData& text,
+                                        const std::vector<bool>& hit) {
+    std::vector<FS_RECTF> rects;
+    bool open = false;
+    FS_RECTF cur = { 0, 0, 0, 0 };
+
+    for (size_t i = 0; i < hit.size(); i++) {
+      if (!hit[i]) {
+        if (open) rects.push_back(cur);
+        open = false;
+        continue;
+      }
+      FS_RECTF box = Normalise(text.boxes[i]);
+      if (text.generated[i] || !HasArea(box)) continue;
+
+      if (open && SameLine(cur, box)) {
+        cur.left   = std::min(cur.left, box.left);
+        cur.right  = std::max(cur.right, box.right);
+        cur.top    = std::max(cur.top, box.top);
+        cur.bottom = std::min(cur.bottom, box.bottom);
+      } else {
+        if (open) rects.push_back(cur);
+        cur = box;
+        open = true;
+      }
+    }
+    if (open) rects.push_back(cur);
+    return rects;
+  }
+
+  /**
+   * Remove every text object that drew a hit char.  The object's
+   * surviving glyph runs are re-created as new text objects at their
+   * original origins; if that fails the whole object stays removed,
+   * which over-redacts but never leaks.
+   */
+  void RemoveHitGlyphs(FPDF_DOCUMENT doc, FPDF_PAGE page,
+                       const TextPageData& text,
+                       const std::vector<bool>& hit,
+                       const std::vector<FPDF_PAGEOBJECT>& objects) {
+    std::unordered_map<int, std::vector<size_t>> charsByObject;
+    std::vector<int> touched;
+
+    for (size_t i = 0; i < text.objects.size(); i++) {
+      int owner = text.objects[i];
+      if (owner >= 0) charsByObject[owner].push_back(i);
+      if (!hit[i]) continue;
+      if (owner >= 0) {
+        touched.push_back(owner);
+      } else if (!text.generated[i]) {
+        // Drawn inside a form XObject: covered by the box only.
+        unremovedChars_++;
+      }
+    }
+
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    for (int objIndex : touched) {
+      if (static_cast<size_t>(objIndex) >= objects.size()) continue;
+      FPDF_PAGEOBJECT obj = objects[static_cast<size_t>(objIndex)];
+      RebuildSurvivingRuns(doc, page, obj, text, hit, charsByObject[objIndex]);
+      FPDFPage_RemoveObject(page, obj);
+      FPDFPageObj_Destroy(obj);
+      textObjectsRemoved_++;
+    }
+  }
+
+  static void RebuildSurvivingRuns(FPDF_DOCUMENT doc, FPDF_PAGE page,
+                                   FPDF_PAGEOBJECT obj,
+                                   const TextPageData& text,
+                                   const std::vector<bool>& hit,
+                                   const std::vector<size_t>& chars) {
+    FPDF_FONT font = FPDFTextObj_GetFont(obj);
+    float fontSize = 0.0f;
+    FS_MATRIX matrix;
+    if (!font || !FPDFTextObj_GetFontSize(obj, &fontSize) ||
+        !FPDFPageObj_GetMatrix(obj, &matrix)) {
+      return;
+    }
+
+    unsigned int r = 0, g = 0, b = 0, a = 255;
+    bool hasFill = FPDFPageObj_GetFillColor(obj, &r, &g, &b, &a) != 0;
+    FPDF_TEXT_RENDERMODE mode = FPDFTextObj_GetTextRenderMode(obj);
+
+    size_t i = 0;
+    while (i < chars.size()) {
+      if (hit[chars[i]]) { i++; continue; }
+
+      size_t first = chars[i];
+      std::u16string run;
+      while (i < chars.size() && !hit[chars[i]]) {
+        AppendUtf16(run, text.chars[chars[i]]);
+        i++;
+      }
+
+      FPDF_PAGEOBJECT runObj = FPDFPageObj_CreateTextObj(doc, font, fontSize);
+      if (!runObj) return;
+      if (!FPDFText_SetText(runObj,
+            reinterpret_cast<FPDF_WIDESTRING>(run.c_str()))) {
+        FPDFPageObj_Destroy(runObj);
+        continue;
+      }
+
+      FS_MATRIX runMatrix = matrix;
+      runMatrix.e = text.origins[first].x;
+      runMatrix.f = text.origins[first].y;
+      FPDFPageObj_SetMatrix(runObj, &runMatrix);
+      if (hasFill) FPDFPageObj_SetFillColor(runObj, r, g, b, a);
+      if (mode != FPDF_TEXTRENDERMODE_UNKNOWN) {
+        FPDFTextObj_SetTextRenderMode(runObj, mode);
+      }
+      FPDFPage_InsertObject(page, runObj);
+    }
+  }
+
+  /** Paint the pixels under each hit rectangle black in overlapping images. */
+  void ClipImages(FPDF_PAGE page,
+                  const std::vector<FPDF_PAGEOBJECT>& objects,
+                  const std::vector<FS_RECTF>& rects) {
+    for (FPDF_PAGEOBJECT obj : objects) {
+      if (FPDFPageObj_GetType(obj) != FPDF_PAGEOBJ_IMAGE) continue;
+
+      FS_RECTF bounds;
+      if (!FPDFPageObj_GetBounds(obj, &bounds.left, &bounds.bottom,
+                                 &bounds.right, &bounds.top)) {
+        continue;
+      }
+
+      std::vector<FS_RECTF> overlapping;
+      for (const FS_RECTF& r : rects) {
+        if (Intersects(r, bounds)) overlapping.push_back(r);
+      }
+      if (overlapping.empty()) continue;
+
+      if (ClipImage(page, obj, overlapping)) imagesClipped_++;
+    }
+  }
+
+  static bool ClipImage(FPDF_PAGE page, FPDF_PAGEOBJECT obj,
+                        const std::vector<FS_RECTF>& rects) {
+    // The image matrix maps the unit square onto the page; invert it to
+    // find which pixels each page-space rectangle covers.
+    FS_MATRIX m;
+    if (!FPDFPageObj_GetMatrix(obj, &m)) return false;
+    double det = static_cast<double>(m.a) * m.d - static_cast<double>(m.b) * m.c;
+    if (std::fabs(det) < 1e-9) return false;
+
+    FPDF_BITMAP bitmap = FPDFImageObj_GetBitmap(obj);
+    if (!bitmap) return false;
+    const int w = FPDFBitmap_GetWidth(bitmap);
+    const int h = FPDFBitmap_GetHeight(bitmap);
+
+    for (const FS_RECTF& r : rects) {
+      const float xs[4] = { r.left, r.right, r.left, r.right };
+      const float ys[4] = { r.bottom, r.bottom, r.top, r.top };
+      double minX = w, minY = h, maxX = 0, maxY = 0;
+
+      for (int k = 0; k < 4; k++) {
+        double dx = xs[k] - m.e, dy = ys[k] - m.f;
+        double u = ( m.d * dx - m.c * dy) / det;
+        double v = (-m.b * dx + m.a * dy) / det;
+        double px = u * w;
+        double py = (1.0 - v) * h;  // image rows run top-down
+        minX = std::min(minX, px); maxX = std::max(maxX, px);
+        minY = std::min(minY, py); maxY = std::max(maxY, py);
+      }
+
+      int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+      int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+      int x1 = std::min(w, static_cast<int>(std::ceil(maxX)));
+      int y1 = std::min(h, static_cast<int>(std::ceil(maxY)));
+      if (x1 > x0 && y1 > y0) {
+        FPDFBitmap_FillRect(bitmap, x0, y0, x1 - x0, y1 - y0, REDACT_FILL_ARGB);
+      }
+    }
+
+    bool ok = FPDFImageObj_SetBitmap(&page, /*count=*/1, obj, bitmap) != 0;
+    FPDFBitmap_Destroy(bitmap);
+    return ok;
+  }
+
+  const bool boxes_;
+  const RedactMatcher matcher_;
+
+  size_t totalMatches_ = 0;
+  size_t skipped_ = 0;
+  int textObjectsRemoved_ = 0;
+  int imagesClipped_ = 0;
+  int unremovedChars_ = 0;
+  std::vector<std::pair<int, int>> pageHits_;  ///< (pageIndex, matches)
+};
+
+/** Read an optional array of strings from the spec object. */
+bool ReadStrings(Napi::Env env, Napi::Value value, const char* name,
+                 std::vector<std::u16string>& out) {
+  if (value.IsUndefined() || value.IsNull()) return true;
+  if (!value.IsArray()) {
+    Napi::TypeError::New(env,
+      std::string("redactDocument: ") + name + " must be an array of strings"
+    ).ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Array arr = value.As<Napi::Array>();
+  for (uint32_t i = 0; i < arr.Length(); i++) {
+    Napi::Value v = arr.Get(i);
+    if (!v.IsString()) {
+      Napi::TypeError::New(env,
+        std::string("redactDocument: ") + name + " must be an array of strings"
+      ).ThrowAsJavaScriptException();
+      return false;
+    }
+    out.push_back(v.As<Napi::String>().Utf16Value());
+  }
+  return true;
+}
+
+} // namespace
+
+// ── redactDocument ──────────────────────────────────────────────────
+
+Napi::Value RedactDocument(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsObject()) {
+    Napi::TypeError::New(env,
+      "redactDocument: requires (handle: number, spec: object, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  Napi::Object specObj   = info[1].As<Napi::Object>();
+  Napi::Value onProgress = info.Length() > 2 ? info[2] : env.Undefined();
+
+  RedactSpec spec;
+  spec.caseSensitive = GetBoolOption(specObj, "caseSensitive", false);
+  spec.wholeWord     = GetBoolOption(specObj, "wholeWord", false);
+  spec.boxes         = GetBoolOption(specObj, "boxes", true);
+
+  std::vector<std::u16string> terms, patterns;
+  if (!ReadStrings(env, specObj.Get("terms"), "terms", terms) ||
+      !ReadStrings(env, specObj.Get("patterns"), "patterns", patterns)) {
+    return env.Undefined();
+  }
+
+  for (const std::u16string& t : terms) {
+    if (!t.empty()) spec.terms.push_back(ToTextPageChars(t));
+  }
+
+  auto flags = std::regex::ECMAScript | std::regex::optimize;
+  if (!spec.caseSensitive) flags |= std::regex::icase;
+  for (const std::u16string& p : patterns) {
+    if (p.empty()) continue;
+    try {
+      spec.patterns.emplace_back(ToTextPageChars(p), flags);
+    } catch (const std::regex_error& e) {
+      Napi::TypeError::New(env,
+        std::string("redactDocument: invalid pattern: ") + e.what()
+      ).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+
+  if (spec.terms.empty() && spec.patterns.empty()) {
+    Napi::RangeError::New(env,
+      "redactDocument: spec needs at least one term or pattern"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<int> pages;
+  if (!ReadPageList(env, specObj.Get("pages"), FPDF_GetPageCount(doc),
+                    "redactDocument", pages)) {
+    return env.Undefined();
+  }
+
+  auto* job = new RedactJob(env, handle, std::move(pages), onProgress,
+                            std::move(spec));
+  return job->Start();
+}
@@ -0,0 +1,23 @@
+/**
+ * redact.h — Search-driven bulk redaction.
+ */
+#ifndef PDFIUM_ADDON_REDACT_H
+#define PDFIUM_ADDON_REDACT_H
+
+#include <napi.h>
+
+/**
+ * redactDocument(handle, spec, onProgress?)
+ * → { jobId, done: Promise<{ matches, textObjectsRemoved, imagesClipped,
+ *                            unremovedChars, skipped,
+ *                            pages: [{ pageIndex, matches }] }> }
+ *
+ * spec: { terms?: string[], patterns?: string[], caseSensitive?: boolean,
+ *         wholeWord?: boolean, boxes?: boolean = true, pages?: number[] }
+ *
+ * `skipped` counts pattern matches too long to search (see
+ * regexsearch.h): their text is left in place.
+ */
+Napi::Value RedactDocument(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_REDACT_H
@@ -0,0 +1,110 @@
+/**
+ * redactmatch.cc — Term and pattern hits for redaction.
+ */
+
+#include "redactmatch.h"
+#include "regexsearch.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <queue>
+#include <utility>
+
+// ── TermMatcher ─────────────────────────────────────────────────────
+
+TermMatcher::TermMatcher(const std::vector<std::wstring>& terms, bool caseSensitive)
+  : caseSensitive_(caseSensitive) {
+  nodes_.emplace_back();
+
+  for (const std::wstring& term : terms) {
+    if (term.empty()) continue;
+    int state = 0;
+    for (wchar_t c : term) {
+      wchar_t f = Fold(c);
+      auto it = nodes_[state].next.find(f);
+      if (it != nodes_[state].next.end()) {
+        state = it->second;
+        continue;
+      }
+      int created = static_cast<int>(nodes_.size());
+      nodes_.emplace_back();
+      nodes_[state].next[f] = created;
+      state = created;
+    }
+    nodes_[state].lengths.push_back(term.size());
+  }
+
+  // Breadth-first failure links; each node also inherits the matches
+  // of its failure target so the scan never walks the chain twice.
+  std::queue<int> queue;
+  for (const auto& [c, child] : nodes_[0].next) queue.push(child);
+  while (!queue.empty()) {
+    int state = queue.front();
+    queue.pop();
+    for (const auto& [c, child] : nodes_[state].next) {
+      int f = nodes_[state].fail;
+      while (f != 0 && nodes_[f].next.count(c) == 0) f = nodes_[f].fail;
+      auto it = nodes_[f].next.find(c);
+      int target = (state != 0 && it != nodes_[f].next.end())
+        ? it->second : 0;
+      nodes_[child].fail = target;
+      const std::vector<size_t>& inherited = nodes_[target].lengths;
+      nodes_[child].lengths.insert(nodes_[child].lengths.end(),
+                                   inherited.begin(), inherited.end());
+      queue.push(child);
+    }
+  }
+}
+
+void TermMatcher::FindAll(const std::wstring& text, std::vector<RedactMatch>& out) const {
+  int state = 0;
+  for (size_t i = 0; i < text.size(); i++) {
+    wchar_t c = Fold(text[i]);
+    while (state != 0 && nodes_[state].next.count(c) == 0) {
+      state = nodes_[state].fail;
+    }
+    auto it = nodes_[state].next.find(c);
+    state = it != nodes_[state].next.end() ? it->second : 0;
+    for (size_t len : nodes_[state].lengths) {
+      out.push_back({ i + 1 - len, i + 1 });
+    }
+  }
+}
+
+wchar_t TermMatcher::Fold(wchar_t c) const {
+  return caseSensitive_ ? c : static_cast<wchar_t>(std::towlower(c));
+}
+
+// ── RedactMatcher ───────────────────────────────────────────────────
+
+RedactMatcher::RedactMatcher(const std::vector<std::wstring>& terms,
+                             std::vector<std::wregex> patterns,
+                             bool caseSensitive, bool wholeWord)
+  : terms_(terms, caseSensitive),
+    patterns_(std::move(patterns)),
+    wholeWord_(wholeWord) {}
+
+size_t RedactMatcher::FindAll(const std::wstring& chars,
+                              std::vector<RedactMatch>& out) const {
+  if (!terms_.Empty()) {
+    const size_t first = out.size();
+    terms_.FindAll(chars, out);
+    if (wholeWord_) {
+      auto isWordChar = [&](size_t i) { return std::iswalnum(chars[i]) != 0; };
+      out.erase(std::remove_if(out.begin() + first, out.end(),
+        [&](const RedactMatch& m) {
+          return (m.start > 0 && isWordChar(m.start - 1)) ||
+                 (m.end < chars.size() && isWordChar(m.end));
+        }), out.end());
+    }
+  }
+
+  size_t tooLong = 0;
+  std::vector<RegexMatch> hits;
+  for (const std::wregex& re : patterns_) {
+    hits.clear();
+    tooLong += FindRegexMatches(chars, re, std::wstring(), hits);
+    for (const RegexMatch& hit : hits) out.push_back({ hit.start, hit.end });
+  }
+  return tooLong;
+}
@@ -0,0 +1,64 @@
+/**
+ * redactmatch.h — The hits a redaction pass removes from one page's
+ * text: literal terms in one Aho–Corasick scan, then each regex pattern
+ * through the windowed search of regexsearch.h.  Needs no document, so
+ * it runs (and is tested) on any thread.
+ */
+#ifndef PDFIUM_ADDON_REDACTMATCH_H
+#define PDFIUM_ADDON_REDACTMATCH_H
+
+#include <cstddef>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct RedactMatch {
+  size_t start;  ///< First char index.
+  size_t end;    ///< One past the last char index.
+};
+
+/** Literal term matcher (Aho–Corasick); terms may overlap. */
+class TermMatcher {
+ public:
+  TermMatcher(const std::vector<std::wstring>& terms, bool caseSensitive);
+
+  bool Empty() const { return nodes_.size() == 1; }
+
+  /** Every occurrence of every term in `text`, overlaps included. */
+  void FindAll(const std::wstring& text, std::vector<RedactMatch>& out) const;
+
+ private:
+  struct Node {
+    std::unordered_map<wchar_t, int> next;
+    int fail = 0;
+    std::vector<size_t> lengths;  ///< Lengths of terms ending here.
+  };
+
+  wchar_t Fold(wchar_t c) const;
+
+  bool caseSensitive_;
+  std::vector<Node> nodes_;
+};
+
+class RedactMatcher {
+ public:
+  RedactMatcher(const std::vector<std::wstring>& terms,
+                std::vector<std::wregex> patterns,
+                bool caseSensitive, bool wholeWord);
+
+  /**
+   * Hits of the terms and patterns in `chars`.  Pattern matches longer
+   * than MAX_REGEX_MATCH may be too long to search; those are not
+   * reported but counted in the return value, so the caller can say
+   * that text was left in place.
+   */
+  size_t FindAll(const std::wstring& chars, std::vector<RedactMatch>& out) const;
+
+ private:
+  TermMatcher terms_;
+  std::vector<std::wregex> patterns_;
+  bool wholeWord_;
+};
+
+#endif // PDFIUM_ADDON_REDACTMATCH_H
@@ -0,0 +1,96 @@
+/**
+ * regexsearch.cc — Windowed regular-expression search.
+ *
+ * Each search sees at most WINDOW chars starting at `pos`.  A match of
+ * up to MAX_REGEX_MATCH chars starting in the first half of the window
+ * ends inside it, so the leftmost such match is found exactly; matches
+ * starting later, or reaching the window's end, are searched again from
+ * a window that starts at them.
+ */
+
+#include "regexsearch.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr size_t WINDOW = 2 * MAX_REGEX_MATCH;
+
+}  // namespace
+
+size_t FindRegexMatches(const std::wstring& text, const std::wregex& pattern,
+                        const std::wstring& format, std::vector<RegexMatch>& out) {
+  const size_t n = text.size();
+  size_t tooLong = 0;
+  // Set while skipping the rest of an over-long match: a match that
+  // starts right where the last window ended continues it.
+  bool continuing = false;
+  // Set after an empty match at `pos`: only a non-empty one there will
+  // do, as regex_iterator retries.
+  bool nonEmptyAt = false;
+
+  for (size_t pos = 0; pos < n;) {
+    const size_t windowEnd = std::min(pos + WINDOW, n);
+    const bool last = windowEnd == n;
+
+    auto flags = std::regex_constants::match_default;
+    // Keep ^, $ and \b true to the whole text at the window's edges.
+    if (pos > 0) flags |= std::regex_constants::match_prev_avail;
+    if (!last) flags |= std::regex_constants::match_not_eol | std::regex_constants::match_not_eow;
+    if (nonEmptyAt) {
+      flags |= std::regex_constants::match_not_null | std::regex_constants::match_continuous;
+    }
+
+    std::wsmatch m;
+    const bool found =
+      std::regex_search(text.begin() + pos, text.begin() + windowEnd, m, pattern, flags);
+    if (nonEmptyAt && !found) {
+      nonEmptyAt = false;
+      pos++;
+      continue;
+    }
+    nonEmptyAt = false;
+    if (!found) {
+      if (last) break;
+      // No match starts in the first half; one may start in the second.
+      pos += MAX_REGEX_MATCH;
+      continuing = false;
+      continue;
+    }
+
+    const size_t start = pos + static_cast<size_t>(m.position(0));
+    const size_t end = start + static_cast<size_t>(m.length(0));
+
+    if (continuing) {
+      if (start == pos) {
+        // Still the over-long match; skip to its end or the window's.
+        continuing = !last && end == windowEnd;
+        pos = std::max(end, pos + 1);
+        continue;
+      }
+      continuing = false;
+    }
+
+    if (!last && (end == windowEnd || start >= pos + MAX_REGEX_MATCH)) {
+      if (start > pos) {
+        // Possibly cut short by the window: look again from its start.
+        pos = start;
+        continue;
+      }
+      // Fills the whole window from its start: longer than the cap.
+      tooLong++;
+      continuing = true;
+      pos = windowEnd;
+      continue;
+    }
+
+    if (end == start) {
+      nonEmptyAt = true;
+      pos = start;
+      continue;
+    }
+    out.push_back({ start, end, m.format(format) });
+    pos = end;
+  }
+  return tooLong;
+}
@@ -0,0 +1,38 @@
+/**
+ * regexsearch.h — Regular-expression search with a bounded match length.
+ *
+ * std::regex matches by recursion, one or more frames per char a match
+ * attempt consumes, so a pattern like [\s\S]+ over a long page overflows
+ * a worker thread's stack.  The search here runs the matcher over short
+ * windows of the text instead, which caps both the stack it needs and
+ * the length of a match.  Holds no state; safe on any thread.
+ */
+#ifndef PDFIUM_ADDON_REGEXSEARCH_H
+#define PDFIUM_ADDON_REGEXSEARCH_H
+
+#include <cstddef>
+#include <regex>
+#include <string>
+#include <vector>
+
+/** Longest match FindRegexMatches is sure to find, in chars. */
+constexpr size_t MAX_REGEX_MATCH = 256;
+
+struct RegexMatch {
+  size_t start;  ///< First char index.
+  size_t end;    ///< One past the last char index.
+  std::wstring replacement;
+};
+
+/**
+ * Non-overlapping, non-empty matches of `pattern` in `text`, left to
+ * right, each with `format` expanded against it.  Matches of up to
+ * MAX_REGEX_MATCH chars are found as regex_iterator would find them.
+ * One that fills a whole search window (twice that) is not reported: it
+ * is counted in the return value and the search resumes after the run
+ * of text it covers.
+ */
+size_t FindRegexMatches(const std::wstring& text, const std::wregex& pattern,
+                        const std::wstring& format, std::vector<RegexMatch>& out);
+
+#endif // PDFIUM_ADDON_REGEXSEARCH_H
@@ -1,21 +1,84 @@
 /**
- * render.cc — Render a PDF page to an RGBA bitmap via PDFium.
+ * render.cc — Render a PDF page, or one of its layers, to an RGBA
+ * bitmap via PDFium; composite layers.
  */
 
 #include "common.h"
 #include "render.h"
+#include "layers.h"
 
 #include <fpdfview.h>
+#include <fpdf_annot.h>
+#include <fpdf_edit.h>
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 /** Render flags: include annotations, sub-pixel text, printing fidelity. */
 static constexpr int RENDER_FLAGS = FPDF_ANNOT | FPDF_PRINTING | FPDF_LCD_TEXT;
 
+/** Content layer: the page as RENDER_FLAGS draws it, minus annotations. */
+static constexpr int CONTENT_RENDER_FLAGS = RENDER_FLAGS & ~FPDF_ANNOT;
+
+/**
+ * Annotation layer: annotations alone on a transparent bitmap.  No LCD
+ * text, whose sub-pixel colour fringes assume an opaque background.
+ */
+static constexpr int ANNOTATION_RENDER_FLAGS = FPDF_ANNOT | FPDF_PRINTING;
+
+enum class RenderLayer { Page, Content, Annotations };
+
+/**
+ * Annotations hidden from rendering (FPDF_ANNOT_FLAG_HIDDEN) until the
+ * guard goes away; their original flags are then restored.
+ */
+class HiddenAnnotations {
+ public:
+  ~HiddenAnnotations() {
+    for (auto& [annot, flags] : saved_) {
+      FPDFAnnot_SetFlags(annot, flags);
+      FPDFPage_CloseAnnot(annot);
+    }
+  }
+
+  void Hide(FPDF_PAGE page, int index) {
+    FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, index);
+    if (!annot) return;
+    int flags = FPDFAnnot_GetFlags(annot);
+    FPDFAnnot_SetFlags(annot, flags | FPDF_ANNOT_FLAG_HIDDEN);
+    saved_.emplace_back(annot, flags);
+  }
+
+ private:
+  std::vector<std::pair<FPDF_ANNOTATION, int>> saved_;
+};
+
+/**
+ * A second instance of a page with every content object removed, for
+ * rendering its annotations alone.  Annotations live in the shared page
+ * dictionary, so they are all there, current edits included; the
+ * removed objects belong to this instance only.  Close it with
+ * FPDF_ClosePage and never generate its content, and the document is
+ * left exactly as it was.
+ */
+static FPDF_PAGE LoadBarePage(FPDF_DOCUMENT doc, int pageIndex) {
+  FPDF_PAGE bare = FPDF_LoadPage(doc, pageIndex);
+  if (!bare) return nullptr;
+  for (int i = FPDFPage_CountObjects(bare) - 1; i >= 0; i--) {
+    FPDF_PAGEOBJECT obj = FPDFPage_GetObject(bare, i);
+    if (FPDFPage_RemoveObject(bare, obj)) FPDFPageObj_Destroy(obj);
+  }
+  return bare;
+}
+
 Napi::Value RenderPage(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
 
   // ── Validate arguments ──────────────────────────────────────────
   if (info.Length() < 3 ||
@@ -32,6 +95,47 @@ Napi::Value RenderPage(const Napi::CallbackInfo& info) {
   int pageIndex   = info[1].As<Napi::Number>().Int32Value();
   double scale    = info[2].As<Napi::Number>().DoubleValue();
 
+  // Optional { layer?: 'page' | 'content' | 'annotations', annotations?: number[],
+  //            rotation?: 0 | 1 | 2 | 3 }
+  RenderLayer layer = RenderLayer::Page;
+  int rotation = 0;
+  bool subset = false;
+  std::set<int> shownAnnots;
+  if (info.Length() > 3 && info[3].IsObject()) {
+    Napi::Object options = info[3].As<Napi::Object>();
+    Napi::Value layerValue = options.Get("layer");
+    if (layerValue.IsString()) {
+      std::string name = layerValue.As<Napi::String>().Utf8Value();
+      if (name == "content") {
+        layer = RenderLayer::Content;
+      } else if (name == "annotations") {
+        layer = RenderLayer::Annotations;
+      } else if (name != "page") {
+        Napi::TypeError::New(env, "renderPage: unknown layer '" + name + "'")
+          .ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+    }
+    Napi::Value annots = options.Get("annotations");
+    if (annots.IsArray()) {
+      Napi::Array arr = annots.As<Napi::Array>();
+      subset = true;
+      for (uint32_t i = 0; i < arr.Length(); ++i) {
+        Napi::Value v = arr.Get(i);
+        if (v.IsNumber()) shownAnnots.insert(v.As<Napi::Number>().Int32Value());
+      }
+    }
+    Napi::Value rotationValue = options.Get("rotation");
+    if (rotationValue.IsNumber()) {
+      rotation = rotationValue.As<Napi::Number>().Int32Value();
+      if (rotation < 0 || rotation > 3) {
+        Napi::RangeError::New(env, "renderPage: rotation must be 0-3 quarter turns")
+          .ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+    }
+  }
+
   FPDF_DOCUMENT doc = RequireDocument(env, handle);
   if (!doc) return env.Undefined();
 
@@ -64,9 +168,10 @@ Napi::Value RenderPage(const Napi::CallbackInfo& info) {
   double pageWidthPt  = FPDF_GetPageWidthF(page);
   double pageHeightPt = FPDF_GetPageHeightF(page);
 
-  // Scaled pixel dimensions
+  // Scaled pixel dimensions; a quarter turn swaps them.
   int width  = static_cast<int>(pageWidthPt  * scale + 0.5);
   int height = static_cast<int>(pageHeightPt * scale + 0.5);
+  if (rotation % 2) std::swap(width, height);
 
   if (width <= 0 || height <= 0) {
     ReleasePage(handle, pageIndex, page, fromCache);
@@ -75,6 +180,35 @@ Napi::Value RenderPage(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
+  // Some annotation layers need no bitmap: say so instead of rendering
+  // (and shipping) one.
+  const int annotCount = FPDFPage_GetAnnotCount(page);
+  if (layer == RenderLayer::Annotations) {
+    bool empty = true;
+    bool separable = true;
+    for (int i = 0; i < annotCount && separable; i++) {
+      if (subset && !shownAnnots.count(i)) continue;
+      empty = false;
+      // Highlights multiply onto the text beneath; on a transparent
+      // layer there is nothing to multiply with.
+      FPDF_ANNOTATION annot = FPDFPage_GetAnnot(page, i);
+      if (annot && FPDFAnnot_GetSubtype(annot) == FPDF_ANNOT_HIGHLIGHT) {
+        separable = false;
+      }
+      if (annot) FPDFPage_CloseAnnot(annot);
+    }
+    if (empty || !separable) {
+      ReleasePage(handle, pageIndex, page, fromCache);
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("data",      Napi::Buffer<uint8_t>::New(env, 0));
+      result.Set("width",     Napi::Number::New(env, width));
+      result.Set("height",    Napi::Number::New(env, height));
+      result.Set("empty",     Napi::Boolean::New(env, empty));
+      result.Set("separable", Napi::Boolean::New(env, separable));
+      return result;
+    }
+  }
+
   // ── Create bitmap and render ────────────────────────────────────
   // Format 4 = FPDFBitmap_BGRA (Blue-Green-Red-Alpha, 4 bytes/pixel)
   FPDF_BITMAP bitmap = FPDFBitmap_Create(width, height, /*alpha=*/1);
@@ -85,17 +219,44 @@ Napi::Value RenderPage(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  // Fill with opaque white background (ARGB 0xFFFFFFFF)
-  FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0xFFFFFFFF);
+  if (layer == RenderLayer::Annotations) {
+    // Transparent background, drawn on a bare copy of the page so the
+    // open page's objects are never touched.
+    FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0x00000000);
 
-  // Render the page onto the bitmap
-  FPDF_RenderPageBitmap(
-    bitmap, page,
-    /*start_x=*/0, /*start_y=*/0,
-    /*size_x=*/width, /*size_y=*/height,
-    /*rotation=*/0,
-    RENDER_FLAGS
-  );
+    FPDF_PAGE bare = LoadBarePage(doc, pageIndex);
+    if (!bare) {
+      FPDFBitmap_Destroy(bitmap);
+      ReleasePage(handle, pageIndex, page, fromCache);
+      Napi::Error::New(env,
+        "renderPage: failed to load page " + std::to_string(pageIndex)
+      ).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    {
+      HiddenAnnotations hiddenAnnots;
+      if (subset) {
+        for (int i = 0; i < annotCount; i++) {
+          if (!shownAnnots.count(i)) hiddenAnnots.Hide(bare, i);
+        }
+      }
+      FPDF_RenderPageBitmap(bitmap, bare, 0, 0, width, height, rotation,
+                            ANNOTATION_RENDER_FLAGS);
+    }
+    FPDF_ClosePage(bare);
+  } else {
+    // Fill with opaque white background (ARGB 0xFFFFFFFF)
+    FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0xFFFFFFFF);
+
+    // Render the page onto the bitmap
+    FPDF_RenderPageBitmap(
+      bitmap, page,
+      /*start_x=*/0, /*start_y=*/0,
+      /*size_x=*/width, /*size_y=*/height,
+      rotation,
+      layer == RenderLayer::Content ? CONTENT_RENDER_FLAGS : RENDER_FLAGS
+    );
+  }
 
   // ── Convert BGRA → RGBA and copy to Node Buffer ────────────────
   uint8_t* src    = static_cast<uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
@@ -133,5 +294,123 @@ Napi::Value RenderPage(const Napi::CallbackInfo& info) {
   result.Set("data",   resultBuf);
   result.Set("width",  Napi::Number::New(env, width));
   result.Set("height", Napi::Number::New(env, height));
+  if (layer == RenderLayer::Annotations) {
+    result.Set("empty",     Napi::Boolean::New(env, false));
+    result.Set("separable", Napi::Boolean::New(env, true));
+  }
   return result;
 }
+
+// ── compositeLayers ─────────────────────────────────────────────────
+
+Napi::Value CompositeLayers(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  // Pure pixel work: no PDFium calls, so no lock.
+
+  if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsBuffer()) {
+    Napi::TypeError::New(env,
+      "compositeLayers: requires (base: Buffer, overlay: Buffer)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto base    = info[0].As<Napi::Buffer<uint8_t>>();
+  auto overlay = info[1].As<Napi::Buffer<uint8_t>>();
+  if (base.Length() != overlay.Length() || base.Length() % 4 != 0) {
+    Napi::RangeError::New(env,
+      "compositeLayers: layers must be RGBA bitmaps of the same size"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto resultBuf = Napi::Buffer<uint8_t>::Copy(env, base.Data(), base.Length());
+  // Rows are tightly packed, so the whole bitmap blends as one run.
+  BlendRowOver(resultBuf.Data(), overlay.Data(),
+               static_cast<int>(base.Length() / 4));
+  return resultBuf;
+}
+
+// ── rotateBitmap ────────────────────────────────────────────────────
+
+Napi::Value RotateBitmap(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  // Pure pixel work: no PDFium calls, so no lock.
+
+  if (info.Length() < 4 || !info[0].IsBuffer() || !info[1].IsNumber() ||
+      !info[2].IsNumber() || !info[3].IsNumber()) {
+    Napi::TypeError::New(env,
+      "rotateBitmap: requires (data: Buffer, width: number, height: number, "
+      "quarterTurns: number)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto data = info[0].As<Napi::Buffer<uint8_t>>();
+  int width  = info[1].As<Napi::Number>().Int32Value();
+  int height = info[2].As<Napi::Number>().Int32Value();
+  int turns  = ((info[3].As<Napi::Number>().Int32Value() % 4) + 4) % 4;
+  if (width <= 0 || height <= 0 ||
+      data.Length() != static_cast<size_t>(width) * height * 4) {
+    Napi::RangeError::New(env,
+      "rotateBitmap: data must be a width × height RGBA bitmap"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto resultBuf = Napi::Buffer<uint8_t>::New(env, data.Length());
+  RotatePixels(data.Data(), width, height, turns, resultBuf.Data());
+  return resultBuf;
+}
+
+// ── filterBitmap ────────────────────────────────────────────────────
+
+Napi::Value FilterBitmap(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  // Pure pixel work: no PDFium calls, so no lock.
+
+  if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsString() ||
+      (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsBuffer())) {
+    Napi::TypeError::New(env,
+      "filterBitmap: requires (data: Buffer, filter: string, target?: Buffer)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto data = info[0].As<Napi::Buffer<uint8_t>>();
+  std::string name = info[1].As<Napi::String>().Utf8Value();
+  ViewFilter filter;
+  if (name == "invert") {
+    filter = ViewFilter::Invert;
+  } else if (name == "dark") {
+    filter = ViewFilter::Dark;
+  } else if (name == "contrast") {
+    filter = ViewFilter::Contrast;
+  } else {
+    Napi::RangeError::New(env,
+      "filterBitmap: filter must be 'invert', 'dark' or 'contrast'"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (data.Length() % 4 != 0) {
+    Napi::RangeError::New(env,
+      "filterBitmap: data must be an RGBA bitmap"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Buffer<uint8_t> resultBuf;
+  if (info.Length() > 2 && info[2].IsBuffer()) {
+    resultBuf = info[2].As<Napi::Buffer<uint8_t>>();
+    if (resultBuf.Length() != data.Length()) {
+      Napi::RangeError::New(env,
+        "filterBitmap: target must be the size of data"
+      ).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  } else {
+    resultBuf = Napi::Buffer<uint8_t>::New(env, data.Length());
+  }
+  FilterPixels(data.Data(), static_cast<int>(data.Length() / 4), filter,
+               resultBuf.Data());
+  return resultBuf;
+}
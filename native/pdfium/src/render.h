@@ -7,9 +7,46 @@
 #include <napi.h>
 
 /**
- * renderPage(handle, pageIndex, scale)
- * → { data: Buffer (RGBA), width: number, height: number }
+ * renderPage(handle, pageIndex, scale, options?)
+ * → { data: Buffer (RGBA), width, height, empty?: boolean, separable?: boolean }
+ *
+ * options: { layer?: 'page' | 'content' | 'annotations' = 'page',
+ *            annotations?: number[], rotation?: 0 | 1 | 2 | 3 }
+ *
+ * 'content' is the page without annotations, on white.  'annotations'
+ * is the annotations alone, straight alpha on transparent, limited to
+ * the given annotation indices when `annotations` is passed.  Blending
+ * it over the content layer gives 'page'.  `data` is zero-length when
+ * `empty` (nothing to draw) or not `separable` (a highlight, whose
+ * multiply blend needs the content beneath — render 'page' instead).
+ * `rotation` turns the page clockwise in quarter turns; odd turns swap
+ * width and height.
  */
 Napi::Value RenderPage(const Napi::CallbackInfo& info);
 
+/**
+ * compositeLayers(base: Buffer, overlay: Buffer) → Buffer
+ * Blends a straight-alpha RGBA overlay over an opaque RGBA base of the
+ * same size, returning a new buffer.
+ */
+Napi::Value CompositeLayers(const Napi::CallbackInfo& info);
+
+/**
+ * rotateBitmap(data: Buffer, width, height, quarterTurns) → Buffer
+ * Turns a tightly packed RGBA bitmap clockwise by whole quarter turns,
+ * returning a new buffer (height × width for odd turns).  Lets a cached
+ * raster serve a rotated view without going back to PDFium.
+ */
+Napi::Value RotateBitmap(const Napi::CallbackInfo& info);
+
+/**
+ * filterBitmap(data: Buffer, filter: 'invert' | 'dark' | 'contrast',
+ *              target?: Buffer) → Buffer
+ * Applies a reading-mode filter to an RGBA bitmap (or a patch of one)
+ * in a single pass, alpha unchanged.  Writes into `target`, which may
+ * be `data` itself, or else a new buffer.  Lets one cached raster serve
+ * every reading mode without going back to PDFium.
+ */
+Napi::Value FilterBitmap(const Napi::CallbackInfo& info);
+
 #endif // PDFIUM_ADDON_RENDER_H
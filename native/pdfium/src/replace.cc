@@ -0,0 +1,321 @@
+/**
+ * replace.cc — Whole-document find and replace in text objects.
+ *
+ * Hits are found in the cached page text and mapped back to the text
+ * objects that drew them through TextPageData::objects.  Each touched
+ * object gets its new text in one FPDFText_SetText call, so a page costs
+ * one lookup and one write per object however many hits it has.
+ */
+
+#include "common.h"
+#include "replace.h"
+#include "jobs.h"
+#include "regexsearch.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+#include <fpdf_text.h>
+
+#include <algorithm>
+#include <cwctype>
+#include <map>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/** A match with its replacement; literal hits share the regex shape. */
+using Hit = RegexMatch;
+
+struct ReplaceSpec {
+  std::wstring literal;
+  std::wregex pattern;
+  bool regex = false;
+  bool caseSensitive = false;
+  bool wholeWord = false;
+  std::wstring replacement;
+};
+
+wchar_t Fold(wchar_t c) {
+  return static_cast<wchar_t>(std::towlower(c));
+}
+
+/**
+ * Text object that drew each char, or -1.  PDFium inserts generated
+ * spaces for wide TJ gaps; those between two chars of the same object
+ * belong to it, so "Acme Corp" in one object can be matched and its
+ * replacement keeps a real space there.
+ */
+std::vector<int> CharOwners(const TextPageData& text) {
+  std::vector<int> owner(text.objects);
+  const size_t n = owner.size();
+  for (size_t i = 0; i < n;) {
+    if (!text.generated[i] || text.chars[i] != L' ') { i++; continue; }
+    size_t j = i;
+    while (j < n && text.generated[j] && text.chars[j] == L' ') j++;
+    int before = i > 0 ? text.objects[i - 1] : -1;
+    int after = j < n ? text.objects[j] : -1;
+    if (before >= 0 && before == after) {
+      std::fill(owner.begin() + i, owner.begin() + j, before);
+    }
+    i = j;
+  }
+  return owner;
+}
+
+/** Text of one text object as PDFium reads it back, UTF-16. */
+std::u16string ObjectText(FPDF_PAGEOBJECT obj, FPDF_TEXTPAGE textPage) {
+  const unsigned long bytes = FPDFTextObj_GetText(obj, textPage, nullptr, 0);
+  if (bytes < sizeof(char16_t)) return std::u16string();
+  std::u16string text(bytes / sizeof(char16_t), u'\0');
+  FPDFTextObj_GetText(obj, textPage, reinterpret_cast<FPDF_WCHAR*>(&text[0]), bytes);
+  while (!text.empty() && text.back() == u'\0') text.pop_back();
+  return text;
+}
+
+// ── ReplaceJob ──────────────────────────────────────────────────────
+
+class ReplaceJob : public PageJob {
+ public:
+  ReplaceJob(Napi::Env env, int handle, std::vector<int> pages,
+             Napi::Value onProgress, ReplaceSpec spec)
+    : PageJob(env, handle, std::move(pages), onProgress),
+      spec_(std::move(spec)) {}
+
+ protected:
+  bool ProcessPage(FPDF_DOCUMENT doc, int pageIndex,
+                   std::string& error) override {
+    // Edited pages are kept open (see CachedPage), so earlier edits are
+    // searched as they now read.
+    bool fromCache = false;
+    FPDF_PAGE page = AcquirePage(handle_, doc, pageIndex, fromCache);
+    if (!page) {
+      error = "findReplace: failed to load page " + std::to_string(pageIndex);
+      return false;
+    }
+
+    auto text = GetTextPageData(handle_, pageIndex, page);
+    size_t tooLong = 0;
+    std::vector<Hit> hits = FindHits(text->chars, tooLong);
+    matches_ += hits.size() + tooLong;
+    skipped_ += tooLong;
+    if (hits.empty()) {
+      ReleasePage(handle_, pageIndex, page, fromCache);
+      return true;
+    }
+
+    std::vector<int> owner = CharOwners(*text);
+    std::map<int, std::vector<Hit>> byObject;
+    for (Hit& hit : hits) {
+      const int o = owner[hit.start];
+      bool single = o >= 0;
+      for (size_t i = hit.start; single && i < hit.end; i++) {
+        single = owner[i] == o;
+      }
+      if (single) {
+        byObject[o].push_back(std::move(hit));
+      } else {
+        skipped_++;
+      }
+    }
+
+    // Chars of each touched object, in reading order.
+    std::map<int, std::vector<size_t>> objectChars;
+    for (size_t i = 0; i < owner.size(); i++) {
+      if (owner[i] >= 0 && byObject.count(owner[i])) objectChars[owner[i]].push_back(i);
+    }
+
+    // The object's own text, to check the chars mapped to it against.
+    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(page);
+    if (!textPage) {
+      for (const auto& entry : byObject) skipped_ += entry.second.size();
+      byObject.clear();
+    }
+
+    int replacedHere = 0;
+    for (auto& [objIndex, objHits] : byObject) {
+      FPDF_PAGEOBJECT obj = FPDFPage_GetObject(page, objIndex);
+      if (!obj || FPDFPageObj_GetType(obj) != FPDF_PAGEOBJ_TEXT) {
+        skipped_ += objHits.size();
+        continue;
+      }
+
+      std::u16string original, updated;
+      const std::vector<size_t>& chars = objectChars[objIndex];
+      size_t next = 0;
+      for (size_t j = 0; j < chars.size();) {
+        if (next < objHits.size() && chars[j] == objHits[next].start) {
+          for (wchar_t c : objHits[next].replacement) AppendUtf16(updated, c);
+          for (; j < chars.size() && chars[j] < objHits[next].end; j++) {
+            AppendUtf16(original, text->chars[chars[j]]);
+          }
+          next++;
+          continue;
+        }
+        AppendUtf16(original, text->chars[chars[j]]);
+        AppendUtf16(updated, text->chars[chars[j]]);
+        j++;
+      }
+
+      // SetText replaces the whole object, so the text it is rebuilt
+      // from must be all of it, in order.  If the page's chars do not
+      // read back as the object's text (reordered or partly shared
+      // glyphs), leave it alone rather than rewrite it from a fragment.
+      if (original != ObjectText(obj, textPage)) {
+        skipped_ += objHits.size();
+        continue;
+      }
+
+      if (!FPDFText_SetText(obj, reinterpret_cast<FPDF_WIDESTRING>(updated.c_str()))) {
+        skipped_ += objHits.size();
+        continue;
+      }
+      replacedHere += static_cast<int>(objHits.size());
+      objectsChanged_++;
+    }
+    if (textPage) FPDFText_ClosePage(textPage);
+
+    if (replacedHere == 0) {
+      ReleasePage(handle_, pageIndex, page, fromCache);
+      return true;
+    }
+
+    // Content is regenerated at save time, as for editTextObject; the
+    // page stays open in the cache until then.
+    CachePageDirty(handle_, pageIndex, page);
+    replaced_ += replacedHere;
+    pageHits_.emplace_back(pageIndex, replacedHere);
+    return true;
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("matches",  Napi::Number::New(env, static_cast<double>(matches_)));
+    result.Set("replaced", Napi::Number::New(env, static_cast<double>(replaced_)));
+    result.Set("skipped",  Napi::Number::New(env, static_cast<double>(skipped_)));
+    result.Set("objectsChanged", Napi::Number::New(env, objectsChanged_));
+
+    Napi::Array pages = Napi::Array::New(env, pageHits_.size());
+    for (size_t i = 0; i < pageHits_.size(); i++) {
+      Napi::Object entry = Napi::Object::New(env);
+      entry.Set("pageIndex", Napi::Number::New(env, pageHits_[i].first));
+      entry.Set("replaced",  Napi::Number::New(env, pageHits_[i].second));
+      pages[static_cast<uint32_t>(i)] = entry;
+    }
+    result.Set("pages", pages);
+    return result;
+  }
+
+ private:
+  /**
+   * Non-overlapping hits, left to right, each with its replacement.
+   * Regex matches too long to search safely are counted in `tooLong`.
+   */
+  std::vector<Hit> FindHits(const std::wstring& chars, size_t& tooLong) const {
+    std::vector<Hit> hits;
+
+    if (spec_.regex) {
+      tooLong = FindRegexMatches(chars, spec_.pattern, spec_.replacement, hits);
+    } else {
+      const std::wstring& needle = spec_.literal;
+      std::wstring haystack = chars;
+      if (!spec_.caseSensitive) {
+        std::transform(haystack.begin(), haystack.end(), haystack.begin(), Fold);
+      }
+      for (size_t at = haystack.find(needle); at != std::wstring::npos;
+           at = haystack.find(needle, at + needle.size())) {
+        hits.push_back({ at, at + needle.size(), spec_.replacement });
+      }
+    }
+
+    if (spec_.wholeWord) {
+      auto isWordChar = [&](size_t i) { return std::iswalnum(chars[i]) != 0; };
+      hits.erase(std::remove_if(hits.begin(), hits.end(),
+        [&](const Hit& h) {
+          return (h.start > 0 && isWordChar(h.start - 1)) ||
+                 (h.end < chars.size() && isWordChar(h.end));
+        }), hits.end());
+    }
+    return hits;
+  }
+
+  const ReplaceSpec spec_;
+
+  size_t matches_ = 0;
+  size_t replaced_ = 0;
+  size_t skipped_ = 0;
+  int objectsChanged_ = 0;
+  std::vector<std::pair<int, int>> pageHits_;
+};
+
+}  // namespace
+
+// ── findReplace ─────────────────────────────────────────────────────
+
+Napi::Value FindReplace(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsString() ||
+      !info[2].IsString()) {
+    Napi::TypeError::New(env,
+      "findReplace: requires (handle: number, pattern: string, "
+      "replacement: string, options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  Napi::Value options    = info.Length() > 3 ? info[3] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 4 ? info[4] : env.Undefined();
+
+  ReplaceSpec spec;
+  spec.regex         = GetBoolOption(options, "regex", false);
+  spec.caseSensitive = GetBoolOption(options, "caseSensitive", false);
+  spec.wholeWord     = GetBoolOption(options, "wholeWord", false);
+  spec.replacement   = ToTextPageChars(info[2].As<Napi::String>().Utf16Value());
+
+  std::wstring pattern = ToTextPageChars(info[1].As<Napi::String>().Utf16Value());
+  if (pattern.empty()) {
+    Napi::RangeError::New(env, "findReplace: pattern must not be empty")
+      .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  if (spec.regex) {
+    auto flags = std::regex::ECMAScript | std::regex::optimize;
+    if (!spec.caseSensitive) flags |= std::regex::icase;
+    try {
+      spec.pattern.assign(pattern, flags);
+    } catch (const std::regex_error& e) {
+      Napi::TypeError::New(env,
+        std::string("findReplace: invalid pattern: ") + e.what()
+      ).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  } else {
+    if (!spec.caseSensitive) {
+      std::transform(pattern.begin(), pattern.end(), pattern.begin(), Fold);
+    }
+    spec.literal = std::move(pattern);
+  }
+
+  std::vector<int> pages;
+  Napi::Value pagesArg = options.IsObject()
+    ? options.As<Napi::Object>().Get("pages")
+    : env.Undefined();
+  if (!ReadPageList(env, pagesArg, FPDF_GetPageCount(doc),
+                    "findReplace", pages)) {
+    return env.Undefined();
+  }
+
+  auto* job = new ReplaceJob(env, handle, std::move(pages), onProgress,
+                             std::move(spec));
+  return job->Start();
+}
@@ -0,0 +1,27 @@
+/**
+ * replace.h — Whole-document find and replace in text objects.
+ */
+#ifndef PDFIUM_ADDON_REPLACE_H
+#define PDFIUM_ADDON_REPLACE_H
+
+#include <napi.h>
+
+/**
+ * findReplace(handle, pattern, replacement, options?, onProgress?)
+ * → { jobId, done: Promise<{ matches, replaced, skipped, objectsChanged,
+ *                            pages: [{ pageIndex, replaced }] }> }
+ *
+ * options: { regex?: boolean = false, caseSensitive?: boolean = false,
+ *            wholeWord?: boolean = false, pages?: number[] }
+ *
+ * With `regex`, `pattern` is an ECMAScript regular expression and
+ * `replacement` may refer to groups ($1, $&).  A hit is replaced when
+ * all its chars were drawn by one top-level text object whose own text
+ * (FPDFTextObj_GetText) reads the same as those chars.  Other hits —
+ * spanning objects, inside form XObjects, or regex matches longer than
+ * the search window (see regexsearch.h) — are counted as `skipped`.
+ * Edited pages stay in the page cache, dirty, as with editTextObject.
+ */
+Napi::Value FindReplace(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_REPLACE_H
@@ -0,0 +1,286 @@
+/**
+ * sha256.cc — Incremental SHA-256 (FIPS 180-4).
+ */
+
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SHA256_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_SHA2)
+#define SHA256_ARM 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+alignas(16) const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+  0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+  0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+  0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+  0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+  0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+using CompressFn = void (*)(uint32_t state[8], const uint8_t* data,
+                            size_t blocks);
+
+// ── Portable ────────────────────────────────────────────────────────
+
+inline uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+void CompressPortable(uint32_t state[8], const uint8_t* data, size_t blocks) {
+  uint32_t w[64];
+  for (; blocks > 0; --blocks, data += 64) {
+    for (int i = 0; i < 16; ++i) {
+      w[i] = (uint32_t(data[i * 4]) << 24) | (uint32_t(data[i * 4 + 1]) << 16) |
+             (uint32_t(data[i * 4 + 2]) << 8) | uint32_t(data[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+      uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+      uint32_t s1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+      uint32_t t1 = h + s1 + ((e & f) ^ (~e & g)) + K[i] + w[i];
+      uint32_t s0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+      uint32_t t2 = s0 + ((a & b) ^ (a & c) ^ (b & c));
+      h = g; g = f; f = e; e = d + t1;
+      d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+  }
+}
+
+// ── x86 SHA extensions ──────────────────────────────────────────────
+
+#ifdef SHA256_X86
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SHA256_TARGET __attribute__((target("sha,sse4.1")))
+#else
+#define SHA256_TARGET
+#endif
+
+SHA256_TARGET
+void CompressShaNi(uint32_t state[8], const uint8_t* data, size_t blocks) {
+  const __m128i byteSwap =
+    _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  // The instructions want the state as ABEF / CDGH.
+  __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+  __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);
+  state1 = _mm_shuffle_epi32(state1, 0x1B);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+  for (; blocks > 0; --blocks, data += 64) {
+    const __m128i abefSave = state0;
+    const __m128i cdghSave = state1;
+
+    __m128i msgs[4];
+    for (int i = 0; i < 4; ++i) {
+      msgs[i] = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)),
+        byteSwap);
+    }
+
+    // Sixteen groups of four rounds; the message schedule for group
+    // i + 4 is built in place while group i runs.
+    for (int i = 0; i < 16; ++i) {
+      __m128i& cur = msgs[i & 3];
+      __m128i& prev = msgs[(i + 3) & 3];
+      __m128i& next = msgs[(i + 1) & 3];
+
+      __m128i msg = _mm_add_epi32(
+        cur, _mm_load_si128(reinterpret_cast<const __m128i*>(&K[i * 4])));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      if (i >= 3 && i <= 14) {
+        next = _mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4));
+        next = _mm_sha256msg2_epu32(next, cur);
+      }
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+      if (i >= 1 && i <= 12) {
+        prev = _mm_sha256msg1_epu32(prev, cur);
+      }
+    }
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+  state1 = _mm_alignr_epi8(state1, tmp, 8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+bool CpuHasShaNi() {
+  unsigned int leaf1[4] = {}, leaf7[4] = {};
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuid(regs, 0);
+  if (regs[0] < 7) return false;
+  __cpuid(regs, 1);
+  std::memcpy(leaf1, regs, sizeof(leaf1));
+  __cpuidex(regs, 7, 0);
+  std::memcpy(leaf7, regs, sizeof(leaf7));
+#else
+  if (__get_cpuid_max(0, nullptr) < 7) return false;
+  __cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+  __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+#endif
+  const bool ssse3 = leaf1[2] & (1u << 9);
+  const bool sse41 = leaf1[2] & (1u << 19);
+  const bool sha   = leaf7[1] & (1u << 29);
+  return ssse3 && sse41 && sha;
+}
+
+#endif // SHA256_X86
+
+// ── ARMv8 crypto extensions ─────────────────────────────────────────
+
+#ifdef SHA256_ARM
+
+void CompressArm(uint32_t state[8], const uint8_t* data, size_t blocks) {
+  uint32x4_t state0 = vld1q_u32(&state[0]);
+  uint32x4_t state1 = vld1q_u32(&state[4]);
+
+  for (; blocks > 0; --blocks, data += 64) {
+    const uint32x4_t abcdSave = state0;
+    const uint32x4_t efghSave = state1;
+
+    uint32x4_t msgs[4];
+    for (int i = 0; i < 4; ++i) {
+      msgs[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+    }
+
+    for (int i = 0; i < 16; ++i) {
+      uint32x4_t& cur = msgs[i & 3];
+      const uint32x4_t wk = vaddq_u32(cur, vld1q_u32(&K[i * 4]));
+      if (i < 12) {
+        cur = vsha256su1q_u32(vsha256su0q_u32(cur, msgs[(i + 1) & 3]),
+                              msgs[(i + 2) & 3], msgs[(i + 3) & 3]);
+      }
+      const uint32x4_t abcd = state0;
+      state0 = vsha256hq_u32(state0, state1, wk);
+      state1 = vsha256h2q_u32(state1, abcd, wk);
+    }
+
+    state0 = vaddq_u32(state0, abcdSave);
+    state1 = vaddq_u32(state1, efghSave);
+  }
+
+  vst1q_u32(&state[0], state0);
+  vst1q_u32(&state[4], state1);
+}
+
+#endif // SHA256_ARM
+
+CompressFn SelectCompress() {
+#if defined(SHA256_ARM)
+  return CompressArm;
+#elif defined(SHA256_X86)
+  return CpuHasShaNi() ? CompressShaNi : CompressPortable;
+#else
+  return CompressPortable;
+#endif
+}
+
+const CompressFn g_compress = SelectCompress();
+
+}  // namespace
+
+// ── Sha256 ──────────────────────────────────────────────────────────
+
+Sha256::Sha256()
+  : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+           0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+void Sha256::Update(const void* data, size_t size) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  totalLen_ += size;
+
+  if (blockLen_ > 0) {
+    size_t take = std::min(size, sizeof(block_) - blockLen_);
+    std::memcpy(block_ + blockLen_, bytes, take);
+    blockLen_ += take;
+    bytes += take;
+    size -= take;
+    if (blockLen_ < sizeof(block_)) return;
+    g_compress(state_, block_, 1);
+    blockLen_ = 0;
+  }
+
+  // Whole blocks straight from the caller's buffer.
+  size_t blocks = size / 64;
+  if (blocks > 0) {
+    g_compress(state_, bytes, blocks);
+    bytes += blocks * 64;
+    size -= blocks * 64;
+  }
+
+  std::memcpy(block_, bytes, size);
+  blockLen_ = size;
+}
+
+void Sha256::Final(uint8_t digest[32]) {
+  const uint64_t bitLen = totalLen_ * 8;
+
+  block_[blockLen_++] = 0x80;
+  if (blockLen_ > 56) {
+    std::memset(block_ + blockLen_, 0, sizeof(block_) - blockLen_);
+    g_compress(state_, block_, 1);
+    blockLen_ = 0;
+  }
+  std::memset(block_ + blockLen_, 0, 56 - blockLen_);
+  for (int i = 0; i < 8; ++i) {
+    block_[56 + i] = static_cast<uint8_t>(bitLen >> (56 - i * 8));
+  }
+  g_compress(state_, block_, 1);
+
+  for (int i = 0; i < 8; ++i) {
+    digest[i * 4]     = static_cast<uint8_t>(state_[i] >> 24);
+    digest[i * 4 + 1] = static_cast<uint8_t>(state_[i] >> 16);
+    digest[i * 4 + 2] = static_cast<uint8_t>(state_[i] >> 8);
+    digest[i * 4 + 3] = static_cast<uint8_t>(state_[i]);
+  }
+}
+
+std::string Sha256::FinalHex() {
+  static const char HEX[] = "0123456789abcdef";
+  uint8_t digest[32];
+  Final(digest);
+
+  std::string hex(64, '0');
+  for (int i = 0; i < 32; ++i) {
+    hex[i * 2]     = HEX[digest[i] >> 4];
+    hex[i * 2 + 1] = HEX[digest[i] & 0x0f];
+  }
+  return hex;
+}
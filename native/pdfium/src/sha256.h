@@ -0,0 +1,35 @@
+/**
+ * sha256.h — Incremental SHA-256.
+ *
+ * Uses the x86 SHA extensions or the ARMv8 crypto extensions when the
+ * CPU has them, and a portable implementation otherwise.  Signing
+ * hashes whole documents, so the hardware path matters: it is several
+ * times faster than the portable one.
+ */
+#ifndef PDFIUM_ADDON_SHA256_H
+#define PDFIUM_ADDON_SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Sha256 {
+ public:
+  Sha256();
+
+  void Update(const void* data, size_t size);
+
+  /** Finish and write the 32-byte digest.  The object is then spent. */
+  void Final(uint8_t digest[32]);
+
+  /** Finish and return the digest as lower-case hex. */
+  std::string FinalHex();
+
+ private:
+  uint32_t state_[8];
+  uint8_t  block_[64];
+  size_t   blockLen_ = 0;
+  uint64_t totalLen_ = 0;
+};
+
+#endif // PDFIUM_ADDON_SHA256_H
@@ -0,0 +1,819 @@
+/**
+ * sign.cc — Prepare a document for a detached signature.
+ *
+ * PDFium can save a document but cannot create signature dictionaries,
+ * so the signature field is added as a small hand-written incremental
+ * update after FPDF_SaveAsCopy's output:
+ *
+ *   1. The save is streamed to disk from a background job, holding
+ *      g_pdfiumMutex only for FPDF_SaveAsCopy; a tap hashes every block
+ *      and keeps the last few kilobytes, which hold the trailer.
+ *   2. The catalog, first page and AcroForm are read back by offset
+ *      through the cross-reference table — a handful of small objects,
+ *      whatever the file size.
+ *   3. The update (edited objects, widget, signature dictionary, xref,
+ *      trailer) is laid out in memory with a fixed-width /ByteRange, so
+ *      every offset is known before it is written.  Its bytes outside
+ *      the /Contents placeholder finish the hash, then it is appended.
+ *
+ * So the digest costs one pass over the output and constant memory,
+ * and embedSignature later patches the placeholder in place.
+ */
+
+#include "common.h"
+#include "sign.h"
+#include "document.h"
+#include "jobs.h"
+#include "pdfscan.h"
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t DEFAULT_PLACEHOLDER_BYTES = 16384;
+constexpr size_t MAX_PLACEHOLDER_BYTES = 1 << 20;
+
+/** Bytes kept from the end of the saved file to find its trailer. */
+constexpr size_t TRAILER_TAIL_BYTES = 8192;
+
+/** Largest object read back (catalog, page, AcroForm, arrays). */
+constexpr size_t MAX_OBJECT_BYTES = 4 << 20;
+
+/** Width of each /ByteRange number, so it can be filled in after layout. */
+constexpr int BYTE_RANGE_DIGITS = 10;
+
+/** Standard xref entries are exactly 20 bytes, EOL included. */
+constexpr int XREF_ENTRY_BYTES = 20;
+
+constexpr size_t npos = std::string::npos;
+
+// ── PDF syntax ──────────────────────────────────────────────────────
+//
+// Dictionaries are edited as source text, so values are located with
+// the pdfscan lexer and copied or replaced byte for byte.
+
+PdfLexer Lexer(const std::string& s, size_t pos = 0) {
+  return PdfLexer(reinterpret_cast<const uint8_t*>(s.data()), s.size(), pos);
+}
+
+/**
+ * Span of the value starting at or after `pos` ("12 0 R" is one
+ * value); false if malformed.
+ */
+bool ValueSpan(const std::string& s, size_t pos, size_t& begin, size_t& end) {
+  PdfLexer lexer = Lexer(s, pos);
+  PdfToken first;
+  PdfObject value;
+  if (!Lexer(s, pos).Next(first) || !ParseObject(lexer, value)) return false;
+  begin = first.start;
+  end = lexer.Pos();
+  return true;
+}
+
+struct DictEntry {
+  std::string key;       ///< Without the leading '/'.
+  size_t valueBegin;
+  size_t valueEnd;
+};
+
+/** Top-level entries of the dictionary at the start of `s`. */
+bool ParseDict(const std::string& s, std::vector<DictEntry>& entries,
+               size_t& dictEnd) {
+  PdfLexer lexer = Lexer(s);
+  PdfToken token;
+  if (!lexer.Next(token) || token.type != PdfTokenType::DictOpen) return false;
+
+  entries.clear();
+  for (;;) {
+    if (!lexer.Next(token)) return false;
+    if (token.type == PdfTokenType::DictClose) {
+      dictEnd = lexer.Pos();
+      return true;
+    }
+    if (token.type != PdfTokenType::Name) return false;
+
+    DictEntry entry{DecodeName(token), 0, 0};
+    if (!ValueSpan(s, lexer.Pos(), entry.valueBegin, entry.valueEnd)) return false;
+    lexer.Seek(entry.valueEnd);
+    entries.push_back(std::move(entry));
+  }
+}
+
+/** Value of /key in the dictionary `dict`, as source text. */
+bool GetEntry(const std::string& dict, const char* key, std::string& value) {
+  std::vector<DictEntry> entries;
+  size_t end;
+  if (!ParseDict(dict, entries, end)) return false;
+  for (const auto& e : entries) {
+    if (e.key == key) {
+      value = dict.substr(e.valueBegin, e.valueEnd - e.valueBegin);
+      return true;
+    }
+  }
+  return false;
+}
+
+/** `dict` with /key replaced or added.  `dict` must parse. */
+std::string SetEntry(const std::string& dict, const char* key,
+                     const std::string& value) {
+  std::vector<DictEntry> entries;
+  size_t end = 0;
+  ParseDict(dict, entries, end);
+  for (const auto& e : entries) {
+    if (e.key == key) {
+      return dict.substr(0, e.valueBegin) + value + dict.substr(e.valueEnd);
+    }
+  }
+  return dict.substr(0, end - 2) + " /" + key + " " + value + " " +
+         dict.substr(end - 2);
+}
+
+/** `array` ("[ … ]") with `item` added at the end. */
+std::string AppendToArray(const std::string& array, const std::string& item) {
+  size_t close = array.rfind(']');
+  return array.substr(0, close) + " " + item + array.substr(close);
+}
+
+struct ObjRef {
+  long long num = 0;
+  int gen = 0;
+};
+
+bool ParseRef(const std::string& value, ObjRef& ref) {
+  PdfLexer lexer = Lexer(value);
+  PdfObject obj;
+  if (!ParseObject(lexer, obj) || obj.type != PdfObject::Ref || obj.num <= 0) {
+    return false;
+  }
+  ref.num = obj.num;
+  ref.gen = obj.gen;
+  return true;
+}
+
+std::string RefText(const ObjRef& ref) {
+  return std::to_string(ref.num) + " " + std::to_string(ref.gen) + " R";
+}
+
+/** A text string: literal when plain ASCII, otherwise UTF-16BE hex. */
+std::string PdfTextString(const std::u16string& text) {
+  bool ascii = std::all_of(text.begin(), text.end(),
+                           [](char16_t c) { return c >= 0x20 && c < 0x7f; });
+  if (ascii) {
+    std::string out = "(";
+    for (char16_t c : text) {
+      if (c == '(' || c == ')' || c == '\\') out += '\\';
+      out += static_cast<char>(c);
+    }
+    return out + ")";
+  }
+
+  static const char HEX[] = "0123456789ABCDEF";
+  std::string out = "<FEFF";
+  for (char16_t c : text) {
+    for (int shift = 12; shift >= 0; shift -= 4) out += HEX[(c >> shift) & 0xf];
+  }
+  return out + ">";
+}
+
+/** The current time as a PDF date string, e.g. (D:20240131120000Z). */
+std::string PdfDateNow() {
+  std::time_t now = std::time(nullptr);
+  std::tm utc{};
+#ifdef _WIN32
+  gmtime_s(&utc, &now);
+#else
+  gmtime_r(&now, &utc);
+#endif
+  char buf[32];
+  std::strftime(buf, sizeof(buf), "(D:%Y%m%d%H%M%SZ)", &utc);
+  return buf;
+}
+
+// ── Reading objects back ────────────────────────────────────────────
+
+/**
+ * Random access to the objects of a freshly saved file through its
+ * (single, classic) cross-reference table.  Only the sections needed
+ * are read: entries are fixed-width, so an object's entry is a seek.
+ */
+class ObjectReader {
+ public:
+  bool Open(const std::string& path, uint64_t xrefOffset, std::string& error) {
+    in_.open(std::filesystem::u8path(path), std::ios::binary);
+    xref_ = xrefOffset;
+    if (!in_) error = "could not reopen " + path;
+    return static_cast<bool>(in_);
+  }
+
+  /** Body of `ref`: the value between "obj" and "endobj". */
+  bool Read(const ObjRef& ref, std::string& body, std::string& error) {
+    if (!ReadBody(ref, body)) {
+      error = "object " + std::to_string(ref.num) + " is unreadable";
+      return false;
+    }
+    // Catalogs, pages and arrays are never streams.
+    size_t begin, end;
+    PdfToken after;
+    if (!ValueSpan(body, 0, begin, end) || Lexer(body, end).Next(after)) {
+      error = "object " + std::to_string(ref.num) + " is not a plain object";
+      return false;
+    }
+    body = body.substr(begin, end - begin);
+    return true;
+  }
+
+ private:
+  bool ReadBody(const ObjRef& ref, std::string& body) {
+    uint64_t offset;
+    if (!FindOffset(ref, offset)) return false;
+
+    std::string buf;
+    size_t endobj = npos;
+    for (size_t chunk = 4096; endobj == npos; chunk *= 2) {
+      if (buf.size() >= MAX_OBJECT_BYTES) return false;
+      size_t from = buf.size() > 6 ? buf.size() - 6 : 0;
+      size_t have = buf.size();
+      buf.resize(have + chunk);
+      in_.clear();
+      in_.seekg(static_cast<std::streamoff>(offset + have));
+      in_.read(&buf[have], static_cast<std::streamsize>(chunk));
+      buf.resize(have + static_cast<size_t>(in_.gcount()));
+      endobj = buf.find("endobj", from);
+      if (endobj == npos && buf.size() < have + chunk) return false;  // EOF
+    }
+
+    PdfLexer lexer = Lexer(buf);
+    PdfToken num, gen, obj;
+    if (!lexer.Next(num) || !lexer.Next(gen) || !lexer.Next(obj) ||
+        num.type != PdfTokenType::Number || num.number != ref.num ||
+        !obj.Is("obj") || lexer.Pos() > endobj) {
+      return false;
+    }
+
+    body = buf.substr(lexer.Pos(), endobj - lexer.Pos());
+    return true;
+  }
+
+  bool ReadLine(std::string& line) {
+    line.clear();
+    for (int c; (c = in_.get()) != EOF;) {
+      if (c == '\n') return true;
+      if (c == '\r') {
+        if (in_.peek() == '\n') in_.get();
+        return true;
+      }
+      line += static_cast<char>(c);
+    }
+    return !line.empty();
+  }
+
+  bool FindOffset(const ObjRef& ref, uint64_t& offset) {
+    in_.clear();
+    in_.seekg(static_cast<std::streamoff>(xref_));
+    std::string line;
+    if (!ReadLine(line) || line.compare(0, 4, "xref") != 0) return false;
+
+    while (ReadLine(line)) {
+      long long start = 0, count = 0;
+      if (line.compare(0, 7, "trailer") == 0 ||
+          std::sscanf(line.c_str(), "%lld %lld", &start, &count) != 2) {
+        return false;
+      }
+
+      std::streamoff section = in_.tellg();
+      if (ref.num < start || ref.num >= start + count) {
+        in_.seekg(section + static_cast<std::streamoff>(count * XREF_ENTRY_BYTES));
+        continue;
+      }
+
+      char entry[XREF_ENTRY_BYTES + 1] = {};
+      in_.seekg(section + static_cast<std::streamoff>(
+        (ref.num - start) * XREF_ENTRY_BYTES));
+      in_.read(entry, XREF_ENTRY_BYTES);
+
+      unsigned long long off = 0;
+      int gen = 0;
+      char type = 0;
+      if (std::sscanf(entry, "%llu %d %c", &off, &gen, &type) != 3 ||
+          type != 'n' || gen != ref.gen) {
+        return false;
+      }
+      offset = off;
+      return true;
+    }
+    return false;
+  }
+
+  std::ifstream in_;
+  uint64_t xref_ = 0;
+};
+
+// ── The incremental update ──────────────────────────────────────────
+
+struct SignatureFields {
+  std::u16string fieldName = u"Signature1";
+  std::u16string name;
+  std::u16string reason;
+  std::u16string location;
+  size_t placeholderSize = DEFAULT_PLACEHOLDER_BYTES;
+};
+
+struct Trailer {
+  uint64_t startxref = 0;
+  long long size = 0;
+  ObjRef root;
+  std::string info;   ///< Source text of /Info, if any.
+  std::string id;     ///< Source text of /ID, if any.
+};
+
+struct UpdatedObject {
+  ObjRef ref;
+  std::string body;
+};
+
+/** Find the last trailer and startxref of the saved file. */
+bool ParseTrailer(const std::string& tail, Trailer& trailer,
+                  std::string& error) {
+  size_t sx = tail.rfind("startxref");
+  unsigned long long startxref = 0;
+  if (sx == npos ||
+      std::sscanf(tail.c_str() + sx + 9, "%llu", &startxref) != 1) {
+    error = "saved file has no startxref";
+    return false;
+  }
+  trailer.startxref = startxref;
+
+  size_t keyword = tail.rfind("trailer", sx);
+  if (keyword == npos) {
+    error = "saved file uses a cross-reference stream";
+    return false;
+  }
+  std::string dict = tail.substr(keyword + 7, sx - keyword - 7);
+
+  PdfLexer lexer = Lexer(dict);
+  PdfObject parsed;
+  if (!ParseObject(lexer, parsed) || parsed.type != PdfObject::Dict) {
+    error = "saved file has a malformed trailer";
+    return false;
+  }
+  if (parsed.Get("Encrypt")) {
+    error = "encrypted documents cannot be signed";
+    return false;
+  }
+  const PdfObject* size = parsed.Get("Size");
+  const PdfObject* root = parsed.Get("Root");
+  if (!size || size->type != PdfObject::Number || size->Int() <= 0 ||
+      !root || root->type != PdfObject::Ref || root->num <= 0) {
+    error = "saved file has a malformed trailer";
+    return false;
+  }
+  trailer.size = size->Int();
+  trailer.root = {root->num, root->gen};
+  GetEntry(dict, "Info", trailer.info);
+  GetEntry(dict, "ID", trailer.id);
+  return true;
+}
+
+/**
+ * `dict` with `item` added to its /key array, which may be missing,
+ * direct, or an indirect object (then edited and queued in `updates`).
+ */
+bool AddToArrayEntry(ObjectReader& reader, std::string& dict, const char* key,
+                     const std::string& item,
+                     std::vector<UpdatedObject>& updates, std::string& error) {
+  std::string value;
+  if (!GetEntry(dict, key, value)) {
+    dict = SetEntry(dict, key, "[" + item + "]");
+    return true;
+  }
+  if (value[0] == '[') {
+    dict = SetEntry(dict, key, AppendToArray(value, item));
+    return true;
+  }
+
+  UpdatedObject array;
+  if (!ParseRef(value, array.ref) || !reader.Read(array.ref, array.body, error) ||
+      array.body[0] != '[') {
+    error = std::string("/") + key + " is not an array";
+    return false;
+  }
+  array.body = AppendToArray(array.body, item);
+  updates.push_back(std::move(array));
+  return true;
+}
+
+/** The first page's reference, walking /Kids from the page tree root. */
+bool FindFirstPage(ObjectReader& reader, const std::string& catalog,
+                   UpdatedObject& page, std::string& error) {
+  std::string value;
+  if (!GetEntry(catalog, "Pages", value) || !ParseRef(value, page.ref)) {
+    error = "catalog has no page tree";
+    return false;
+  }
+
+  for (int depth = 0; depth < 64; ++depth) {
+    if (!reader.Read(page.ref, page.body, error)) return false;
+
+    // Leaves are /Type /Page; some writers omit /Type, but only nodes
+    // have /Kids.
+    std::string kids;
+    ObjRef kidsRef;
+    if ((GetEntry(page.body, "Type", value) && value == "/Page") ||
+        !GetEntry(page.body, "Kids", kids)) {
+      return true;
+    }
+    if (ParseRef(kids, kidsRef) && !reader.Read(kidsRef, kids, error)) {
+      return false;
+    }
+    size_t first, firstEnd;
+    if (kids[0] != '[' || !ValueSpan(kids, 1, first, firstEnd) ||
+        !ParseRef(kids.substr(first, firstEnd - first), page.ref)) {
+      break;
+    }
+  }
+  error = "page tree is malformed";
+  return false;
+}
+
+/**
+ * Lay out the update that adds the signature field.  On return
+ * `contentsBegin` / `contentsEnd` bracket the <…> placeholder and
+ * `byteRangeAt` is where the three fixed-width numbers go.
+ */
+bool BuildUpdate(ObjectReader& reader, const Trailer& trailer,
+                 uint64_t baseSize, bool needsEol,
+                 const SignatureFields& fields, std::string& text,
+                 size_t& contentsBegin, size_t& contentsEnd,
+                 size_t& byteRangeAt, std::string& error) {
+  const ObjRef widget{trailer.size, 0};
+  const ObjRef sig{trailer.size + 1, 0};
+  const std::string widgetRef = RefText(widget);
+
+  std::vector<UpdatedObject> updates;
+
+  // Catalog → AcroForm → Fields, and SigFlags 3 (signed, append-only).
+  UpdatedObject catalog{trailer.root, {}};
+  if (!reader.Read(catalog.ref, catalog.body, error)) return false;
+
+  std::string acroForm;
+  ObjRef acroRef;
+  if (!GetEntry(catalog.body, "AcroForm", acroForm)) {
+    acroForm = "<< /Fields [" + widgetRef + "] /SigFlags 3 >>";
+    catalog.body = SetEntry(catalog.body, "AcroForm", acroForm);
+    updates.push_back(catalog);
+  } else {
+    const bool indirect = ParseRef(acroForm, acroRef);
+    if (indirect && !reader.Read(acroRef, acroForm, error)) return false;
+    if (acroForm.compare(0, 2, "<<") != 0) {
+      error = "/AcroForm is not a dictionary";
+      return false;
+    }
+    if (!AddToArrayEntry(reader, acroForm, "Fields", widgetRef, updates, error)) {
+      return false;
+    }
+    acroForm = SetEntry(acroForm, "SigFlags", "3");
+    if (indirect) {
+      updates.push_back({acroRef, acroForm});
+    } else {
+      catalog.body = SetEntry(catalog.body, "AcroForm", acroForm);
+      updates.push_back(catalog);
+    }
+  }
+
+  // First page → Annots.
+  UpdatedObject page;
+  if (!FindFirstPage(reader, catalog.body, page, error)) return false;
+  const std::string pageBefore = page.body;
+  if (!AddToArrayEntry(reader, page.body, "Annots", widgetRef, updates, error)) {
+    return false;
+  }
+  if (page.body != pageBefore) updates.push_back(page);
+
+  // Merged field / widget, invisible by its zero rect; /F 132 = Print | Locked.
+  updates.push_back({widget,
+    "<< /Type /Annot /Subtype /Widget /FT /Sig /F 132 /Rect [0 0 0 0]"
+    " /T " + PdfTextString(fields.fieldName) +
+    " /P " + RefText(page.ref) +
+    " /V " + RefText(sig) + " >>"});
+
+  std::string sigDict =
+    "<< /Type /Sig /Filter /Adobe.PPKLite /SubFilter /adbe.pkcs7.detached"
+    " /M " + PdfDateNow();
+  if (!fields.name.empty()) sigDict += " /Name " + PdfTextString(fields.name);
+  if (!fields.reason.empty()) sigDict += " /Reason " + PdfTextString(fields.reason);
+  if (!fields.location.empty()) {
+    sigDict += " /Location " + PdfTextString(fields.location);
+  }
+  sigDict += " /ByteRange [0 ";
+  const size_t byteRangeInDict = sigDict.size();
+  for (int i = 0; i < 3; ++i) sigDict += std::string(BYTE_RANGE_DIGITS, ' ') + " ";
+  sigDict.back() = ']';
+  sigDict += " /Contents <";
+  const size_t contentsInDict = sigDict.size() - 1;
+  sigDict += std::string(fields.placeholderSize * 2, '0') + "> >>";
+  updates.push_back({sig, std::move(sigDict)});
+
+  // Objects, then the xref section and trailer.
+  text = needsEol ? "\n" : "";
+  struct XrefEntry { ObjRef ref; uint64_t offset; };
+  std::vector<XrefEntry> xref;
+  for (const auto& obj : updates) {
+    xref.push_back({obj.ref, baseSize + text.size()});
+    text += std::to_string(obj.ref.num) + " " + std::to_string(obj.ref.gen) +
+            " obj\n";
+    if (obj.ref.num == sig.num) {
+      byteRangeAt = text.size() + byteRangeInDict;
+      contentsBegin = text.size() + contentsInDict;
+      contentsEnd = contentsBegin + fields.placeholderSize * 2 + 2;
+    }
+    text += obj.body + "\nendobj\n";
+  }
+
+  std::sort(xref.begin(), xref.end(), [](const XrefEntry& a, const XrefEntry& b) {
+    return a.ref.num < b.ref.num;
+  });
+  const uint64_t xrefOffset = baseSize + text.size();
+  text += "xref\n";
+  for (size_t i = 0; i < xref.size();) {
+    size_t run = 1;
+    while (i + run < xref.size() &&
+           xref[i + run].ref.num == xref[i].ref.num + static_cast<long long>(run)) {
+      ++run;
+    }
+    text += std::to_string(xref[i].ref.num) + " " + std::to_string(run) + "\n";
+    for (size_t k = i; k < i + run; ++k) {
+      char entry[XREF_ENTRY_BYTES + 1];
+      std::snprintf(entry, sizeof(entry), "%010llu %05d n\r\n",
+                    static_cast<unsigned long long>(xref[k].offset),
+                    xref[k].ref.gen);
+      text += entry;
+    }
+    i += run;
+  }
+
+  text += "trailer\n<< /Size " + std::to_string(sig.num + 1) +
+          " /Root " + RefText(trailer.root) +
+          " /Prev " + std::to_string(trailer.startxref);
+  if (!trailer.info.empty()) text += " /Info " + trailer.info;
+  if (!trailer.id.empty()) text += " /ID " + trailer.id;
+  text += " >>\nstartxref\n" + std::to_string(xrefOffset) + "\n%%EOF\n";
+  return true;
+}
+
+struct SignaturePlacement {
+  uint64_t byteRange[4];
+  std::string digest;
+};
+
+/**
+ * Append the signature update to the file FPDF_SaveAsCopy just wrote.
+ * `hash` has seen the `baseSize` bytes written so far; `tail` holds
+ * the end of them.
+ */
+bool AppendSignatureUpdate(const std::string& path, uint64_t baseSize,
+                           const std::string& tail,
+                           const SignatureFields& fields, Sha256& hash,
+                           SignaturePlacement& placement, std::string& error) {
+  Trailer trailer;
+  if (!ParseTrailer(tail, trailer, error)) return false;
+
+  std::string text;
+  size_t contentsBegin = 0, contentsEnd = 0, byteRangeAt = 0;
+  {
+    ObjectReader reader;
+    const bool needsEol = tail.empty() || (tail.back() != '\n' && tail.back() != '\r');
+    if (!reader.Open(path, trailer.startxref, error) ||
+        !BuildUpdate(reader, trailer, baseSize, needsEol, fields, text,
+                     contentsBegin, contentsEnd, byteRangeAt, error)) {
+      return false;
+    }
+  }
+
+  const uint64_t total = baseSize + text.size();
+  placement.byteRange[0] = 0;
+  placement.byteRange[1] = baseSize + contentsBegin;
+  placement.byteRange[2] = baseSize + contentsEnd;
+  placement.byteRange[3] = total - placement.byteRange[2];
+
+  for (int i = 0; i < 3; ++i) {
+    char digits[BYTE_RANGE_DIGITS + 2];
+    int n = std::snprintf(digits, sizeof(digits), "%llu",
+                          static_cast<unsigned long long>(placement.byteRange[i + 1]));
+    if (n > BYTE_RANGE_DIGITS) {
+      error = "document is too large for a signature byte range";
+      return false;
+    }
+    text.replace(byteRangeAt + i * (BYTE_RANGE_DIGITS + 1), n, digits, n);
+  }
+
+  hash.Update(text.data(), contentsBegin);
+  hash.Update(text.data() + contentsEnd, text.size() - contentsEnd);
+  placement.digest = hash.FinalHex();
+
+  std::ofstream out(std::filesystem::u8path(path),
+                    std::ios::binary | std::ios::app);
+  out.write(text.data(), static_cast<std::streamsize>(text.size()));
+  out.close();
+  if (out.fail()) {
+    error = "failed writing " + path;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Streams the save and appends the update off the JS thread.  Only
+ * FPDF_SaveAsCopy needs g_pdfiumMutex; the byte-range layout reads
+ * and appends to the file it wrote.
+ */
+class SignJob : public Job {
+ public:
+  SignJob(Napi::Env env, int handle, std::string path, SignatureFields fields)
+    : Job(env, env.Undefined()),
+      handle_(handle),
+      path_(std::move(path)),
+      fields_(std::move(fields)) {}
+
+ protected:
+  void Execute(const ExecutionProgress&) override {
+    Sha256 hash;
+    uint64_t baseSize = 0;
+    std::string tail;
+    SaveBlockTap tap = [&](const uint8_t* data, size_t size) {
+      hash.Update(data, size);
+      baseSize += size;
+      tail.append(reinterpret_cast<const char*>(data), size);
+      if (tail.size() > 2 * TRAILER_TAIL_BYTES) {
+        tail.erase(0, tail.size() - TRAILER_TAIL_BYTES);
+      }
+    };
+
+    std::string error;
+    {
+      PdfiumLock lock(g_pdfiumMutex);
+      auto it = g_documents.find(handle_);
+      if (it == g_documents.end()) {
+        SetError("document was closed while the job was running");
+        return;
+      }
+      if (!WriteDocumentToFile(handle_, it->second, path_, error, tap)) {
+        SetError(error);
+        return;
+      }
+    }
+
+    if (!AppendSignatureUpdate(path_, baseSize, tail, fields_, hash,
+                               placement_, error)) {
+      SetError(error);
+    }
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Array byteRange = Napi::Array::New(env, 4);
+    for (uint32_t i = 0; i < 4; ++i) {
+      byteRange.Set(i, Napi::Number::New(env,
+        static_cast<double>(placement_.byteRange[i])));
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("byteRange", byteRange);
+    result.Set("digest", placement_.digest);
+    return result;
+  }
+
+ private:
+  const int handle_;
+  const std::string path_;
+  const SignatureFields fields_;
+  SignaturePlacement placement_{};
+};
+
+bool GetTextOption(Napi::Value options, const char* key, std::u16string& out) {
+  if (!options.IsObject()) return false;
+  Napi::Value v = options.As<Napi::Object>().Get(key);
+  if (!v.IsString()) return false;
+  out = v.As<Napi::String>().Utf16Value();
+  return true;
+}
+
+}  // namespace
+
+// ── prepareSignature ────────────────────────────────────────────────
+
+Napi::Value PrepareSignature(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
+    Napi::TypeError::New(env,
+      "prepareSignature: requires (handle: number, path: string, options?: object)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  std::string path = info[1].As<Napi::String>().Utf8Value();
+  Napi::Value options = info.Length() > 2 ? info[2] : env.Undefined();
+
+  SignatureFields fields;
+  double placeholder = GetNumberOption(options, "placeholderSize",
+                                       DEFAULT_PLACEHOLDER_BYTES);
+  if (!(placeholder >= 1 && placeholder <= MAX_PLACEHOLDER_BYTES)) {
+    Napi::RangeError::New(env,
+      "prepareSignature: placeholderSize must be between 1 and " +
+      std::to_string(MAX_PLACEHOLDER_BYTES)
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  fields.placeholderSize = static_cast<size_t>(placeholder);
+  GetTextOption(options, "fieldName", fields.fieldName);
+  GetTextOption(options, "name", fields.name);
+  GetTextOption(options, "reason", fields.reason);
+  GetTextOption(options, "location", fields.location);
+  if (fields.fieldName.empty()) fields.fieldName = u"Signature1";
+
+  if (!RequireDocument(env, handle)) return env.Undefined();
+
+  auto* job = new SignJob(env, handle, std::move(path), std::move(fields));
+  return job->Start();
+}
+
+// ── embedSignature ──────────────────────────────────────────────────
+
+void EmbedSignature(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 3 || !info[0].IsString() || !info[1].IsArray() ||
+      !info[2].IsBuffer()) {
+    Napi::TypeError::New(env,
+      "embedSignature: requires (path: string, byteRange: number[], signature: Buffer)"
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::string path = info[0].As<Napi::String>().Utf8Value();
+  Napi::Array range = info[1].As<Napi::Array>();
+  auto signature = info[2].As<Napi::Buffer<uint8_t>>();
+
+  uint64_t byteRange[4] = {};
+  bool valid = range.Length() == 4;
+  for (uint32_t i = 0; valid && i < 4; ++i) {
+    Napi::Value v = range.Get(i);
+    valid = v.IsNumber() && v.As<Napi::Number>().DoubleValue() >= 0;
+    if (valid) byteRange[i] = static_cast<uint64_t>(v.As<Napi::Number>().Int64Value());
+  }
+  valid = valid && byteRange[0] == 0 && byteRange[2] >= byteRange[1] + 2;
+  if (!valid) {
+    Napi::TypeError::New(env, "embedSignature: malformed byteRange")
+      .ThrowAsJavaScriptException();
+    return;
+  }
+
+  const uint64_t capacity = (byteRange[2] - byteRange[1] - 2) / 2;
+  if (signature.Length() > capacity) {
+    Napi::RangeError::New(env,
+      "embedSignature: signature is " + std::to_string(signature.Length()) +
+      " bytes but the placeholder holds " + std::to_string(capacity)
+    ).ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::fstream file(std::filesystem::u8path(path),
+                    std::ios::binary | std::ios::in | std::ios::out);
+  char open = 0, close = 0;
+  if (file) {
+    file.seekg(static_cast<std::streamoff>(byteRange[1]));
+    file.get(open);
+    file.seekg(static_cast<std::streamoff>(byteRange[2] - 1));
+    file.get(close);
+    file.seekg(0, std::ios::end);
+  }
+  if (!file || open != '<' || close != '>' ||
+      static_cast<uint64_t>(file.tellg()) != byteRange[2] + byteRange[3]) {
+    Napi::Error::New(env,
+      "embedSignature: " + path + " does not match the byte range")
+      .ThrowAsJavaScriptException();
+    return;
+  }
+
+  static const char HEX[] = "0123456789abcdef";
+  std::string hex(signature.Length() * 2, '0');
+  for (size_t i = 0; i < signature.Length(); ++i) {
+    hex[i * 2]     = HEX[signature.Data()[i] >> 4];
+    hex[i * 2 + 1] = HEX[signature.Data()[i] & 0x0f];
+  }
+  file.seekp(static_cast<std::streamoff>(byteRange[1] + 1));
+  file.write(hex.data(), static_cast<std::streamsize>(hex.size()));
+  file.close();
+  if (file.fail()) {
+    Napi::Error::New(env, "embedSignature: failed writing " + path)
+      .ThrowAsJavaScriptException();
+  }
+}
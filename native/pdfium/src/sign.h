@@ -0,0 +1,33 @@
+/**
+ * sign.h — Signature preparation with streaming byte-range hashing.
+ */
+#ifndef PDFIUM_ADDON_SIGN_H
+#define PDFIUM_ADDON_SIGN_H
+
+#include <napi.h>
+
+/**
+ * prepareSignature(handle, path, options?)
+ * → { jobId, done: Promise<{ byteRange: [0, a, b, c], digest: string }> }
+ *
+ * Saves the document to `path` on a background job, followed by an
+ * incremental update that adds an invisible signature field on the
+ * first page, its /Contents a zero-filled placeholder.  The SHA-256 of
+ * the byte ranges (hex) is computed while the file is written, so it is
+ * never read back or held in memory.  Sign the digest
+ * (adbe.pkcs7.detached) and pass the DER to embedSignature.
+ *
+ * options: { placeholderSize?: number = 16384 (bytes of DER),
+ *            fieldName?: string = "Signature1", name?: string,
+ *            reason?: string, location?: string }
+ */
+Napi::Value PrepareSignature(const Napi::CallbackInfo& info);
+
+/**
+ * embedSignature(path, byteRange, signature: Buffer): void
+ * Writes the DER signature into the placeholder left by
+ * prepareSignature, in place.
+ */
+void EmbedSignature(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_SIGN_H
@@ -0,0 +1,121 @@
+/**
+ * textgeometry.cc — Character boxes, codepoints and line/word spans of
+ * a page in one call.
+ */
+
+#include "common.h"
+#include "textgeometry.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static_assert(sizeof(FS_RECTF) == 4 * sizeof(float),
+              "FS_RECTF must be four packed floats");
+
+namespace {
+
+/** Copy the [start, end) pairs of `spans` that overlap [first, last). */
+Napi::Uint32Array OverlappingSpans(Napi::Env env, const std::vector<uint32_t>& spans,
+                                   uint32_t first, uint32_t last) {
+  // Spans are sorted and disjoint: binary-search the first one that
+  // ends after `first`, then take them while they start before `last`.
+  const size_t pairs = spans.size() / 2;
+  size_t lo = 0, hi = pairs;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (spans[mid * 2 + 1] <= first) lo = mid + 1; else hi = mid;
+  }
+  size_t end = lo;
+  while (end < pairs && spans[end * 2] < last) end++;
+
+  auto out = Napi::Uint32Array::New(env, (end - lo) * 2);
+  if (end > lo) {
+    std::memcpy(out.Data(), spans.data() + lo * 2, (end - lo) * 2 * sizeof(uint32_t));
+  }
+  return out;
+}
+
+}  // namespace
+
+// ── getCharGeometry ─────────────────────────────────────────────────
+
+Napi::Value GetCharGeometry(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env,
+      "getCharGeometry: requires (handle, pageIndex, range?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle    = info[0].As<Napi::Number>().Int32Value();
+  int pageIndex = info[1].As<Napi::Number>().Int32Value();
+  Napi::Value range = info.Length() > 2 ? info[2] : env.Undefined();
+  double rangeStart = GetNumberOption(range, "start", 0);
+  double rangeCount = GetNumberOption(range, "count", -1);
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  int pageCount = FPDF_GetPageCount(doc);
+  if (pageIndex < 0 || pageIndex >= pageCount) {
+    Napi::RangeError::New(env,
+      "getCharGeometry: pageIndex " + std::to_string(pageIndex) +
+      " out of range [0, " + std::to_string(pageCount - 1) + "]"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Only load the page when its text is not cached yet.
+  std::shared_ptr<const TextPageData> text = PeekTextPageData(handle, pageIndex);
+  if (!text) {
+    bool fromCache = false;
+    FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+    if (!page) {
+      Napi::Error::New(env,
+        "getCharGeometry: failed to load page " + std::to_string(pageIndex)
+      ).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    text = GetTextPageData(handle, pageIndex, page);
+    ReleasePage(handle, pageIndex, page, fromCache);
+  }
+
+  const size_t total = text->chars.size();
+  const size_t start = static_cast<size_t>(
+    std::clamp(rangeStart, 0.0, static_cast<double>(total)));
+  const size_t count = rangeCount < 0
+    ? total - start
+    : std::min(static_cast<size_t>(rangeCount), total - start);
+
+  auto boxes = Napi::Float32Array::New(env, count * 4);
+  if (count > 0) {
+    std::memcpy(boxes.Data(), text->boxes.data() + start, count * sizeof(FS_RECTF));
+  }
+
+  auto codepoints = Napi::Uint32Array::New(env, count);
+  for (size_t i = 0; i < count; i++) {
+    codepoints[i] = static_cast<uint32_t>(text->chars[start + i]);
+  }
+
+  const uint32_t first = static_cast<uint32_t>(start);
+  const uint32_t last = static_cast<uint32_t>(start + count);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("version", Napi::Number::New(env, text->version));
+  result.Set("start", Napi::Number::New(env, static_cast<double>(start)));
+  result.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+  result.Set("boxes", boxes);
+  result.Set("codepoints", codepoints);
+  result.Set("lines", OverlappingSpans(env, text->lines, first, last));
+  result.Set("words", OverlappingSpans(env, text->words, first, last));
+  return result;
+}
@@ -0,0 +1,26 @@
+/**
+ * textgeometry.h — Batched character geometry for text selection and
+ * search highlighting.
+ */
+#ifndef PDFIUM_ADDON_TEXTGEOMETRY_H
+#define PDFIUM_ADDON_TEXTGEOMETRY_H
+
+#include <napi.h>
+
+/**
+ * getCharGeometry(handle, pageIndex, range?)
+ * → { version, start, count,
+ *     boxes: Float32Array (left, top, right, bottom per char, page space),
+ *     codepoints: Uint32Array,
+ *     lines: Uint32Array, words: Uint32Array }
+ *
+ * range: { start?: number = 0, count?: number = all }
+ *
+ * Served from the cached text page (textpage.h), so a page is only
+ * walked once per version; `version` changes whenever the page is
+ * edited.  `lines` and `words` are flat [start, end) pairs of absolute
+ * char indices, limited to spans that overlap the range.
+ */
+Napi::Value GetCharGeometry(const Napi::CallbackInfo& info);
+
+#endif // PDFIUM_ADDON_TEXTGEOMETRY_H
@@ -0,0 +1,206 @@
+/**
+ * textpage.cc — Bounded LRU cache of extracted page text.
+ */
+
+#include "common.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+#include <fpdf_edit.h>
+#include <fpdf_text.h>
+
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+/** Pages kept in the cache; roughly 20 KB per page of dense text. */
+static constexpr size_t MAX_CACHED_TEXT_PAGES = 256;
+
+using TextKey = std::pair<int, int>;  // (handle, pageIndex)
+
+struct TextCacheEntry {
+  std::shared_ptr<const TextPageData> data;
+  std::list<TextKey>::iterator lruPos;
+};
+
+/** Most-recently used key at the front. */
+static std::list<TextKey> g_textLru;
+static std::map<TextKey, TextCacheEntry> g_textCache;
+
+/** Pages edited at least once; absent means version 0. */
+static std::map<TextKey, uint32_t> g_pageVersions;
+
+// ── Extraction ──────────────────────────────────────────────────────
+
+static bool IsLineBreak(wchar_t c) {
+  return c == L'\r' || c == L'\n';
+}
+
+static bool IsWordSeparator(wchar_t c) {
+  return IsLineBreak(c) || c == L' ' || c == L'\t' ||
+         c == 0x00A0 || c == 0x3000;
+}
+
+/**
+ * Split `chars` into [start, end) runs not containing separators.
+ * Runs are appended to `out` as flat pairs.
+ */
+static void CollectSpans(const std::wstring& chars, bool (*separator)(wchar_t),
+                         std::vector<uint32_t>& out) {
+  uint32_t start = 0;
+  const uint32_t n = static_cast<uint32_t>(chars.size());
+  for (uint32_t i = 0; i <= n; i++) {
+    if (i < n && !separator(chars[i])) continue;
+    if (i > start) {
+      out.push_back(start);
+      out.push_back(i);
+    }
+    start = i + 1;
+  }
+}
+
+static std::shared_ptr<TextPageData> ExtractText(FPDF_PAGE page, uint32_t version) {
+  auto data = std::make_shared<TextPageData>();
+  data->version = version;
+
+  FPDF_TEXTPAGE textPage = FPDFText_LoadPage(page);
+  if (!textPage) return data;
+
+  int charCount = FPDFText_CountChars(textPage);
+  if (charCount < 0) charCount = 0;
+
+  // FPDFText_GetTextObject hands back object pointers; map them to the
+  // indices the rest of the API (listPageObjects, edits) uses.
+  std::unordered_map<FPDF_PAGEOBJECT, int> objectIndex;
+  int objCount = FPDFPage_CountObjects(page);
+  for (int i = 0; i < objCount; i++) {
+    objectIndex[FPDFPage_GetObject(page, i)] = i;
+  }
+
+  const size_t n = static_cast<size_t>(charCount);
+  data->chars.resize(n);
+  data->boxes.resize(n);
+  data->origins.resize(n);
+  data->objects.resize(n);
+  data->generated.resize(n);
+
+  for (int i = 0; i < charCount; i++) {
+    const size_t k = static_cast<size_t>(i);
+
+    unsigned int cp = FPDFText_GetUnicode(textPage, i);
+    data->chars[k] = (sizeof(wchar_t) == 2 && cp > 0xFFFF)
+      ? static_cast<wchar_t>(0xFFFD)
+      : static_cast<wchar_t>(cp);
+
+    FS_RECTF box = { 0.0f, 0.0f, 0.0f, 0.0f };
+    FPDFText_GetLooseCharBox(textPage, i, &box);
+    data->boxes[k] = box;
+
+    double ox = 0.0, oy = 0.0;
+    FPDFText_GetCharOrigin(textPage, i, &ox, &oy);
+    data->origins[k] = { static_cast<float>(ox), static_cast<float>(oy) };
+
+    bool generated = FPDFText_IsGenerated(textPage, i) == 1;
+    data->generated[k] = generated;
+
+    int owner = -1;
+    if (!generated) {
+      auto it = objectIndex.find(FPDFText_GetTextObject(textPage, i));
+      if (it != objectIndex.end()) owner = it->second;
+    }
+    data->objects[k] = owner;
+  }
+
+  FPDFText_ClosePage(textPage);
+
+  CollectSpans(data->chars, IsLineBreak, data->lines);
+  CollectSpans(data->chars, IsWordSeparator, data->words);
+  return data;
+}
+
+// ── Cache API ───────────────────────────────────────────────────────
+
+std::shared_ptr<const TextPageData> GetTextPageData(
+  int handle, int pageIndex, FPDF_PAGE page) {
+  TextKey key(handle, pageIndex);
+
+  auto it = g_textCache.find(key);
+  if (it != g_textCache.end()) {
+    g_textLru.splice(g_textLru.begin(), g_textLru, it->second.lruPos);
+    return it->second.data;
+  }
+
+  std::shared_ptr<const TextPageData> data =
+    ExtractText(page, GetPageVersion(handle, pageIndex));
+
+  g_textLru.push_front(key);
+  g_textCache[key] = { data, g_textLru.begin() };
+
+  while (g_textCache.size() > MAX_CACHED_TEXT_PAGES) {
+    g_textCache.erase(g_textLru.back());
+    g_textLru.pop_back();
+  }
+  return data;
+}
+
+std::shared_ptr<const TextPageData> PeekTextPageData(int handle, int pageIndex) {
+  auto it = g_textCache.find(TextKey(handle, pageIndex));
+  if (it == g_textCache.end()) return nullptr;
+  g_textLru.splice(g_textLru.begin(), g_textLru, it->second.lruPos);
+  return it->second.data;
+}
+
+uint32_t GetPageVersion(int handle, int pageIndex) {
+  auto it = g_pageVersions.find(TextKey(handle, pageIndex));
+  return it == g_pageVersions.end() ? 0 : it->second;
+}
+
+void InvalidateTextPageData(int handle, int pageIndex) {
+  ++g_pageVersions[TextKey(handle, pageIndex)];
+
+  auto it = g_textCache.find(TextKey(handle, pageIndex));
+  if (it == g_textCache.end()) return;
+  g_textLru.erase(it->second.lruPos);
+  g_textCache.erase(it);
+}
+
+void DiscardTextPageData(int handle) {
+  auto it = g_textCache.lower_bound(TextKey(handle, 0));
+  while (it != g_textCache.end() && it->first.first == handle) {
+    g_textLru.erase(it->second.lruPos);
+    it = g_textCache.erase(it);
+  }
+  g_pageVersions.erase(g_pageVersions.lower_bound(TextKey(handle, 0)),
+                       g_pageVersions.lower_bound(TextKey(handle + 1, 0)));
+}
+
+// ── String conversion ───────────────────────────────────────────────
+
+std::wstring ToTextPageChars(const std::u16string& s) {
+  std::wstring out;
+  out.reserve(s.size());
+  for (size_t i = 0; i < s.size(); i++) {
+    char32_t c = s[i];
+    if (c >= 0xD800 && c <= 0xDBFF && i + 1 < s.size() &&
+        s[i + 1] >= 0xDC00 && s[i + 1] <= 0xDFFF) {
+      c = 0x10000 + ((c - 0xD800) << 10) + (s[i + 1] - 0xDC00);
+      i++;
+    }
+    out.push_back((sizeof(wchar_t) == 2 && c > 0xFFFF)
+      ? static_cast<wchar_t>(0xFFFD)
+      : static_cast<wchar_t>(c));
+  }
+  return out;
+}
+
+void AppendUtf16(std::u16string& out, wchar_t c) {
+  char32_t cp = static_cast<char32_t>(c);
+  if (cp > 0xFFFF) {
+    cp -= 0x10000;
+    out.push_back(static_cast<char16_t>(0xD800 + (cp >> 10)));
+    out.push_back(static_cast<char16_t>(0xDC00 + (cp & 0x3FF)));
+  } else {
+    out.push_back(static_cast<char16_t>(cp));
+  }
+}
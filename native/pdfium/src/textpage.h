@@ -0,0 +1,80 @@
+/**
+ * textpage.h — Cached per-page text extraction.
+ *
+ * Loading an FPDF_TEXTPAGE and walking its characters is the expensive
+ * part of every text feature (search, redaction, selection).  The
+ * result is cached per (handle, pageIndex) until the page is edited.
+ */
+#ifndef PDFIUM_ADDON_TEXTPAGE_H
+#define PDFIUM_ADDON_TEXTPAGE_H
+
+#include <fpdfview.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** Extracted text of one page, indexed by FPDF_TEXTPAGE char index. */
+struct TextPageData {
+  /**
+   * One code unit per char index.  On platforms with a 16-bit wchar_t,
+   * characters outside the BMP are stored as U+FFFD so that indices
+   * stay aligned with PDFium's.
+   */
+  std::wstring chars;
+  /** Loose char box (page space) per char; zero-area for generated chars. */
+  std::vector<FS_RECTF> boxes;
+  /** Glyph origin (page space) per char. */
+  std::vector<FS_POINTF> origins;
+  /**
+   * Index of the top-level page object that drew the char, or -1 for
+   * generated chars and chars drawn inside form XObjects.
+   */
+  std::vector<int> objects;
+  /** Whether PDFium synthesised the char (spaces, line breaks). */
+  std::vector<bool> generated;
+  /** Lines as [start, end) char index pairs, line breaks excluded. */
+  std::vector<uint32_t> lines;
+  /** Whitespace-delimited words as [start, end) char index pairs. */
+  std::vector<uint32_t> words;
+  /** Page version the text was extracted at (see GetPageVersion). */
+  uint32_t version = 0;
+};
+
+/**
+ * Return the cached text of (handle, pageIndex), extracting it from
+ * `page` on a miss.  The caller must hold g_pdfiumMutex and keep the
+ * returned pointer only while it does.
+ */
+std::shared_ptr<const TextPageData> GetTextPageData(
+  int handle, int pageIndex, FPDF_PAGE page);
+
+/**
+ * Return the cached text of (handle, pageIndex) without loading the
+ * page, or nullptr on a miss.  Same locking rules as GetTextPageData.
+ */
+std::shared_ptr<const TextPageData> PeekTextPageData(int handle, int pageIndex);
+
+/**
+ * Edit counter of a page: starts at 0 and increases every time its
+ * text is invalidated, so callers can tell stale derived data apart.
+ */
+uint32_t GetPageVersion(int handle, int pageIndex);
+
+/** Drop the cached text of one page (after an edit) and bump its version. */
+void InvalidateTextPageData(int handle, int pageIndex);
+
+/** Drop the cached text of every page of a document. */
+void DiscardTextPageData(int handle);
+
+/**
+ * Convert a JS string to the wide form used by TextPageData, applying
+ * the same U+FFFD substitution for non-BMP chars on 16-bit wchar_t.
+ */
+std::wstring ToTextPageChars(const std::u16string& s);
+
+/** Encode a TextPageData char as UTF-16, e.g. for FPDFText_SetText. */
+void AppendUtf16(std::u16string& out, wchar_t c);
+
+#endif // PDFIUM_ADDON_TEXTPAGE_H
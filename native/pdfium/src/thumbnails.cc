@@ -0,0 +1,572 @@
+/**
+ * thumbnails.cc — Page thumbnails kept as PNGs in a memory-mapped file.
+ *
+ * The store file grows a SEGMENT_BYTES segment at a time and each
+ * segment is mapped once, so earlier pointers stay valid as it grows
+ * and no thumbnail straddles two mappings.  A re-rendered thumbnail is
+ * appended and the index pointed at it; the old bytes are left behind
+ * until the document closes.
+ */
+
+#include "common.h"
+#include "thumbnails.h"
+#include "jobs.h"
+#include "png.h"
+#include "textpage.h"
+
+#include <fpdfview.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int DEFAULT_THUMB_WIDTH = 160;
+constexpr int DEFAULT_THUMB_HEIGHT = 200;
+constexpr int MAX_THUMB_EDGE = 1024;
+
+/** Store growth step; a multiple of every platform's mapping granularity. */
+constexpr uint64_t SEGMENT_BYTES = 8 * 1024 * 1024;
+
+/** Annotations show, as on the page; LCD text would blur when scaled. */
+constexpr int THUMB_RENDER_FLAGS = FPDF_ANNOT;
+
+struct ThumbEntry {
+  uint64_t offset = 0;
+  uint32_t size = 0;      ///< PNG bytes; 0 when never stored.
+  uint32_t version = 0;   ///< GetPageVersion when rendered.
+  uint16_t width = 0;
+  uint16_t height = 0;
+};
+
+/** A rendered thumbnail before encoding, as packed RGB. */
+struct RawThumb {
+  std::vector<uint8_t> rgb;
+  int width = 0;
+  int height = 0;
+  uint32_t version = 0;
+};
+
+// ── ThumbnailStore ──────────────────────────────────────────────────
+
+class ThumbnailStore {
+ public:
+  ThumbnailStore(int pageCount, int maxWidth, int maxHeight)
+    : entries_(static_cast<size_t>(std::max(pageCount, 0))),
+      maxWidth_(maxWidth),
+      maxHeight_(maxHeight),
+      id_(++nextId_) {}
+  ThumbnailStore(const ThumbnailStore&) = delete;
+  ThumbnailStore& operator=(const ThumbnailStore&) = delete;
+  ~ThumbnailStore();
+
+  /** Create the backing file, which is deleted when the store is. */
+  bool Open(std::string& error);
+
+  int MaxWidth() const { return maxWidth_; }
+  int MaxHeight() const { return maxHeight_; }
+  /** Distinguishes a store from one that replaced it for the same handle. */
+  uint64_t Id() const { return id_; }
+  int PageCount() const { return static_cast<int>(entries_.size()); }
+
+  /** Entry of `page` if it was rendered at `version`, else nullptr. */
+  const ThumbEntry* Current(int page, uint32_t version) const {
+    const ThumbEntry& e = entries_[static_cast<size_t>(page)];
+    return e.size && e.version == version ? &e : nullptr;
+  }
+
+  const uint8_t* Bytes(const ThumbEntry& e) const {
+    return segments_[e.offset / SEGMENT_BYTES] + e.offset % SEGMENT_BYTES;
+  }
+
+  bool Put(int page, const RawThumb& thumb, const std::vector<uint8_t>& png,
+           std::string& error);
+
+ private:
+  bool AddSegment(std::string& error);
+
+  std::vector<ThumbEntry> entries_;
+  std::vector<uint8_t*> segments_;
+  uint64_t end_ = 0;
+  const int maxWidth_;
+  const int maxHeight_;
+  const uint64_t id_;
+#ifdef _WIN32
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+#else
+  int fd_ = -1;
+#endif
+
+  static std::atomic<uint64_t> nextId_;
+};
+
+std::atomic<uint64_t> ThumbnailStore::nextId_{0};
+
+bool ThumbnailStore::Put(int page, const RawThumb& thumb,
+                         const std::vector<uint8_t>& png, std::string& error) {
+  if (png.empty() || png.size() > SEGMENT_BYTES) {
+    error = "thumbnail of page " + std::to_string(page) + " does not fit the store";
+    return false;
+  }
+
+  // Start a new segment rather than split the PNG across two mappings.
+  const uint64_t capacity = segments_.size() * SEGMENT_BYTES;
+  if (end_ + png.size() > capacity) {
+    if (!AddSegment(error)) return false;
+    end_ = capacity;
+  }
+
+  std::memcpy(segments_[end_ / SEGMENT_BYTES] + end_ % SEGMENT_BYTES,
+              png.data(), png.size());
+  ThumbEntry& e = entries_[static_cast<size_t>(page)];
+  e.offset = end_;
+  e.size = static_cast<uint32_t>(png.size());
+  e.version = thumb.version;
+  e.width = static_cast<uint16_t>(thumb.width);
+  e.height = static_cast<uint16_t>(thumb.height);
+  end_ += png.size();
+  return true;
+}
+
+#ifdef _WIN32
+
+ThumbnailStore::~ThumbnailStore() {
+  for (uint8_t* segment : segments_) UnmapViewOfFile(segment);
+  if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+}
+
+bool ThumbnailStore::Open(std::string& error) {
+  std::error_code ec;
+  std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+  if (ec) {
+    error = "no temporary directory for thumbnails";
+    return false;
+  }
+  std::filesystem::path path = dir / ("pdf-thumbnails-" +
+    std::to_string(GetCurrentProcessId()) + "-" + std::to_string(id_));
+
+  file_ = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                      CREATE_ALWAYS,
+                      FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+                      nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    error = "could not create " + path.string();
+    return false;
+  }
+  return true;
+}
+
+bool ThumbnailStore::AddSegment(std::string& error) {
+  const uint64_t size = (segments_.size() + 1) * SEGMENT_BYTES;
+  const uint64_t offset = size - SEGMENT_BYTES;
+
+  // Creating a mapping larger than the file extends it.
+  HANDLE mapping = CreateFileMappingW(file_, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(size >> 32),
+                                      static_cast<DWORD>(size), nullptr);
+  if (!mapping) {
+    error = "could not grow the thumbnail store";
+    return false;
+  }
+  void* data = MapViewOfFile(mapping, FILE_MAP_WRITE,
+                             static_cast<DWORD>(offset >> 32),
+                             static_cast<DWORD>(offset), SEGMENT_BYTES);
+  CloseHandle(mapping);  // the view keeps the mapping alive
+  if (!data) {
+    error = "could not map the thumbnail store";
+    return false;
+  }
+  segments_.push_back(static_cast<uint8_t*>(data));
+  return true;
+}
+
+#else
+
+ThumbnailStore::~ThumbnailStore() {
+  for (uint8_t* segment : segments_) munmap(segment, SEGMENT_BYTES);
+  if (fd_ >= 0) close(fd_);
+}
+
+bool ThumbnailStore::Open(std::string& error) {
+  std::error_code ec;
+  std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+  if (ec) {
+    error = "no temporary directory for thumbnails";
+    return false;
+  }
+  std::string path = (dir / "pdf-thumbnails-XXXXXX").string();
+
+  fd_ = mkstemp(&path[0]);
+  if (fd_ < 0) {
+    error = "could not create " + path;
+    return false;
+  }
+  unlink(path.c_str());  // the file lives on until fd_ and the mappings go
+  return true;
+}
+
+bool ThumbnailStore::AddSegment(std::string& error) {
+  const uint64_t size = (segments_.size() + 1) * SEGMENT_BYTES;
+  if (ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+    error = "could not grow the thumbnail store";
+    return false;
+  }
+  void* data = mmap(nullptr, SEGMENT_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd_, static_cast<off_t>(size - SEGMENT_BYTES));
+  if (data == MAP_FAILED) {
+    error = "could not map the thumbnail store";
+    return false;
+  }
+  segments_.push_back(static_cast<uint8_t*>(data));
+  return true;
+}
+
+#endif
+
+/** Store per document handle; guarded by g_pdfiumMutex. */
+std::map<int, std::unique_ptr<ThumbnailStore>> g_thumbnails;
+
+/** The store of `handle` at this size, replacing one of another size. */
+ThumbnailStore* StoreFor(int handle, FPDF_DOCUMENT doc, int maxWidth,
+                         int maxHeight, std::string& error) {
+  auto it = g_thumbnails.find(handle);
+  if (it != g_thumbnails.end() && it->second->MaxWidth() == maxWidth &&
+      it->second->MaxHeight() == maxHeight) {
+    return it->second.get();
+  }
+
+  auto store = std::make_unique<ThumbnailStore>(FPDF_GetPageCount(doc),
+                                                maxWidth, maxHeight);
+  if (!store->Open(error)) return nullptr;
+  ThumbnailStore* result = store.get();
+  g_thumbnails[handle] = std::move(store);
+  return result;
+}
+
+ThumbnailStore* FindStore(int handle, uint64_t id) {
+  auto it = g_thumbnails.find(handle);
+  return it != g_thumbnails.end() && it->second->Id() == id ? it->second.get()
+                                                            : nullptr;
+}
+
+// ── Rendering ───────────────────────────────────────────────────────
+
+/** Render a page to fit maxWidth × maxHeight.  Caller holds g_pdfiumMutex. */
+bool RenderThumbnail(int handle, FPDF_DOCUMENT doc, int pageIndex,
+                     int maxWidth, int maxHeight, RawThumb& out) {
+  bool fromCache = false;
+  FPDF_PAGE page = AcquirePage(handle, doc, pageIndex, fromCache);
+  if (!page) return false;
+
+  const double w = std::max(1.0f, FPDF_GetPageWidthF(page));
+  const double h = std::max(1.0f, FPDF_GetPageHeightF(page));
+  const double scale = std::min(maxWidth / w, maxHeight / h);
+  out.width = std::clamp(static_cast<int>(std::lround(w * scale)), 1, maxWidth);
+  out.height = std::clamp(static_cast<int>(std::lround(h * scale)), 1, maxHeight);
+  out.version = GetPageVersion(handle, pageIndex);
+
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(out.width, out.height, /*alpha=*/0);
+  if (bitmap) {
+    FPDFBitmap_FillRect(bitmap, 0, 0, out.width, out.height, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bitmap, page, 0, 0, out.width, out.height, 0,
+                          THUMB_RENDER_FLAGS);
+
+    // BGRx → RGB, which PNG stores a quarter smaller.
+    const uint8_t* src = static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap));
+    const int stride = FPDFBitmap_GetStride(bitmap);
+    out.rgb.resize(static_cast<size_t>(out.width) * out.height * 3);
+    uint8_t* dst = out.rgb.data();
+    for (int y = 0; y < out.height; ++y) {
+      const uint8_t* row = src + static_cast<size_t>(y) * stride;
+      for (int x = 0; x < out.width; ++x, dst += 3) {
+        dst[0] = row[x * 4 + 2];
+        dst[1] = row[x * 4 + 1];
+        dst[2] = row[x * 4];
+      }
+    }
+    FPDFBitmap_Destroy(bitmap);
+  }
+  ReleasePage(handle, pageIndex, page, fromCache);
+  return bitmap != nullptr;
+}
+
+std::vector<uint8_t> EncodeThumbnail(const RawThumb& thumb) {
+  std::vector<uint8_t> png;
+  EncodePng(thumb.rgb.data(), static_cast<size_t>(thumb.width) * 3,
+            thumb.width, thumb.height, PngColor::Rgb, 8, png);
+  return png;
+}
+
+/** Read maxWidth / maxHeight; throws a RangeError and returns false if bad. */
+bool ReadThumbSize(Napi::Env env, Napi::Value options, const char* fnName,
+                   int& maxWidth, int& maxHeight) {
+  const double w = GetNumberOption(options, "maxWidth", DEFAULT_THUMB_WIDTH);
+  const double h = GetNumberOption(options, "maxHeight", DEFAULT_THUMB_HEIGHT);
+  if (!(w >= 1 && w <= MAX_THUMB_EDGE) || !(h >= 1 && h <= MAX_THUMB_EDGE)) {
+    Napi::RangeError::New(env,
+      std::string(fnName) + ": maxWidth and maxHeight must be 1-" +
+      std::to_string(MAX_THUMB_EDGE)
+    ).ThrowAsJavaScriptException();
+    return false;
+  }
+  maxWidth = static_cast<int>(w);
+  maxHeight = static_cast<int>(h);
+  return true;
+}
+
+// ── ThumbnailJob ────────────────────────────────────────────────────
+
+class ThumbnailJob : public Job {
+ public:
+  ThumbnailJob(Napi::Env env, int handle, uint64_t storeId, int maxWidth,
+               int maxHeight, std::vector<int> pages, Napi::Value onProgress)
+    : Job(env, onProgress),
+      handle_(handle),
+      storeId_(storeId),
+      maxWidth_(maxWidth),
+      maxHeight_(maxHeight),
+      pages_(std::move(pages)) {}
+
+ protected:
+  void Execute(const ExecutionProgress& progress) override {
+    const int total = static_cast<int>(pages_.size());
+    std::string error;
+
+    for (int i = 0; i < total; ++i) {
+      if (CancelRequested()) {
+        MarkCancelled();
+        break;
+      }
+
+      const int pageIndex = pages_[i];
+      RawThumb thumb;
+      bool render = false;
+      {
+        PdfiumLock lock(g_pdfiumMutex);
+        auto it = g_documents.find(handle_);
+        if (it == g_documents.end()) {
+          SetError("document was closed while thumbnails were being built");
+          return;
+        }
+        ThumbnailStore* store = FindStore(handle_, storeId_);
+        if (!store) {
+          SetError("the thumbnail store was replaced by one of another size");
+          return;
+        }
+        if (store->Current(pageIndex, GetPageVersion(handle_, pageIndex))) {
+          current_++;
+        } else if (RenderThumbnail(handle_, it->second, pageIndex, maxWidth_,
+                                   maxHeight_, thumb)) {
+          render = true;
+        } else {
+          failed_++;
+        }
+      }
+
+      if (render) {
+        std::vector<uint8_t> png = EncodeThumbnail(thumb);
+
+        PdfiumLock lock(g_pdfiumMutex);
+        ThumbnailStore* store = FindStore(handle_, storeId_);
+        // An edit while encoding makes this one stale already; the next
+        // build or getThumbnails call renders the page again.
+        if (store && GetPageVersion(handle_, pageIndex) == thumb.version) {
+          if (!store->Put(pageIndex, thumb, png, error)) {
+            SetError(error);
+            return;
+          }
+          built_++;
+        }
+      }
+
+      JobProgress p = { i + 1, total };
+      progress.Send(&p, 1);
+    }
+  }
+
+  Napi::Object Result(Napi::Env env) override {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("built",   Napi::Number::New(env, built_));
+    result.Set("current", Napi::Number::New(env, current_));
+    result.Set("failed",  Napi::Number::New(env, failed_));
+    return result;
+  }
+
+ private:
+  const int handle_;
+  const uint64_t storeId_;
+  const int maxWidth_;
+  const int maxHeight_;
+  const std::vector<int> pages_;
+
+  int built_ = 0;
+  int current_ = 0;
+  int failed_ = 0;
+};
+
+}  // namespace
+
+// ── buildThumbnails ─────────────────────────────────────────────────
+
+Napi::Value BuildThumbnails(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env,
+      "buildThumbnails: requires (handle: number, options?, onProgress?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  Napi::Value options    = info.Length() > 1 ? info[1] : env.Undefined();
+  Napi::Value onProgress = info.Length() > 2 ? info[2] : env.Undefined();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  int maxWidth = 0, maxHeight = 0;
+  if (!ReadThumbSize(env, options, "buildThumbnails", maxWidth, maxHeight)) {
+    return env.Undefined();
+  }
+
+  std::vector<int> pages;
+  Napi::Value pagesArg = options.IsObject()
+    ? options.As<Napi::Object>().Get("pages")
+    : env.Undefined();
+  if (!ReadPageList(env, pagesArg, FPDF_GetPageCount(doc),
+                    "buildThumbnails", pages)) {
+    return env.Undefined();
+  }
+
+  std::string error;
+  ThumbnailStore* store = StoreFor(handle, doc, maxWidth, maxHeight, error);
+  if (!store) {
+    Napi::Error::New(env, "buildThumbnails: " + error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto* job = new ThumbnailJob(env, handle, store->Id(), maxWidth, maxHeight,
+                               std::move(pages), onProgress);
+  return job->Start();
+}
+
+// ── getThumbnails ───────────────────────────────────────────────────
+
+Napi::Value GetThumbnails(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PdfiumLock lock(g_pdfiumMutex);
+
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() ||
+      !info[2].IsNumber()) {
+    Napi::TypeError::New(env,
+      "getThumbnails: requires (handle: number, first: number, count: number, options?)"
+    ).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int handle = info[0].As<Napi::Number>().Int32Value();
+  Napi::Value options = info.Length() > 3 ? info[3] : env.Undefined();
+
+  FPDF_DOCUMENT doc = RequireDocument(env, handle);
+  if (!doc) return env.Undefined();
+
+  int maxWidth = 0, maxHeight = 0;
+  if (!ReadThumbSize(env, options, "getThumbnails", maxWidth, maxHeight)) {
+    return env.Undefined();
+  }
+  const bool render = GetBoolOption(options, "render", false);
+
+  const int pageCount = FPDF_GetPageCount(doc);
+  const int first = std::clamp(info[1].As<Napi::Number>().Int32Value(), 0, pageCount);
+  const int count = std::clamp(info[2].As<Napi::Number>().Int32Value(), 0, pageCount - first);
+
+  std::string error;
+  ThumbnailStore* store = nullptr;
+  if (render) {
+    store = StoreFor(handle, doc, maxWidth, maxHeight, error);
+    if (!store) {
+      Napi::Error::New(env, "getThumbnails: " + error).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  } else {
+    auto it = g_thumbnails.find(handle);
+    if (it != g_thumbnails.end() && it->second->MaxWidth() == maxWidth &&
+        it->second->MaxHeight() == maxHeight) {
+      store = it->second.get();
+    }
+  }
+
+  std::vector<uint16_t> widths(static_cast<size_t>(count), 0);
+  std::vector<uint16_t> heights(static_cast<size_t>(count), 0);
+  std::vector<uint32_t> offsets{0};
+  std::vector<const ThumbEntry*> entries(static_cast<size_t>(count), nullptr);
+
+  for (int i = 0; store && i < count; ++i) {
+    const int pageIndex = first + i;
+    if (pageIndex >= store->PageCount()) break;
+    const uint32_t version = GetPageVersion(handle, pageIndex);
+    const ThumbEntry* entry = store->Current(pageIndex, version);
+
+    RawThumb thumb;
+    if (!entry && render &&
+        RenderThumbnail(handle, doc, pageIndex, maxWidth, maxHeight, thumb) &&
+        store->Put(pageIndex, thumb, EncodeThumbnail(thumb), error)) {
+      entry = store->Current(pageIndex, version);
+    }
+    entries[static_cast<size_t>(i)] = entry;
+  }
+
+  size_t total = 0;
+  for (const ThumbEntry* entry : entries) total += entry ? entry->size : 0;
+  auto data = Napi::Uint8Array::New(env, total);
+  size_t at = 0;
+  for (int i = 0; i < count; ++i) {
+    const ThumbEntry* entry = entries[static_cast<size_t>(i)];
+    if (entry) {
+      std::memcpy(data.Data() + at, store->Bytes(*entry), entry->size);
+      at += entry->size;
+      widths[static_cast<size_t>(i)] = entry->width;
+      heights[static_cast<size_t>(i)] = entry->height;
+    }
+    offsets.push_back(static_cast<uint32_t>(at));
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("first", Napi::Number::New(env, first));
+  result.Set("count", Napi::Number::New(env, count));
+  result.Set("widths", ToTypedArray<Napi::Uint16Array>(env, widths, widths.size()));
+  result.Set("heights", ToTypedArray<Napi::Uint16Array>(env, heights, heights.size()));
+  result.Set("offsets", ToTypedArray<Napi::Uint32Array>(env, offsets, offsets.size()));
+  result.Set("data", data);
+  return result;
+}
+
+void DiscardThumbnails(int handle) {
+  g_thumbnails.erase(handle);
+}
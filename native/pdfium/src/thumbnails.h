@@ -0,0 +1,47 @@
+/**
+ * thumbnails.h — Page thumbnails kept as PNGs in a memory-mapped file.
+ *
+ * Each document gets one store: a temporary file, deleted when closed,
+ * mapped in fixed-size segments and filled append-only.  Only a small
+ * index (page → offset, size, version) lives on the heap; the PNG bytes
+ * are file-backed pages the OS can drop and re-read at will, so memory
+ * stays flat however many pages a document has.  A thumbnail is stale
+ * once its page's version (GetPageVersion) moves on.
+ */
+#ifndef PDFIUM_ADDON_THUMBNAILS_H
+#define PDFIUM_ADDON_THUMBNAILS_H
+
+#include <napi.h>
+
+/**
+ * buildThumbnails(handle, options?, onProgress?)
+ * → { jobId, done: Promise<{ built, current }> }
+ *
+ * options: { maxWidth?: number = 160, maxHeight?: number = 200,
+ *            pages?: number[] }
+ *
+ * Render every missing or stale thumbnail into the store on a
+ * background thread.  Pages are rendered under g_pdfiumMutex and PNG
+ * encoded outside it.  A store of another size is dropped first.
+ */
+Napi::Value BuildThumbnails(const Napi::CallbackInfo& info);
+
+/**
+ * getThumbnails(handle, first, count, options?)
+ * → { first, count, widths: Uint16Array, heights: Uint16Array,
+ *     offsets: Uint32Array, data: Uint8Array }
+ *
+ * options: { maxWidth?: number = 160, maxHeight?: number = 200,
+ *            render?: boolean = false }
+ *
+ * Thumbnails of pages first .. first + count, as PNG files concatenated
+ * in `data`: page first + i is data.subarray(offsets[i], offsets[i + 1]),
+ * empty when missing or stale.  With `render`, those are rendered and
+ * stored first, for the pages on screen.
+ */
+Napi::Value GetThumbnails(const Napi::CallbackInfo& info);
+
+/** Unmap and delete the thumbnail store of a closed document. */
+void DiscardThumbnails(int handle);
+
+#endif // PDFIUM_ADDON_THUMBNAILS_H
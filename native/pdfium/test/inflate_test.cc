@@ -0,0 +1,131 @@
+/**
+ * inflate_test.cc — FlateDecode decoder and encoder: streams from zlib
+ * itself, round trips, and the limits and damage inflate.h promises to
+ * handle.
+ */
+
+#include "test.h"
+#include "deflate.h"
+#include "inflate.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string Decode(const std::vector<uint8_t>& zlib, bool& ok, size_t limit = 1 << 20) {
+  std::vector<uint8_t> out;
+  ok = Inflate(zlib.data(), zlib.size(), out, limit);
+  return std::string(out.begin(), out.end());
+}
+
+std::vector<uint8_t> Encode(const std::string& text) {
+  std::vector<uint8_t> zlib;
+  Deflate(reinterpret_cast<const uint8_t*>(text.data()), text.size(), zlib);
+  return zlib;
+}
+
+/** zlib.compress(b"hello hello hello hello", 9): one fixed-Huffman block. */
+const std::vector<uint8_t> ZLIB_FIXED = {
+  0x78, 0xda, 0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0x57, 0xc8, 0x40, 0x27, 0x01,
+  0x68, 0x03, 0x08, 0xb1,
+};
+
+/** zlib.compress(DYNAMIC_TEXT, 9): one dynamic-Huffman block. */
+const char DYNAMIC_TEXT[] =
+  "tealeeheareseeeooeeehoereellrerraeeehetoeherthueerrleaeh eredenuhotiriatee "
+  "eertsnt itdeesoetenoeuehrtt adnrieetn uee  tlruit auaeiaedeneete eaaneeiahte"
+  "oht oauaeeeeeeueenretteeohadrte sdlu eiuhaaaaenla";
+const std::vector<uint8_t> ZLIB_DYNAMIC = {
+  0x78, 0xda, 0x1d, 0x8d, 0x41, 0x0a, 0x44, 0x31, 0x08, 0x43, 0xaf, 0xe2,
+  0xd5, 0x84, 0x3e, 0x50, 0x28, 0x15, 0x6c, 0x7a, 0xff, 0xf1, 0x4f, 0x16,
+  0x41, 0x93, 0x18, 0x85, 0x6f, 0x08, 0xbc, 0xb9, 0x40, 0xd5, 0x50, 0x14,
+  0x0d, 0x7b, 0x37, 0xdd, 0xfe, 0xed, 0xa8, 0x86, 0x5a, 0xf1, 0x18, 0x69,
+  0xe3, 0x84, 0x4d, 0x64, 0x71, 0x5e, 0x94, 0xb2, 0xd3, 0x05, 0x36, 0x9e,
+  0xee, 0x91, 0xa5, 0x16, 0xdc, 0x42, 0x9c, 0xe2, 0x11, 0x2d, 0x99, 0xaf,
+  0xd3, 0x09, 0x3a, 0x36, 0x15, 0x66, 0xda, 0xfd, 0x72, 0xd4, 0xe7, 0xa4,
+  0x7f, 0x3d, 0x63, 0x4d, 0x81, 0xfb, 0x0c, 0xe9, 0x21, 0x2a, 0x64, 0xf5,
+  0xd9, 0x7f, 0xcc, 0xcd, 0x69, 0x34, 0x4f, 0x2a, 0x7c, 0xf5, 0x44, 0xef,
+  0xda, 0xcf, 0xc8, 0x17, 0x3e, 0xe0, 0x6c, 0xff, 0x01, 0x7a, 0x17, 0x4f,
+  0x55,
+};
+
+}  // namespace
+
+TEST(InflateFixedHuffmanBlock) {
+  bool ok = false;
+  CHECK_EQ(Decode(ZLIB_FIXED, ok), std::string("hello hello hello hello"));
+  CHECK(ok);
+}
+
+TEST(InflateDynamicHuffmanBlock) {
+  bool ok = false;
+  CHECK_EQ(Decode(ZLIB_DYNAMIC, ok), std::string(DYNAMIC_TEXT));
+  CHECK(ok);
+}
+
+TEST(InflateStoredBlock) {
+  // Header, final stored block of 3 bytes (LEN, ~LEN), then Adler-32.
+  const std::vector<uint8_t> zlib = {
+    0x78, 0x01, 0x01, 0x03, 0x00, 0xfc, 0xff, 'a', 'b', 'c',
+    0x02, 0x4d, 0x01, 0x27,
+  };
+  bool ok = false;
+  CHECK_EQ(Decode(zlib, ok), std::string("abc"));
+  CHECK(ok);
+}
+
+TEST(InflateStopsAtLimit) {
+  bool ok = true;
+  const std::string partial = Decode(ZLIB_FIXED, ok, 8);
+  CHECK(!ok);
+  CHECK(partial.size() <= 8 + 258);  // at most one match past the limit
+}
+
+TEST(InflateRejectsCorruptData) {
+  std::vector<uint8_t> zlib = ZLIB_FIXED;
+  zlib[2] = 0xff;  // reserved block type 11
+  bool ok = true;
+  Decode(zlib, ok);
+  CHECK(!ok);
+
+  // Truncated: fails, keeping what decoded before the cut.
+  std::vector<uint8_t> cut(ZLIB_DYNAMIC.begin(), ZLIB_DYNAMIC.begin() + 60);
+  ok = true;
+  const std::string partial = Decode(cut, ok);
+  CHECK(!ok);
+  CHECK(std::string(DYNAMIC_TEXT).compare(0, partial.size(), partial) == 0);
+}
+
+TEST(DeflateRoundTrips) {
+  std::string repetitive;
+  for (int i = 0; i < 2000; i++) repetitive += "row " + std::to_string(i % 17) + "; ";
+  std::string noise;
+  uint32_t x = 12345;
+  for (int i = 0; i < 70000; i++) {
+    x = x * 1103515245u + 12345u;
+    noise += static_cast<char>(x >> 24);
+  }
+
+  for (const std::string& text : { std::string(), std::string("a"), repetitive, noise }) {
+    const std::vector<uint8_t> zlib = Encode(text);
+    bool ok = false;
+    CHECK(Decode(zlib, ok, text.size() + 1) == text);
+    CHECK(ok);
+  }
+  // Matches make repetitive data much smaller.
+  CHECK(Encode(repetitive).size() < repetitive.size() / 4);
+}
+
+TEST(DeflateEndsWithAdler32) {
+  CHECK_EQ(Adler32(reinterpret_cast<const uint8_t*>("Wikipedia"), 9), 300286872u);
+  CHECK_EQ(Adler32(nullptr, 0), 1u);
+
+  const std::string text = "checksum me";
+  const std::vector<uint8_t> zlib = Encode(text);
+  const uint32_t adler = Adler32(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+  const size_t n = zlib.size();
+  CHECK_EQ((uint32_t(zlib[n - 4]) << 24) | (zlib[n - 3] << 16) | (zlib[n - 2] << 8) | zlib[n - 1],
+           adler);
+}
@@ -0,0 +1,158 @@
+/**
+ * layers_test.cc — Pixel kernels: the SSE2/NEON bulk loops must give
+ * the same bytes as the scalar tails they stand in for.  A one-pixel
+ * call never enters a vector loop, so it is the scalar result.
+ */
+
+#include "test.h"
+#include "layers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+/** `n` RGBA pixels of deterministic noise, with every alpha present. */
+std::vector<uint8_t> Noise(int n, uint32_t seed) {
+  std::vector<uint8_t> pixels(static_cast<size_t>(n) * 4);
+  uint32_t x = seed;
+  for (size_t i = 0; i < pixels.size(); i++) {
+    x = x * 1664525u + 1013904223u;
+    pixels[i] = static_cast<uint8_t>(x >> 24);
+  }
+  for (int i = 0; i < n; i++) pixels[i * 4 + 3] = static_cast<uint8_t>(i);
+  // Extremes, where rounding and clamping go wrong first.
+  const uint8_t edges[][4] = {
+    { 0, 0, 0, 0 }, { 255, 255, 255, 255 }, { 0, 0, 0, 255 },
+    { 255, 255, 255, 0 }, { 128, 127, 129, 128 }, { 255, 0, 128, 1 },
+  };
+  for (size_t e = 0; e < sizeof(edges) / sizeof(edges[0]) && e < size_t(n); e++) {
+    std::copy(edges[e], edges[e] + 4, &pixels[e * 4]);
+  }
+  return pixels;
+}
+
+/** Pixel count with a ragged tail after the four- and eight-pixel loops. */
+constexpr int PIXELS = 256 * 16 + 7;
+
+}  // namespace
+
+TEST(BlendRowOverMatchesScalar) {
+  const std::vector<uint8_t> src = Noise(PIXELS, 7);
+  const std::vector<uint8_t> base = Noise(PIXELS, 11);
+
+  std::vector<uint8_t> bulk = base;
+  BlendRowOver(bulk.data(), src.data(), PIXELS);
+
+  std::vector<uint8_t> single = base;
+  for (int i = 0; i < PIXELS; i++) BlendRowOver(&single[i * 4], &src[i * 4], 1);
+  CHECK(bulk == single);
+
+  // Both are (src·a + dst·(255 − a)) / 255 rounded to nearest, opaque.
+  for (int i = 0; i < PIXELS; i++) {
+    const unsigned a = src[i * 4 + 3];
+    for (int c = 0; c < 3; c++) {
+      const unsigned t = src[i * 4 + c] * a + base[i * 4 + c] * (255 - a);
+      CHECK_EQ(unsigned(bulk[i * 4 + c]), (t + 127) / 255);
+    }
+    CHECK_EQ(int(bulk[i * 4 + 3]), 255);
+  }
+}
+
+TEST(RotatePixelsMatchesNaiveTurn) {
+  // Sizes below, at and across the 4×4 block and 64-pixel tile edges.
+  const int sizes[][2] = { { 1, 1 }, { 1, 5 }, { 5, 1 }, { 4, 4 }, { 37, 23 }, { 130, 67 } };
+  for (const auto& size : sizes) {
+    const int w = size[0], h = size[1];
+    const std::vector<uint8_t> src = Noise(w * h, uint32_t(w * 1000 + h));
+    for (int turns = 0; turns < 4; turns++) {
+      std::vector<uint8_t> dst(src.size(), 0);
+      RotatePixels(src.data(), w, h, turns, dst.data());
+
+      // Clockwise turns: a source pixel (x, y) lands at (dx, dy) of a
+      // destination dw pixels wide.
+      const int dw = turns % 2 ? h : w;
+      bool same = true;
+      for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+          int dx = x, dy = y;
+          if (turns == 1) { dx = h - 1 - y; dy = x; }
+          if (turns == 2) { dx = w - 1 - x; dy = h - 1 - y; }
+          if (turns == 3) { dx = y; dy = w - 1 - x; }
+          same = same && std::equal(&src[(size_t(y) * w + x) * 4],
+                                    &src[(size_t(y) * w + x) * 4] + 4,
+                                    &dst[(size_t(dy) * dw + dx) * 4]);
+        }
+      }
+      CHECK(same);
+    }
+  }
+}
+
+TEST(FilterPixelsMatchesScalar) {
+  const std::vector<uint8_t> src = Noise(PIXELS, 23);
+  for (ViewFilter filter : { ViewFilter::Invert, ViewFilter::Dark, ViewFilter::Contrast }) {
+    std::vector<uint8_t> bulk(src.size());
+    FilterPixels(src.data(), PIXELS, filter, bulk.data());
+
+    std::vector<uint8_t> single(src.size());
+    for (int i = 0; i < PIXELS; i++) FilterPixels(&src[i * 4], 1, filter, &single[i * 4]);
+    CHECK(bulk == single);
+
+    // filterBitmap may be handed its source buffer as the target.
+    std::vector<uint8_t> inPlace = src;
+    FilterPixels(inPlace.data(), PIXELS, filter, inPlace.data());
+    CHECK(inPlace == bulk);
+
+    for (int i = 0; i < PIXELS; i++) CHECK_EQ(bulk[i * 4 + 3], src[i * 4 + 3]);
+  }
+}
+
+TEST(DownsamplePixelsAveragesBoxes) {
+  // 4×2 BGRA down to 2×1: each output pixel is the mean of a 2×2 box.
+  const uint8_t src[] = {
+    0, 0, 0, 255,    0, 0, 255, 255,    10, 20, 30, 0,   10, 20, 30, 0,
+    0, 0, 0, 255,    0, 0, 255, 255,    10, 20, 30, 0,   10, 20, 30, 0,
+  };
+  uint8_t out[8];
+  DownsamplePixels(src, 16, 4, true, 4, 2, 2, 1, out);
+  const uint8_t expected[] = { 128, 0, 0, 255, 30, 20, 10, 0 };
+  CHECK(std::equal(out, out + 8, expected));
+
+  // Without alpha the fourth byte is ignored and the result is opaque.
+  DownsamplePixels(src, 16, 4, false, 4, 2, 2, 1, out);
+  CHECK_EQ(int(out[7]), 255);
+}
+
+TEST(DownsamplePixelsSumsHugeBoxes) {
+  // One box of 4200² white pixels sums to 255 · 17.64M, past 2³².
+  const int edge = 4200;
+  const std::vector<uint8_t> gray(static_cast<size_t>(edge) * edge, 255);
+  uint8_t out[4];
+  DownsamplePixels(gray.data(), edge, 1, false, edge, edge, 1, 1, out);
+  for (int c = 0; c < 4; c++) CHECK_EQ(int(out[c]), 255);
+}
+
+TEST(FilterPixelsMapsPaperAndInk) {
+  const uint8_t white[4] = { 255, 255, 255, 255 }, black[4] = { 0, 0, 0, 255 };
+  uint8_t out[4];
+
+  FilterPixels(white, 1, ViewFilter::Invert, out);
+  CHECK_EQ(int(out[0]), 0);
+
+  // Dark mode keeps paper off pure black and ink off pure white.
+  FilterPixels(white, 1, ViewFilter::Dark, out);
+  const int paper = out[0];
+  FilterPixels(black, 1, ViewFilter::Dark, out);
+  const int ink = out[0];
+  CHECK(paper > 0 && paper < 64);
+  CHECK(ink > 192 && ink < 255);
+
+  // Contrast pushes near-white to white and leaves mid grey alone.
+  const uint8_t light[4] = { 230, 230, 230, 255 }, grey[4] = { 128, 128, 128, 255 };
+  FilterPixels(light, 1, ViewFilter::Contrast, out);
+  CHECK_EQ(int(out[0]), 255);
+  FilterPixels(grey, 1, ViewFilter::Contrast, out);
+  CHECK_EQ(int(out[0]), 128);
+}
@@ -0,0 +1,42 @@
+/**
+ * main.cc — Runs every TEST() linked into pdfium_tests.
+ *
+ * Usage: pdfium_tests [name-substring]
+ */
+
+#include "test.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+int g_failures = 0;
+bool g_currentFailed = false;
+
+}  // namespace
+
+std::vector<TestCase>& TestCases() {
+  static std::vector<TestCase> cases;
+  return cases;
+}
+
+void TestFailed(const char* file, int line, const std::string& what) {
+  std::fprintf(stderr, "  %s:%d: CHECK failed: %s\n", file, line, what.c_str());
+  g_currentFailed = true;
+}
+
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : nullptr;
+  int run = 0;
+  for (const TestCase& test : TestCases()) {
+    if (filter && !std::strstr(test.name, filter)) continue;
+    g_currentFailed = false;
+    test.run();
+    run++;
+    if (g_currentFailed) g_failures++;
+    std::printf("%s %s\n", g_currentFailed ? "FAIL" : "ok  ", test.name);
+  }
+  std::printf("%d run, %d failed\n", run, g_failures);
+  return g_failures == 0 ? 0 : 1;
+}
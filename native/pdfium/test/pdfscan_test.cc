@@ -0,0 +1,219 @@
+/**
+ * pdfscan_test.cc — Tokenizer, object parser, cross-reference reader
+ * and content scanner of the PDFium-free structure reader.
+ */
+
+#include "test.h"
+#include "deflate.h"
+#include "pdfscan.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/** Tokens of `text`; they point into it, so it must outlive them. */
+std::vector<PdfToken> Tokens(const std::string& text) {
+  PdfLexer lexer(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+  std::vector<PdfToken> tokens;
+  for (PdfToken t; lexer.Next(t);) tokens.push_back(t);
+  return tokens;
+}
+
+bool Parse(const std::string& text, PdfObject& out) {
+  PdfLexer lexer(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+  return ParseObject(lexer, out);
+}
+
+/** Objects 1..n written out with a correct xref table and trailer. */
+std::string BuildPdf(const std::vector<std::string>& objects) {
+  std::string pdf = "%PDF-1.7\n";
+  std::vector<size_t> offsets;
+  for (size_t i = 0; i < objects.size(); i++) {
+    offsets.push_back(pdf.size());
+    pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+  }
+  const size_t xref = pdf.size();
+  pdf += "xref\n0 " + std::to_string(objects.size() + 1) + "\n0000000000 65535 f \n";
+  for (size_t offset : offsets) {
+    char entry[21];
+    std::snprintf(entry, sizeof(entry), "%010zu 00000 n \n", offset);
+    pdf += entry;
+  }
+  pdf += "trailer\n<< /Size " + std::to_string(objects.size() + 1) +
+         " /Root 1 0 R >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n";
+  return pdf;
+}
+
+std::string WriteTemp(const std::string& name, const std::string& bytes) {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+  std::ofstream(path, std::ios::binary) << bytes;
+  return path.u8string();
+}
+
+std::string Stream(const std::string& dict, const std::string& data) {
+  return "<< " + dict + " /Length " + std::to_string(data.size()) + " >>\nstream\n" +
+         data + "\nendstream";
+}
+
+std::string Compress(const std::string& text) {
+  std::vector<uint8_t> zlib;
+  Deflate(reinterpret_cast<const uint8_t*>(text.data()), text.size(), zlib);
+  return std::string(zlib.begin(), zlib.end());
+}
+
+const std::vector<std::string> TWO_PAGES = {
+  "<< /Type /Catalog /Pages 2 0 R >>",
+  "<< /Type /Pages /Kids [3 0 R 4 0 R] /Count 2 /Resources << /Font << >> >> >>",
+  "<< /Type /Page /Parent 2 0 R /Contents 5 0 R >>",
+  "<< /Type /Page /Parent 2 0 R /Resources << /XObject << >> >> >>",
+  Stream("/Filter /FlateDecode", Compress("0 0 m 10 10 l S BT (Hi) Tj ET")),
+};
+
+}  // namespace
+
+TEST(LexerSplitsTokens) {
+  const std::string text = "12 -3.5 /Na#20me (a\\)b) <48 69> [ ] << >> obj";
+  std::vector<PdfToken> t = Tokens(text);
+  CHECK_EQ(t.size(), 10u);
+  CHECK(t[0].type == PdfTokenType::Number && t[0].integer && t[0].number == 12);
+  CHECK(t[1].type == PdfTokenType::Number && !t[1].integer && t[1].number == -3.5);
+  CHECK(t[2].type == PdfTokenType::Name);
+  CHECK_EQ(DecodeName(t[2]), std::string("Na me"));
+  CHECK(t[3].type == PdfTokenType::String);
+  CHECK_EQ(DecodeString(t[3]), std::string("a)b"));
+  CHECK(t[4].type == PdfTokenType::HexString);
+  CHECK_EQ(DecodeString(t[4]), std::string("Hi"));
+  CHECK(t[5].type == PdfTokenType::ArrayOpen && t[6].type == PdfTokenType::ArrayClose);
+  CHECK(t[7].type == PdfTokenType::DictOpen && t[8].type == PdfTokenType::DictClose);
+  CHECK(t[9].type == PdfTokenType::Keyword && t[9].Is("obj"));
+}
+
+TEST(LexerSkipsComments) {
+  const std::string text = "% comment\n1 % more\r2";
+  std::vector<PdfToken> t = Tokens(text);
+  CHECK_EQ(t.size(), 2u);
+  CHECK_EQ(t[1].number, 2.0);
+}
+
+TEST(DecodeStringResolvesEscapes) {
+  const std::string text = "(a\\nb\\101\\\\\\(c\\)) <4>";
+  std::vector<PdfToken> t = Tokens(text);
+  CHECK_EQ(DecodeString(t[0]), std::string("a\nbA\\(c)"));
+  // An odd hex digit count ends in a high nibble.
+  CHECK_EQ(DecodeString(t[1]), std::string("@"));
+}
+
+TEST(ParseObjectFoldsReferences) {
+  PdfObject o;
+  CHECK(Parse("<< /Kids [1 0 R 2 0 R] /Count 2 /Flag true /N null >>", o));
+  CHECK(o.type == PdfObject::Dict);
+  const PdfObject* kids = o.Get("Kids");
+  CHECK(kids && kids->type == PdfObject::Array);
+  CHECK_EQ(kids->items.size(), 2u);
+  CHECK(kids->items[1].type == PdfObject::Ref);
+  CHECK_EQ(kids->items[1].num, 2);
+  CHECK_EQ(o.Get("Count")->Int(), 2);
+  CHECK(o.Get("Flag")->type == PdfObject::Bool && o.Get("Flag")->boolean);
+  CHECK(o.Get("N")->type == PdfObject::Null);
+  CHECK(o.Get("Missing") == nullptr);
+}
+
+TEST(ParseObjectRejectsDeepNesting) {
+  PdfObject o;
+  CHECK(!Parse(std::string(100, '[') + std::string(100, ']'), o));
+  CHECK(!Parse("<< /A ", o));
+}
+
+TEST(StreamFiltersReadsNamesAndArrays) {
+  PdfObject one, two;
+  CHECK(Parse("<< /Filter /FlateDecode >>", one));
+  CHECK(Parse("<< /Filter [/FlateDecode /DCTDecode] >>", two));
+  CHECK_EQ(StreamFilters(one).size(), 1u);
+  CHECK_EQ(StreamFilters(two).size(), 2u);
+  CHECK_EQ(StreamFilters(two)[1], std::string("DCTDecode"));
+}
+
+TEST(UndoPngPredictorRestoresRows) {
+  // Two rows of three 8-bit gray samples: Sub, then Up.
+  std::vector<uint8_t> rows = { 1, 10, 5, 5, 2, 1, 1, 1 };
+  CHECK(UndoPngPredictor(rows, 1, 8, 3));
+  CHECK(rows == std::vector<uint8_t>({ 10, 15, 20, 11, 16, 21 }));
+
+  std::vector<uint8_t> bad = { 5, 0, 0, 0 };
+  CHECK(!UndoPngPredictor(bad, 1, 8, 3));
+}
+
+TEST(FileReadsXrefTableAndPages) {
+  const std::string path = WriteTemp("pdfscan_test_table.pdf", BuildPdf(TWO_PAGES));
+  PdfFile file;
+  std::string error;
+  CHECK(file.Open(path, error));
+  CHECK_EQ(file.Version(), std::string("1.7"));
+  CHECK(file.Source() == XrefSource::Table);
+  CHECK(!file.Encrypted());
+
+  std::vector<PdfPageRef> pages = file.Pages();
+  CHECK_EQ(pages.size(), 2u);
+  CHECK_EQ(pages[0].num, 3);
+  // Resources are inherited from the tree node unless the page has its own.
+  CHECK(pages[0].resources.Get("Font") != nullptr);
+  CHECK(pages[1].resources.Get("XObject") != nullptr);
+
+  PdfObject dict;
+  ByteSpan raw;
+  CHECK(file.Load(5, dict, &raw));
+  std::vector<uint8_t> decoded;
+  CHECK(file.DecodeStream(dict, raw, decoded, 1 << 20));
+  CHECK_EQ(std::string(decoded.begin(), decoded.end()),
+           std::string("0 0 m 10 10 l S BT (Hi) Tj ET"));
+  // Over the limit is a failure, not a silent truncation.
+  decoded.clear();
+  CHECK(!file.DecodeStream(dict, raw, decoded, 4));
+  std::remove(path.c_str());
+}
+
+TEST(FileRebuildsDamagedXref) {
+  std::string pdf = BuildPdf(TWO_PAGES);
+  const size_t at = pdf.rfind("startxref\n") + 10;
+  pdf.replace(at, pdf.find('\n', at) - at, "999999");
+  // startxref points past the end: the objects are found by scanning.
+  const std::string path = WriteTemp("pdfscan_test_rebuild.pdf", pdf);
+  PdfFile file;
+  std::string error;
+  CHECK(file.Open(path, error));
+  CHECK(file.Source() == XrefSource::Rebuilt);
+  CHECK_EQ(file.Pages().size(), 2u);
+  std::remove(path.c_str());
+}
+
+TEST(FileRejectsEmptyFile) {
+  const std::string path = WriteTemp("pdfscan_test_empty.pdf", "");
+  PdfFile file;
+  std::string error;
+  CHECK(!file.Open(path, error));
+  CHECK(!error.empty());
+  std::remove(path.c_str());
+}
+
+TEST(ScanContentCountsOperators) {
+  const std::string content =
+    "q 1 0 0 1 0 0 cm 0 0 m 1 1 l 0 0 5 5 re f S\n"
+    "BT /F1 12 Tf (a) Tj [(b) 2 (c)] TJ ET\n"
+    "/Im1 Do BI /W 1 /H 1 ID \x01\x02 EI Q";
+  ContentStats stats;
+  std::vector<std::string> xobjects;
+  ScanContent(reinterpret_cast<const uint8_t*>(content.data()), content.size(),
+              stats, xobjects);
+  CHECK_EQ(stats.pathSegments, 3u);
+  CHECK_EQ(stats.paints, 2u);
+  CHECK_EQ(stats.textShows, 2u);
+  CHECK_EQ(stats.images, 1u);
+  CHECK_EQ(xobjects.size(), 1u);
+  CHECK_EQ(xobjects[0], std::string("Im1"));
+  // q cm m l re f S BT Tf Tj TJ ET Do BI Q
+  CHECK_EQ(stats.operators, 15u);
+}
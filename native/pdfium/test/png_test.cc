@@ -0,0 +1,192 @@
+/**
+ * png_test.cc — PNG writer, checked by decoding its output: chunk CRCs,
+ * the header, and scanlines unfiltered back to the input samples.
+ */
+
+#include "test.h"
+#include "deflate.h"
+#include "inflate.h"
+#include "png.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+uint32_t ReadU32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+uint32_t Crc32(const uint8_t* data, size_t size) {
+  uint32_t c = 0xffffffffu;
+  for (size_t i = 0; i < size; i++) {
+    c ^= data[i];
+    for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+  }
+  return c ^ 0xffffffffu;
+}
+
+struct DecodedPng {
+  bool ok = false;
+  uint32_t width = 0, height = 0;
+  int bitDepth = 0, color = -1;
+  std::vector<std::string> chunks;
+  std::vector<uint8_t> idat;     // concatenated zlib stream
+  std::vector<uint8_t> samples;  // unfiltered rows, tightly packed
+};
+
+/** Reference decoder for the subset the writer emits. */
+DecodedPng Decode(const std::vector<uint8_t>& file) {
+  DecodedPng png;
+  static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  if (file.size() < 8 || !std::equal(SIGNATURE, SIGNATURE + 8, file.begin())) return png;
+
+  for (size_t at = 8; at + 12 <= file.size();) {
+    const uint32_t length = ReadU32(&file[at]);
+    if (at + 12 + length > file.size()) return png;
+    const uint8_t* type = &file[at + 4];
+    const uint8_t* data = type + 4;
+    if (Crc32(type, length + 4) != ReadU32(data + length)) return png;
+    png.chunks.emplace_back(reinterpret_cast<const char*>(type), 4);
+    if (png.chunks.back() == "IHDR") {
+      png.width = ReadU32(data);
+      png.height = ReadU32(data + 4);
+      png.bitDepth = data[8];
+      png.color = data[9];
+    } else if (png.chunks.back() == "IDAT") {
+      png.idat.insert(png.idat.end(), data, data + length);
+    }
+    at += 12 + length;
+  }
+
+  std::vector<uint8_t> raw;
+  if (!Inflate(png.idat.data(), png.idat.size(), raw, size_t(1) << 26)) return png;
+  const int channels = png.color == 2 ? 3 : png.color == 6 ? 4 : 1;
+  const size_t bitsPerPixel = size_t(channels) * png.bitDepth;
+  const size_t rowBytes = (png.width * bitsPerPixel + 7) / 8;
+  const size_t bpp = bitsPerPixel < 8 ? 1 : bitsPerPixel / 8;
+  if (raw.size() != png.height * (rowBytes + 1)) return png;
+
+  std::vector<uint8_t> prior(rowBytes, 0);
+  for (uint32_t y = 0; y < png.height; y++) {
+    const uint8_t filter = raw[y * (rowBytes + 1)];
+    uint8_t* row = &raw[y * (rowBytes + 1) + 1];
+    for (size_t i = 0; i < rowBytes; i++) {
+      const int a = i >= bpp ? row[i - bpp] : 0;
+      const int b = prior[i];
+      const int c = i >= bpp ? prior[i - bpp] : 0;
+      int predicted = 0;
+      switch (filter) {
+        case 0: break;
+        case 1: predicted = a; break;
+        case 2: predicted = b; break;
+        case 3: predicted = (a + b) / 2; break;
+        case 4: {
+          const int p = a + b - c;
+          const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+          predicted = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+          break;
+        }
+        default: return png;
+      }
+      row[i] = static_cast<uint8_t>(row[i] + predicted);
+    }
+    png.samples.insert(png.samples.end(), row, row + rowBytes);
+    prior.assign(row, row + rowBytes);
+  }
+  png.ok = true;
+  return png;
+}
+
+/** Rows of deterministic noise mixed with gradients, so every filter wins somewhere. */
+std::vector<uint8_t> Samples(size_t rowBytes, size_t stride, int height) {
+  std::vector<uint8_t> pixels(stride * height, 0xee);  // padding must be ignored
+  uint32_t x = 99;
+  for (int y = 0; y < height; y++) {
+    for (size_t i = 0; i < rowBytes; i++) {
+      x = x * 1664525u + 1013904223u;
+      pixels[y * stride + i] = y % 3 == 0 ? static_cast<uint8_t>(x >> 24)
+                             : static_cast<uint8_t>(i * 3 + y * 5);
+    }
+  }
+  return pixels;
+}
+
+std::vector<uint8_t> Unpadded(const std::vector<uint8_t>& pixels, size_t rowBytes,
+                              size_t stride, int height) {
+  std::vector<uint8_t> rows;
+  for (int y = 0; y < height; y++) {
+    rows.insert(rows.end(), pixels.begin() + y * stride, pixels.begin() + y * stride + rowBytes);
+  }
+  return rows;
+}
+
+void CheckRoundTrip(PngColor color, int channels, int bitDepth, int width, int height) {
+  const size_t rowBytes = (size_t(width) * channels * bitDepth + 7) / 8;
+  const size_t stride = rowBytes + 5;
+  std::vector<uint8_t> pixels = Samples(rowBytes, stride, height);
+  // Bits past the last sample of a packed row are not part of the image.
+  if ((width * channels * bitDepth) % 8) {
+    const int spare = 8 - (width * channels * bitDepth) % 8;
+    for (int y = 0; y < height; y++) {
+      pixels[y * stride + rowBytes - 1] &= static_cast<uint8_t>(0xff << spare);
+    }
+  }
+
+  std::vector<uint8_t> file;
+  EncodePng(pixels.data(), stride, width, height, color, bitDepth, file);
+  const DecodedPng png = Decode(file);
+  CHECK(png.ok);
+  CHECK_EQ(png.width, uint32_t(width));
+  CHECK_EQ(png.height, uint32_t(height));
+  CHECK_EQ(png.bitDepth, bitDepth);
+  CHECK_EQ(png.color, int(color));
+  CHECK(png.samples == Unpadded(pixels, rowBytes, stride, height));
+}
+
+}  // namespace
+
+TEST(EncodePngWritesValidChunks) {
+  const uint8_t pixels[4] = { 0, 64, 128, 255 };
+  std::vector<uint8_t> file;
+  EncodePng(pixels, 2, 2, 2, PngColor::Gray, 8, file);
+  const DecodedPng png = Decode(file);
+  CHECK(png.ok);
+  CHECK_EQ(png.chunks.size(), 3u);
+  CHECK_EQ(png.chunks.front(), std::string("IHDR"));
+  CHECK_EQ(png.chunks.back(), std::string("IEND"));
+}
+
+TEST(EncodePngRoundTripsEightBit) {
+  CheckRoundTrip(PngColor::Gray, 1, 8, 37, 11);
+  CheckRoundTrip(PngColor::Rgb, 3, 8, 64, 20);
+  CheckRoundTrip(PngColor::Rgba, 4, 8, 5, 7);
+}
+
+TEST(EncodePngRoundTripsPackedGray) {
+  CheckRoundTrip(PngColor::Gray, 1, 1, 45, 9);
+  CheckRoundTrip(PngColor::Gray, 1, 2, 13, 6);
+  CheckRoundTrip(PngColor::Gray, 1, 4, 7, 5);
+}
+
+TEST(EncodePngRoundTripsSixteenBit) {
+  CheckRoundTrip(PngColor::Gray, 1, 16, 19, 8);
+  CheckRoundTrip(PngColor::Rgb, 3, 16, 10, 10);
+}
+
+TEST(WrapPngKeepsStreamVerbatim) {
+  // Two rows of filtered 8-bit gray, as a PNG-predicted FlateDecode stream holds them.
+  const uint8_t filtered[] = { 1, 10, 5, 5, 2, 1, 1, 1 };
+  std::vector<uint8_t> zlib;
+  Deflate(filtered, sizeof(filtered), zlib);
+
+  std::vector<uint8_t> file;
+  WrapPng(zlib.data(), zlib.size(), 3, 2, PngColor::Gray, 8, file);
+  const DecodedPng png = Decode(file);
+  CHECK(png.ok);
+  CHECK(png.idat == zlib);
+  CHECK(png.samples == std::vector<uint8_t>({ 10, 15, 20, 11, 16, 21 }));
+}
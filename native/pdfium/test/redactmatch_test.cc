@@ -0,0 +1,74 @@
+/**
+ * redactmatch_test.cc — Redaction hits: literal terms, whole words, and
+ * regex patterns over pages far longer than std::regex can recurse over.
+ */
+
+#include "test.h"
+#include "redactmatch.h"
+#include "regexsearch.h"
+
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+const auto FLAGS = std::regex::ECMAScript | std::regex::optimize | std::regex::icase;
+
+std::vector<std::wregex> Patterns(std::initializer_list<const wchar_t*> sources) {
+  std::vector<std::wregex> patterns;
+  for (const wchar_t* source : sources) patterns.emplace_back(source, FLAGS);
+  return patterns;
+}
+
+bool Has(const std::vector<RedactMatch>& matches, size_t start, size_t end) {
+  for (const RedactMatch& m : matches) {
+    if (m.start == start && m.end == end) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(RedactMatcherFindsTermsAndPatterns) {
+  const std::wstring text = L"Call ACME on 555-0100 or acmecorp on 555-0199.";
+  RedactMatcher matcher({ L"acme" }, Patterns({ L"\\d{3}-\\d{4}" }), false, false);
+  std::vector<RedactMatch> matches;
+  CHECK_EQ(matcher.FindAll(text, matches), 0u);
+  CHECK_EQ(matches.size(), 4u);
+  CHECK(Has(matches, 5, 9));
+  CHECK(Has(matches, 25, 29));
+  CHECK(Has(matches, 13, 21));
+  CHECK(Has(matches, 37, 45));
+}
+
+TEST(RedactMatcherWholeWordAppliesToTerms) {
+  const std::wstring text = L"acme acmecorp ACME";
+  RedactMatcher matcher({ L"acme" }, {}, false, true);
+  std::vector<RedactMatch> matches;
+  matcher.FindAll(text, matches);
+  CHECK_EQ(matches.size(), 2u);
+  CHECK(Has(matches, 0, 4));
+  CHECK(Has(matches, 14, 18));
+
+  RedactMatcher exact({ L"acme" }, {}, true, true);
+  matches.clear();
+  exact.FindAll(text, matches);
+  CHECK_EQ(matches.size(), 1u);
+}
+
+TEST(RedactMatcherSurvivesLongSingleRunPage) {
+  // One run of text with no line breaks, as a scanned-and-OCRed or
+  // machine-generated page can be: unbounded std::regex recursion over
+  // it overflows the job thread's stack.
+  std::wstring text(200000, L'x');
+  text.replace(100000, 11, L"555-0100 ok");
+  RedactMatcher matcher({}, Patterns({ L"[\\s\\S]+", L"x+", L"\\d{3}-\\d{4}" }), false, false);
+  std::vector<RedactMatch> matches;
+  const size_t skipped = matcher.FindAll(text, matches);
+
+  // The short match is found; the page-long ones are reported, not redacted.
+  CHECK(Has(matches, 100000, 100008));
+  CHECK(skipped > 0);
+  for (const RedactMatch& m : matches) CHECK(m.end - m.start <= 2 * MAX_REGEX_MATCH);
+}
@@ -0,0 +1,98 @@
+/**
+ * regexsearch_test.cc — Windowed regex search: same hits as
+ * regex_iterator where matches are short, bounded work where they are not.
+ */
+
+#include "test.h"
+#include "regexsearch.h"
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+const auto FLAGS = std::regex::ECMAScript | std::regex::optimize | std::regex::icase;
+
+/** Words and line breaks, as page text reads. */
+std::wstring PageText(size_t length) {
+  static const wchar_t* WORDS[] = {
+    L"Acme", L"Corp", L"invoice", L"2024", L"total:", L"due", L"net-30", L"the", L"of", L"A",
+  };
+  std::wstring text;
+  uint32_t x = 7;
+  while (text.size() < length) {
+    x = x * 1664525u + 1013904223u;
+    text += WORDS[(x >> 24) % 10];
+    text += (x >> 16) % 9 == 0 ? L"\r\n" : L" ";
+  }
+  text.resize(length);
+  return text;
+}
+
+std::vector<RegexMatch> Expected(const std::wstring& text, const std::wregex& pattern,
+                                 const std::wstring& format) {
+  std::vector<RegexMatch> hits;
+  for (std::wsregex_iterator it(text.begin(), text.end(), pattern), end; it != end; ++it) {
+    if (it->length(0) == 0) continue;
+    const size_t start = static_cast<size_t>(it->position(0));
+    hits.push_back({ start, start + static_cast<size_t>(it->length(0)), it->format(format) });
+  }
+  return hits;
+}
+
+bool Same(const std::vector<RegexMatch>& a, const std::vector<RegexMatch>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].start != b[i].start || a[i].end != b[i].end ||
+        a[i].replacement != b[i].replacement) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(RegexSearchMatchesIteratorOnShortHits) {
+  const std::wstring text = PageText(5000);
+  for (const wchar_t* source : {
+         L"acme\\s+corp", L"\\bA\\b", L"\\d+", L"^Acme", L"due$", L"(\\w+)-(\\d+)",
+         L"t\\w*", L"x*", L"[^ ]{1,40}", L"of the|the of",
+       }) {
+    const std::wregex pattern(source, FLAGS);
+    std::vector<RegexMatch> hits;
+    CHECK_EQ(FindRegexMatches(text, pattern, L"[$1|$&]", hits), 0u);
+    CHECK(Same(hits, Expected(text, pattern, L"[$1|$&]")));
+  }
+}
+
+TEST(RegexSearchFindsLastShortMatch) {
+  std::wstring text(3 * MAX_REGEX_MATCH, L' ');
+  text += L"needle";
+  std::vector<RegexMatch> hits;
+  FindRegexMatches(text, std::wregex(L"needle$", FLAGS), L"pin", hits);
+  CHECK_EQ(hits.size(), 1u);
+  CHECK_EQ(hits[0].start, 3 * MAX_REGEX_MATCH);
+  CHECK(hits[0].replacement == L"pin");
+}
+
+TEST(RegexSearchSkipsOverlongMatchesOnLongPage) {
+  // Long enough that an unbounded match overflows any thread's stack.
+  const std::wstring text = PageText(200000);
+  for (const wchar_t* source : { L"[\\s\\S]+", L"(a|c|m|e| |\\w)+", L"[^\\r\\n]+\\r\\n" }) {
+    std::vector<RegexMatch> hits;
+    const size_t tooLong = FindRegexMatches(text, std::wregex(source, FLAGS), L"", hits);
+    for (const RegexMatch& hit : hits) CHECK(hit.end - hit.start < 2 * MAX_REGEX_MATCH);
+    if (source[1] == L'\\') {
+      // One run over the whole page: nothing reported, the run counted once.
+      CHECK(hits.empty());
+      CHECK_EQ(tooLong, 1u);
+    }
+  }
+  // Line-sized matches are unaffected.
+  std::vector<RegexMatch> lines;
+  CHECK_EQ(FindRegexMatches(text, std::wregex(L"[^\\r\\n]+", FLAGS), L"", lines), 0u);
+  CHECK(Same(lines, Expected(text, std::wregex(L"[^\\r\\n]+", FLAGS), L"")));
+}
@@ -0,0 +1,59 @@
+/**
+ * sha256_test.cc — SHA-256 against the FIPS 180-2 test vectors, and
+ * incremental updates against one-shot hashing.
+ */
+
+#include "test.h"
+#include "sha256.h"
+
+#include <cstdint>
+#include <string>
+
+namespace {
+
+std::string Hex(const std::string& data) {
+  Sha256 hash;
+  hash.Update(data.data(), data.size());
+  return hash.FinalHex();
+}
+
+}  // namespace
+
+TEST(Sha256MatchesKnownVectors) {
+  CHECK_EQ(Hex(""),
+           std::string("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+  CHECK_EQ(Hex("abc"),
+           std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+  CHECK_EQ(Hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+           std::string("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+  CHECK_EQ(Hex(std::string(1000000, 'a')),
+           std::string("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+}
+
+TEST(Sha256IncrementalUpdatesMatchOneShot) {
+  std::string data;
+  for (int i = 0; i < 1000; i++) data += static_cast<char>(i * 7 + 3);
+
+  // Split points around the 64-byte block and the 56-byte padding edge.
+  for (size_t split : { size_t(0), size_t(1), size_t(55), size_t(56), size_t(63),
+                        size_t(64), size_t(65), size_t(128), size_t(999) }) {
+    Sha256 hash;
+    hash.Update(data.data(), split);
+    hash.Update(data.data() + split, data.size() - split);
+    CHECK_EQ(hash.FinalHex(), Hex(data));
+  }
+
+  // Byte at a time.
+  Sha256 bytes;
+  for (char c : data) bytes.Update(&c, 1);
+  CHECK_EQ(bytes.FinalHex(), Hex(data));
+}
+
+TEST(Sha256FinalWritesRawDigest) {
+  Sha256 hash;
+  hash.Update("abc", 3);
+  uint8_t digest[32];
+  hash.Final(digest);
+  CHECK_EQ(digest[0], 0xbau);
+  CHECK_EQ(digest[31], 0xadu);
+}
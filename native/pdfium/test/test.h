@@ -0,0 +1,64 @@
+/**
+ * test.h — A small test registry for the addon's self-contained modules
+ * (pdfscan, inflate/deflate, png, sha256, regex and redaction matching,
+ * pixel kernels), which need neither Node nor an open document.
+ *
+ * TEST(Name) { ... } registers a test; CHECK stops it at the first
+ * failed condition.  main.cc runs every test and exits non-zero if any
+ * failed.
+ */
+#ifndef PDFIUM_ADDON_TEST_H
+#define PDFIUM_ADDON_TEST_H
+
+#include <string>
+#include <vector>
+
+struct TestCase {
+  const char* name;
+  void (*run)();
+};
+
+/** Every registered test, in registration order. */
+std::vector<TestCase>& TestCases();
+
+/** Record a failure of the running test. */
+void TestFailed(const char* file, int line, const std::string& what);
+
+/** Values as failure messages print them. */
+template <typename T>
+std::string TestText(const T& value) { return std::to_string(value); }
+inline std::string TestText(const std::string& value) { return '"' + value + '"'; }
+inline std::string TestText(const char* value) { return TestText(std::string(value)); }
+
+struct TestRegistrar {
+  TestRegistrar(const char* name, void (*run)()) {
+    TestCases().push_back({ name, run });
+  }
+};
+
+#define TEST(name)                                              \
+  static void name();                                           \
+  static TestRegistrar name##_registrar(#name, name);           \
+  static void name()
+
+#define CHECK(cond)                                             \
+  do {                                                          \
+    if (!(cond)) {                                              \
+      TestFailed(__FILE__, __LINE__, #cond);                    \
+      return;                                                   \
+    }                                                           \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                          \
+  do {                                                          \
+    const auto& check_a_ = (a);                                 \
+    const auto& check_b_ = (b);                                 \
+    if (!(check_a_ == check_b_)) {                              \
+      TestFailed(__FILE__, __LINE__,                            \
+                 #a " == " #b " (" + TestText(check_a_) +      \
+                 " vs " + TestText(check_b_) + ")");            \
+      return;                                                   \
+    }                                                           \
+  } while (0)
+
+#endif // PDFIUM_ADDON_TEST_H
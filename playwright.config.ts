@@ -1,7 +1,6 @@
 import { defineConfig } from '@playwright/test';
 
 export default defineConfig({
-  testDir: './test/e2e',
   timeout: 60_000,
   retries: 0,
   workers: 1, // Electron E2E must run serially
@@ -9,4 +8,9 @@ export default defineConfig({
   use: {
     trace: 'on-first-retry',
   },
+  projects: [
+    { name: 'e2e', testDir: './test/e2e' },
+    // Pure main-process modules, loaded without Electron.
+    { name: 'unit', testDir: './test/unit' },
+  ],
 });
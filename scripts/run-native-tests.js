@@ -0,0 +1,23 @@
+/**
+ * Run the native unit tests (native/pdfium/test) built by
+ * `npm run build:native` as the pdfium_tests executable.
+ *
+ * Extra arguments are passed through: a name substring selects tests.
+ */
+
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+const exe = path.join(
+  __dirname, '..', 'native', 'pdfium', 'build', 'Release',
+  process.platform === 'win32' ? 'pdfium_tests.exe' : 'pdfium_tests',
+);
+
+if (!fs.existsSync(exe)) {
+  console.error(`[native-tests] ${exe} not found — run "npm run build:native" first.`);
+  process.exit(1);
+}
+
+const result = spawnSync(exe, process.argv.slice(2), { stdio: 'inherit' });
+process.exit(result.status ?? 1);
@@ -5,23 +5,87 @@
  * and validates the channel against the shared allow-list.
  */
 
-import { ipcMain, dialog, app, BrowserWindow } from 'electron';
+import { ipcMain, dialog, app, BrowserWindow, type WebContents } from 'electron';
 import * as fs from 'node:fs/promises';
 import {
   IPC_CHANNELS,
   isAllowedChannel,
+  ANALYZE_JOB_ID,
   type FileOpenResult,
   type FileSavePayload,
   type PdfOpenPayload,
   type PdfOpenResult,
   type PdfRenderPagePayload,
   type PdfRenderResult,
+  type PdfRenderLayer,
+  type PdfViewRotation,
+  type PdfViewFilter,
   type PdfListObjectsPayload,
+  type PdfCharGeometryPayload,
+  type PdfCharGeometry,
   type PageObject,
   type PdfEditTextPayload,
+  type PdfLoadFontPayload,
+  type PdfLoadFontResult,
+  type PdfMeasureTextPayload,
+  type PdfTextMetrics,
   type PdfReplaceImagePayload,
+  type PdfImagePreviewPayload,
+  type PdfImagePreview,
+  type PdfTransformObjectPayload,
+  type PdfDragBeginPayload,
+  type PdfDragBeginResult,
+  type PdfDragPreviewPayload,
+  type PdfDragPreviewResult,
+  type PdfMatrix,
+  type PdfInkBeginPayload,
+  type PdfInkAppendPayload,
+  type PdfInkPatch,
+  type PdfInkStroke,
+  type PdfAddInkPayload,
+  type PdfRemoveAnnotationPayload,
+  type PdfOutlineChildrenPayload,
+  type PdfOutlineBatch,
+  type PdfThumbnailsPayload,
+  type PdfThumbnailBatch,
+  type PdfBuildThumbnailsPayload,
+  type PdfBuildThumbnailsResult,
+  type PdfListAnnotationsPayload,
+  type PdfAnnotationColumns,
+  type PdfUpdateAnnotationsPayload,
+  type PdfUpdateAnnotationsResult,
   type PdfSavePayload,
   type PdfSaveResult,
+  type PdfSignPreparePayload,
+  type PdfSignPrepareResult,
+  type PdfSignEmbedPayload,
+  type PdfFlattenPayload,
+  type PdfFlattenResult,
+  type PdfRasterizePayload,
+  type PdfRasterizeResult,
+  type PdfCancelJobPayload,
+  type PdfJobProgressPayload,
+  type PdfRedactPayload,
+  type PdfRedactResumePayload,
+  type PdfRedactResult,
+  type PdfFindReplacePayload,
+  type PdfFindReplaceResult,
+  type PdfMailMergePayload,
+  type PdfMailMergeResult,
+  type PdfCompareDocumentsPayload,
+  type PdfComparePageEvent,
+  type PdfCompareResult,
+  type PdfOcrPayload,
+  type PdfOcrResult,
+  type PdfAnalyzePayload,
+  type PdfAnalyzeResult,
+  type PdfExtractImagesPayload,
+  type PdfExtractImagesResult,
+  type PdfPrefetchImagePreviewsPayload,
+  type PdfPrefetchImagePreviewsResult,
+  type PdfMacro,
+  type PdfMacroReplayPayload,
+  type PdfMacroReplayResult,
 } from '../shared/ipc-schema';
 import {
   PDF_FILE_FILTERS,
@@ -29,7 +93,13 @@ import {
   MAX_BITMAP_CACHE_BYTES,
   RENDER_CONCURRENCY_LIMIT,
 } from '../shared/constants';
-import { PdfiumEngine } from './pdfium';
+import { PdfiumEngine, resolveAddonPath } from './pdfium';
+import { runRedaction, resumeRedaction, cancelRedaction } from './redaction';
+import { runMailMerge, cancelMailMerge } from './mail-merge';
+import { PdfWorkerPool } from './worker-pool';
+import { MacroRecorder, runMacroBatch, cancelMacroBatch } from './macro';
+import { runOcr, cancelOcr } from './ocr';
+import { quantiseScale } from './render-scale';
 
 /** In-memory recent file list (persisted to disk in a later task). */
 let recentFiles: string[] = [];
@@ -37,6 +107,17 @@ let recentFiles: string[] = [];
 /** Singleton PDFium engine instance. */
 const pdfiumEngine = new PdfiumEngine();
 
+/** Edit macros being recorded, by docId. */
+const macroRecorder = new MacroRecorder();
+
+/** Worker processes for batch jobs, spawned on first use. */
+let workerPool: PdfWorkerPool | null = null;
+
+function getWorkerPool(): PdfWorkerPool {
+  workerPool ??= new PdfWorkerPool(resolveAddonPath());
+  return workerPool;
+}
+
 // ── LRU Bitmap Cache ────────────────────────────────────────────────
 
 interface CacheEntry {
@@ -44,6 +125,11 @@ interface CacheEntry {
   image: Uint8Array;
   width: number;
   height: number;
+  /** Render scale: one of RENDER_SCALE_BUCKETS, so keys repeat. */
+  scale: number;
+  /** Annotation layer only: nothing to draw, or must use the 'page' layer. */
+  empty?: boolean;
+  separable?: boolean;
 }
 
 /**
@@ -54,8 +140,16 @@ class LruBitmapCache {
   private readonly entries = new Map<string, CacheEntry>();
   private currentBytes = 0;
 
-  static makeKey(docId: string, pageIndex: number, scale: number): string {
-    return `${docId}:${pageIndex}:${scale}`;
+  /** Rasters PDFium drew rotated carry the rotation after the scale. */
+  static makeKey(
+    docId: string,
+    pageIndex: number,
+    scale: number,
+    layer: PdfRenderLayer,
+    rotation: PdfViewRotation = 0,
+  ): string {
+    const view = rotation === 0 ? `${scale}` : `${scale}@${rotation}`;
+    return `${docId}:${pageIndex}:${view}:${layer}`;
   }
 
   get(key: string): CacheEntry | undefined {
@@ -111,6 +205,22 @@ class LruBitmapCache {
     }
   }
 
+  /**
+   * Invalidate some layers of a page (all scales): content edits keep
+   * the annotation layer, annotation edits keep the content layer.
+   * The combined 'page' layer always goes.
+   */
+  invalidateLayers(docId: string, pageIndex: number, layers: PdfRenderLayer[]): void {
+    const prefix = `${docId}:${pageIndex}:`;
+    const suffixes = [...new Set<PdfRenderLayer>([...layers, 'page'])].map((l) => `:${l}`);
+    for (const [key, entry] of this.entries.entries()) {
+      if (key.startsWith(prefix) && suffixes.some((sfx) => key.endsWith(sfx))) {
+        this.currentBytes -= entry.image.byteLength;
+        this.entries.delete(key);
+      }
+    }
+  }
+
   clear(): void {
     this.entries.clear();
     this.currentBytes = 0;
@@ -168,6 +278,131 @@ class RenderQueue {
 
 const renderQueue = new RenderQueue();
 
+/** One layer of a page, from the bitmap cache or rendered through the queue. */
+async function renderLayer(
+  docId: string,
+  pageIndex: number,
+  scale: number,
+  layer: PdfRenderLayer,
+  rotation: PdfViewRotation = 0,
+): Promise<CacheEntry> {
+  const key = LruBitmapCache.makeKey(docId, pageIndex, scale, layer, rotation);
+  const cached = bitmapCache.get(key);
+  if (cached) return cached;
+
+  return renderQueue.enqueue(async () => {
+    // Double-check cache after waiting in queue
+    const secondCheck = bitmapCache.get(key);
+    if (secondCheck) return secondCheck;
+
+    const result = pdfiumEngine.renderPageLayer(docId, pageIndex, scale, layer, undefined, rotation);
+    const entry: CacheEntry = {
+      key,
+      image: result.image,
+      width: result.width,
+      height: result.height,
+      scale,
+      ...(layer === 'annotations' ? { empty: result.empty, separable: result.separable } : {}),
+    };
+    bitmapCache.put(entry);
+    return entry;
+  });
+}
+
+function toRenderResult(entry: CacheEntry): PdfRenderResult {
+  return { image: entry.image, width: entry.width, height: entry.height, scale: entry.scale };
+}
+
+/**
+ * One layer of a page in the view's rotation.  Quarter turns of the
+ * cached upright raster are exact, so rotating the view normally costs
+ * a transpose, not a render.  The exception is LCD text (every layer
+ * but 'annotations'): its colour fringes are laid out for the panel's
+ * left-to-right sub-pixel order, and a half turn reverses that order,
+ * so 180° goes back to PDFium — as does any layer on `refine`.
+ */
+async function renderViewLayer(
+  payload: PdfRenderPagePayload,
+  layer: PdfRenderLayer,
+): Promise<CacheEntry> {
+  const { docId, pageIndex } = payload;
+  const scale = quantiseScale(payload.zoom, payload.devicePixelRatio);
+  const rotation = payload.rotation ?? 0;
+  if (rotation === 0) return renderLayer(docId, pageIndex, scale, layer);
+  if (payload.refine || (rotation === 180 && layer !== 'annotations')) {
+    return renderLayer(docId, pageIndex, scale, layer, rotation);
+  }
+
+  const upright = await renderLayer(docId, pageIndex, scale, layer);
+  if (upright.image.byteLength === 0) {
+    // Annotation layer with nothing to draw: only the size turns.
+    const swap = rotation !== 180;
+    return {
+      ...upright,
+      width: swap ? upright.height : upright.width,
+      height: swap ? upright.width : upright.height,
+    };
+  }
+  return { ...upright, ...pdfiumEngine.rotateBitmap(upright, rotation) };
+}
+
+/**
+ * The page before any reading mode.  Content and annotations are
+ * cached as separate layers and composited here, so toggling
+ * annotations or editing one layer never re-rasterises the other.
+ * `owned` is set when the image is a fresh composite no cache holds.
+ */
+async function composePageView(
+  payload: PdfRenderPagePayload,
+): Promise<{ view: PdfRenderResult; owned: boolean }> {
+  const content = (): Promise<CacheEntry> => renderViewLayer(payload, 'content');
+  const cached = async (entry: Promise<CacheEntry>) => ({
+    view: toRenderResult(await entry),
+    owned: false,
+  });
+  if (payload.annotations === false) return cached(content());
+
+  const annotations = await renderViewLayer(payload, 'annotations');
+  if (annotations.empty) return cached(content());
+  if (annotations.separable === false) return cached(renderViewLayer(payload, 'page'));
+
+  const base = await content();
+  const view: PdfRenderResult = {
+    image: pdfiumEngine.compositeLayers(base.image, annotations.image),
+    width: base.width,
+    height: base.height,
+    scale: base.scale,
+  };
+  return { view, owned: true };
+}
+
+/** `image` through a reading mode; an `owned` image is filtered in place. */
+function applyViewFilter(
+  image: Uint8Array,
+  filter: PdfViewFilter | undefined,
+  owned: boolean,
+): Uint8Array {
+  if (!filter || filter === 'none') return image;
+  return pdfiumEngine.filterBitmap(image, filter, owned);
+}
+
+/**
+ * The page as displayed.  Reading modes filter the cached rasters on
+ * the way out, so switching modes costs one pass over the pixels and
+ * never a render or a cache entry of its own.
+ */
+async function renderPageView(payload: PdfRenderPagePayload): Promise<PdfRenderResult> {
+  const { view, owned } = await composePageView(payload);
+  return { ...view, image: applyViewFilter(view.image, payload.filter, owned) };
+}
+
+/**
+ * Reading mode of each live drag and ink session.  Their patches are
+ * composited unfiltered and filtered on the way out, like the page.
+ */
+const dragFilters = new Map<number, PdfViewFilter>();
+const inkFilters = new Map<number, PdfViewFilter>();
+
 /**
  * Register all IPC handlers.  Called once from main/index.ts.
  */
@@ -261,6 +496,7 @@ export function registerIpcHandlers(): void {
     IPC_CHANNELS.PDF_CLOSE,
     async (_event, docId: string): Promise<void> => {
       bitmapCache.invalidateDoc(docId);
+      macroRecorder.discard(docId);
       pdfiumEngine.close(docId);
     },
   );
@@ -273,30 +509,27 @@ export function registerIpcHandlers(): void {
   );
 
   ipcMain.handle(
-    IPC_CHANNELS.PDF_RENDER_PAGE,
-    async (_event, payload: PdfRenderPagePayload): Promise<PdfRenderResult> => {
-      const cacheKey = LruBitmapCache.makeKey(payload.docId, payload.pageIndex, payload.scale);
-      const cached = bitmapCache.get(cacheKey);
-      if (cached) {
-        return { image: cached.image, width: cached.width, height: cached.height };
-      }
+    IPC_CHANNELS.PDF_OUTLINE_CHILDREN,
+    async (_event, payload: PdfOutlineChildrenPayload): Promise<PdfOutlineBatch> => {
+      return pdfiumEngine.getOutlineChildren(payload.docId, payload.nodeRef, {
+        start: payload.start,
+        limit: payload.limit,
+      });
+    },
+  );
 
-      return renderQueue.enqueue(async () => {
-        // Double-check cache after waiting in queue
-        const secondCheck = bitmapCache.get(cacheKey);
-        if (secondCheck) {
-          return { image: secondCheck.image, width: secondCheck.width, height: secondCheck.height };
-        }
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_THUMBNAILS,
+    async (_event, payload: PdfThumbnailsPayload): Promise<PdfThumbnailBatch> => {
+      const { docId, first, count, ...options } = payload;
+      return pdfiumEngine.getThumbnails(docId, first, count, options);
+    },
+  );
 
-        const result = pdfiumEngine.renderPage(payload.docId, payload.pageIndex, payload.scale);
-        bitmapCache.put({
-          key: cacheKey,
-          image: result.image,
-          width: result.width,
-          height: result.height,
-        });
-        return result;
-      });
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_RENDER_PAGE,
+    async (_event, payload: PdfRenderPagePayload): Promise<PdfRenderResult> => {
+      return renderPageView(payload);
     },
   );
 
@@ -307,9 +540,18 @@ export function registerIpcHandlers(): void {
     },
   );
 
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_CHAR_GEOMETRY,
+    async (_event, payload: PdfCharGeometryPayload): Promise<PdfCharGeometry> => {
+      const { docId, pageIndex, start, count } = payload;
+      return pdfiumEngine.getCharGeometry(docId, pageIndex, { start, count });
+    },
+  );
+
   ipcMain.handle(
     IPC_CHANNELS.PDF_EDIT_TEXT,
     async (_event, payload: PdfEditTextPayload): Promise<{ ok: true }> => {
+      const step = macroRecorder.captureTextEdit(pdfiumEngine, payload);
       pdfiumEngine.editTextObject(
         payload.docId,
         payload.pageIndex,
@@ -318,14 +560,38 @@ export function registerIpcHandlers(): void {
         payload.fontName,
         payload.fontSize,
       );
-      bitmapCache.invalidatePage(payload.docId, payload.pageIndex);
+      macroRecorder.append(payload.docId, step);
+      bitmapCache.invalidateLayers(payload.docId, payload.pageIndex, ['content']);
       return { ok: true };
     },
   );
 
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_LOAD_FONT,
+    async (_event, payload: PdfLoadFontPayload): Promise<PdfLoadFontResult> => {
+      const fontRef = pdfiumEngine.loadFont(payload.docId, payload.data, payload.cid);
+      macroRecorder.noteFont(payload.docId, fontRef, payload.data);
+      return { fontRef };
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_MEASURE_TEXT,
+    async (_event, payload: PdfMeasureTextPayload): Promise<PdfTextMetrics> => {
+      return pdfiumEngine.measureText(
+        payload.docId,
+        payload.pageIndex,
+        payload.objectId ?? payload.font ?? '',
+        payload.text,
+        payload.size,
+      );
+    },
+  );
+
   ipcMain.handle(
     IPC_CHANNELS.PDF_REPLACE_IMAGE,
     async (_event, payload: PdfReplaceImagePayload): Promise<{ ok: true }> => {
+      const step = macroRecorder.captureImageReplace(pdfiumEngine, payload);
       pdfiumEngine.replaceImageObject(
         payload.docId,
         payload.pageIndex,
@@ -333,11 +599,152 @@ export function registerIpcHandlers(): void {
         payload.image,
         payload.format,
       );
-      bitmapCache.invalidatePage(payload.docId, payload.pageIndex);
+      macroRecorder.append(payload.docId, step);
+      bitmapCache.invalidateLayers(payload.docId, payload.pageIndex, ['content']);
+      return { ok: true };
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_IMAGE_PREVIEW,
+    async (_event, payload: PdfImagePreviewPayload): Promise<PdfImagePreview> => {
+      return pdfiumEngine.getImagePreview(
+        payload.docId,
+        payload.pageIndex,
+        payload.objectId,
+        payload.maxEdge,
+      );
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_TRANSFORM_OBJECT,
+    async (_event, payload: PdfTransformObjectPayload): Promise<{ ok: true }> => {
+      pdfiumEngine.transformObject(
+        payload.docId,
+        payload.pageIndex,
+        payload.objectId,
+        payload.matrix,
+      );
+      bitmapCache.invalidateLayers(payload.docId, payload.pageIndex, ['content']);
       return { ok: true };
     },
   );
 
+  // ── Drag previews ──────────────────────────────────────────────
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_DRAG_BEGIN,
+    async (_event, payload: PdfDragBeginPayload): Promise<PdfDragBeginResult> => {
+      const session = await renderQueue.enqueue(async () => pdfiumEngine.beginObjectDrag(
+        payload.docId,
+        payload.pageIndex,
+        payload.objectId,
+        payload.scale,
+      ));
+      if (payload.filter && payload.filter !== 'none') {
+        dragFilters.set(session.sessionId, payload.filter);
+      }
+      return { ...session, image: applyViewFilter(session.image, payload.filter, true) };
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_DRAG_PREVIEW,
+    async (_event, payload: PdfDragPreviewPayload): Promise<PdfDragPreviewResult> => {
+      const patch = pdfiumEngine.previewObjectDrag(payload.sessionId, payload.rect);
+      const filter = dragFilters.get(payload.sessionId);
+      return { ...patch, image: applyViewFilter(patch.image, filter, true) };
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_DRAG_END,
+    async (_event, sessionId: number): Promise<PdfMatrix | null> => {
+      dragFilters.delete(sessionId);
+      return pdfiumEngine.endObjectDrag(sessionId);
+    },
+  );
+
+  // ── Ink & annotations ──────────────────────────────────────────
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_INK_BEGIN,
+    async (_event, payload: PdfInkBeginPayload): Promise<number> => {
+      // The stroke is drawn over the cached raster the user is looking
+      // at, before its reading mode; each patch is filtered on the way out.
+      const { view } = await composePageView(payload);
+      const sessionId = pdfiumEngine.beginInk(
+        payload.docId,
+        payload.pageIndex,
+        view.scale,
+        view,
+        payload.style,
+      );
+      if (payload.filter && payload.filter !== 'none') {
+        inkFilters.set(sessionId, payload.filter);
+      }
+      return sessionId;
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_INK_APPEND,
+    async (_event, payload: PdfInkAppendPayload): Promise<PdfInkPatch> => {
+      const patch = pdfiumEngine.appendInk(payload.sessionId, payload.points);
+      const filter = inkFilters.get(payload.sessionId);
+      return { ...patch, image: applyViewFilter(patch.image, filter, true) };
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_INK_END,
+    async (_event, sessionId: number): Promise<PdfInkStroke | null> => {
+      inkFilters.delete(sessionId);
+      return pdfiumEngine.endInk(sessionId);
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_ADD_INK,
+    async (_event, payload: PdfAddInkPayload): Promise<number> => {
+      const annotIndex = pdfiumEngine.addInkAnnotation(
+        payload.docId,
+        payload.pageIndex,
+        payload.stroke,
+      );
+      bitmapCache.invalidateLayers(payload.docId, payload.pageIndex, ['annotations']);
+      return annotIndex;
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_REMOVE_ANNOTATION,
+    async (_event, payload: PdfRemoveAnnotationPayload): Promise<{ ok: true }> => {
+      pdfiumEngine.removeAnnotation(payload.docId, payload.pageIndex, payload.annotIndex);
+      bitmapCache.invalidateLayers(payload.docId, payload.pageIndex, ['annotations']);
+      return { ok: true };
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_LIST_ANNOTATIONS,
+    async (_event, payload: PdfListAnnotationsPayload): Promise<PdfAnnotationColumns> => {
+      return pdfiumEngine.listAnnotations(payload.docId, payload.pages);
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_UPDATE_ANNOTATIONS,
+    async (_event, payload: PdfUpdateAnnotationsPayload): Promise<PdfUpdateAnnotationsResult> => {
+      const result = pdfiumEngine.updateAnnotations(payload.docId, payload.updates);
+      for (const pageIndex of new Set(payload.updates.map((u) => u.pageIndex))) {
+        bitmapCache.invalidateLayers(payload.docId, pageIndex, ['annotations']);
+      }
+      return result;
+    },
+  );
+
   ipcMain.handle(
     IPC_CHANNELS.PDF_SAVE,
     async (_event, payload: PdfSavePayload): Promise<PdfSaveResult> => {
@@ -346,6 +753,223 @@ export function registerIpcHandlers(): void {
     },
   );
 
+  // ── Digital signatures ─────────────────────────────────────────
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_SIGN_PREPARE,
+    async (_event, payload: PdfSignPreparePayload): Promise<PdfSignPrepareResult> => {
+      const { docId, outputPath, ...options } = payload;
+      return pdfiumEngine.prepareSignature(docId, outputPath, options);
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_SIGN_EMBED,
+    async (_event, payload: PdfSignEmbedPayload): Promise<void> => {
+      pdfiumEngine.embedSignature(payload.outputPath, payload.byteRange, payload.signature);
+    },
+  );
+
+  // ── Edit macros ────────────────────────────────────────────────
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_MACRO_START,
+    async (_event, docId: string): Promise<void> => {
+      macroRecorder.start(docId);
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_MACRO_STOP,
+    async (_event, docId: string): Promise<PdfMacro> => {
+      return macroRecorder.stop(docId);
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_MACRO_REPLAY,
+    async (event, payload: PdfMacroReplayPayload): Promise<PdfMacroReplayResult> => {
+      const docId = payload.inputDir;
+      return runMacroBatch(getWorkerPool(), payload, (done, total, documentsPerSecond) => {
+        sendJobProgress(event.sender, {
+          docId, job: 'macro-replay', done, total, rate: documentsPerSecond, rateUnit: 'documents',
+        });
+      });
+    },
+  );
+
+  // ── Background document passes ─────────────────────────────────
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_FLATTEN,
+    async (event, payload: PdfFlattenPayload): Promise<PdfFlattenResult> => {
+      const { docId, ...options } = payload;
+      try {
+        return await pdfiumEngine.flattenDocument(docId, options, (done, total) => {
+          sendJobProgress(event.sender, { docId, job: 'flatten', done, total });
+        });
+      } finally {
+        // Flattened pages render differently even if the pass stopped early.
+        bitmapCache.invalidateDoc(docId);
+      }
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_RASTERIZE,
+    async (event, payload: PdfRasterizePayload): Promise<PdfRasterizeResult> => {
+      const { docId, ...options } = payload;
+      try {
+        return await pdfiumEngine.rasterizePages(docId, options, (done, total) => {
+          sendJobProgress(event.sender, { docId, job: 'rasterize', done, total });
+        });
+      } finally {
+        bitmapCache.invalidateDoc(docId);
+      }
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_REDACT,
+    async (event, payload: PdfRedactPayload): Promise<PdfRedactResult> => {
+      const { docId, outputPath, ...spec } = payload;
+      try {
+        return await runRedaction(pdfiumEngine, docId, spec, outputPath, (done, total, pagesPerSecond) => {
+          sendJobProgress(event.sender, {
+            docId, job: 'redact', done, total, rate: pagesPerSecond, rateUnit: 'pages',
+          });
+        });
+      } finally {
+        bitmapCache.invalidateDoc(docId);
+      }
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_REDACT_RESUME,
+    async (event, payload: PdfRedactResumePayload): Promise<PdfRedactResult> => {
+      // The resumed run works on its own copy of the partial output, so
+      // progress and cancellation are keyed by the output path rather
+      // than an open docId.
+      return resumeRedaction(pdfiumEngine, payload.outputPath, (done, total, pagesPerSecond) => {
+        sendJobProgress(event.sender, {
+          docId: payload.outputPath, job: 'redact', done, total,
+          rate: pagesPerSecond, rateUnit: 'pages',
+        });
+      });
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_FIND_REPLACE,
+    async (event, payload: PdfFindReplacePayload): Promise<PdfFindReplaceResult> => {
+      const { docId, pattern, replacement, ...options } = payload;
+      try {
+        return await pdfiumEngine.findReplace(docId, pattern, replacement, options, (done, total) => {
+          sendJobProgress(event.sender, { docId, job: 'find-replace', done, total });
+        });
+      } finally {
+        // Pages edited before a cancel or failure keep their new text.
+        bitmapCache.invalidateDoc(docId);
+      }
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_MAIL_MERGE,
+    async (event, payload: PdfMailMergePayload): Promise<PdfMailMergeResult> => {
+      // Merges have no open document; progress and cancel are keyed by
+      // the template path instead.
+      const docId = payload.templatePath;
+      return runMailMerge(getWorkerPool(), payload, (done, total, documentsPerMinute) => {
+        sendJobProgress(event.sender, {
+          docId, job: 'mail-merge', done, total,
+          rate: documentsPerMinute / 60, rateUnit: 'documents',
+        });
+      });
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_ANALYZE,
+    async (event, payload: PdfAnalyzePayload): Promise<PdfAnalyzeResult> => {
+      // The native pass never takes the PDFium lock, so it runs in this
+      // process alongside open documents instead of in the worker pool.
+      const { paths, ...options } = payload;
+      return pdfiumEngine.analyzeFiles(ANALYZE_JOB_ID, paths, options, (done, total) => {
+        sendJobProgress(event.sender, { docId: ANALYZE_JOB_ID, job: 'analyze', done, total });
+      });
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_EXTRACT_IMAGES,
+    async (event, payload: PdfExtractImagesPayload): Promise<PdfExtractImagesResult> => {
+      const { docId, outDir, ...options } = payload;
+      await fs.mkdir(outDir, { recursive: true });
+      return pdfiumEngine.extractImages(docId, outDir, options, (done, total) => {
+        sendJobProgress(event.sender, { docId, job: 'extract-images', done, total });
+      });
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_BUILD_THUMBNAILS,
+    async (event, payload: PdfBuildThumbnailsPayload): Promise<PdfBuildThumbnailsResult> => {
+      const { docId, ...options } = payload;
+      return pdfiumEngine.buildThumbnails(docId, options, (done, total) => {
+        sendJobProgress(event.sender, { docId, job: 'thumbnails', done, total });
+      });
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_PREFETCH_IMAGE_PREVIEWS,
+    async (_event, payload: PdfPrefetchImagePreviewsPayload): Promise<PdfPrefetchImagePreviewsResult> => {
+      const { docId, ...options } = payload;
+      return pdfiumEngine.prefetchImagePreviews(docId, options);
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_COMPARE_DOCUMENTS,
+    async (event, payload: PdfCompareDocumentsPayload): Promise<PdfCompareResult> => {
+      const { docIdA, docIdB, ...options } = payload;
+      return pdfiumEngine.compareDocuments(docIdA, docIdB, options, (done, total, pages) => {
+        sendJobProgress(event.sender, { docId: docIdA, job: 'compare', done, total });
+        if (!pages || event.sender.isDestroyed()) return;
+        for (const page of pages) {
+          const message: PdfComparePageEvent = { docIdA, docIdB, ...page };
+          event.sender.send(IPC_CHANNELS.PDF_COMPARE_PAGE, message);
+        }
+      });
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_OCR,
+    async (event, payload: PdfOcrPayload): Promise<PdfOcrResult> => {
+      // The text layer is invisible, so cached bitmaps stay valid.
+      const { docId } = payload;
+      return runOcr(pdfiumEngine, payload, (done, total, pagesPerMinute) => {
+        sendJobProgress(event.sender, {
+          docId, job: 'ocr', done, total, rate: pagesPerMinute / 60, rateUnit: 'pages',
+        });
+      });
+    },
+  );
+
+  ipcMain.handle(
+    IPC_CHANNELS.PDF_CANCEL_JOB,
+    async (_event, payload: PdfCancelJobPayload): Promise<boolean> => {
+      if (payload.job === 'mail-merge') return cancelMailMerge(payload.docId);
+      if (payload.job === 'macro-replay') return cancelMacroBatch(payload.docId);
+      if (payload.job === 'ocr') return cancelOcr(payload.docId);
+      if (payload.job === 'redact') return cancelRedaction(payload.docId);
+      return pdfiumEngine.cancelJob(payload.docId, payload.job);
+    },
+  );
+
   // ── Catch-all: reject unknown channels ─────────────────────────
   ipcMain.on('message', (event, channel: string) => {
     if (!isAllowedChannel(channel)) {
@@ -364,10 +988,19 @@ function addRecentFile(filePath: string): void {
   );
 }
 
+/** Relay job progress to the requesting window, if it is still open. */
+function sendJobProgress(sender: WebContents, payload: PdfJobProgressPayload): void {
+  if (!sender.isDestroyed()) {
+    sender.send(IPC_CHANNELS.PDF_JOB_PROGRESS, payload);
+  }
+}
+
 /**
  * Clean up PDFium resources.  Called from main/index.ts on app quit.
  */
 export function cleanupPdfium(): void {
+  workerPool?.dispose();
+  workerPool = null;
   bitmapCache.clear();
   pdfiumEngine.closeAll();
 }
@@ -0,0 +1,301 @@
+/**
+ * Edit macros: record text and image edits by content, replay them on
+ * other documents.
+ *
+ * A recorded step remembers what the edited object contained (its text,
+ * or its image fingerprint), not its object index, so the same macro
+ * applies to documents whose object order differs — a year of invoices
+ * from slightly different template revisions, say.
+ *
+ * Batch replay fans documents out to the PDFium worker pool; each
+ * worker opens, edits, streams the copy to disk and closes one file at
+ * a time (pdf-worker.ts).
+ */
+
+import * as fs from 'node:fs/promises';
+import * as path from 'node:path';
+import { nativeImage } from 'electron';
+import type {
+  PdfEditTextPayload,
+  PdfReplaceImagePayload,
+  PdfMacro,
+  PdfMacroStep,
+  PdfMacroDocumentResult,
+  PdfMacroReplayPayload,
+  PdfMacroReplayResult,
+} from '../shared/ipc-schema';
+import { MACRO_BATCH_DOCUMENTS } from '../shared/constants';
+import { PdfiumEngine, PdfiumError, PDFIUM_ERROR_CODES } from './pdfium';
+import { TaskCancelledError, type PdfWorkerPool } from './worker-pool';
+
+// ── Recording ───────────────────────────────────────────────────────
+
+/** Collects steps for documents that are being recorded. */
+export class MacroRecorder {
+  private readonly recordings = new Map<string, PdfMacroStep[]>();
+  /** Font files loaded into each document, by the reference loadFont returned. */
+  private readonly fonts = new Map<string, Map<string, Uint8Array>>();
+
+  start(docId: string): void {
+    this.recordings.set(docId, []);
+  }
+
+  /** Stop recording and return the macro; empty if none was running. */
+  stop(docId: string): PdfMacro {
+    const steps = this.recordings.get(docId) ?? [];
+    this.recordings.delete(docId);
+    return { version: 1, steps };
+  }
+
+  /**
+   * Remember the bytes behind a loaded font, recording or not: a font
+   * loaded before recording starts may still be used by a recorded edit.
+   */
+  noteFont(docId: string, fontRef: string, data: Uint8Array): void {
+    let fonts = this.fonts.get(docId);
+    if (!fonts) this.fonts.set(docId, (fonts = new Map()));
+    fonts.set(fontRef, data);
+  }
+
+  /**
+   * Describe a text edit by the object's current content.  Call before
+   * the edit is applied; null when the document is not being recorded.
+   */
+  captureTextEdit(engine: PdfiumEngine, payload: PdfEditTextPayload): PdfMacroStep | null {
+    if (!this.recordings.has(payload.docId)) return null;
+
+    const obj = engine
+      .listPageObjects(payload.docId, payload.pageIndex)
+      .find((o) => o.id === payload.objectId);
+    if (obj?.text === undefined) return null;
+
+    const fontData = payload.fontName !== undefined
+      ? this.fonts.get(payload.docId)?.get(payload.fontName)
+      : undefined;
+    return {
+      op: 'edit-text',
+      pageIndex: payload.pageIndex,
+      scope: 'page',
+      match: obj.text,
+      newText: payload.newText,
+      ...(payload.fontName !== undefined ? { fontName: payload.fontName } : {}),
+      ...(fontData ? { fontData: Buffer.from(fontData).toString('base64') } : {}),
+      ...(payload.fontSize !== undefined ? { fontSize: payload.fontSize } : {}),
+    };
+  }
+
+  /** Describe an image replacement by the current image's fingerprint. */
+  captureImageReplace(engine: PdfiumEngine, payload: PdfReplaceImagePayload): PdfMacroStep | null {
+    if (!this.recordings.has(payload.docId)) return null;
+
+    const match = engine.getImageFingerprint(payload.docId, payload.pageIndex, payload.objectId);
+    const base = { op: 'replace-image', pageIndex: payload.pageIndex, scope: 'page', match } as const;
+
+    if (payload.format === 'jpeg') {
+      return { ...base, image: Buffer.from(payload.image).toString('base64'), format: 'jpeg' };
+    }
+    // Worker processes have no nativeImage, so decode PNGs now.
+    const img = nativeImage.createFromBuffer(Buffer.from(payload.image));
+    if (img.isEmpty()) return null;
+    const { width, height } = img.getSize();
+    return { ...base, image: img.toBitmap().toString('base64'), format: 'bgra', width, height };
+  }
+
+  /** Add a captured step once its edit has succeeded. */
+  append(docId: string, step: PdfMacroStep | null): void {
+    if (step) this.recordings.get(docId)?.push(step);
+  }
+
+  /** Forget a recording and the document's fonts (document closed). */
+  discard(docId: string): void {
+    this.recordings.delete(docId);
+    this.fonts.delete(docId);
+  }
+}
+
+// ── Replay ──────────────────────────────────────────────────────────
+
+/**
+ * Apply every step of `macro` to an open document.
+ * Returns the number of objects edited and of steps that matched nothing.
+ */
+export function applyMacro(
+  engine: PdfiumEngine,
+  docId: string,
+  macro: PdfMacro,
+): { edits: number; unmatchedSteps: number } {
+  if (macro.version !== 1) {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.INVALID_INPUT,
+      `Unsupported macro version ${macro.version}`,
+    );
+  }
+
+  const pageCount = engine.getPageCount(docId);
+  let edits = 0;
+  let unmatchedSteps = 0;
+
+  for (const step of macro.steps) {
+    const pages = step.scope === 'document'
+      ? Array.from({ length: pageCount }, (_, i) => i)
+      : step.pageIndex < pageCount ? [step.pageIndex] : [];
+    const image = step.op === 'replace-image' ? Buffer.from(step.image, 'base64') : null;
+    // A loaded font is embedded on first use only, so a step that
+    // matches nothing leaves the document alone.
+    let fontName = step.op === 'edit-text' && !step.fontData ? step.fontName : undefined;
+
+    let matched = 0;
+    for (const pageIndex of pages) {
+      for (const obj of engine.listPageObjects(docId, pageIndex)) {
+        if (step.op === 'edit-text') {
+          if (obj.type !== 'text' || obj.text !== step.match) continue;
+          if (step.fontData && fontName === undefined) {
+            const cid = step.fontName?.endsWith(':cid') ?? false;
+            fontName = engine.loadFont(docId, Buffer.from(step.fontData, 'base64'), cid);
+          }
+          engine.editTextObject(docId, pageIndex, obj.id, step.newText, fontName, step.fontSize);
+        } else {
+          if (obj.type !== 'image') continue;
+          const fp = engine.getImageFingerprint(docId, pageIndex, obj.id);
+          if (fp.hash !== step.match.hash ||
+              fp.pixelWidth !== step.match.pixelWidth ||
+              fp.pixelHeight !== step.match.pixelHeight) {
+            continue;
+          }
+          if (step.format === 'bgra') {
+            engine.replaceImageObjectBitmap(
+              docId, pageIndex, obj.id, image!, step.width ?? 0, step.height ?? 0,
+            );
+          } else {
+            engine.replaceImageObject(docId, pageIndex, obj.id, image!, 'jpeg');
+          }
+        }
+        matched++;
+      }
+    }
+
+    edits += matched;
+    if (matched === 0) unmatchedSteps++;
+  }
+  return { edits, unmatchedSteps };
+}
+
+/** Open `input`, apply the macro, stream the result to `output`. */
+export async function replayMacroOnFile(
+  engine: PdfiumEngine,
+  macro: PdfMacro,
+  input: string,
+  output: string,
+): Promise<PdfMacroDocumentResult> {
+  const startedAt = Date.now();
+  const file = path.basename(input);
+  try {
+    const { docId } = engine.open(await fs.readFile(input));
+    try {
+      const { edits, unmatchedSteps } = applyMacro(engine, docId, macro);
+      engine.saveToFile(docId, output);
+      return { file, ok: true, edits, unmatchedSteps, elapsedMs: Date.now() - startedAt };
+    } finally {
+      engine.close(docId);
+    }
+  } catch (err) {
+    return {
+      file, ok: false, edits: 0, unmatchedSteps: 0,
+      elapsedMs: Date.now() - startedAt,
+      error: (err as Error).message,
+    };
+  }
+}
+
+// ── Batch runner ────────────────────────────────────────────────────
+
+/** Cancel hooks of running replays, keyed by input directory. */
+const activeReplays = new Map<string, () => void>();
+
+/** Replay a macro on every PDF in `inputDir` across the worker pool. */
+export async function runMacroBatch(
+  pool: PdfWorkerPool,
+  payload: PdfMacroReplayPayload,
+  onProgress?: (done: number, total: number, documentsPerSecond: number) => void,
+): Promise<PdfMacroReplayResult> {
+  const { macro, inputDir, outputDir } = payload;
+  if (activeReplays.has(inputDir)) {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.INVALID_INPUT,
+      'A macro replay is already running for this directory',
+    );
+  }
+  if (path.resolve(inputDir) === path.resolve(outputDir)) {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.INVALID_INPUT,
+      'Output directory must differ from the input directory',
+    );
+  }
+
+  const entries = await fs.readdir(inputDir, { withFileTypes: true });
+  const inputs = entries
+    .filter((e) => e.isFile() && e.name.toLowerCase().endsWith('.pdf'))
+    .map((e) => e.name)
+    .sort();
+  await fs.mkdir(outputDir, { recursive: true });
+
+  const startedAt = Date.now();
+  const total = inputs.length;
+  let done = 0;
+  let cancelled = false;
+  const taskIds: number[] = [];
+  const batches: Array<Promise<PdfMacroDocumentResult[]>> = [];
+
+  for (let start = 0; start < total; start += MACRO_BATCH_DOCUMENTS) {
+    const names = inputs.slice(start, start + MACRO_BATCH_DOCUMENTS);
+    const { taskId, done: finished } = pool.run<PdfMacroDocumentResult[]>(
+      {
+        kind: 'macro-replay',
+        macro,
+        files: names.map((name) => ({
+          input: path.join(inputDir, name),
+          output: path.join(outputDir, name),
+        })),
+      },
+      () => {
+        done++;
+        const seconds = (Date.now() - startedAt) / 1000;
+        onProgress?.(done, total, seconds > 0 ? done / seconds : 0);
+      },
+    );
+    taskIds.push(taskId);
+    batches.push(finished.catch((err: Error) => {
+      if (err instanceof TaskCancelledError) return [];
+      // A crashed worker fails every document of its batch.
+      return names.map((file) => ({
+        file, ok: false, edits: 0, unmatchedSteps: 0, elapsedMs: 0, error: err.message,
+      }));
+    }));
+  }
+
+  activeReplays.set(inputDir, () => {
+    cancelled = true;
+    for (const taskId of taskIds) pool.cancel(taskId);
+  });
+
+  try {
+    const documents = (await Promise.all(batches)).flat();
+    const succeeded = documents.filter((d) => d.ok).length;
+    return {
+      documents,
+      succeeded,
+      failed: documents.length - succeeded,
+      elapsedMs: Date.now() - startedAt,
+      cancelled,
+    };
+  } finally {
+    activeReplays.delete(inputDir);
+  }
+}
+
+/** Cancel the replay running over `inputDir`.  False if none is. */
+export function cancelMacroBatch(inputDir: string): boolean {
+  const cancel = activeReplays.get(inputDir);
+  cancel?.();
+  return cancel !== undefined;
+}
@@ -0,0 +1,157 @@
+/**
+ * Form-field mail merge across the PDFium worker pool.
+ *
+ * Records are split into batches of MAIL_MERGE_BATCH_RECORDS and fanned
+ * out to worker processes.  Each worker reads the template once, and
+ * its native job indexes the form once per batch, then fills and
+ * streams one document per record.
+ */
+
+import * as fs from 'node:fs/promises';
+import * as path from 'node:path';
+import type {
+  PdfMailMergePayload,
+  PdfMailMergeResult,
+  PdfMergeRecord,
+} from '../shared/ipc-schema';
+import { MAIL_MERGE_BATCH_RECORDS } from '../shared/constants';
+import { PdfiumError, PDFIUM_ERROR_CODES, type NativeMailMergeResult } from './pdfium';
+import { PdfWorkerPool, TaskCancelledError } from './worker-pool';
+
+/** Progress over the whole merge, with throughput. */
+export type MailMergeProgressCallback = (
+  done: number,
+  total: number,
+  documentsPerMinute: number,
+) => void;
+
+/** Cancel hooks of running merges, keyed by template path. */
+const activeMerges = new Map<string, () => void>();
+
+/** Characters that are not allowed in file names on some platform. */
+const UNSAFE_FILE_CHARS = /[\\/:*?"<>|\x00-\x1f]/g;
+
+/** One output path per record, unique even when names collide. */
+function outputPathsFor(
+  records: PdfMergeRecord[],
+  outputDir: string,
+  fileNameField?: string,
+): string[] {
+  const used = new Set<string>();
+  const width = String(records.length).length;
+
+  return records.map((record, i) => {
+    const fallback = String(i + 1).padStart(width, '0');
+    const named = fileNameField !== undefined ? record[fileNameField] : undefined;
+    let stem = named !== undefined ? String(named).replace(UNSAFE_FILE_CHARS, '_').trim() : '';
+    if (!stem) stem = fallback;
+    if (used.has(stem.toLowerCase())) stem = `${stem}-${fallback}`;
+    used.add(stem.toLowerCase());
+    return path.join(outputDir, `${stem}.pdf`);
+  });
+}
+
+export async function runMailMerge(
+  pool: PdfWorkerPool,
+  payload: PdfMailMergePayload,
+  onProgress?: MailMergeProgressCallback,
+): Promise<PdfMailMergeResult> {
+  const { templatePath, records, outputDir } = payload;
+  if (records.length === 0) {
+    throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Mail merge needs at least one record');
+  }
+  if (activeMerges.has(templatePath)) {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.INVALID_INPUT,
+      'A mail merge is already running for this template',
+    );
+  }
+
+  await fs.mkdir(outputDir, { recursive: true });
+  const outputs = outputPathsFor(records, outputDir, payload.fileNameField);
+
+  const startedAt = Date.now();
+  const total = records.length;
+  const batchDone: number[] = [];
+  const taskIds: number[] = [];
+  let cancelled = false;
+
+  const reportProgress = (): void => {
+    const done = batchDone.reduce((a, b) => a + b, 0);
+    const minutes = (Date.now() - startedAt) / 60_000;
+    onProgress?.(done, total, minutes > 0 ? done / minutes : 0);
+  };
+
+  const batches: Array<Promise<NativeMailMergeResult & { cancelled: boolean }>> = [];
+  for (let start = 0; start < total; start += MAIL_MERGE_BATCH_RECORDS) {
+    const batch = batches.length;
+    batchDone.push(0);
+    const end = Math.min(total, start + MAIL_MERGE_BATCH_RECORDS);
+
+    const { taskId, done } = pool.run<NativeMailMergeResult & { cancelled: boolean }>(
+      {
+        kind: 'mail-merge',
+        templatePath,
+        records: records.slice(start, end),
+        outputs: outputs.slice(start, end),
+        flatten: payload.flatten,
+        password: payload.password,
+      },
+      (d) => {
+        batchDone[batch] = d;
+        reportProgress();
+      },
+    );
+    taskIds.push(taskId);
+
+    batches.push(done.then(
+      (result) => ({
+        ...result,
+        failed: result.failed.map((f) => ({ ...f, record: f.record + start })),
+      }),
+      (err: Error) => {
+        if (err instanceof TaskCancelledError) {
+          return { written: 0, failed: [], unknownFields: [], cancelled: true };
+        }
+        // A crashed worker fails its batch, not the whole merge.
+        return {
+          written: 0,
+          failed: Array.from({ length: end - start }, (_, i) => ({
+            record: start + i, error: err.message,
+          })),
+          unknownFields: [],
+          cancelled: false,
+        };
+      },
+    ));
+  }
+
+  activeMerges.set(templatePath, () => {
+    cancelled = true;
+    for (const taskId of taskIds) pool.cancel(taskId);
+  });
+
+  try {
+    const results = await Promise.all(batches);
+    const elapsedMs = Date.now() - startedAt;
+    const written = results.reduce((n, r) => n + r.written, 0);
+
+    return {
+      written,
+      failed: results.flatMap((r) => r.failed),
+      unknownFields: [...new Set(results.flatMap((r) => r.unknownFields))],
+      elapsedMs,
+      documentsPerMinute: elapsedMs > 0 ? (written * 60_000) / elapsedMs : 0,
+      cancelled: cancelled || results.some((r) => r.cancelled),
+    };
+  } finally {
+    activeMerges.delete(templatePath);
+  }
+}
+
+/** Cancel the merge running for `templatePath`.  False if none is. */
+export function cancelMailMerge(templatePath: string): boolean {
+  const cancel = activeMerges.get(templatePath);
+  cancel?.();
+  return cancel !== undefined;
+}
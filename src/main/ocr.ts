@@ -0,0 +1,295 @@
+/**
+ * OCR text layers for scanned pages.
+ *
+ * The addon renders the image-only pages to grey PGM files on its job
+ * thread and streams them here as they are written.  A pool of OCR
+ * engine processes (Tesseract, one per core) recognises them while
+ * later pages render, and each page's words go back into the document
+ * as invisible text through addTextLayer.  PDFium stays on one thread;
+ * recognition, which costs far more per page, scales with cores.
+ */
+
+import { spawn, type ChildProcess } from 'node:child_process';
+import * as fs from 'node:fs/promises';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import { app } from 'electron';
+import type { PdfOcrPayload, PdfOcrResult } from '../shared/ipc-schema';
+import {
+  DEFAULT_OCR_DPI,
+  DEFAULT_OCR_MIN_CONFIDENCE,
+  OCR_RENDER_CHUNK_PAGES,
+} from '../shared/constants';
+import {
+  PdfiumEngine,
+  PdfiumError,
+  PDFIUM_ERROR_CODES,
+  type NativeOcrImage,
+  type NativeTextLayer,
+} from './pdfium';
+
+/** Progress over the whole pass, with throughput. */
+export type OcrProgressCallback = (
+  done: number,
+  total: number,
+  pagesPerMinute: number,
+) => void;
+
+/** The OCR engine executable and its language data. */
+interface OcrEngine {
+  binary: string;
+  tessdata: string;
+}
+
+/** Cancel hooks of running passes, keyed by docId. */
+const activeOcr = new Map<string, () => void>();
+
+/**
+ * Resolve the bundled OCR engine for both dev and packaged builds.
+ *
+ * Dev:       <project>/native/ocr/tesseract[.exe], language data in tessdata/
+ * Packaged:  <resources>/ocr/tesseract[.exe]
+ */
+function resolveOcrEngine(): OcrEngine {
+  const root = app.isPackaged
+    ? path.join(process.resourcesPath, 'ocr')
+    : path.join(__dirname, '..', '..', 'native', 'ocr');
+  return {
+    binary: path.join(root, process.platform === 'win32' ? 'tesseract.exe' : 'tesseract'),
+    tessdata: path.join(root, 'tessdata'),
+  };
+}
+
+/** Run the engine on one image and return its TSV output. */
+function recognise(
+  engine: OcrEngine,
+  imagePath: string,
+  language: string,
+  dpi: number,
+  running: Set<ChildProcess>,
+): Promise<string> {
+  return new Promise((resolve, reject) => {
+    const child = spawn(
+      engine.binary,
+      [imagePath, 'stdout', '-l', language, '--dpi', String(Math.round(dpi)), 'tsv'],
+      {
+        // One thread per process: the pool already fills every core.
+        env: { ...process.env, TESSDATA_PREFIX: engine.tessdata, OMP_THREAD_LIMIT: '1' },
+        stdio: ['ignore', 'pipe', 'pipe'],
+        windowsHide: true,
+      },
+    );
+    running.add(child);
+
+    const out: Buffer[] = [];
+    let stderr = '';
+    child.stdout.on('data', (chunk: Buffer) => out.push(chunk));
+    child.stderr.on('data', (chunk: Buffer) => { stderr += chunk.toString(); });
+    child.on('error', (err) => {
+      running.delete(child);
+      reject(err);
+    });
+    child.on('close', (code, signal) => {
+      running.delete(child);
+      if (code === 0) {
+        resolve(Buffer.concat(out).toString('utf8'));
+        return;
+      }
+      const lastLine = stderr.trim().split('\n').pop();
+      reject(new Error(
+        signal ? `OCR engine stopped by ${signal}` : lastLine || `OCR engine exited with code ${code}`,
+      ));
+    });
+  });
+}
+
+/**
+ * The word rows of Tesseract TSV output as a text layer.  Columns:
+ * level page block par line word left top width height conf text.
+ */
+function parseWords(
+  tsv: string,
+  width: number,
+  height: number,
+  minConfidence: number,
+): NativeTextLayer {
+  const boxes: number[] = [];
+  const offsets = [0];
+  let text = '';
+
+  for (const line of tsv.split('\n')) {
+    const cols = line.split('\t');
+    if (cols.length < 12 || cols[0] !== '5') continue;
+    const word = cols.slice(11).join('\t').trim();
+    if (!word || Number(cols[10]) < minConfidence) continue;
+
+    const left = Number(cols[6]);
+    const top = Number(cols[7]);
+    boxes.push(left, top, left + Number(cols[8]), top + Number(cols[9]));
+    text += word;
+    offsets.push(text.length);
+  }
+
+  return {
+    width,
+    height,
+    boxes: new Float32Array(boxes),
+    text,
+    offsets: Uint32Array.from(offsets),
+  };
+}
+
+export async function runOcr(
+  engine: PdfiumEngine,
+  payload: PdfOcrPayload,
+  onProgress?: OcrProgressCallback,
+): Promise<PdfOcrResult> {
+  const { docId } = payload;
+  if (activeOcr.has(docId)) {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.INVALID_INPUT,
+      'OCR is already running for this document',
+    );
+  }
+
+  const ocrEngine = resolveOcrEngine();
+  try {
+    await fs.access(ocrEngine.binary);
+  } catch {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.OCR_ENGINE_NOT_FOUND,
+      `No OCR engine at ${ocrEngine.binary}`,
+    );
+  }
+
+  const pages = payload.pages
+    ?? Array.from({ length: engine.getPageCount(docId) }, (_, i) => i);
+  const dpi = payload.dpi ?? DEFAULT_OCR_DPI;
+  const language = payload.language ?? 'eng';
+  const minConfidence = payload.minConfidence ?? DEFAULT_OCR_MIN_CONFIDENCE;
+  const concurrency = Math.max(1, os.availableParallelism());
+  const dir = await fs.mkdtemp(path.join(os.tmpdir(), 'pdf-ocr-'));
+
+  const startedAt = Date.now();
+  const total = pages.length;
+  const failed: PdfOcrResult['failed'] = [];
+  let recognised = 0;
+  let skipped = 0;
+  let words = 0;
+  let cancelled = false;
+
+  // Images waiting for an engine process, and the processes running.
+  const queue: NativeOcrImage[] = [];
+  const queued = new Set<string>();
+  const running = new Set<ChildProcess>();
+  let active = 0;
+  const waiters: Array<() => void> = [];
+
+  const reportProgress = (): void => {
+    const done = recognised + skipped + failed.length;
+    const minutes = (Date.now() - startedAt) / 60_000;
+    onProgress?.(done, total, minutes > 0 ? recognised / minutes : 0);
+  };
+
+  /** Resolves once at most `n` images are queued or being recognised. */
+  const backlogAtMost = (n: number): Promise<void> =>
+    new Promise((resolve) => {
+      const check = (): void => {
+        if (queue.length + active <= n) resolve();
+        else waiters.push(check);
+      };
+      check();
+    });
+  const wakeWaiters = (): void => {
+    for (const waiter of waiters.splice(0)) waiter();
+  };
+
+  const recognisePage = async (image: NativeOcrImage): Promise<void> => {
+    try {
+      const tsv = await recognise(ocrEngine, image.path, language, dpi, running);
+      const layer = parseWords(tsv, image.width, image.height, minConfidence);
+      words += engine.addTextLayer(docId, image.pageIndex, layer, { font: payload.font });
+      recognised++;
+    } catch (err) {
+      if (!cancelled) failed.push({ pageIndex: image.pageIndex, error: (err as Error).message });
+    } finally {
+      await fs.rm(image.path, { force: true });
+    }
+  };
+
+  const pump = (): void => {
+    while (!cancelled && active < concurrency && queue.length > 0) {
+      const image = queue.shift()!;
+      active++;
+      void recognisePage(image).finally(() => {
+        active--;
+        reportProgress();
+        pump();
+        wakeWaiters();
+      });
+    }
+  };
+
+  const enqueue = (images: NativeOcrImage[]): void => {
+    for (const image of images) {
+      if (cancelled || queued.has(image.path)) continue;
+      queued.add(image.path);
+      queue.push(image);
+    }
+    pump();
+  };
+
+  activeOcr.set(docId, () => {
+    cancelled = true;
+    queue.length = 0;
+    for (const child of running) child.kill();
+    engine.cancelJob(docId, 'ocr');
+    wakeWaiters();
+  });
+
+  try {
+    for (let start = 0; start < total && !cancelled; start += OCR_RENDER_CHUNK_PAGES) {
+      // Render ahead of recognition by at most one chunk.
+      await backlogAtMost(OCR_RENDER_CHUNK_PAGES);
+      if (cancelled) break;
+
+      const result = await engine.renderOcrPages(
+        docId,
+        dir,
+        { dpi, pages: pages.slice(start, start + OCR_RENDER_CHUNK_PAGES), all: payload.all },
+        (_done, _total, images) => {
+          if (images) enqueue(images);
+        },
+      );
+      enqueue(result.images);
+      skipped += result.skipped;
+      failed.push(...result.failed);
+      reportProgress();
+    }
+    await backlogAtMost(0);
+
+    const elapsedMs = Date.now() - startedAt;
+    return {
+      recognised,
+      skipped,
+      words,
+      failed,
+      elapsedMs,
+      pagesPerMinute: elapsedMs > 0 ? (recognised * 60_000) / elapsedMs : 0,
+      cancelled,
+    };
+  } finally {
+    activeOcr.delete(docId);
+    cancelled = true;
+    for (const child of running) child.kill();
+    await fs.rm(dir, { recursive: true, force: true });
+  }
+}
+
+/** Stop a running OCR pass.  Returns false if none was running. */
+export function cancelOcr(docId: string): boolean {
+  const cancel = activeOcr.get(docId);
+  if (!cancel) return false;
+  cancel();
+  return true;
+}
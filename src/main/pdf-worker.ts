@@ -0,0 +1,86 @@
+/**
+ * PDFium worker process (Electron utility process).
+ *
+ * Loads its own copy of the native addon and runs tasks posted by
+ * PdfWorkerPool one at a time.  The addon path arrives through
+ * PDFIUM_ADDON_PATH because Electron's `app` is not available here.
+ */
+
+import * as fs from 'node:fs/promises';
+import { PdfiumEngine } from './pdfium';
+import { replayMacroOnFile } from './macro';
+import type {
+  WorkerRequest,
+  WorkerReply,
+  MailMergeTask,
+  MacroReplayTask,
+} from './worker-pool';
+import type { PdfMacroDocumentResult } from '../shared/ipc-schema';
+
+const engine = new PdfiumEngine(process.env.PDFIUM_ADDON_PATH);
+
+/**
+ * The template of the current merge.  A worker usually serves several
+ * batches of the same merge, so it is read from disk only once.
+ */
+let cachedTemplate: { path: string; data: Buffer } | null = null;
+
+/** Tasks cancelled before their native job started. */
+const cancelledTasks = new Set<number>();
+
+function post(reply: WorkerReply): void {
+  process.parentPort.postMessage(reply);
+}
+
+function ownerOf(taskId: number): string {
+  return `task:${taskId}`;
+}
+
+async function runMailMerge(taskId: number, task: MailMergeTask): Promise<unknown> {
+  let template = cachedTemplate?.path === task.templatePath ? cachedTemplate.data : null;
+  if (!template) {
+    template = await fs.readFile(task.templatePath);
+    cachedTemplate = { path: task.templatePath, data: template };
+  }
+  if (cancelledTasks.has(taskId)) {
+    return { written: 0, failed: [], unknownFields: [], cancelled: true };
+  }
+
+  return engine.mailMerge(
+    ownerOf(taskId),
+    template,
+    task.records,
+    task.outputs,
+    { flatten: task.flatten, password: task.password },
+    (done, total) => post({ type: 'progress', taskId, done, total }),
+  );
+}
+
+async function runMacroReplay(taskId: number, task: MacroReplayTask): Promise<unknown> {
+  const results: PdfMacroDocumentResult[] = [];
+  for (const { input, output } of task.files) {
+    if (cancelledTasks.has(taskId)) break;
+    results.push(await replayMacroOnFile(engine, task.macro, input, output));
+    post({ type: 'progress', taskId, done: results.length, total: task.files.length });
+  }
+  return results;
+}
+
+process.parentPort.on('message', (event) => {
+  const msg = event.data as WorkerRequest;
+
+  if (msg.type === 'cancel') {
+    cancelledTasks.add(msg.taskId);
+    engine.cancelJob(ownerOf(msg.taskId), 'mail-merge');
+    return;
+  }
+
+  const run = msg.task.kind === 'mail-merge'
+    ? runMailMerge(msg.taskId, msg.task)
+    : runMacroReplay(msg.taskId, msg.task);
+
+  run.finally(() => cancelledTasks.delete(msg.taskId)).then(
+    (result) => post({ type: 'result', taskId: msg.taskId, result }),
+    (err) => post({ type: 'error', taskId: msg.taskId, message: (err as Error).message }),
+  );
+});
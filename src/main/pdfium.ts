@@ -15,8 +15,49 @@ import { app, nativeImage } from 'electron';
 import type {
   PdfOpenResult,
   PdfRenderResult,
+  PdfRenderLayer,
+  PdfViewRotation,
+  PdfViewFilter,
+  PdfCharGeometry,
+  PdfTextMetrics,
   PageObject,
   PageObjectType,
+  PdfJobKind,
+  PdfFlattenOptions,
+  PdfFlattenResult,
+  PdfRasterizeOptions,
+  PdfRasterizeResult,
+  PdfRedactSpec,
+  PdfRedactStats,
+  PdfFindReplacePayload,
+  PdfFindReplaceResult,
+  PdfMergeRecord,
+  PdfMailMergeResult,
+  PdfAnalyzeResult,
+  PdfExtractImagesResult,
+  PdfComparePageDiff,
+  PdfCompareResult,
+  PdfCompareDocumentsPayload,
+  PdfImageFingerprint,
+  PdfImagePreview,
+  PdfPrefetchImagePreviewsResult,
+  PdfSignByteRange,
+  PdfSignPreparePayload,
+  PdfSignPrepareResult,
+  PdfMatrix,
+  PdfPixelRect,
+  PdfDragBeginResult,
+  PdfDragPreviewResult,
+  PdfInkStyle,
+  PdfInkPatch,
+  PdfInkStroke,
+  PdfAnnotationColumns,
+  PdfOutlineBatch,
+  PdfThumbnailBatch,
+  PdfThumbnailSize,
+  PdfBuildThumbnailsResult,
+  PdfAnnotationUpdate,
+  PdfUpdateAnnotationsResult,
 } from '../shared/ipc-schema';
 import { MAX_IMAGE_BYTES } from '../shared/constants';
 
@@ -33,6 +74,10 @@ export const PDFIUM_ERROR_CODES = {
   SAVE_FAILED: 'SAVE_FAILED',
   INVALID_INPUT: 'INVALID_INPUT',
   IMAGE_TOO_LARGE: 'IMAGE_TOO_LARGE',
+  JOB_FAILED: 'JOB_FAILED',
+  SIGN_FAILED: 'SIGN_FAILED',
+  FONT_LOAD_FAILED: 'FONT_LOAD_FAILED',
+  OCR_ENGINE_NOT_FOUND: 'OCR_ENGINE_NOT_FOUND',
 } as const;
 
 export class PdfiumError extends Error {
@@ -47,6 +92,74 @@ export class PdfiumError extends Error {
 
 // ── Native addon interface (contract for the C++ N-API module) ──────
 
+/**
+ * A background pass started by the addon (native/pdfium/src/jobs.h).
+ * `done` settles once every page has been visited or the job was
+ * cancelled via `cancelJob`.
+ */
+interface NativeJob<T> {
+  jobId: number;
+  done: Promise<T & { cancelled: boolean }>;
+}
+
+/** What the native mail-merge job reports for one batch of records. */
+export type NativeMailMergeResult = Pick<PdfMailMergeResult, 'written' | 'failed' | 'unknownFields'>;
+
+/** Progress callback for native jobs: pages done out of total. */
+export type JobProgressCallback = (done: number, total: number) => void;
+
+/** A compared page as streamed by compareDocuments, with its heatmap. */
+export interface NativeComparePage extends PdfComparePageDiff {
+  heatmap: Uint8Array;
+  heatmapWidth: number;
+  heatmapHeight: number;
+  /** Cell edge in pixels and in points. */
+  cellSize: number;
+  cellPoints: number;
+}
+
+/** compareDocuments progress: pages finished since the previous call. */
+export type CompareProgressCallback = (
+  done: number,
+  total: number,
+  pages?: NativeComparePage[],
+) => void;
+
+/** A page image written by renderOcrPages. */
+export interface NativeOcrImage {
+  pageIndex: number;
+  /** 8-bit grey PGM file. */
+  path: string;
+  width: number;
+  height: number;
+}
+
+/** renderOcrPages progress: page images written since the previous call. */
+export type OcrRenderProgressCallback = (
+  done: number,
+  total: number,
+  images?: NativeOcrImage[],
+) => void;
+
+/** What renderOcrPages reports once its pages are done. */
+export interface NativeOcrRenderResult {
+  images: NativeOcrImage[];
+  /** Pages left alone because they already have text. */
+  skipped: number;
+  failed: Array<{ pageIndex: number; error: string }>;
+}
+
+/** Recognised words of one page, in pixels of a width × height render. */
+export interface NativeTextLayer {
+  width: number;
+  height: number;
+  /** left, top, right, bottom per word. */
+  boxes: Float32Array;
+  /** Words back to back; word i is text.slice(offsets[i], offsets[i + 1]). */
+  text: string;
+  offsets: Uint32Array;
+}
+
 /**
  * Shape of the native PDFium addon.
  *
@@ -58,15 +171,46 @@ interface PdfiumAddon {
   openDocument(data: Buffer, password?: string): number;
   closeDocument(handle: number): void;
   getPageCount(handle: number): number;
+  /** One batch of an outline node's children as columns; node 0 is the root. */
+  getOutlineChildren(
+    handle: number,
+    nodeRef: number,
+    options?: { start?: number; limit?: number },
+  ): PdfOutlineBatch;
+  /**
+   * Thumbnails of a run of pages from the document's memory-mapped
+   * store, as PNGs.  With `render`, missing ones are rendered first.
+   */
+  getThumbnails(
+    handle: number,
+    first: number,
+    count: number,
+    options: PdfThumbnailSize & { render?: boolean },
+  ): PdfThumbnailBatch;
   /**
-   * Render a page to an RGBA bitmap.
-   * Returns { data: Buffer, width: number, height: number }.
+   * Render a page, or one layer of it, to an RGBA bitmap.
+   * Returns { data: Buffer, width: number, height: number }; the
+   * annotation layer also reports `empty` and `separable`, and has no
+   * data when either rules it out.
    */
-  renderPage(handle: number, pageIndex: number, scale: number): {
+  renderPage(
+    handle: number,
+    pageIndex: number,
+    scale: number,
+    options?: { layer?: PdfRenderLayer; annotations?: number[]; rotation?: number },
+  ): {
     data: Buffer;
     width: number;
     height: number;
+    empty?: boolean;
+    separable?: boolean;
   };
+  /** Blend a straight-alpha RGBA layer over an opaque one of the same size. */
+  compositeLayers(base: Buffer, overlay: Buffer): Buffer;
+  /** Turn an RGBA bitmap clockwise by quarter turns (1–3). */
+  rotateBitmap(data: Buffer, width: number, height: number, quarterTurns: number): Buffer;
+  /** Apply a reading-mode filter to RGBA pixels, into `target` if given. */
+  filterBitmap(data: Buffer, filter: string, target?: Buffer): Buffer;
   /**
    * List text and image objects on a page.
    * Returns array of { id, type, left, top, right, bottom }.
@@ -88,6 +232,33 @@ interface PdfiumAddon {
     fontName?: string,
     fontSize?: number,
   ): void;
+  /**
+   * Char boxes, codepoints and line/word spans of a page from the
+   * cached text page, as typed arrays.
+   */
+  getCharGeometry(
+    handle: number,
+    pageIndex: number,
+    range?: { start?: number; count?: number },
+  ): PdfCharGeometry;
+  /**
+   * Load font data into a document once (same bytes → same reference).
+   * The reference works as editTextObject's fontName.
+   */
+  loadFont(handle: number, data: Buffer, options?: { cid?: boolean }): string;
+  /**
+   * Measure text in a text object's font or in a font reference, from
+   * per-document cached glyph advances.  `size` defaults to the object's.
+   */
+  measureText(
+    handle: number,
+    pageIndex: number,
+    target: number | string,
+    text: string,
+    size?: number,
+  ): PdfTextMetrics;
+  /** Concatenate a PDF-space matrix onto an object's transform. */
+  transformObject(handle: number, pageIndex: number, objectId: number, matrix: PdfMatrix): void;
   replaceImageObject(
     handle: number,
     pageIndex: number,
@@ -104,8 +275,205 @@ interface PdfiumAddon {
     width: number,
     height: number,
   ): void;
+  /** Content fingerprint of an image object, for matching across documents. */
+  getImageFingerprint(handle: number, pageIndex: number, objectId: number): PdfImageFingerprint;
+  /** Downsampled pixels of an image object, from a cache keyed by its stream. */
+  getImagePreview(
+    handle: number,
+    pageIndex: number,
+    objectId: number,
+    maxEdge?: number,
+  ): PdfImagePreview;
+  /**
+   * Decode the previews of every image on the pages into the cache,
+   * taking the PDFium lock only while nothing else wants it.
+   */
+  prefetchImagePreviews(
+    handle: number,
+    options: { pages?: number[]; maxEdge?: number },
+    onProgress?: JobProgressCallback,
+  ): NativeJob<Omit<PdfPrefetchImagePreviewsResult, 'cancelled'>>;
+  /**
+   * Render the page without an object and the object alone, once,
+   * for compositing while it is dragged.  The document is unchanged.
+   */
+  beginObjectDrag(handle: number, pageIndex: number, objectId: number, scale: number): {
+    sessionId: number;
+    data: Buffer;
+    width: number;
+    height: number;
+    sprite: PdfPixelRect;
+  };
+  /** Blend the object's sprite at `rect`; returns the changed patch. */
+  previewObjectDrag(
+    sessionId: number, x: number, y: number, width: number, height: number,
+  ): PdfPixelRect & { data: Buffer };
+  /** End a drag; the matrix to the last previewed rect, or null. */
+  endObjectDrag(sessionId: number): PdfMatrix | null;
+  /** Start a freehand stroke over `base`, the RGBA raster on screen. */
+  beginInk(
+    handle: number,
+    pageIndex: number,
+    scale: number,
+    base: Buffer,
+    width: number,
+    height: number,
+    style?: PdfInkStyle,
+  ): number;
+  /** Append page-pixel points; returns the patch they changed. */
+  appendInk(sessionId: number, points: Float32Array): PdfPixelRect & { data: Buffer };
+  /** End a stroke; its points in PDF space, or null if empty. */
+  endInk(sessionId: number): PdfInkStroke | null;
+  /** Add a one-stroke ink annotation; returns its index. */
+  addInkAnnotation(
+    handle: number,
+    pageIndex: number,
+    points: Float32Array,
+    style?: PdfInkStyle,
+  ): number;
+  removeAnnotation(handle: number, pageIndex: number, annotIndex: number): void;
+  /** Annotations of `pages` (default all) as columnar typed arrays. */
+  listAnnotations(handle: number, pages?: number[]): PdfAnnotationColumns;
+  /** Apply many annotation updates, loading each page once. */
+  updateAnnotations(handle: number, updates: PdfAnnotationUpdate[]): PdfUpdateAnnotationsResult;
   /** Serialise the document to a Buffer (FPDF_SaveAsCopy). */
   saveDocument(handle: number): Buffer;
+  /**
+   * Stream the document to a file (FPDF_SaveAsCopy) without building
+   * the whole PDF in a Buffer.
+   */
+  saveDocumentToFile(handle: number, filePath: string): void;
+  /**
+   * Stream the document to a file followed by an incremental update
+   * with an empty signature field, on a background thread.  The
+   * byte-range digest is computed while writing, so the file is never
+   * read back.
+   */
+  prepareSignature(
+    handle: number,
+    filePath: string,
+    options: Omit<PdfSignPreparePayload, 'docId' | 'outputPath'>,
+  ): NativeJob<{ byteRange: PdfSignByteRange; digest: string }>;
+  /** Write a DER signature into the placeholder, in place. */
+  embedSignature(filePath: string, byteRange: PdfSignByteRange, signature: Buffer): void;
+  /**
+   * Flatten annotations and/or form fields into page content on a
+   * background thread (FPDFPage_Flatten).
+   */
+  flattenDocument(
+    handle: number,
+    options: PdfFlattenOptions,
+    onProgress?: JobProgressCallback,
+  ): NativeJob<Omit<PdfFlattenResult, 'cancelled'>>;
+  /** Time a cold load and render of each page, on a background thread. */
+  profilePages(
+    handle: number,
+    options: { pages?: number[]; dpi?: number },
+    onProgress?: JobProgressCallback,
+  ): NativeJob<{ pages: number[]; ms: number[] }>;
+  /**
+   * Replace each page's content with one image object rendered at
+   * `dpi`, on a background thread.  Annotations are left as they are.
+   */
+  rasterizePages(
+    handle: number,
+    options: Omit<PdfRasterizeOptions, 'slowest'>,
+    onProgress?: JobProgressCallback,
+  ): NativeJob<{ rasterized: number[]; failed: number[] }>;
+  /**
+   * Remove text and image content under term/pattern hits on a
+   * background thread, regenerating each page as it goes.
+   */
+  redactDocument(
+    handle: number,
+    spec: PdfRedactSpec,
+    onProgress?: JobProgressCallback,
+  ): NativeJob<PdfRedactStats>;
+  /**
+   * Replace `pattern` in the text objects of every page on a background
+   * thread.  Edited pages stay open and dirty, as after editTextObject.
+   */
+  findReplace(
+    handle: number,
+    pattern: string,
+    replacement: string,
+    options: Omit<PdfFindReplacePayload, 'docId' | 'pattern' | 'replacement'>,
+    onProgress?: JobProgressCallback,
+  ): NativeJob<Omit<PdfFindReplaceResult, 'cancelled'>>;
+  /**
+   * Fill a form template once per record through the form-fill API,
+   * streaming each filled copy to the matching output path.  The
+   * template is not registered as an open document.
+   */
+  mailMerge(
+    template: Buffer,
+    records: PdfMergeRecord[],
+    outputs: string[],
+    options: { flatten?: boolean; password?: string },
+    onProgress?: JobProgressCallback,
+  ): NativeJob<NativeMailMergeResult>;
+  /**
+   * Read the structure, image and font inventories and per-page
+   * operator counts of files on disk.  Parses the files itself on
+   * native threads and never takes the PDFium lock, so it scales with
+   * cores and does not hold up rendering or edits.
+   */
+  analyzeFiles(
+    paths: string[],
+    options: { threads?: number; hashStreams?: boolean },
+    onProgress?: JobProgressCallback,
+  ): NativeJob<Pick<PdfAnalyzeResult, 'files'>>;
+  /**
+   * Write every image on the given pages into `outDir` (which must
+   * exist).  JPEG and JPEG 2000 streams are copied still encoded;
+   * decoding and file I/O run on native writer threads, off the lock.
+   */
+  extractImages(
+    handle: number,
+    outDir: string,
+    options: { pages?: number[]; threads?: number },
+    onProgress?: JobProgressCallback,
+  ): NativeJob<Omit<PdfExtractImagesResult, 'cancelled'>>;
+  /**
+   * Fill the thumbnail store with every missing or stale thumbnail on a
+   * background thread, PNG encoding outside the lock.
+   */
+  buildThumbnails(
+    handle: number,
+    options: PdfThumbnailSize & { pages?: number[] },
+    onProgress?: JobProgressCallback,
+  ): NativeJob<Omit<PdfBuildThumbnailsResult, 'cancelled'>>;
+  /**
+   * Render page pairs of two documents on a background thread and box
+   * the areas that differ.  Each pair is rendered under the lock and
+   * diffed outside it; heatmaps are only streamed through onProgress.
+   */
+  compareDocuments(
+    handleA: number,
+    handleB: number,
+    options: Omit<PdfCompareDocumentsPayload, 'docIdA' | 'docIdB'>,
+    onProgress?: CompareProgressCallback,
+  ): NativeJob<Omit<PdfCompareResult, 'cancelled'>>;
+  /**
+   * Render the image-only pages (or every page with `all`) to grey PGM
+   * files in `outDir` for OCR on a background thread, streaming each
+   * file through onProgress as soon as it is written.
+   */
+  renderOcrPages(
+    handle: number,
+    outDir: string,
+    options: { dpi?: number; pages?: number[]; all?: boolean },
+    onProgress?: OcrRenderProgressCallback,
+  ): NativeJob<NativeOcrRenderResult>;
+  /** Add recognised words as invisible text.  Returns the words added. */
+  addTextLayer(
+    handle: number,
+    pageIndex: number,
+    layer: NativeTextLayer,
+    options?: { font?: string },
+  ): number;
+  /** Stop a background job before its next page.  False if already ended. */
+  cancelJob(jobId: number): boolean;
 }
 
 // ── Stub addon (used until native build is available) ───────────────
@@ -117,20 +485,156 @@ const STUB_ADDON: PdfiumAddon = {
   },
   closeDocument(_handle: number): void { /* no-op */ },
   getPageCount(_handle: number): number { return 1; },
-  renderPage(_handle: number, _pageIndex: number, _scale: number) {
+  getThumbnails(_handle: number, first: number) {
+    return {
+      first, count: 0, widths: new Uint16Array(0), heights: new Uint16Array(0),
+      offsets: new Uint32Array(1), data: new Uint8Array(0),
+    };
+  },
+  getOutlineChildren() {
+    return {
+      total: 0, start: 0, count: 0, ids: new Uint32Array(0), flags: new Uint8Array(0),
+      pages: new Int32Array(0), points: new Float32Array(0), titles: '',
+      titleOffsets: new Uint32Array(1),
+    };
+  },
+  renderPage(_handle: number, _pageIndex: number, _scale: number, options?: { layer?: PdfRenderLayer }) {
+    if (options?.layer === 'annotations') {
+      return { data: Buffer.alloc(0), width: 1, height: 1, empty: true, separable: true };
+    }
     // Return a minimal 1×1 transparent RGBA bitmap
     const SINGLE_PIXEL_SIZE = 4;
     return { data: Buffer.alloc(SINGLE_PIXEL_SIZE), width: 1, height: 1 };
   },
+  compositeLayers(base: Buffer): Buffer {
+    return Buffer.from(base);
+  },
+  rotateBitmap(data: Buffer): Buffer {
+    return Buffer.from(data);
+  },
+  filterBitmap(data: Buffer, _filter: string, target?: Buffer): Buffer {
+    return target ?? Buffer.from(data);
+  },
   listPageObjects(_handle: number, _pageIndex: number) {
     return [];
   },
   editTextObject() { /* no-op */ },
+  getCharGeometry() {
+    return {
+      version: 0, start: 0, count: 0,
+      boxes: new Float32Array(0), codepoints: new Uint32Array(0),
+      lines: new Uint32Array(0), words: new Uint32Array(0),
+    };
+  },
+  loadFont() { return 'font:stub'; },
+  measureText() {
+    return { width: 0, ascent: 0, descent: 0, advances: new Float32Array(0) };
+  },
+  transformObject() { /* no-op */ },
   replaceImageObject() { /* no-op */ },
   replaceImageObjectBitmap() { /* no-op */ },
+  getImageFingerprint() {
+    return { pixelWidth: 0, pixelHeight: 0, hash: '' };
+  },
+  getImagePreview() {
+    return {
+      width: 1, height: 1, image: new Uint8Array(4), pixelWidth: 1, pixelHeight: 1,
+      cached: false,
+    };
+  },
+  prefetchImagePreviews() {
+    return { jobId: 0, done: Promise.resolve({ decoded: 0, cancelled: false }) };
+  },
+  beginObjectDrag() {
+    return {
+      sessionId: 0, data: Buffer.alloc(4), width: 1, height: 1,
+      sprite: { x: 0, y: 0, width: 1, height: 1 },
+    };
+  },
+  previewObjectDrag() {
+    return { data: Buffer.alloc(0), x: 0, y: 0, width: 0, height: 0 };
+  },
+  endObjectDrag() { return null; },
+  beginInk() { return 0; },
+  appendInk() {
+    return { data: Buffer.alloc(0), x: 0, y: 0, width: 0, height: 0 };
+  },
+  endInk() { return null; },
+  addInkAnnotation() { return 0; },
+  removeAnnotation() { /* no-op */ },
+  listAnnotations() {
+    return {
+      count: 0, pages: new Uint32Array(0), indices: new Uint32Array(0),
+      subtypes: new Uint8Array(0), rects: new Float32Array(0), flags: new Uint32Array(0),
+      colors: new Uint8Array(0), contents: '', contentsOffsets: new Uint32Array(1),
+    };
+  },
+  updateAnnotations() { return { updated: 0, failed: [] }; },
   saveDocument(_handle: number): Buffer {
     return Buffer.alloc(0);
   },
+  saveDocumentToFile() { /* no-op */ },
+  prepareSignature() {
+    return {
+      jobId: 0,
+      done: Promise.resolve({
+        byteRange: [0, 0, 0, 0] as PdfSignByteRange, digest: '', cancelled: false,
+      }),
+    };
+  },
+  embedSignature() { /* no-op */ },
+  flattenDocument() {
+    return {
+      jobId: 0,
+      done: Promise.resolve({ flattened: 0, unchanged: 0, skipped: [], failed: [], cancelled: false }),
+    };
+  },
+  profilePages() {
+    return { jobId: 0, done: Promise.resolve({ pages: [], ms: [], cancelled: false }) };
+  },
+  rasterizePages() {
+    return { jobId: 0, done: Promise.resolve({ rasterized: [], failed: [], cancelled: false }) };
+  },
+  mailMerge() {
+    return {
+      jobId: 0,
+      done: Promise.resolve({ written: 0, failed: [], unknownFields: [], cancelled: false }),
+    };
+  },
+  analyzeFiles() {
+    return { jobId: 0, done: Promise.resolve({ files: [], cancelled: false }) };
+  },
+  extractImages() {
+    return { jobId: 0, done: Promise.resolve({ files: [], failed: [], cancelled: false }) };
+  },
+  buildThumbnails() {
+    return { jobId: 0, done: Promise.resolve({ built: 0, current: 0, failed: 0, cancelled: false }) };
+  },
+  compareDocuments() {
+    return { jobId: 0, done: Promise.resolve({ pages: [], changedPages: 0, cancelled: false }) };
+  },
+  renderOcrPages() {
+    return { jobId: 0, done: Promise.resolve({ images: [], skipped: 0, failed: [], cancelled: false }) };
+  },
+  addTextLayer() { return 0; },
+  findReplace() {
+    return {
+      jobId: 0,
+      done: Promise.resolve({
+        matches: 0, replaced: 0, skipped: 0, objectsChanged: 0, pages: [], cancelled: false,
+      }),
+    };
+  },
+  redactDocument() {
+    return {
+      jobId: 0,
+      done: Promise.resolve({
+        matches: 0, textObjectsRemoved: 0, imagesClipped: 0, unremovedChars: 0,
+        skipped: 0, pages: [], cancelled: false,
+      }),
+    };
+  },
+  cancelJob(): boolean { return false; },
 };
 
 // ── Addon loader ────────────────────────────────────────────────────
@@ -141,7 +645,7 @@ const STUB_ADDON: PdfiumAddon = {
  * Dev:       <project>/native/pdfium/build/Release/pdfium.node
  * Packaged:  <resources>/app.asar.unpacked/native/pdfium/build/Release/pdfium.node
  */
-function resolveAddonPath(): string {
+export function resolveAddonPath(): string {
   const isPackaged = app.isPackaged;
   if (isPackaged) {
     // In packaged mode, asarUnpack extracts files next to the asar archive
@@ -157,9 +661,9 @@ function resolveAddonPath(): string {
   );
 }
 
-function loadAddon(): PdfiumAddon {
+function loadAddon(addonPath?: string): PdfiumAddon {
   try {
-    const addonPath = resolveAddonPath();
+    addonPath ??= resolveAddonPath();
     // eslint-disable-next-line @typescript-eslint/no-require-imports
     const addon = require(addonPath) as PdfiumAddon;
     console.log('[PdfiumEngine] Native addon loaded');
@@ -185,9 +689,14 @@ export class PdfiumEngine {
    * Released when the document is closed.
    */
   private readonly pinnedBuffers = new Map<string, Buffer>();
-
-  constructor() {
-    this.addon = loadAddon();
+  /** Running native jobs, keyed by `${docId}:${kind}` → native job id. */
+  private readonly jobs = new Map<string, number>();
+  /**
+   * @param addonPath explicit addon location, for worker processes
+   *   where Electron's `app` is unavailable (see pdf-worker.ts)
+   */
+  constructor(addonPath?: string) {
+    this.addon = loadAddon(addonPath);
   }
 
   // ── Document lifecycle ──────────────────────────────────────────
@@ -215,6 +724,7 @@ export class PdfiumEngine {
   /** Close a previously opened document. */
   close(docId: string): void {
     const handle = this.requireHandle(docId);
+    this.cancelDocumentJobs(docId);
     this.addon.closeDocument(handle);
     this.handles.delete(docId);
     this.pinnedBuffers.delete(docId);
@@ -223,6 +733,7 @@ export class PdfiumEngine {
   /** Close all open documents (cleanup on app quit). */
   closeAll(): void {
     for (const [docId, handle] of this.handles.entries()) {
+      this.cancelDocumentJobs(docId);
       try {
         this.addon.closeDocument(handle);
       } catch {
@@ -239,6 +750,71 @@ export class PdfiumEngine {
     return this.addon.getPageCount(handle);
   }
 
+  // ── Outline ─────────────────────────────────────────────────────
+
+  /**
+   * Children of one outline node, a batch at a time.  Only the nodes
+   * asked for are ever walked, so opening a document never pays for
+   * its outline.
+   */
+  getOutlineChildren(
+    docId: string,
+    nodeRef: number,
+    options: { start?: number; limit?: number } = {},
+  ): PdfOutlineBatch {
+    const handle = this.requireHandle(docId);
+
+    try {
+      return this.addon.getOutlineChildren(handle, nodeRef, options);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        `Outline lookup failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  // ── Thumbnails ──────────────────────────────────────────────────
+
+  /**
+   * Thumbnails of pages first .. first + count.  Kept as PNGs in a
+   * memory-mapped file per document, so only the ones asked for are
+   * ever copied or decoded.
+   */
+  getThumbnails(
+    docId: string,
+    first: number,
+    count: number,
+    options: PdfThumbnailSize & { render?: boolean } = {},
+  ): PdfThumbnailBatch {
+    const handle = this.requireHandle(docId);
+
+    try {
+      return this.addon.getThumbnails(handle, first, count, options);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Thumbnail lookup failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Render every missing or stale thumbnail into the store. */
+  async buildThumbnails(
+    docId: string,
+    options: PdfThumbnailSize & { pages?: number[] },
+    onProgress?: JobProgressCallback,
+  ): Promise<PdfBuildThumbnailsResult> {
+    const handle = this.requireHandle(docId);
+    if (options.pages) {
+      for (const pageIndex of options.pages) this.validatePageIndex(handle, pageIndex);
+    }
+
+    return this.runJob(docId, 'thumbnails', () =>
+      this.addon.buildThumbnails(handle, options, onProgress),
+    );
+  }
+
   // ── Rendering ───────────────────────────────────────────────────
 
   /** Render a page to an RGBA bitmap (PNG-encoded for IPC transfer). */
@@ -256,6 +832,7 @@ export class PdfiumEngine {
         image: new Uint8Array(result.data),
         width: result.width,
         height: result.height,
+        scale,
       };
     } catch (err) {
       throw new PdfiumError(
@@ -265,6 +842,116 @@ export class PdfiumEngine {
     }
   }
 
+  /**
+   * Render one layer of a page.  Content and annotation layers are
+   * cached and invalidated separately; see `compositeLayers`.
+   * `annotations` limits the annotation layer to those indices;
+   * `rotation` turns the page clockwise (degrees).
+   */
+  renderPageLayer(
+    docId: string,
+    pageIndex: number,
+    scale: number,
+    layer: PdfRenderLayer,
+    annotations?: number[],
+    rotation: PdfViewRotation = 0,
+  ): PdfRenderResult & { empty: boolean; separable: boolean } {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (scale <= 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Scale must be > 0');
+    }
+
+    try {
+      const result = this.addon.renderPage(handle, pageIndex, scale, {
+        layer,
+        annotations,
+        rotation: rotation / 90,
+      });
+      return {
+        image: new Uint8Array(result.data),
+        width: result.width,
+        height: result.height,
+        scale,
+        empty: result.empty ?? false,
+        separable: result.separable ?? true,
+      };
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Render failed for page ${pageIndex} (${layer}): ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Blend an annotation layer over a content layer of the same size. */
+  compositeLayers(content: Uint8Array, annotations: Uint8Array): Uint8Array {
+    try {
+      const out = this.addon.compositeLayers(
+        Buffer.from(content.buffer, content.byteOffset, content.byteLength),
+        Buffer.from(annotations.buffer, annotations.byteOffset, annotations.byteLength),
+      );
+      return new Uint8Array(out.buffer, out.byteOffset, out.byteLength);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Layer compositing failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /**
+   * Turn a rendered RGBA bitmap clockwise.  Quarter turns move whole
+   * pixels, so this is exact and needs no PDFium (and no lock).
+   */
+  rotateBitmap(bitmap: PdfRenderResult, rotation: PdfViewRotation): PdfRenderResult {
+    if (rotation === 0) return bitmap;
+    try {
+      const { image, width, height } = bitmap;
+      const out = this.addon.rotateBitmap(
+        Buffer.from(image.buffer, image.byteOffset, image.byteLength),
+        width,
+        height,
+        rotation / 90,
+      );
+      const swap = rotation !== 180;
+      return {
+        ...bitmap,
+        image: new Uint8Array(out.buffer, out.byteOffset, out.byteLength),
+        width: swap ? height : width,
+        height: swap ? width : height,
+      };
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Bitmap rotation failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /**
+   * Filter RGBA pixels for a reading mode: a whole raster or a patch of
+   * one, since every pixel maps on its own.  `inPlace` overwrites the
+   * input and is only for bitmaps no cache holds.
+   */
+  filterBitmap(
+    image: Uint8Array,
+    filter: Exclude<PdfViewFilter, 'none'>,
+    inPlace = false,
+  ): Uint8Array {
+    try {
+      const data = Buffer.from(image.buffer, image.byteOffset, image.byteLength);
+      const out = this.addon.filterBitmap(data, filter, inPlace ? data : undefined);
+      return new Uint8Array(out.buffer, out.byteOffset, out.byteLength);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Bitmap filter failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
   // ── Object inspection ───────────────────────────────────────────
 
   /** List text and image objects on a page. */
@@ -284,60 +971,428 @@ export class PdfiumEngine {
     }));
   }
 
-  // ── Editing ─────────────────────────────────────────────────────
-
-  /** Edit the text content of a text object. */
-  editTextObject(
+  /**
+   * Geometry of a page's chars for selection and highlighting.  The
+   * page's text is extracted once per version; later calls only copy.
+   */
+  getCharGeometry(
     docId: string,
     pageIndex: number,
-    objectId: number,
-    newText: string,
-    fontName?: string,
-    fontSize?: number,
-  ): void {
+    range: { start?: number; count?: number } = {},
+  ): PdfCharGeometry {
     const handle = this.requireHandle(docId);
     this.validatePageIndex(handle, pageIndex);
 
-    if (!newText) {
-      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'newText must not be empty');
+    if ((range.start ?? 0) < 0 || (range.count ?? 0) < 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'range must not be negative');
     }
-    if (fontSize !== undefined && fontSize <= 0) {
-      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'fontSize must be > 0');
+
+    try {
+      return this.addon.getCharGeometry(handle, pageIndex, range);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Char geometry failed for page ${pageIndex}: ${(err as Error).message}`,
+      );
     }
+  }
 
+  /** Identify an image object by its content (pixel size + stream hash). */
+  getImageFingerprint(docId: string, pageIndex: number, objectId: number): PdfImageFingerprint {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
     try {
-      this.addon.editTextObject(handle, pageIndex, objectId, newText, fontName, fontSize);
+      return this.addon.getImageFingerprint(handle, pageIndex, objectId);
     } catch (err) {
       throw new PdfiumError(
-        PDFIUM_ERROR_CODES.EDIT_FAILED,
-        `Text edit failed: ${(err as Error).message}`,
+        PDFIUM_ERROR_CODES.OBJECT_NOT_FOUND,
+        `Image fingerprint failed: ${(err as Error).message}`,
       );
     }
   }
 
-  /** Replace an image object with new image data. */
-  replaceImageObject(
+  /**
+   * Downsampled preview of an image object.  Cheap once cached: by
+   * selection, or ahead of it through prefetchImagePreviews.
+   */
+  getImagePreview(
     docId: string,
     pageIndex: number,
     objectId: number,
-    imageData: Uint8Array,
-    format: 'png' | 'jpeg',
-  ): void {
+    maxEdge?: number,
+  ): PdfImagePreview {
     const handle = this.requireHandle(docId);
     this.validatePageIndex(handle, pageIndex);
-
-    if (imageData.byteLength > MAX_IMAGE_BYTES) {
+    try {
+      return this.addon.getImagePreview(handle, pageIndex, objectId, maxEdge);
+    } catch (err) {
       throw new PdfiumError(
-        PDFIUM_ERROR_CODES.IMAGE_TOO_LARGE,
-        `Image exceeds maximum size of ${MAX_IMAGE_BYTES} bytes`,
+        PDFIUM_ERROR_CODES.OBJECT_NOT_FOUND,
+        `Image preview failed: ${(err as Error).message}`,
       );
     }
-    if (format !== 'png' && format !== 'jpeg') {
-      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Format must be "png" or "jpeg"');
+  }
+
+  /** Fill the preview cache for the images on `pages` in the background. */
+  async prefetchImagePreviews(
+    docId: string,
+    options: { pages?: number[]; maxEdge?: number },
+    onProgress?: JobProgressCallback,
+  ): Promise<PdfPrefetchImagePreviewsResult> {
+    const handle = this.requireHandle(docId);
+    if (options.pages) {
+      for (const pageIndex of options.pages) this.validatePageIndex(handle, pageIndex);
     }
+    return this.runJob(docId, 'image-previews', () =>
+      this.addon.prefetchImagePreviews(handle, options, onProgress),
+    );
+  }
 
-    try {
-      if (format === 'png') {
+  // ── Drag previews ───────────────────────────────────────────────
+
+  /**
+   * Start a drag or resize of an object.  Renders the base and sprite
+   * layers once; frames are then composited without touching PDFium.
+   */
+  beginObjectDrag(
+    docId: string,
+    pageIndex: number,
+    objectId: number,
+    scale: number,
+  ): PdfDragBeginResult {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (scale <= 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Scale must be > 0');
+    }
+
+    try {
+      const { sessionId, data, width, height, sprite } =
+        this.addon.beginObjectDrag(handle, pageIndex, objectId, scale);
+      return { sessionId, image: new Uint8Array(data), width, height, sprite };
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Drag preview failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Composite one frame with the object at `rect` (page pixels). */
+  previewObjectDrag(sessionId: number, rect: PdfPixelRect): PdfDragPreviewResult {
+    const { x, y, width, height } = rect;
+    if (!(width > 0 && height > 0)) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Drag rect must not be empty');
+    }
+
+    try {
+      const patch = this.addon.previewObjectDrag(
+        sessionId, Math.round(x), Math.round(y), Math.round(width), Math.round(height),
+      );
+      return {
+        image: new Uint8Array(patch.data),
+        x: patch.x,
+        y: patch.y,
+        width: patch.width,
+        height: patch.height,
+      };
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Drag preview failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /**
+   * End a drag.  Returns the matrix for `transformObject` that puts the
+   * object where it was last previewed, or null if it did not move.
+   */
+  endObjectDrag(sessionId: number): PdfMatrix | null {
+    try {
+      return this.addon.endObjectDrag(sessionId);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        `Drag end failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  // ── Ink ─────────────────────────────────────────────────────────
+
+  /**
+   * Start a freehand stroke over `view`, the page raster on screen.
+   * Points are then drawn into it natively, without re-rendering.
+   */
+  beginInk(
+    docId: string,
+    pageIndex: number,
+    scale: number,
+    view: PdfRenderResult,
+    style?: PdfInkStyle,
+  ): number {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (scale <= 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Scale must be > 0');
+    }
+
+    try {
+      const { image, width, height } = view;
+      return this.addon.beginInk(
+        handle,
+        pageIndex,
+        scale,
+        Buffer.from(image.buffer, image.byteOffset, image.byteLength),
+        width,
+        height,
+        style,
+      );
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Ink failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Append page-pixel points (x, y pairs) to a stroke. */
+  appendInk(sessionId: number, points: Float32Array): PdfInkPatch {
+    try {
+      const patch = this.addon.appendInk(sessionId, points);
+      return {
+        image: new Uint8Array(patch.data),
+        x: patch.x,
+        y: patch.y,
+        width: patch.width,
+        height: patch.height,
+      };
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.RENDER_FAILED,
+        `Ink failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** End a stroke.  Returns it in PDF points, or null if it is empty. */
+  endInk(sessionId: number): PdfInkStroke | null {
+    try {
+      return this.addon.endInk(sessionId);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        `Ink end failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Commit a stroke as an ink annotation.  Returns its index. */
+  addInkAnnotation(docId: string, pageIndex: number, stroke: PdfInkStroke): number {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (stroke.points.length < 2) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Stroke has no points');
+    }
+
+    try {
+      return this.addon.addInkAnnotation(handle, pageIndex, stroke.points, {
+        color: stroke.color,
+        width: stroke.width,
+      });
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.EDIT_FAILED,
+        `Ink annotation failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Remove an annotation; later annotations shift down one index. */
+  removeAnnotation(docId: string, pageIndex: number, annotIndex: number): void {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    try {
+      this.addon.removeAnnotation(handle, pageIndex, annotIndex);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.EDIT_FAILED,
+        `Annotation removal failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  // ── Annotations ─────────────────────────────────────────────────
+
+  /**
+   * List annotations across pages in one native call, as columns.
+   * Strings share one table, so there is no per-annotation object.
+   */
+  listAnnotations(docId: string, pages?: number[]): PdfAnnotationColumns {
+    const handle = this.requireHandle(docId);
+    for (const pageIndex of pages ?? []) this.validatePageIndex(handle, pageIndex);
+
+    try {
+      return this.addon.listAnnotations(handle, pages);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        `Annotation listing failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Update many annotations; positions that failed are reported, not thrown. */
+  updateAnnotations(docId: string, updates: PdfAnnotationUpdate[]): PdfUpdateAnnotationsResult {
+    const handle = this.requireHandle(docId);
+
+    try {
+      return this.addon.updateAnnotations(handle, updates);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.EDIT_FAILED,
+        `Annotation update failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  // ── Editing ─────────────────────────────────────────────────────
+
+  /** Edit the text content of a text object. */
+  editTextObject(
+    docId: string,
+    pageIndex: number,
+    objectId: number,
+    newText: string,
+    fontName?: string,
+    fontSize?: number,
+  ): void {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (!newText) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'newText must not be empty');
+    }
+    if (fontSize !== undefined && fontSize <= 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'fontSize must be > 0');
+    }
+
+    try {
+      this.addon.editTextObject(handle, pageIndex, objectId, newText, fontName, fontSize);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.EDIT_FAILED,
+        `Text edit failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /**
+   * Load a TrueType/OpenType font for text edits.  Fonts are cached per
+   * document, so repeated loads and edits share one embedded copy.
+   */
+  loadFont(docId: string, data: Uint8Array, cid = false): string {
+    const handle = this.requireHandle(docId);
+
+    if (data.byteLength === 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Font data must not be empty');
+    }
+
+    try {
+      return this.addon.loadFont(
+        handle,
+        Buffer.from(data.buffer, data.byteOffset, data.byteLength),
+        { cid },
+      );
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.FONT_LOAD_FAILED,
+        `Font load failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /**
+   * Measure text for layout while editing.  Advances are cached per
+   * document and font, so repeated queries do not load the page.
+   */
+  measureText(
+    docId: string,
+    pageIndex: number,
+    target: number | string,
+    text: string,
+    size?: number,
+  ): PdfTextMetrics {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (target === '') {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'objectId or font is required');
+    }
+    if (size !== undefined && size <= 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'size must be > 0');
+    }
+    if (typeof target === 'string' && size === undefined) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'size is required with a font');
+    }
+
+    try {
+      return this.addon.measureText(handle, pageIndex, target, text, size);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.OBJECT_NOT_FOUND,
+        `Text measurement failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Move, scale or otherwise transform an object by a PDF-space matrix. */
+  transformObject(docId: string, pageIndex: number, objectId: number, matrix: PdfMatrix): void {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (matrix.length !== 6 || !matrix.every(Number.isFinite)) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'matrix must be 6 finite numbers');
+    }
+
+    try {
+      this.addon.transformObject(handle, pageIndex, objectId, matrix);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.EDIT_FAILED,
+        `Transform failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Replace an image object with new image data. */
+  replaceImageObject(
+    docId: string,
+    pageIndex: number,
+    objectId: number,
+    imageData: Uint8Array,
+    format: 'png' | 'jpeg',
+  ): void {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (imageData.byteLength > MAX_IMAGE_BYTES) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.IMAGE_TOO_LARGE,
+        `Image exceeds maximum size of ${MAX_IMAGE_BYTES} bytes`,
+      );
+    }
+    if (format !== 'png' && format !== 'jpeg') {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Format must be "png" or "jpeg"');
+    }
+
+    try {
+      if (format === 'png') {
         // Decode PNG to raw BGRA bitmap using Electron's nativeImage,
         // then use the bitmap-based replacement path that preserves alpha.
         const img = nativeImage.createFromBuffer(Buffer.from(imageData));
@@ -365,6 +1420,41 @@ export class PdfiumEngine {
     }
   }
 
+  /**
+   * Replace an image object with decoded BGRA pixels.  Needs no
+   * nativeImage, so worker processes use it for pre-decoded PNGs.
+   */
+  replaceImageObjectBitmap(
+    docId: string,
+    pageIndex: number,
+    objectId: number,
+    bgra: Uint8Array,
+    width: number,
+    height: number,
+  ): void {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    if (bgra.byteLength !== width * height * 4) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        'Bitmap size does not match width × height × 4',
+      );
+    }
+
+    try {
+      this.addon.replaceImageObjectBitmap(
+        handle, pageIndex, objectId,
+        Buffer.from(bgra.buffer, bgra.byteOffset, bgra.byteLength), width, height,
+      );
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.EDIT_FAILED,
+        `Image replace failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
   // ── Save ────────────────────────────────────────────────────────
 
   /** Serialise the document to PDF bytes (FPDF_SaveAsCopy). */
@@ -381,8 +1471,379 @@ export class PdfiumEngine {
     }
   }
 
+  /**
+   * Stream the document straight to `filePath`.  Unlike `save`, the
+   * bytes never pass through the JS heap, so this suits very large
+   * documents and checkpoints.
+   */
+  saveToFile(docId: string, filePath: string): void {
+    const handle = this.requireHandle(docId);
+    try {
+      this.addon.saveDocumentToFile(handle, filePath);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.SAVE_FAILED,
+        `Save failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  // ── Signatures ──────────────────────────────────────────────────
+
+  /**
+   * Save a copy with an empty signature field and return the digest
+   * to sign.  Costs one streaming pass however large the document, off
+   * the main thread.
+   */
+  async prepareSignature(
+    docId: string,
+    filePath: string,
+    options: Omit<PdfSignPreparePayload, 'docId' | 'outputPath'> = {},
+  ): Promise<PdfSignPrepareResult> {
+    const handle = this.requireHandle(docId);
+    try {
+      const { byteRange, digest } =
+        await this.addon.prepareSignature(handle, filePath, options).done;
+      return { outputPath: filePath, byteRange, digest };
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.SIGN_FAILED,
+        `Signature preparation failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Write a detached signature into a file from `prepareSignature`. */
+  embedSignature(filePath: string, byteRange: PdfSignByteRange, signature: Uint8Array): void {
+    try {
+      this.addon.embedSignature(
+        filePath, byteRange,
+        Buffer.from(signature.buffer, signature.byteOffset, signature.byteLength),
+      );
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.SIGN_FAILED,
+        `Signature embedding failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  // ── Background jobs ─────────────────────────────────────────────
+
+  /**
+   * Flatten annotations and/or form fields into page content.
+   * Edits the open document in place; save afterwards to write the
+   * flattened copy.
+   */
+  async flattenDocument(
+    docId: string,
+    options: PdfFlattenOptions,
+    onProgress?: JobProgressCallback,
+  ): Promise<PdfFlattenResult> {
+    const handle = this.requireHandle(docId);
+
+    if (options.annotations === false && options.forms === false) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        'At least one of annotations/forms must be flattened',
+      );
+    }
+    if (options.pages) {
+      for (const pageIndex of options.pages) this.validatePageIndex(handle, pageIndex);
+    }
+
+    return this.runJob(docId, 'flatten', () =>
+      this.addon.flattenDocument(handle, options, onProgress),
+    );
+  }
+
+  /**
+   * Replace the content of pathologically slow pages with a single
+   * image, so the saved copy opens and renders quickly anywhere.  With
+   * `slowest`, candidates are profiled first and only the N slowest
+   * are rasterised.  Edits the open document in place.
+   */
+  async rasterizePages(
+    docId: string,
+    options: PdfRasterizeOptions,
+    onProgress?: JobProgressCallback,
+  ): Promise<PdfRasterizeResult> {
+    const handle = this.requireHandle(docId);
+    const { slowest, ...rasterOptions } = options;
+
+    if (options.dpi !== undefined && options.dpi <= 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'dpi must be > 0');
+    }
+    if (slowest !== undefined && !(slowest >= 1)) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'slowest must be >= 1');
+    }
+    if (options.pages) {
+      for (const pageIndex of options.pages) this.validatePageIndex(handle, pageIndex);
+    }
+
+    let profile: PdfRasterizeResult['profile'];
+    if (slowest !== undefined) {
+      const timings = await this.runJob(docId, 'rasterize', () =>
+        this.addon.profilePages(handle, { pages: options.pages }, onProgress),
+      );
+      profile = { pages: timings.pages, ms: timings.ms };
+      if (timings.cancelled) return { rasterized: [], failed: [], profile, cancelled: true };
+
+      rasterOptions.pages = timings.pages
+        .map((pageIndex, i) => ({ pageIndex, ms: timings.ms[i] }))
+        .sort((a, b) => b.ms - a.ms)
+        .slice(0, slowest)
+        .map((p) => p.pageIndex)
+        .sort((a, b) => a - b);
+      if (rasterOptions.pages.length === 0) {
+        return { rasterized: [], failed: [], profile, cancelled: false };
+      }
+    }
+
+    const result = await this.runJob(docId, 'rasterize', () =>
+      this.addon.rasterizePages(handle, rasterOptions, onProgress),
+    );
+    return profile ? { ...result, profile } : result;
+  }
+
+  /**
+   * Redact every term/pattern hit on the given pages of the open
+   * document.  Resumable, checkpointed runs are built on this in
+   * redaction.ts.
+   */
+  async redactDocument(
+    docId: string,
+    spec: PdfRedactSpec,
+    onProgress?: JobProgressCallback,
+  ): Promise<PdfRedactStats & { cancelled: boolean }> {
+    const handle = this.requireHandle(docId);
+
+    const hasTerm = spec.terms?.some((t) => t.length > 0) ?? false;
+    const hasPattern = spec.patterns?.some((p) => p.length > 0) ?? false;
+    if (!hasTerm && !hasPattern) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        'Redaction needs at least one term or pattern',
+      );
+    }
+    if (spec.pages) {
+      for (const pageIndex of spec.pages) this.validatePageIndex(handle, pageIndex);
+    }
+
+    return this.runJob(docId, 'redact', () =>
+      this.addon.redactDocument(handle, spec, onProgress),
+    );
+  }
+
+  /**
+   * Replace every hit of `pattern` in the open document's text objects
+   * in one native pass.  Hits spanning text objects are left alone and
+   * counted as skipped.
+   */
+  async findReplace(
+    docId: string,
+    pattern: string,
+    replacement: string,
+    options: Omit<PdfFindReplacePayload, 'docId' | 'pattern' | 'replacement'>,
+    onProgress?: JobProgressCallback,
+  ): Promise<PdfFindReplaceResult> {
+    const handle = this.requireHandle(docId);
+    if (pattern.length === 0) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'Find pattern must not be empty');
+    }
+    if (options.pages) {
+      for (const pageIndex of options.pages) this.validatePageIndex(handle, pageIndex);
+    }
+
+    return this.runJob(docId, 'find-replace', () =>
+      this.addon.findReplace(handle, pattern, replacement, options, onProgress),
+    );
+  }
+
+  /**
+   * Fill `template` once per record and write each copy to the matching
+   * entry of `outputs`.  `owner` keys the job for `cancelJob` since no
+   * document is opened.
+   */
+  async mailMerge(
+    owner: string,
+    template: Uint8Array,
+    records: PdfMergeRecord[],
+    outputs: string[],
+    options: { flatten?: boolean; password?: string },
+    onProgress?: JobProgressCallback,
+  ): Promise<NativeMailMergeResult & { cancelled: boolean }> {
+    if (records.length !== outputs.length) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        'Every mail-merge record needs exactly one output path',
+      );
+    }
+
+    const buf = Buffer.from(template.buffer, template.byteOffset, template.byteLength);
+    return this.runJob(owner, 'mail-merge', () =>
+      this.addon.mailMerge(buf, records, outputs, options, onProgress),
+    );
+  }
+
+  /**
+   * Analyse PDF files on disk without opening them as documents.
+   * Progress counts files; `owner` keys progress and cancellation.
+   */
+  async analyzeFiles(
+    owner: string,
+    paths: string[],
+    options: { threads?: number; hashStreams?: boolean },
+    onProgress?: JobProgressCallback,
+  ): Promise<PdfAnalyzeResult> {
+    if (options.threads !== undefined && !(options.threads >= 1)) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'threads must be >= 1');
+    }
+
+    const startedAt = Date.now();
+    const result = await this.runJob(owner, 'analyze', () =>
+      this.addon.analyzeFiles(paths, options, onProgress),
+    );
+    return { ...result, elapsedMs: Date.now() - startedAt };
+  }
+
+  /**
+   * Write the images of the open document to `outDir` as .jpg, .jp2
+   * or .png files.  Progress counts pages.
+   */
+  async extractImages(
+    docId: string,
+    outDir: string,
+    options: { pages?: number[]; threads?: number },
+    onProgress?: JobProgressCallback,
+  ): Promise<PdfExtractImagesResult> {
+    const handle = this.requireHandle(docId);
+    if (options.threads !== undefined && !(options.threads >= 1)) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'threads must be >= 1');
+    }
+    if (options.pages) {
+      for (const pageIndex of options.pages) this.validatePageIndex(handle, pageIndex);
+    }
+
+    return this.runJob(docId, 'extract-images', () =>
+      this.addon.extractImages(handle, outDir, options, onProgress),
+    );
+  }
+
+  /**
+   * Compare two open documents page by page.  The job is keyed by
+   * `docIdA`; closing either document fails it.
+   */
+  async compareDocuments(
+    docIdA: string,
+    docIdB: string,
+    options: Omit<PdfCompareDocumentsPayload, 'docIdA' | 'docIdB'>,
+    onProgress?: CompareProgressCallback,
+  ): Promise<PdfCompareResult> {
+    const handleA = this.requireHandle(docIdA);
+    const handleB = this.requireHandle(docIdB);
+    if (options.dpi !== undefined && !(options.dpi > 0)) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'dpi must be > 0');
+    }
+    if (options.pairs) {
+      for (const [pageA, pageB] of options.pairs) {
+        if (pageA >= 0) this.validatePageIndex(handleA, pageA);
+        if (pageB >= 0) this.validatePageIndex(handleB, pageB);
+      }
+    }
+
+    return this.runJob(docIdA, 'compare', () =>
+      this.addon.compareDocuments(handleA, handleB, options, onProgress),
+    );
+  }
+
+  /**
+   * Render pages for OCR into `outDir`, which must exist.  Only pages
+   * that show images but hold no text are rendered unless `all` is set.
+   */
+  async renderOcrPages(
+    docId: string,
+    outDir: string,
+    options: { dpi?: number; pages?: number[]; all?: boolean },
+    onProgress?: OcrRenderProgressCallback,
+  ): Promise<NativeOcrRenderResult & { cancelled: boolean }> {
+    const handle = this.requireHandle(docId);
+    if (options.dpi !== undefined && !(options.dpi > 0)) {
+      throw new PdfiumError(PDFIUM_ERROR_CODES.INVALID_INPUT, 'dpi must be > 0');
+    }
+    if (options.pages) {
+      for (const pageIndex of options.pages) this.validatePageIndex(handle, pageIndex);
+    }
+
+    return this.runJob(docId, 'ocr', () =>
+      this.addon.renderOcrPages(handle, outDir, options, onProgress),
+    );
+  }
+
+  /** Write recognised words onto a page as invisible, searchable text. */
+  addTextLayer(
+    docId: string,
+    pageIndex: number,
+    layer: NativeTextLayer,
+    options: { font?: string } = {},
+  ): number {
+    const handle = this.requireHandle(docId);
+    this.validatePageIndex(handle, pageIndex);
+
+    try {
+      return this.addon.addTextLayer(handle, pageIndex, layer, options);
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.EDIT_FAILED,
+        `Text layer failed: ${(err as Error).message}`,
+      );
+    }
+  }
+
+  /** Cancel a running job.  Returns false if none was running. */
+  cancelJob(docId: string, kind: PdfJobKind): boolean {
+    const jobId = this.jobs.get(`${docId}:${kind}`);
+    return jobId !== undefined && this.addon.cancelJob(jobId);
+  }
+
   // ── Internal helpers ────────────────────────────────────────────
 
+  /** Start a native job, allowing one job of each kind per document. */
+  private async runJob<T>(
+    docId: string,
+    kind: PdfJobKind,
+    start: () => NativeJob<T>,
+  ): Promise<T & { cancelled: boolean }> {
+    const key = `${docId}:${kind}`;
+    if (this.jobs.has(key)) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.INVALID_INPUT,
+        `A ${kind} job is already running for this document`,
+      );
+    }
+
+    try {
+      const job = start();
+      this.jobs.set(key, job.jobId);
+      return await job.done;
+    } catch (err) {
+      throw new PdfiumError(
+        PDFIUM_ERROR_CODES.JOB_FAILED,
+        `${kind} failed: ${(err as Error).message}`,
+      );
+    } finally {
+      this.jobs.delete(key);
+    }
+  }
+
+  /** Ask every running job on a document to stop before it is closed. */
+  private cancelDocumentJobs(docId: string): void {
+    for (const [key, jobId] of this.jobs.entries()) {
+      if (key.startsWith(docId + ':')) this.addon.cancelJob(jobId);
+    }
+  }
+
+
   private requireHandle(docId: string): number {
     const handle = this.handles.get(docId);
     if (handle === undefined) {
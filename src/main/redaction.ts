@@ -0,0 +1,223 @@
+/**
+ * Resumable bulk redaction.
+ *
+ * Runs the native redaction pass over a document in chunks of
+ * REDACTION_CHECKPOINT_PAGES.  After each chunk the partly redacted
+ * document is streamed to `<outputPath>.partial` and a checkpoint
+ * (`<outputPath>.redact-checkpoint.json`) records where to continue, so
+ * a crash or cancel on page 9,000 of 10,000 loses at most one chunk.
+ *
+ * Re-running a chunk is harmless: redacted text is gone from the page,
+ * so the second visit finds nothing to match.
+ */
+
+import * as fs from 'node:fs/promises';
+import type {
+  PdfRedactSpec,
+  PdfRedactStats,
+  PdfRedactResult,
+} from '../shared/ipc-schema';
+import { REDACTION_CHECKPOINT_PAGES } from '../shared/constants';
+import { PdfiumEngine, PdfiumError, PDFIUM_ERROR_CODES } from './pdfium';
+
+const CHECKPOINT_VERSION = 1;
+
+/** Progress over the whole run, with throughput. */
+export type RedactionProgressCallback = (
+  done: number,
+  total: number,
+  pagesPerSecond: number,
+) => void;
+
+interface RedactionCheckpoint {
+  version: number;
+  outputPath: string;
+  spec: Omit<PdfRedactSpec, 'pages'>;
+  /** Every page the run will visit, in order. */
+  pages: number[];
+  /** Index into `pages` of the first page not yet redacted. */
+  next: number;
+  stats: PdfRedactStats;
+  elapsedMs: number;
+}
+
+/**
+ * Cancel hooks of running passes, keyed as their progress is: by docId,
+ * or by outputPath for a resumed run, whose document is private.
+ */
+const activeRedactions = new Map<string, () => void>();
+
+function partialPathFor(outputPath: string): string {
+  return `${outputPath}.partial`;
+}
+
+function checkpointPathFor(outputPath: string): string {
+  return `${outputPath}.redact-checkpoint.json`;
+}
+
+/**
+ * Redact an open document and write the result to `outputPath`.
+ * The open document is modified in place.
+ */
+export async function runRedaction(
+  engine: PdfiumEngine,
+  docId: string,
+  spec: PdfRedactSpec,
+  outputPath: string,
+  onProgress?: RedactionProgressCallback,
+): Promise<PdfRedactResult> {
+  const { pages, ...rest } = spec;
+  const pageCount = engine.getPageCount(docId);
+  const checkpoint: RedactionCheckpoint = {
+    version: CHECKPOINT_VERSION,
+    outputPath,
+    spec: rest,
+    pages: pages ?? Array.from({ length: pageCount }, (_, i) => i),
+    next: 0,
+    stats: {
+      matches: 0, textObjectsRemoved: 0, imagesClipped: 0, unremovedChars: 0, skipped: 0,
+      pages: [],
+    },
+    elapsedMs: 0,
+  };
+  return continueRedaction(engine, docId, docId, checkpoint, onProgress);
+}
+
+/**
+ * Continue an interrupted run from the checkpoint beside `outputPath`.
+ * The partial output is opened as a fresh document and closed again
+ * when the run ends; cancel it with `cancelRedaction(outputPath)`.
+ */
+export async function resumeRedaction(
+  engine: PdfiumEngine,
+  outputPath: string,
+  onProgress?: RedactionProgressCallback,
+): Promise<PdfRedactResult> {
+  let checkpoint: RedactionCheckpoint;
+  try {
+    const raw = await fs.readFile(checkpointPathFor(outputPath), 'utf8');
+    checkpoint = JSON.parse(raw) as RedactionCheckpoint;
+  } catch (err) {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.INVALID_INPUT,
+      `No redaction checkpoint for ${outputPath}: ${(err as Error).message}`,
+    );
+  }
+  if (checkpoint.version !== CHECKPOINT_VERSION) {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.INVALID_INPUT,
+      `Unsupported redaction checkpoint version ${checkpoint.version}`,
+    );
+  }
+
+  const data = await fs.readFile(partialPathFor(outputPath));
+  const { docId } = engine.open(data);
+  try {
+    return await continueRedaction(engine, outputPath, docId, checkpoint, onProgress);
+  } finally {
+    engine.close(docId);
+  }
+}
+
+async function continueRedaction(
+  engine: PdfiumEngine,
+  key: string,
+  docId: string,
+  checkpoint: RedactionCheckpoint,
+  onProgress?: RedactionProgressCallback,
+): Promise<PdfRedactResult> {
+  if (activeRedactions.has(key)) {
+    throw new PdfiumError(
+      PDFIUM_ERROR_CODES.INVALID_INPUT,
+      'A redaction is already running for this document',
+    );
+  }
+  const { outputPath, pages, stats } = checkpoint;
+  const total = pages.length;
+  const startedAt = Date.now();
+  const priorMs = checkpoint.elapsedMs;
+  const priorDone = checkpoint.next;
+
+  const rate = (done: number): number => {
+    const ms = Date.now() - startedAt;
+    return ms > 0 ? ((done - priorDone) * 1000) / ms : 0;
+  };
+
+  // Set by cancelRedaction, which may land between chunks as well as
+  // during one.
+  let cancelRequested = false;
+  activeRedactions.set(key, () => {
+    cancelRequested = true;
+    engine.cancelJob(docId, 'redact');
+  });
+
+  let cancelled = false;
+  try {
+    while (checkpoint.next < total && !cancelled) {
+      if (cancelRequested) {
+        cancelled = true;
+        break;
+      }
+      const chunkStart = checkpoint.next;
+      const chunk = pages.slice(chunkStart, chunkStart + REDACTION_CHECKPOINT_PAGES);
+
+      const result = await engine.redactDocument(
+        docId,
+        { ...checkpoint.spec, pages: chunk },
+        (done) => onProgress?.(chunkStart + done, total, rate(chunkStart + done)),
+      );
+
+      stats.matches += result.matches;
+      stats.textObjectsRemoved += result.textObjectsRemoved;
+      stats.imagesClipped += result.imagesClipped;
+      stats.unremovedChars += result.unremovedChars;
+      // Checkpoints written before `skipped` existed lack it.
+      stats.skipped = (stats.skipped ?? 0) + result.skipped;
+      stats.pages.push(...result.pages);
+
+      // A cancelled chunk is re-run from its start on resume.
+      cancelled = result.cancelled;
+      if (!cancelled) checkpoint.next = chunkStart + chunk.length;
+      checkpoint.elapsedMs = priorMs + (Date.now() - startedAt);
+
+      engine.saveToFile(docId, partialPathFor(outputPath));
+      await writeCheckpoint(checkpoint);
+    }
+  } finally {
+    activeRedactions.delete(key);
+  }
+
+  if (!cancelled) {
+    await fs.rename(partialPathFor(outputPath), outputPath);
+    await fs.rm(checkpointPathFor(outputPath), { force: true });
+  }
+
+  const elapsedMs = priorMs + (Date.now() - startedAt);
+  return {
+    ...stats,
+    ...(cancelled ? {} : { outputPath }),
+    pagesProcessed: checkpoint.next,
+    elapsedMs,
+    pagesPerSecond: elapsedMs > 0 ? (checkpoint.next * 1000) / elapsedMs : 0,
+    cancelled,
+  };
+}
+
+/** Write via a temp file and rename, so a crash never leaves half a checkpoint. */
+async function writeCheckpoint(checkpoint: RedactionCheckpoint): Promise<void> {
+  const target = checkpointPathFor(checkpoint.outputPath);
+  const tmp = `${target}.tmp`;
+  await fs.writeFile(tmp, JSON.stringify(checkpoint));
+  await fs.rename(tmp, target);
+}
+
+/**
+ * Stop a running redaction, keyed by docId or, for a resumed run, by
+ * its outputPath.  Returns false if none was running.
+ */
+export function cancelRedaction(key: string): boolean {
+  const cancel = activeRedactions.get(key);
+  if (!cancel) return false;
+  cancel();
+  return true;
+}
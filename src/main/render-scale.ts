@@ -0,0 +1,20 @@
+/**
+ * Render-scale quantisation, kept free of Electron so it can be tested
+ * on its own.
+ */
+
+import { RENDER_SCALE_BUCKETS } from '../shared/constants';
+
+/**
+ * The scale a view renders at: the first bucket not below zoom × device
+ * pixel ratio, so the compositor only ever shrinks the raster, by at
+ * most one bucket step.  Past the last bucket the scale is kept, rounded
+ * up to 1/64 so keys still repeat.
+ */
+export function quantiseScale(zoom: number, devicePixelRatio = 1): number {
+  const exact = zoom * devicePixelRatio;
+  if (!(exact > 0)) return exact; // let the engine reject it
+  // Allow for float noise, e.g. 1.1 × 1.25, so exact products stay put.
+  const bucket = RENDER_SCALE_BUCKETS.find((b) => b >= exact * (1 - 1e-6));
+  return bucket ?? Math.ceil(exact * 64) / 64;
+}
@@ -0,0 +1,176 @@
+/**
+ * Pool of PDFium worker processes for batch jobs.
+ *
+ * PDFium is not thread-safe and the addon serialises every call behind
+ * one lock, so batch throughput scales with processes, not threads.
+ * Each worker is an Electron utility process with its own copy of the
+ * addon (pdf-worker.ts).  Workers are spawned on demand and stay alive
+ * for the next task until the pool is disposed.
+ */
+
+import * as os from 'node:os';
+import * as path from 'node:path';
+import { utilityProcess, type UtilityProcess } from 'electron';
+import type { PdfMergeRecord, PdfMacro } from '../shared/ipc-schema';
+import { MAX_PDF_WORKERS } from '../shared/constants';
+
+// ── Worker protocol ─────────────────────────────────────────────────
+
+/** Fill one batch of mail-merge records. */
+export interface MailMergeTask {
+  kind: 'mail-merge';
+  templatePath: string;
+  records: PdfMergeRecord[];
+  outputs: string[];
+  flatten?: boolean;
+  password?: string;
+}
+
+/** Replay a macro on a batch of files, one at a time. */
+export interface MacroReplayTask {
+  kind: 'macro-replay';
+  macro: PdfMacro;
+  files: Array<{ input: string; output: string }>;
+}
+
+export type WorkerTask = MailMergeTask | MacroReplayTask;
+
+/** Parent → worker. */
+export type WorkerRequest =
+  | { type: 'run'; taskId: number; task: WorkerTask }
+  | { type: 'cancel'; taskId: number };
+
+/** Worker → parent. */
+export type WorkerReply =
+  | { type: 'progress'; taskId: number; done: number; total: number }
+  | { type: 'result'; taskId: number; result: unknown }
+  | { type: 'error'; taskId: number; message: string };
+
+/** Rejection reason for tasks dropped from the queue by `cancel`. */
+export class TaskCancelledError extends Error {
+  constructor() {
+    super('Task cancelled before it started');
+    this.name = 'TaskCancelledError';
+  }
+}
+
+// ── Pool ────────────────────────────────────────────────────────────
+
+const WORKER_SCRIPT = path.join(__dirname, 'pdf-worker.js');
+
+interface PendingTask {
+  taskId: number;
+  task: WorkerTask;
+  resolve: (result: unknown) => void;
+  reject: (err: Error) => void;
+  onProgress?: (done: number, total: number) => void;
+}
+
+interface PoolWorker {
+  proc: UtilityProcess;
+  current: PendingTask | null;
+}
+
+export class PdfWorkerPool {
+  private readonly workers: PoolWorker[] = [];
+  private readonly queue: PendingTask[] = [];
+  private nextTaskId = 1;
+
+  /**
+   * @param addonPath location of pdfium.node, passed to each worker
+   * @param size      maximum concurrent workers
+   */
+  constructor(
+    private readonly addonPath: string,
+    private readonly size = Math.max(1, Math.min(MAX_PDF_WORKERS, os.availableParallelism() - 1)),
+  ) {}
+
+  /** Queue a task on the next free worker. */
+  run<T>(
+    task: WorkerTask,
+    onProgress?: (done: number, total: number) => void,
+  ): { taskId: number; done: Promise<T> } {
+    const taskId = this.nextTaskId++;
+    const done = new Promise<T>((resolve, reject) => {
+      this.queue.push({
+        taskId, task, onProgress, reject,
+        resolve: resolve as (result: unknown) => void,
+      });
+    });
+    this.dispatch();
+    return { taskId, done };
+  }
+
+  /**
+   * Cancel a task.  Queued tasks reject with TaskCancelledError; running
+   * ones are asked to stop and resolve with their partial result.
+   */
+  cancel(taskId: number): void {
+    const queued = this.queue.findIndex((t) => t.taskId === taskId);
+    if (queued >= 0) {
+      const [task] = this.queue.splice(queued, 1);
+      task.reject(new TaskCancelledError());
+      return;
+    }
+    const worker = this.workers.find((w) => w.current?.taskId === taskId);
+    worker?.proc.postMessage({ type: 'cancel', taskId } satisfies WorkerRequest);
+  }
+
+  /** Kill every worker and fail outstanding tasks. */
+  dispose(): void {
+    for (const task of this.queue.splice(0)) task.reject(new TaskCancelledError());
+    for (const worker of this.workers.splice(0)) {
+      worker.current?.reject(new Error('Worker pool disposed'));
+      worker.current = null;
+      worker.proc.kill();
+    }
+  }
+
+  private dispatch(): void {
+    while (this.queue.length > 0) {
+      let worker = this.workers.find((w) => w.current === null);
+      if (!worker) {
+        if (this.workers.length >= this.size) return;
+        worker = this.spawn();
+      }
+      const task = this.queue.shift()!;
+      worker.current = task;
+      worker.proc.postMessage(
+        { type: 'run', taskId: task.taskId, task: task.task } satisfies WorkerRequest,
+      );
+    }
+  }
+
+  private spawn(): PoolWorker {
+    const proc = utilityProcess.fork(WORKER_SCRIPT, [], {
+      serviceName: 'PDF worker',
+      env: { ...process.env, PDFIUM_ADDON_PATH: this.addonPath },
+    });
+    const worker: PoolWorker = { proc, current: null };
+
+    proc.on('message', (reply: WorkerReply) => {
+      const task = worker.current;
+      if (!task || task.taskId !== reply.taskId) return;
+
+      if (reply.type === 'progress') {
+        task.onProgress?.(reply.done, reply.total);
+        return;
+      }
+      worker.current = null;
+      if (reply.type === 'result') task.resolve(reply.result);
+      else task.reject(new Error(reply.message));
+      this.dispatch();
+    });
+
+    proc.on('exit', (code) => {
+      const idx = this.workers.indexOf(worker);
+      if (idx >= 0) this.workers.splice(idx, 1);
+      worker.current?.reject(new Error(`PDF worker exited with code ${code}`));
+      worker.current = null;
+      this.dispatch();
+    });
+
+    this.workers.push(worker);
+    return worker;
+  }
+}
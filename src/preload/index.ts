@@ -17,11 +17,71 @@ import {
   type PdfRenderPagePayload,
   type PdfRenderResult,
   type PdfListObjectsPayload,
+  type PdfCharGeometryPayload,
+  type PdfCharGeometry,
   type PageObject,
   type PdfEditTextPayload,
+  type PdfLoadFontPayload,
+  type PdfLoadFontResult,
+  type PdfMeasureTextPayload,
+  type PdfTextMetrics,
   type PdfReplaceImagePayload,
+  type PdfImagePreviewPayload,
+  type PdfImagePreview,
+  type PdfTransformObjectPayload,
+  type PdfDragBeginPayload,
+  type PdfDragBeginResult,
+  type PdfDragPreviewPayload,
+  type PdfDragPreviewResult,
+  type PdfMatrix,
+  type PdfInkBeginPayload,
+  type PdfInkAppendPayload,
+  type PdfInkPatch,
+  type PdfInkStroke,
+  type PdfAddInkPayload,
+  type PdfRemoveAnnotationPayload,
+  type PdfOutlineChildrenPayload,
+  type PdfOutlineBatch,
+  type PdfThumbnailsPayload,
+  type PdfThumbnailBatch,
+  type PdfBuildThumbnailsPayload,
+  type PdfBuildThumbnailsResult,
+  type PdfListAnnotationsPayload,
+  type PdfAnnotationColumns,
+  type PdfUpdateAnnotationsPayload,
+  type PdfUpdateAnnotationsResult,
   type PdfSavePayload,
   type PdfSaveResult,
+  type PdfSignPreparePayload,
+  type PdfSignPrepareResult,
+  type PdfSignEmbedPayload,
+  type PdfFlattenPayload,
+  type PdfFlattenResult,
+  type PdfRasterizePayload,
+  type PdfRasterizeResult,
+  type PdfCancelJobPayload,
+  type PdfJobProgressPayload,
+  type PdfRedactPayload,
+  type PdfRedactResumePayload,
+  type PdfRedactResult,
+  type PdfFindReplacePayload,
+  type PdfFindReplaceResult,
+  type PdfMailMergePayload,
+  type PdfMailMergeResult,
+  type PdfAnalyzePayload,
+  type PdfAnalyzeResult,
+  type PdfExtractImagesPayload,
+  type PdfExtractImagesResult,
+  type PdfPrefetchImagePreviewsPayload,
+  type PdfPrefetchImagePreviewsResult,
+  type PdfCompareDocumentsPayload,
+  type PdfComparePageEvent,
+  type PdfCompareResult,
+  type PdfOcrPayload,
+  type PdfOcrResult,
+  type PdfMacro,
+  type PdfMacroReplayPayload,
+  type PdfMacroReplayResult,
 } from '../shared/ipc-schema';
 
 /**
@@ -97,21 +157,148 @@ const api = {
     getPageCount: (docId: string): Promise<number> =>
       ipcRenderer.invoke(IPC_CHANNELS.PDF_GET_PAGE_COUNT, docId),
 
+    outlineChildren: (payload: PdfOutlineChildrenPayload): Promise<PdfOutlineBatch> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_OUTLINE_CHILDREN, payload),
+
+    thumbnails: (payload: PdfThumbnailsPayload): Promise<PdfThumbnailBatch> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_THUMBNAILS, payload),
+
     renderPage: (payload: PdfRenderPagePayload): Promise<PdfRenderResult> =>
       ipcRenderer.invoke(IPC_CHANNELS.PDF_RENDER_PAGE, payload),
 
     listObjects: (payload: PdfListObjectsPayload): Promise<PageObject[]> =>
       ipcRenderer.invoke(IPC_CHANNELS.PDF_LIST_OBJECTS, payload),
 
+    charGeometry: (payload: PdfCharGeometryPayload): Promise<PdfCharGeometry> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_CHAR_GEOMETRY, payload),
+
     editText: (payload: PdfEditTextPayload): Promise<{ ok: true }> =>
       ipcRenderer.invoke(IPC_CHANNELS.PDF_EDIT_TEXT, payload),
 
+    loadFont: (payload: PdfLoadFontPayload): Promise<PdfLoadFontResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_LOAD_FONT, payload),
+
+    measureText: (payload: PdfMeasureTextPayload): Promise<PdfTextMetrics> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_MEASURE_TEXT, payload),
+
     replaceImage: (payload: PdfReplaceImagePayload): Promise<{ ok: true }> =>
       ipcRenderer.invoke(IPC_CHANNELS.PDF_REPLACE_IMAGE, payload),
 
+    imagePreview: (payload: PdfImagePreviewPayload): Promise<PdfImagePreview> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_IMAGE_PREVIEW, payload),
+
+    transformObject: (payload: PdfTransformObjectPayload): Promise<{ ok: true }> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_TRANSFORM_OBJECT, payload),
+
+    dragBegin: (payload: PdfDragBeginPayload): Promise<PdfDragBeginResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_DRAG_BEGIN, payload),
+
+    dragPreview: (payload: PdfDragPreviewPayload): Promise<PdfDragPreviewResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_DRAG_PREVIEW, payload),
+
+    dragEnd: (sessionId: number): Promise<PdfMatrix | null> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_DRAG_END, sessionId),
+
+    inkBegin: (payload: PdfInkBeginPayload): Promise<number> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_INK_BEGIN, payload),
+
+    inkAppend: (payload: PdfInkAppendPayload): Promise<PdfInkPatch> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_INK_APPEND, payload),
+
+    inkEnd: (sessionId: number): Promise<PdfInkStroke | null> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_INK_END, sessionId),
+
+    addInk: (payload: PdfAddInkPayload): Promise<number> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_ADD_INK, payload),
+
+    removeAnnotation: (payload: PdfRemoveAnnotationPayload): Promise<{ ok: true }> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_REMOVE_ANNOTATION, payload),
+
+    listAnnotations: (payload: PdfListAnnotationsPayload): Promise<PdfAnnotationColumns> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_LIST_ANNOTATIONS, payload),
+
+    updateAnnotations: (
+      payload: PdfUpdateAnnotationsPayload,
+    ): Promise<PdfUpdateAnnotationsResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_UPDATE_ANNOTATIONS, payload),
+
     save: (payload: PdfSavePayload): Promise<PdfSaveResult> =>
       ipcRenderer.invoke(IPC_CHANNELS.PDF_SAVE, payload),
 
+    signPrepare: (payload: PdfSignPreparePayload): Promise<PdfSignPrepareResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_SIGN_PREPARE, payload),
+
+    signEmbed: (payload: PdfSignEmbedPayload): Promise<void> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_SIGN_EMBED, payload),
+
+    macroStart: (docId: string): Promise<void> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_MACRO_START, docId),
+
+    macroStop: (docId: string): Promise<PdfMacro> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_MACRO_STOP, docId),
+
+    macroReplay: (payload: PdfMacroReplayPayload): Promise<PdfMacroReplayResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_MACRO_REPLAY, payload),
+
+    flatten: (payload: PdfFlattenPayload): Promise<PdfFlattenResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_FLATTEN, payload),
+
+    rasterize: (payload: PdfRasterizePayload): Promise<PdfRasterizeResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_RASTERIZE, payload),
+
+    redact: (payload: PdfRedactPayload): Promise<PdfRedactResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_REDACT, payload),
+
+    resumeRedact: (payload: PdfRedactResumePayload): Promise<PdfRedactResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_REDACT_RESUME, payload),
+
+    findReplace: (payload: PdfFindReplacePayload): Promise<PdfFindReplaceResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_FIND_REPLACE, payload),
+
+    mailMerge: (payload: PdfMailMergePayload): Promise<PdfMailMergeResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_MAIL_MERGE, payload),
+
+    analyzeFiles: (payload: PdfAnalyzePayload): Promise<PdfAnalyzeResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_ANALYZE, payload),
+
+    extractImages: (payload: PdfExtractImagesPayload): Promise<PdfExtractImagesResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_EXTRACT_IMAGES, payload),
+
+    buildThumbnails: (payload: PdfBuildThumbnailsPayload): Promise<PdfBuildThumbnailsResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_BUILD_THUMBNAILS, payload),
+
+    prefetchImagePreviews: (
+      payload: PdfPrefetchImagePreviewsPayload,
+    ): Promise<PdfPrefetchImagePreviewsResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_PREFETCH_IMAGE_PREVIEWS, payload),
+
+    compareDocuments: (payload: PdfCompareDocumentsPayload): Promise<PdfCompareResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_COMPARE_DOCUMENTS, payload),
+
+    ocr: (payload: PdfOcrPayload): Promise<PdfOcrResult> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_OCR, payload),
+
+    cancelJob: (payload: PdfCancelJobPayload): Promise<boolean> =>
+      ipcRenderer.invoke(IPC_CHANNELS.PDF_CANCEL_JOB, payload),
+
+    /** Subscribe to progress events from background jobs. */
+    onJobProgress: (callback: (payload: PdfJobProgressPayload) => void): (() => void) => {
+      const handler = (_event: Electron.IpcRendererEvent, payload: PdfJobProgressPayload): void => {
+        callback(payload);
+      };
+      ipcRenderer.on(IPC_CHANNELS.PDF_JOB_PROGRESS, handler);
+      return () => ipcRenderer.removeListener(IPC_CHANNELS.PDF_JOB_PROGRESS, handler);
+    },
+
+    /** Subscribe to compared pages as compareDocuments finishes them. */
+    onComparePage: (callback: (payload: PdfComparePageEvent) => void): (() => void) => {
+      const handler = (_event: Electron.IpcRendererEvent, payload: PdfComparePageEvent): void => {
+        callback(payload);
+      };
+      ipcRenderer.on(IPC_CHANNELS.PDF_COMPARE_PAGE, handler);
+      return () => ipcRenderer.removeListener(IPC_CHANNELS.PDF_COMPARE_PAGE, handler);
+    },
+
     /** Subscribe to page-rendered events from main. */
     onPageRendered: (callback: (payload: { docId: string; pageIndex: number }) => void): (() => void) => {
       const handler = (_event: Electron.IpcRendererEvent, payload: { docId: string; pageIndex: number }): void => {
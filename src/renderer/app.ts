@@ -6,8 +6,12 @@
  *
  * Implements:
  *   - PDF open via PDFium engine (canvas rendering)
- *   - Zoom / pan / page navigation
+ *   - Zoom / pan / page navigation / view rotation
+ *   - Lazily expanded outline (bookmarks) sidebar
  *   - Object selection & hit-testing
+ *   - Text selection from batched char geometry
+ *   - Object move / resize with layered drag previews
+ *   - Freehand ink annotations
  *   - In-place text editing
  *   - Image replacement
  *   - Undo / redo command stack
@@ -20,6 +24,22 @@ const MAX_ZOOM_PERCENT = 500;
 const DEFAULT_ZOOM_PERCENT = 100;
 const ZOOM_STEP_PERCENT = 25;
 const MAX_UNDO_DEPTH = 100;
+/** Pointer travel (CSS px) before a press on an object becomes a drag. */
+const DRAG_THRESHOLD_PX = 3;
+/** Half-size of the selection handles drawn at each corner. */
+const HANDLE_SIZE = 6;
+/** Outline rows fetched per request (mirrors PdfOutlineChildrenPayload). */
+const OUTLINE_BATCH = 512;
+/** PDF_OUTLINE_FLAGS bits. */
+const OUTLINE_HAS_CHILDREN = 1;
+const OUTLINE_OPEN = 2;
+const OUTLINE_EXTERNAL = 4;
+/** Thumbnail box (CSS px) and the height of each row in the strip. */
+const THUMB_MAX_WIDTH = 160;
+const THUMB_MAX_HEIGHT = 200;
+const THUMB_ROW_HEIGHT = 232;
+/** Rows kept laid out above and below the visible ones. */
+const THUMB_OVERSCAN = 3;
 
 // ── DOM references ──────────────────────────────────────────────────
 const btnOpen = document.getElementById('btn-open') as HTMLButtonElement;
@@ -41,6 +61,8 @@ const overlayCanvas = document.getElementById('overlay-canvas') as HTMLCanvasEle
 const btnZoomIn = document.getElementById('btn-zoom-in') as HTMLButtonElement;
 const btnZoomOut = document.getElementById('btn-zoom-out') as HTMLButtonElement;
 const btnZoomFit = document.getElementById('btn-zoom-fit') as HTMLButtonElement;
+const btnRotateLeft = document.getElementById('btn-rotate-left') as HTMLButtonElement;
+const btnRotateRight = document.getElementById('btn-rotate-right') as HTMLButtonElement;
 const zoomLevelEl = document.getElementById('zoom-level') as HTMLSpanElement;
 
 // Page navigation
@@ -51,17 +73,29 @@ const pageTotalEl = document.getElementById('page-total') as HTMLSpanElement;
 
 // Editing tools
 const btnToolSelect = document.getElementById('btn-tool-select') as HTMLButtonElement;
+const btnToolSelectText = document.getElementById('btn-tool-select-text') as HTMLButtonElement;
 const btnToolEditText = document.getElementById('btn-tool-edit-text') as HTMLButtonElement;
 const btnToolReplaceImage = document.getElementById('btn-tool-replace-image') as HTMLButtonElement;
+const btnToolInk = document.getElementById('btn-tool-ink') as HTMLButtonElement;
 const btnUndo = document.getElementById('btn-undo') as HTMLButtonElement;
 const btnRedo = document.getElementById('btn-redo') as HTMLButtonElement;
 
+// Document tools
+const btnToggleAnnotations = document.getElementById('btn-toggle-annotations') as HTMLButtonElement;
+const viewFilterSelect = document.getElementById('view-filter') as HTMLSelectElement;
+const btnFlatten = document.getElementById('btn-flatten') as HTMLButtonElement;
+const btnRasterize = document.getElementById('btn-rasterize') as HTMLButtonElement;
+const btnOcr = document.getElementById('btn-ocr') as HTMLButtonElement;
+
 // Thumbnails panel
 const thumbnailsPanel = document.getElementById('thumbnails-panel') as HTMLElement;
 
+// Outline panel
+const outlinePanel = document.getElementById('outline-panel') as HTMLElement;
+
 // ── State ───────────────────────────────────────────────────────────
 
-type ToolMode = 'select' | 'edit-text' | 'replace-image';
+type ToolMode = 'select' | 'select-text' | 'edit-text' | 'replace-image' | 'ink';
 
 interface AppState {
   filePath: string | null;
@@ -70,10 +104,20 @@ interface AppState {
   pageCount: number;
   currentPage: number;     // 0-based
   zoomPercent: number;
+  /**
+   * Scale the page raster was drawn at, in device pixels per point: a
+   * bucket at or above zoom × devicePixelRatio, shown shrunk to the zoom.
+   */
+  renderScale: number;
+  /** Clockwise view rotation; the document itself is not rotated. */
+  rotation: PdfViewRotation;
   modified: boolean;
   toolMode: ToolMode;
   pageObjects: PageObject[];
   selectedObjectId: number | null;
+  showAnnotations: boolean;
+  /** Reading mode; filters the cached raster, the document is untouched. */
+  viewFilter: PdfViewFilter;
 }
 
 const state: AppState = {
@@ -83,10 +127,14 @@ const state: AppState = {
   pageCount: 0,
   currentPage: 0,
   zoomPercent: DEFAULT_ZOOM_PERCENT,
+  renderScale: 1,
+  rotation: 0,
   modified: false,
   toolMode: 'select',
   pageObjects: [],
   selectedObjectId: null,
+  showAnnotations: true,
+  viewFilter: 'none',
 };
 
 // ── Undo / Redo ─────────────────────────────────────────────────────
@@ -162,6 +210,10 @@ async function init(): Promise<void> {
   btnZoomOut.addEventListener('click', () => setZoom(state.zoomPercent - ZOOM_STEP_PERCENT));
   btnZoomFit.addEventListener('click', handleZoomFit);
 
+  // Rotation
+  btnRotateLeft.addEventListener('click', () => rotateView(-90));
+  btnRotateRight.addEventListener('click', () => rotateView(90));
+
   // Page navigation
   btnPrevPage.addEventListener('click', () => goToPage(state.currentPage - 1));
   btnNextPage.addEventListener('click', () => goToPage(state.currentPage + 1));
@@ -172,14 +224,46 @@ async function init(): Promise<void> {
 
   // Editing tools
   btnToolSelect.addEventListener('click', () => setToolMode('select'));
+  btnToolSelectText.addEventListener('click', () => setToolMode('select-text'));
   btnToolEditText.addEventListener('click', () => setToolMode('edit-text'));
   btnToolReplaceImage.addEventListener('click', () => setToolMode('replace-image'));
+  btnToolInk.addEventListener('click', () => setToolMode('ink'));
   btnUndo.addEventListener('click', () => undoStack.undo());
   btnRedo.addEventListener('click', () => undoStack.redo());
 
+  // Document tools
+  btnToggleAnnotations.addEventListener('click', () => {
+    // Only recomposites in main: both layers stay cached.
+    state.showAnnotations = !state.showAnnotations;
+    btnToggleAnnotations.classList.toggle('active', state.showAnnotations);
+    renderCurrentPage();
+  });
+  viewFilterSelect.addEventListener('change', () => {
+    // A pass over the cached raster in main, never a re-render.
+    state.viewFilter = viewFilterSelect.value as PdfViewFilter;
+    renderCurrentPage();
+  });
+  btnFlatten.addEventListener('click', handleFlatten);
+  btnRasterize.addEventListener('click', handleRasterize);
+  btnOcr.addEventListener('click', handleOcr);
+
+  // Thumbnail strip
+  thumbnailsPanel.addEventListener('scroll', scheduleThumbnailLayout, { passive: true });
+  window.addEventListener('resize', scheduleThumbnailLayout);
+  watchDevicePixelRatio();
+
   // Canvas click for object selection
   overlayCanvas.addEventListener('click', handleCanvasClick);
   overlayCanvas.addEventListener('dblclick', handleCanvasDblClick);
+  overlayCanvas.addEventListener('mousedown', handleDragStart);
+  window.addEventListener('mousemove', handleDragMove);
+  window.addEventListener('mouseup', handleDragEnd);
+  overlayCanvas.addEventListener('mousedown', handleTextSelectStart);
+  window.addEventListener('mousemove', handleTextSelectMove);
+  window.addEventListener('mouseup', () => { selectingText = false; });
+  overlayCanvas.addEventListener('pointerdown', handleInkStart);
+  window.addEventListener('pointermove', handleInkMove);
+  window.addEventListener('pointerup', handleInkEnd);
 
   // Wire drag-and-drop
   viewerContainer.addEventListener('dragover', (e) => {
@@ -230,6 +314,7 @@ async function handleOpen(): Promise<void> {
     state.docId = pdfResult.docId;
     state.pageCount = pdfResult.pageCount;
     state.currentPage = 0;
+    state.rotation = 0;
     state.modified = false;
     state.selectedObjectId = null;
     state.pageObjects = [];
@@ -253,6 +338,7 @@ async function handleOpen(): Promise<void> {
   updateZoomInfo();
   updateDirtyIndicator();
   await renderCurrentPage();
+  void buildOutline();
   await buildThumbnails();
 
   setStatus(`Opened: ${fileName} (${state.pageCount} page${state.pageCount !== 1 ? 's' : ''})`);
@@ -324,6 +410,7 @@ async function handleDrop(e: DragEvent): Promise<void> {
     state.docId = pdfResult.docId;
     state.pageCount = pdfResult.pageCount;
     state.currentPage = 0;
+    state.rotation = 0;
     state.modified = false;
     state.selectedObjectId = null;
     state.pageObjects = [];
@@ -344,6 +431,7 @@ async function handleDrop(e: DragEvent): Promise<void> {
   updateZoomInfo();
   updateDirtyIndicator();
   await renderCurrentPage();
+  void buildOutline();
   await buildThumbnails();
 
   setStatus(`Opened: ${file.name}`);
@@ -354,17 +442,22 @@ async function handleDrop(e: DragEvent): Promise<void> {
 async function renderCurrentPage(): Promise<void> {
   if (!state.docId) return;
 
-  const scale = state.zoomPercent / 100;
+  const zoom = state.zoomPercent / 100;
   try {
     const result = await window.api.pdf.renderPage({
       docId: state.docId,
       pageIndex: state.currentPage,
-      scale,
+      zoom,
+      devicePixelRatio: window.devicePixelRatio || 1,
+      annotations: state.showAnnotations,
+      rotation: state.rotation,
+      filter: state.viewFilter,
     });
 
     const ctx = pageCanvas.getContext('2d');
     if (!ctx) return;
 
+    state.renderScale = result.scale;
     pageCanvas.width = result.width;
     pageCanvas.height = result.height;
 
@@ -376,11 +469,22 @@ async function renderCurrentPage(): Promise<void> {
     );
     ctx.putImageData(imageData, 0, 0);
 
-    // Size overlay canvas to match
-    overlayCanvas.width = result.width;
-    overlayCanvas.height = result.height;
-    overlayCanvas.style.width = pageCanvas.style.width = `${result.width}px`;
-    overlayCanvas.style.height = pageCanvas.style.height = `${result.height}px`;
+    // The raster is at a scale bucket; the compositor shrinks it to the
+    // zoom, so the canvas is sized in CSS pixels at the logical zoom.
+    const cssWidth = Math.round((result.width * zoom) / result.scale);
+    const cssHeight = Math.round((result.height * zoom) / result.scale);
+    pageCanvas.style.width = `${cssWidth}px`;
+    pageCanvas.style.height = `${cssHeight}px`;
+
+    // The overlay stays in upright CSS pixels at the zoom, turned with the
+    // view by CSS, so selection drawing and hit-testing need no rotation
+    // or device-pixel maths.
+    const sideways = state.rotation % 180 !== 0;
+    overlayCanvas.width = sideways ? cssHeight : cssWidth;
+    overlayCanvas.height = sideways ? cssWidth : cssHeight;
+    overlayCanvas.style.width = `${overlayCanvas.width}px`;
+    overlayCanvas.style.height = `${overlayCanvas.height}px`;
+    overlayCanvas.style.transform = state.rotation ? `rotate(${state.rotation}deg)` : '';
 
     // Fetch objects for this page
     await loadPageObjects();
@@ -392,6 +496,19 @@ async function renderCurrentPage(): Promise<void> {
   }
 }
 
+/**
+ * Re-render when the window moves to a display of another pixel ratio
+ * (or the OS scale changes), so the page stays crisp.  The query only
+ * matches the current ratio, so it is re-armed on every change.
+ */
+function watchDevicePixelRatio(): void {
+  const query = window.matchMedia(`(resolution: ${window.devicePixelRatio}dppx)`);
+  query.addEventListener('change', () => {
+    watchDevicePixelRatio();
+    void renderCurrentPage();
+  }, { once: true });
+}
+
 async function loadPageObjects(): Promise<void> {
   if (!state.docId) return;
   try {
@@ -402,6 +519,23 @@ async function loadPageObjects(): Promise<void> {
   } catch {
     state.pageObjects = [];
   }
+  scheduleImagePrefetch();
+}
+
+/**
+ * Once the page is idle, decode previews of its images so selecting
+ * one shows the original at once.  The native job itself also yields
+ * the PDFium lock to renders and edits.
+ */
+function scheduleImagePrefetch(): void {
+  if (!state.docId || !state.pageObjects.some((o) => o.type === 'image')) return;
+  const docId = state.docId;
+  const pageIndex = state.currentPage;
+  requestIdleCallback(() => {
+    if (state.docId !== docId || state.currentPage !== pageIndex) return;
+    // A prefetch already running for this document is fine to skip.
+    window.api.pdf.prefetchImagePreviews({ docId, pages: [pageIndex] }).catch(() => {});
+  });
 }
 
 function drawSelectionOverlay(): void {
@@ -409,6 +543,7 @@ function drawSelectionOverlay(): void {
   if (!ctx) return;
 
   ctx.clearRect(0, 0, overlayCanvas.width, overlayCanvas.height);
+  drawTextSelection(ctx);
 
   if (state.selectedObjectId === null) return;
 
@@ -429,7 +564,6 @@ function drawSelectionOverlay(): void {
   ctx.strokeRect(x, y, w, h);
 
   // Draw corner handles
-  const HANDLE_SIZE = 6;
   ctx.fillStyle = '#0078d4';
   ctx.setLineDash([]);
   const corners = [
@@ -442,61 +576,298 @@ function drawSelectionOverlay(): void {
 }
 
 // ── Thumbnails ──────────────────────────────────────────────────────
+//
+// The strip is virtual: a spacer as tall as every row, and a small pool
+// of items moved to whichever rows are in view.  Thumbnails come from
+// main's memory-mapped PNG store, which a background job fills; rows on
+// screen are rendered on demand.  Only the images in the pool are ever
+// decoded, so memory does not grow with the page count.
+
+interface ThumbnailSlot {
+  item: HTMLDivElement;
+  image: HTMLImageElement;
+  label: HTMLSpanElement;
+  /** Page shown, or -1 while in the free pool. */
+  page: number;
+  /** Object URL of the PNG on display. */
+  url: string | null;
+}
+
+let thumbnailSpacer: HTMLDivElement | null = null;
+const thumbnailSlots: ThumbnailSlot[] = [];
+let thumbnailFrame = 0;
 
 async function buildThumbnails(): Promise<void> {
+  resetThumbnails();
   if (!state.docId) return;
+  const docId = state.docId;
 
-  thumbnailsPanel.innerHTML = '';
-  const THUMB_SCALE = 0.2;
+  thumbnailSpacer = document.createElement('div');
+  thumbnailSpacer.className = 'thumbnail-spacer';
+  thumbnailSpacer.style.height = `${state.pageCount * THUMB_ROW_HEIGHT}px`;
+  thumbnailsPanel.appendChild(thumbnailSpacer);
+  await layoutThumbnails();
 
-  for (let i = 0; i < state.pageCount; i++) {
-    const wrapper = document.createElement('div');
-    wrapper.className = 'thumbnail-item';
-    if (i === state.currentPage) wrapper.classList.add('active');
-    wrapper.dataset.page = String(i);
+  // Already running (e.g. rebuilt after flattening): that pass sees the
+  // new page versions too.
+  window.api.pdf.buildThumbnails({ docId, ...thumbnailSize() }).catch(() => undefined);
+}
 
-    const label = document.createElement('span');
-    label.className = 'thumbnail-label';
-    label.textContent = String(i + 1);
+function resetThumbnails(): void {
+  for (const slot of thumbnailSlots) {
+    if (slot.url) URL.revokeObjectURL(slot.url);
+  }
+  thumbnailSlots.length = 0;
+  thumbnailSpacer = null;
+  thumbnailsPanel.innerHTML = '';
+}
 
-    const canvas = document.createElement('canvas');
-    canvas.className = 'thumbnail-canvas';
+/** Thumbnail box in device pixels, so thumbnails stay sharp on HiDPI. */
+function thumbnailSize(): { maxWidth: number; maxHeight: number } {
+  const dpr = window.devicePixelRatio || 1;
+  return {
+    maxWidth: Math.round(THUMB_MAX_WIDTH * dpr),
+    maxHeight: Math.round(THUMB_MAX_HEIGHT * dpr),
+  };
+}
 
-    wrapper.appendChild(canvas);
-    wrapper.appendChild(label);
-    thumbnailsPanel.appendChild(wrapper);
+function scheduleThumbnailLayout(): void {
+  if (thumbnailFrame) return;
+  thumbnailFrame = requestAnimationFrame(() => {
+    thumbnailFrame = 0;
+    void layoutThumbnails();
+  });
+}
 
-    wrapper.addEventListener('click', () => goToPage(i));
+/** Move the pool onto the rows in view and fetch the images they lack. */
+async function layoutThumbnails(): Promise<void> {
+  const docId = state.docId;
+  if (!docId || !thumbnailSpacer) return;
+
+  const top = thumbnailsPanel.scrollTop;
+  const first = Math.max(0, Math.floor(top / THUMB_ROW_HEIGHT) - THUMB_OVERSCAN);
+  const end = Math.min(
+    state.pageCount,
+    Math.ceil((top + thumbnailsPanel.clientHeight) / THUMB_ROW_HEIGHT) + THUMB_OVERSCAN,
+  );
+
+  const shown = new Map<number, ThumbnailSlot>();
+  const free: ThumbnailSlot[] = [];
+  for (const slot of thumbnailSlots) {
+    if (slot.page >= first && slot.page < end) {
+      shown.set(slot.page, slot);
+    } else {
+      releaseThumbnailSlot(slot);
+      free.push(slot);
+    }
+  }
 
-    // Render thumbnail asynchronously
-    try {
-      const result = await window.api.pdf.renderPage({
-        docId: state.docId!,
-        pageIndex: i,
-        scale: THUMB_SCALE,
-      });
-      canvas.width = result.width;
-      canvas.height = result.height;
-      const ctx = canvas.getContext('2d');
-      if (ctx) {
-        const imgData = new ImageData(
-          new Uint8ClampedArray(result.image),
-          result.width,
-          result.height,
-        );
-        ctx.putImageData(imgData, 0, 0);
-      }
-    } catch {
-      // Thumbnail render failed — leave blank
+  let missingFirst = end;
+  let missingEnd = first;
+  for (let page = first; page < end; page++) {
+    let slot = shown.get(page);
+    if (!slot) {
+      slot = free.pop() ?? createThumbnailSlot();
+      slot.page = page;
+      slot.item.style.transform = `translateY(${page * THUMB_ROW_HEIGHT}px)`;
+      slot.item.classList.toggle('active', page === state.currentPage);
+      slot.label.textContent = String(page + 1);
+      slot.item.hidden = false;
+    }
+    if (!slot.url) {
+      missingFirst = Math.min(missingFirst, page);
+      missingEnd = page + 1;
     }
   }
+  if (missingFirst >= missingEnd) return;
+
+  let batch: PdfThumbnailBatch;
+  try {
+    batch = await window.api.pdf.thumbnails({
+      docId,
+      first: missingFirst,
+      count: missingEnd - missingFirst,
+      render: true,
+      ...thumbnailSize(),
+    });
+  } catch {
+    return; // Thumbnail render failed — leave blank
+  }
+  if (state.docId !== docId) return;
+
+  const dpr = window.devicePixelRatio || 1;
+  for (const slot of thumbnailSlots) {
+    const i = slot.page - batch.first;
+    if (slot.url || i < 0 || i >= batch.count) continue;
+    const png = batch.data.subarray(batch.offsets[i], batch.offsets[i + 1]);
+    if (png.length === 0) continue;
+    slot.url = URL.createObjectURL(new Blob([png], { type: 'image/png' }));
+    slot.image.style.width = `${batch.widths[i] / dpr}px`;
+    slot.image.style.height = `${batch.heights[i] / dpr}px`;
+    slot.image.src = slot.url;
+  }
+}
+
+function createThumbnailSlot(): ThumbnailSlot {
+  const item = document.createElement('div');
+  item.className = 'thumbnail-item';
+
+  const image = document.createElement('img');
+  image.className = 'thumbnail-image';
+  image.decoding = 'async';
+  image.alt = '';
+
+  const label = document.createElement('span');
+  label.className = 'thumbnail-label';
+
+  item.appendChild(image);
+  item.appendChild(label);
+  thumbnailSpacer?.appendChild(item);
+
+  const slot: ThumbnailSlot = { item, image, label, page: -1, url: null };
+  item.addEventListener('click', () => {
+    if (slot.page >= 0) goToPage(slot.page);
+  });
+  thumbnailSlots.push(slot);
+  return slot;
+}
+
+function releaseThumbnailSlot(slot: ThumbnailSlot): void {
+  if (slot.url) URL.revokeObjectURL(slot.url);
+  slot.url = null;
+  slot.page = -1;
+  slot.image.removeAttribute('src');
+  slot.item.hidden = true;
 }
 
 function updateActiveThumbnail(): void {
-  const items = thumbnailsPanel.querySelectorAll('.thumbnail-item');
-  items.forEach((el, idx) => {
-    el.classList.toggle('active', idx === state.currentPage);
+  for (const slot of thumbnailSlots) {
+    slot.item.classList.toggle('active', slot.page === state.currentPage);
+  }
+
+  // Bring the current page's row into view.
+  const top = state.currentPage * THUMB_ROW_HEIGHT;
+  const viewTop = thumbnailsPanel.scrollTop;
+  const viewHeight = thumbnailsPanel.clientHeight;
+  if (top < viewTop || top + THUMB_ROW_HEIGHT > viewTop + viewHeight) {
+    thumbnailsPanel.scrollTop = top - (viewHeight - THUMB_ROW_HEIGHT) / 2;
+  }
+}
+
+// ── Outline ─────────────────────────────────────────────────────────
+//
+// Nodes are fetched from main only when opened, a batch at a time, so
+// the sidebar costs the same for ten bookmarks or fifty thousand.
+
+async function buildOutline(): Promise<void> {
+  outlinePanel.innerHTML = '';
+  outlinePanel.hidden = true;
+  if (!state.docId) return;
+
+  const list = document.createElement('ul');
+  list.className = 'outline-list';
+  outlinePanel.appendChild(list);
+  const docId = state.docId;
+  const loaded = await appendOutlineChildren(docId, 0, list, 0, true);
+  if (state.docId === docId) outlinePanel.hidden = loaded === 0;
+}
+
+/**
+ * Fetch one batch of `nodeRef`'s children into `list`, followed by a
+ * "more" row when the node has further children.  `honourOpen` expands
+ * the rows the file marks open (top level only, to keep this lazy).
+ * Returns the number of rows added.
+ */
+async function appendOutlineChildren(
+  docId: string,
+  nodeRef: number,
+  list: HTMLUListElement,
+  start: number,
+  honourOpen = false,
+): Promise<number> {
+  let batch: PdfOutlineBatch;
+  try {
+    batch = await window.api.pdf.outlineChildren({ docId, nodeRef, start, limit: OUTLINE_BATCH });
+  } catch {
+    return 0;
+  }
+  if (state.docId !== docId) return 0;
+
+  const fragment = document.createDocumentFragment();
+  const toOpen: HTMLLIElement[] = [];
+  for (let i = 0; i < batch.count; i++) {
+    const item = outlineItem(docId, batch, i);
+    fragment.appendChild(item);
+    if (honourOpen && batch.flags[i] & OUTLINE_OPEN) toOpen.push(item);
+  }
+
+  const end = batch.start + batch.count;
+  if (end < batch.total) {
+    const more = document.createElement('li');
+    more.className = 'outline-more';
+    more.textContent = `${batch.total - end} more…`;
+    more.addEventListener('click', () => {
+      more.remove();
+      void appendOutlineChildren(docId, nodeRef, list, end);
+    });
+    fragment.appendChild(more);
+  }
+  list.appendChild(fragment);
+
+  for (const item of toOpen) void toggleOutlineItem(docId, item);
+  return batch.count;
+}
+
+function outlineItem(docId: string, batch: PdfOutlineBatch, i: number): HTMLLIElement {
+  const item = document.createElement('li');
+  item.className = 'outline-item';
+  item.dataset.node = String(batch.ids[i]);
+
+  const row = document.createElement('div');
+  row.className = 'outline-row';
+
+  const twisty = document.createElement('span');
+  twisty.className = 'outline-twisty';
+  if (batch.flags[i] & OUTLINE_HAS_CHILDREN) {
+    twisty.textContent = '▸';
+    twisty.addEventListener('click', (e) => {
+      e.stopPropagation();
+      void toggleOutlineItem(docId, item);
+    });
+  }
+
+  const title = document.createElement('span');
+  title.className = 'outline-title';
+  title.textContent = batch.titles.slice(batch.titleOffsets[i], batch.titleOffsets[i + 1]);
+  const page = batch.pages[i];
+  if (page >= 0) {
+    title.title = `Page ${page + 1}`;
+  } else if (batch.flags[i] & OUTLINE_EXTERNAL) {
+    row.classList.add('external');
+    title.title = 'Opens outside this document';
+  }
+
+  row.append(twisty, title);
+  row.addEventListener('click', () => {
+    if (page >= 0 && state.docId === docId) goToPage(page);
   });
+  item.appendChild(row);
+  return item;
+}
+
+/** Open or close an outline row, fetching its children the first time. */
+async function toggleOutlineItem(docId: string, item: HTMLLIElement): Promise<void> {
+  const twisty = item.querySelector(':scope > .outline-row > .outline-twisty');
+  let children = item.querySelector<HTMLUListElement>(':scope > .outline-list');
+  if (children) {
+    children.hidden = !children.hidden;
+  } else {
+    children = document.createElement('ul');
+    children.className = 'outline-list';
+    item.appendChild(children);
+    await appendOutlineChildren(docId, Number(item.dataset.node), children, 0);
+  }
+  if (twisty) twisty.textContent = children.hidden ? '▸' : '▾';
 }
 
 // ── Page navigation ─────────────────────────────────────────────────
@@ -505,6 +876,7 @@ async function goToPage(pageIndex: number): Promise<void> {
   if (pageIndex < 0 || pageIndex >= state.pageCount) return;
   state.currentPage = pageIndex;
   state.selectedObjectId = null;
+  textSelection = null;
   updatePageInfo();
   updateActiveThumbnail();
   await renderCurrentPage();
@@ -524,21 +896,43 @@ function handleZoomFit(): void {
   if (!state.docId) return;
   // Approximate: set zoom so page width fills viewer container
   const containerWidth = viewerContainer.clientWidth - 40; // padding
-  const pageWidth = pageCanvas.width / (state.zoomPercent / 100);
+  const pageWidth = pageCanvas.width / state.renderScale;
   if (pageWidth > 0) {
     const fitPercent = Math.round((containerWidth / pageWidth) * 100);
     setZoom(fitPercent);
   }
 }
 
+// ── Rotation ────────────────────────────────────────────────────────
+
+/**
+ * Turn the view by ±90°.  Main serves the turn from the cached raster,
+ * so this is as quick as a repaint.
+ */
+async function rotateView(delta: number): Promise<void> {
+  if (!state.docId) return;
+  state.rotation = ((state.rotation + delta + 360) % 360) as PdfViewRotation;
+  document.getElementById('in-place-editor')?.remove();
+  await renderCurrentPage();
+}
+
+/** Tools that paint into the page canvas work on the upright page only. */
+function requireUprightView(action: string): boolean {
+  if (state.rotation === 0) return true;
+  setStatus(`${action} needs the page upright — rotate the view back first`);
+  return false;
+}
+
 // ── Object selection & hit testing ──────────────────────────────────
 
 function handleCanvasClick(e: MouseEvent): void {
-  if (!state.docId) return;
+  if (!state.docId || state.toolMode === 'select-text' || state.toolMode === 'ink') return;
+  if (suppressNextClick) {
+    suppressNextClick = false;
+    return;
+  }
 
-  const rect = overlayCanvas.getBoundingClientRect();
-  const canvasX = e.clientX - rect.left;
-  const canvasY = e.clientY - rect.top;
+  const { x: canvasX, y: canvasY } = canvasPoint(e);
   const scale = state.zoomPercent / 100;
 
   // Convert canvas coordinates to PDF coordinates
@@ -560,8 +954,346 @@ function handleCanvasClick(e: MouseEvent): void {
   updatePropertiesPanel(hit);
 }
 
+// ── Object drag & resize ────────────────────────────────────────────
+//
+// A drag renders the page without the object and the object alone
+// once (dragBegin); every mouse move then only composites the two
+// (dragPreview) and paints the returned patch.  The object is
+// transformed, through the undo stack, once on drop.
+
+interface ActiveDrag {
+  docId: string;
+  pageIndex: number;
+  objectId: number;
+  mode: 'move' | 'resize';
+  startX: number;
+  startY: number;
+  /** Set once the pointer passes the threshold and layers are requested. */
+  session: Promise<PdfDragBeginResult | null> | null;
+  sprite: PdfPixelRect | null;
+  /** Newest rect not yet sent; only one preview is in flight at a time. */
+  pending: PdfPixelRect | null;
+  inFlight: Promise<void> | null;
+}
+
+let activeDrag: ActiveDrag | null = null;
+let suppressNextClick = false;
+
+/** Page raster pixels per overlay pixel: the device-pixel bucket over the zoom. */
+function rasterRatio(): number {
+  return state.renderScale / (state.zoomPercent / 100);
+}
+
+/** Pointer position in upright overlay pixels, whatever the view rotation. */
+function canvasPoint(e: MouseEvent): { x: number; y: number } {
+  const rect = overlayCanvas.getBoundingClientRect();
+  if (state.rotation === 0) return { x: e.clientX - rect.left, y: e.clientY - rect.top };
+
+  // Undo the CSS rotation about the overlay's centre.
+  const dx = e.clientX - (rect.left + rect.width / 2);
+  const dy = e.clientY - (rect.top + rect.height / 2);
+  const [ux, uy] = state.rotation === 90 ? [dy, -dx]
+    : state.rotation === 180 ? [-dx, -dy]
+    : [-dy, dx];
+  return { x: ux + overlayCanvas.width / 2, y: uy + overlayCanvas.height / 2 };
+}
+
+function handleDragStart(e: MouseEvent): void {
+  suppressNextClick = false;
+  if (!state.docId || e.button !== 0 || state.toolMode !== 'select') return;
+  const obj = state.pageObjects.find((o) => o.id === state.selectedObjectId);
+  if (!obj || state.rotation !== 0) return;
+
+  const scale = state.zoomPercent / 100;
+  const { x, y } = canvasPoint(e);
+  const left = obj.left * scale;
+  const top = (overlayCanvas.height / scale - obj.top) * scale;
+  const right = obj.right * scale;
+  const bottom = top + (obj.top - obj.bottom) * scale;
+
+  const onResizeHandle =
+    Math.abs(x - right) <= HANDLE_SIZE && Math.abs(y - bottom) <= HANDLE_SIZE;
+  if (!onResizeHandle && (x < left || x > right || y < top || y > bottom)) return;
+
+  e.preventDefault();
+  activeDrag = {
+    docId: state.docId,
+    pageIndex: state.currentPage,
+    objectId: obj.id,
+    mode: onResizeHandle ? 'resize' : 'move',
+    startX: x,
+    startY: y,
+    session: null,
+    sprite: null,
+    pending: null,
+    inFlight: null,
+  };
+}
+
+function handleDragMove(e: MouseEvent): void {
+  const drag = activeDrag;
+  if (!drag) return;
+
+  const { x, y } = canvasPoint(e);
+  const dx = x - drag.startX;
+  const dy = y - drag.startY;
+
+  if (!drag.session) {
+    if (Math.hypot(dx, dy) < DRAG_THRESHOLD_PX) return;
+    drag.session = beginDragLayers(drag);
+  }
+  void drag.session.then((session) => {
+    if (!session || activeDrag !== drag || !drag.sprite) return;
+    // The session works in raster pixels, the pointer in overlay pixels.
+    const sprite = drag.sprite;
+    const rx = Math.round(dx * rasterRatio());
+    const ry = Math.round(dy * rasterRatio());
+    drag.pending = drag.mode === 'move'
+      ? { x: sprite.x + rx, y: sprite.y + ry,
+          width: sprite.width, height: sprite.height }
+      : { x: sprite.x, y: sprite.y,
+          width: Math.max(1, sprite.width + rx),
+          height: Math.max(1, sprite.height + ry) };
+    pumpDragPreview(drag, session.sessionId);
+  });
+}
+
+async function beginDragLayers(drag: ActiveDrag): Promise<PdfDragBeginResult | null> {
+  try {
+    const session = await window.api.pdf.dragBegin({
+      docId: drag.docId,
+      pageIndex: drag.pageIndex,
+      objectId: drag.objectId,
+      scale: state.renderScale,
+      filter: state.viewFilter,
+    });
+    const ctx = pageCanvas.getContext('2d');
+    ctx?.putImageData(
+      new ImageData(new Uint8ClampedArray(session.image), session.width, session.height),
+      0, 0,
+    );
+    drag.sprite = session.sprite;
+    return session;
+  } catch (err) {
+    setStatus(`Drag error: ${(err as Error).message}`);
+    return null;
+  }
+}
+
+/** Send the newest pending rect unless a preview is already in flight. */
+function pumpDragPreview(drag: ActiveDrag, sessionId: number): void {
+  if (drag.inFlight || !drag.pending) return;
+  const rect = drag.pending;
+  drag.pending = null;
+
+  drag.inFlight = (async () => {
+    try {
+      const patch = await window.api.pdf.dragPreview({ sessionId, rect });
+      const ctx = pageCanvas.getContext('2d');
+      if (ctx && patch.width > 0 && patch.height > 0) {
+        ctx.putImageData(
+          new ImageData(new Uint8ClampedArray(patch.image), patch.width, patch.height),
+          patch.x, patch.y,
+        );
+      }
+      drawDragOverlay(rect);
+    } catch (err) {
+      setStatus(`Drag error: ${(err as Error).message}`);
+    } finally {
+      drag.inFlight = null;
+    }
+    pumpDragPreview(drag, sessionId);
+  })();
+}
+
+function drawDragOverlay(rect: PdfPixelRect): void {
+  const ctx = overlayCanvas.getContext('2d');
+  if (!ctx) return;
+  ctx.clearRect(0, 0, overlayCanvas.width, overlayCanvas.height);
+  ctx.strokeStyle = '#0078d4';
+  ctx.lineWidth = 2;
+  ctx.setLineDash([4, 2]);
+  const k = 1 / rasterRatio();
+  ctx.strokeRect(rect.x * k, rect.y * k, rect.width * k, rect.height * k);
+  ctx.setLineDash([]);
+}
+
+async function handleDragEnd(): Promise<void> {
+  const drag = activeDrag;
+  if (!drag) return;
+  activeDrag = null;
+  if (!drag.session) return; // a plain click
+
+  suppressNextClick = true;
+  const session = await drag.session;
+  if (!session) {
+    await renderCurrentPage();
+    return;
+  }
+  // Flush so the session ends on the rect the user last saw.
+  while (drag.inFlight) await drag.inFlight;
+
+  const matrix = await window.api.pdf.dragEnd(session.sessionId);
+  if (!matrix) {
+    await renderCurrentPage();
+    return;
+  }
+
+  const { docId, pageIndex, objectId } = drag;
+  const [a, b, c, d, e, f] = matrix;
+  const det = a * d - b * c;
+  const inverse: PdfMatrix = [
+    d / det, -b / det, -c / det, a / det,
+    (c * f - d * e) / det, (b * e - a * f) / det,
+  ];
+
+  const cmd: EditCommand = {
+    description: `${drag.mode === 'move' ? 'Move' : 'Resize'} object ${objectId}`,
+    async execute(): Promise<void> {
+      await window.api.pdf.transformObject({ docId, pageIndex, objectId, matrix });
+      markDirty();
+      await renderCurrentPage();
+    },
+    async undo(): Promise<void> {
+      await window.api.pdf.transformObject({ docId, pageIndex, objectId, matrix: inverse });
+      markDirty();
+      await renderCurrentPage();
+    },
+  };
+
+  await undoStack.push(cmd);
+}
+
+// ── Freehand ink ────────────────────────────────────────────────────
+//
+// A stroke is drawn natively over the raster already on screen
+// (inkBegin).  Pointer points are batched while an append is in
+// flight, and each reply is only the patch the new segments touched.
+// The stroke becomes an ink annotation, through the undo stack, on
+// pointer up.
+
+const INK_STYLE: PdfInkStyle = { color: [0, 0, 0, 255], width: 2 };
+
+interface ActiveInk {
+  docId: string;
+  pageIndex: number;
+  session: Promise<number | null>;
+  /** Page-pixel x, y pairs not yet sent; one append is in flight at a time. */
+  pending: number[];
+  inFlight: Promise<void> | null;
+}
+
+let activeInk: ActiveInk | null = null;
+
+function handleInkStart(e: PointerEvent): void {
+  if (!state.docId || e.button !== 0 || state.toolMode !== 'ink') return;
+  if (!requireUprightView('Ink')) return;
+  e.preventDefault();
+  overlayCanvas.setPointerCapture(e.pointerId);
+
+  const { x, y } = canvasPoint(e);
+  const ink: ActiveInk = {
+    docId: state.docId,
+    pageIndex: state.currentPage,
+    session: window.api.pdf.inkBegin({
+      docId: state.docId,
+      pageIndex: state.currentPage,
+      zoom: state.zoomPercent / 100,
+      devicePixelRatio: window.devicePixelRatio || 1,
+      annotations: state.showAnnotations,
+      filter: state.viewFilter,
+      style: INK_STYLE,
+    }).catch((err: Error) => {
+      setStatus(`Ink error: ${err.message}`);
+      return null;
+    }),
+    pending: [x * rasterRatio(), y * rasterRatio()],
+    inFlight: null,
+  };
+  activeInk = ink;
+  void ink.session.then((sessionId) => {
+    if (sessionId !== null) pumpInk(ink, sessionId);
+  });
+}
+
+function handleInkMove(e: PointerEvent): void {
+  const ink = activeInk;
+  if (!ink) return;
+
+  // A pen reports more points than events; keep the ones merged into this one.
+  for (const ev of e.getCoalescedEvents?.() ?? [e]) {
+    const { x, y } = canvasPoint(ev);
+    ink.pending.push(x * rasterRatio(), y * rasterRatio());
+  }
+  void ink.session.then((sessionId) => {
+    if (sessionId !== null) pumpInk(ink, sessionId);
+  });
+}
+
+/** Send the pending points unless an append is already in flight. */
+function pumpInk(ink: ActiveInk, sessionId: number): void {
+  if (ink.inFlight || ink.pending.length === 0) return;
+  const points = new Float32Array(ink.pending);
+  ink.pending = [];
+
+  ink.inFlight = (async () => {
+    try {
+      const patch = await window.api.pdf.inkAppend({ sessionId, points });
+      const ctx = pageCanvas.getContext('2d');
+      if (ctx && patch.width > 0 && patch.height > 0) {
+        ctx.putImageData(
+          new ImageData(new Uint8ClampedArray(patch.image), patch.width, patch.height),
+          patch.x, patch.y,
+        );
+      }
+    } catch (err) {
+      setStatus(`Ink error: ${(err as Error).message}`);
+    } finally {
+      ink.inFlight = null;
+    }
+    pumpInk(ink, sessionId);
+  })();
+}
+
+async function handleInkEnd(): Promise<void> {
+  const ink = activeInk;
+  if (!ink) return;
+  activeInk = null;
+
+  const sessionId = await ink.session;
+  if (sessionId === null) return;
+  // Flush so the annotation holds every point that was drawn.
+  pumpInk(ink, sessionId);
+  while (ink.inFlight) await ink.inFlight;
+
+  const stroke = await window.api.pdf.inkEnd(sessionId);
+  if (!stroke) return;
+
+  const { docId, pageIndex } = ink;
+  let annotIndex = -1;
+  const cmd: EditCommand = {
+    description: 'Draw ink',
+    async execute(): Promise<void> {
+      annotIndex = await window.api.pdf.addInk({ docId, pageIndex, stroke });
+      markDirty();
+      await renderCurrentPage();
+    },
+    async undo(): Promise<void> {
+      await window.api.pdf.removeAnnotation({ docId, pageIndex, annotIndex });
+      markDirty();
+      await renderCurrentPage();
+    },
+  };
+
+  await undoStack.push(cmd);
+}
+
 function handleCanvasDblClick(e: MouseEvent): void {
-  if (!state.docId || !state.selectedObjectId) return;
+  if (state.toolMode === 'select-text') {
+    selectWordAt(e);
+    return;
+  }
+  if (!state.docId || !state.selectedObjectId || state.toolMode === 'ink') return;
 
   const obj = state.pageObjects.find((o) => o.id === state.selectedObjectId);
   if (!obj) return;
@@ -577,9 +1309,166 @@ function handleCanvasDblClick(e: MouseEvent): void {
   }
 }
 
+// ── Text selection ──────────────────────────────────────────────────
+//
+// The page's char geometry arrives once per page version as typed
+// arrays (charGeometry); hit-testing and highlighting while the user
+// drags are then plain JS over those arrays.
+
+interface PageGeometry extends PdfCharGeometry {
+  key: string;
+  /** left, top, right, bottom of each line in `lines`. */
+  lineBoxes: Float32Array;
+}
+
+let pageGeometry: PageGeometry | null = null;
+let pageGeometryRequest: Promise<PageGeometry | null> | null = null;
+/** Char indices; the selection is [min, max). */
+let textSelection: { anchor: number; focus: number } | null = null;
+let selectingText = false;
+
+function loadPageGeometry(): Promise<PageGeometry | null> {
+  if (!state.docId) return Promise.resolve(null);
+  const key = `${state.docId}:${state.currentPage}`;
+  if (pageGeometry?.key === key) return Promise.resolve(pageGeometry);
+
+  pageGeometryRequest ??= (async () => {
+    try {
+      const geometry = await window.api.pdf.charGeometry({
+        docId: state.docId!,
+        pageIndex: state.currentPage,
+      });
+      const { boxes, lines } = geometry;
+      const lineBoxes = new Float32Array(lines.length * 2);
+      for (let l = 0; l < lines.length / 2; l++) {
+        let left = Infinity, top = -Infinity, right = -Infinity, bottom = Infinity;
+        for (let i = lines[l * 2]; i < lines[l * 2 + 1]; i++) {
+          left = Math.min(left, boxes[i * 4]);
+          top = Math.max(top, boxes[i * 4 + 1]);
+          right = Math.max(right, boxes[i * 4 + 2]);
+          bottom = Math.min(bottom, boxes[i * 4 + 3]);
+        }
+        lineBoxes.set([left, top, right, bottom], l * 4);
+      }
+      pageGeometry = { ...geometry, key, lineBoxes };
+      return pageGeometry;
+    } catch (err) {
+      setStatus(`Text geometry error: ${(err as Error).message}`);
+      return null;
+    } finally {
+      pageGeometryRequest = null;
+    }
+  })();
+  return pageGeometryRequest;
+}
+
+/** Caret position (char index) nearest to a canvas point. */
+function charIndexAt(geometry: PageGeometry, e: MouseEvent): number {
+  const { x, y } = canvasPoint(e);
+  const scale = state.zoomPercent / 100;
+  const pdfX = x / scale;
+  const pdfY = (overlayCanvas.height - y) / scale;
+  const { boxes, lines, lineBoxes } = geometry;
+  if (lines.length === 0) return 0;
+
+  // Nearest line vertically, then the char whose midpoint follows x.
+  let best = 0;
+  let bestDistance = Infinity;
+  for (let l = 0; l < lines.length / 2; l++) {
+    const top = lineBoxes[l * 4 + 1];
+    const bottom = lineBoxes[l * 4 + 3];
+    const distance = pdfY > top ? pdfY - top : pdfY < bottom ? bottom - pdfY : 0;
+    if (distance < bestDistance) {
+      bestDistance = distance;
+      best = l;
+    }
+  }
+  const start = lines[best * 2];
+  const end = lines[best * 2 + 1];
+  for (let i = start; i < end; i++) {
+    if (pdfX < (boxes[i * 4] + boxes[i * 4 + 2]) / 2) return i;
+  }
+  return end;
+}
+
+async function handleTextSelectStart(e: MouseEvent): Promise<void> {
+  if (state.toolMode !== 'select-text' || e.button !== 0) return;
+  e.preventDefault();
+  selectingText = true;
+  const geometry = await loadPageGeometry();
+  if (!geometry || !selectingText) return;
+  const index = charIndexAt(geometry, e);
+  textSelection = { anchor: index, focus: index };
+  drawSelectionOverlay();
+}
+
+function handleTextSelectMove(e: MouseEvent): void {
+  if (!selectingText || !textSelection || !pageGeometry) return;
+  const focus = charIndexAt(pageGeometry, e);
+  if (focus === textSelection.focus) return;
+  textSelection.focus = focus;
+  drawSelectionOverlay();
+}
+
+async function selectWordAt(e: MouseEvent): Promise<void> {
+  const geometry = await loadPageGeometry();
+  if (!geometry) return;
+  const index = charIndexAt(geometry, e);
+  const { words } = geometry;
+  for (let w = 0; w < words.length; w += 2) {
+    if (index >= words[w] && index < words[w + 1]) {
+      textSelection = { anchor: words[w], focus: words[w + 1] };
+      drawSelectionOverlay();
+      return;
+    }
+  }
+}
+
+function drawTextSelection(ctx: CanvasRenderingContext2D): void {
+  if (!textSelection || !pageGeometry || textSelection.anchor === textSelection.focus) return;
+  const from = Math.min(textSelection.anchor, textSelection.focus);
+  const to = Math.max(textSelection.anchor, textSelection.focus);
+  const { boxes, lines } = pageGeometry;
+  const scale = state.zoomPercent / 100;
+  const pageHeight = overlayCanvas.height / scale;
+
+  // One rectangle per line: the union of its selected chars.
+  ctx.fillStyle = 'rgba(0, 120, 212, 0.3)';
+  for (let l = 0; l < lines.length; l += 2) {
+    const start = Math.max(lines[l], from);
+    const end = Math.min(lines[l + 1], to);
+    if (start >= end) continue;
+    let left = Infinity, top = -Infinity, right = -Infinity, bottom = Infinity;
+    for (let i = start; i < end; i++) {
+      left = Math.min(left, boxes[i * 4]);
+      top = Math.max(top, boxes[i * 4 + 1]);
+      right = Math.max(right, boxes[i * 4 + 2]);
+      bottom = Math.min(bottom, boxes[i * 4 + 3]);
+    }
+    ctx.fillRect(
+      left * scale, (pageHeight - top) * scale,
+      (right - left) * scale, (top - bottom) * scale,
+    );
+  }
+}
+
+function copySelectedText(): void {
+  if (!textSelection || !pageGeometry) return;
+  const from = Math.min(textSelection.anchor, textSelection.focus);
+  const to = Math.max(textSelection.anchor, textSelection.focus);
+  const codepoints = pageGeometry.codepoints.subarray(from, to);
+  const text = Array.from(codepoints, (c) => String.fromCodePoint(c)).join('');
+  navigator.clipboard.writeText(text).then(
+    () => setStatus(`Copied ${to - from} characters`),
+    (err: Error) => setStatus(`Copy failed: ${err.message}`),
+  );
+}
+
 // ── In-place text editor ────────────────────────────────────────────
 
 function openInPlaceTextEditor(obj: PageObject): void {
+  if (!requireUprightView('Text editing')) return;
+
   // Remove any existing editor
   const existing = document.getElementById('in-place-editor');
   if (existing) existing.remove();
@@ -643,6 +1532,36 @@ function openInPlaceTextEditor(obj: PageObject): void {
     }
   });
 
+  // Grow the editor to the width the text will have in the object's
+  // font.  One measurement in flight; the latest text wins.
+  let measuring = false;
+  let remeasure = false;
+  const fitToText = async (): Promise<void> => {
+    if (!state.docId) return;
+    if (measuring) {
+      remeasure = true;
+      return;
+    }
+    measuring = true;
+    try {
+      do {
+        remeasure = false;
+        const metrics = await window.api.pdf.measureText({
+          docId: state.docId,
+          pageIndex: state.currentPage,
+          objectId: obj.id,
+          text: editor.textContent ?? '',
+        });
+        editor.style.width = `${Math.max(w, Math.ceil(metrics.width * scale))}px`;
+      } while (remeasure && editor.parentElement);
+    } catch {
+      // Keep the object's own width when it cannot be measured.
+    } finally {
+      measuring = false;
+    }
+  };
+  editor.addEventListener('input', () => { fitToText(); });
+
   editor.addEventListener('blur', () => {
     // Commit on blur (unless already removed by Escape)
     if (editor.parentElement) commitEdit();
@@ -704,14 +1623,137 @@ async function handleReplaceImage(obj: PageObject): Promise<void> {
   input.click();
 }
 
+// ── Flattening ──────────────────────────────────────────────────────
+
+async function handleFlatten(): Promise<void> {
+  if (!state.docId) return;
+  const docId = state.docId;
+
+  btnFlatten.disabled = true;
+  setStatus('Flattening…');
+  const unsubscribe = window.api.pdf.onJobProgress((p) => {
+    if (p.docId === docId && p.job === 'flatten') {
+      setStatus(`Flattening… page ${p.done} of ${p.total}`);
+    }
+  });
+
+  try {
+    const result = await window.api.pdf.flatten({ docId });
+    if (state.docId !== docId) return;
+
+    // Flattening renumbers page objects, so earlier edit commands no
+    // longer point at the right objects.
+    undoStack.clear();
+    state.selectedObjectId = null;
+    updatePropertiesPanel(null);
+    if (result.flattened > 0) markDirty();
+
+    await renderCurrentPage();
+    await buildThumbnails();
+
+    let summary = `Flattened ${result.flattened} page${result.flattened !== 1 ? 's' : ''}`;
+    if (result.skipped.length > 0) summary += `, ${result.skipped.length} skipped`;
+    if (result.failed.length > 0) summary += `, ${result.failed.length} failed`;
+    if (result.cancelled) summary += ' (cancelled)';
+    setStatus(summary);
+  } catch (err) {
+    setStatus(`Flatten failed: ${(err as Error).message}`);
+  } finally {
+    unsubscribe();
+    btnFlatten.disabled = false;
+  }
+}
+
+async function handleRasterize(): Promise<void> {
+  if (!state.docId) return;
+  const docId = state.docId;
+  const pageIndex = state.currentPage;
+
+  btnRasterize.disabled = true;
+  setStatus(`Rasterizing page ${pageIndex + 1}…`);
+
+  try {
+    const result = await window.api.pdf.rasterize({ docId, pages: [pageIndex] });
+    if (state.docId !== docId) return;
+
+    // The page's objects are gone, so edit commands on it are stale.
+    undoStack.clear();
+    state.selectedObjectId = null;
+    updatePropertiesPanel(null);
+    if (result.rasterized.length > 0) markDirty();
+
+    await renderCurrentPage();
+
+    setStatus(result.rasterized.length > 0
+      ? `Page ${pageIndex + 1} rasterized`
+      : `Could not rasterize page ${pageIndex + 1}`);
+  } catch (err) {
+    setStatus(`Rasterize failed: ${(err as Error).message}`);
+  } finally {
+    btnRasterize.disabled = false;
+  }
+}
+
+// ── OCR ─────────────────────────────────────────────────────────────
+
+/** Document of the running OCR pass; the button cancels it meanwhile. */
+let ocrDocId: string | null = null;
+
+async function handleOcr(): Promise<void> {
+  if (ocrDocId) {
+    await window.api.pdf.cancelJob({ docId: ocrDocId, job: 'ocr' });
+    return;
+  }
+  if (!state.docId) return;
+  const docId = state.docId;
+
+  ocrDocId = docId;
+  btnOcr.textContent = 'Cancel OCR';
+  setStatus('Recognising text…');
+  const unsubscribe = window.api.pdf.onJobProgress((p) => {
+    if (p.docId === docId && p.job === 'ocr') {
+      setStatus(`Recognising text… page ${p.done} of ${p.total} (${formatJobRate(p)})`);
+    }
+  });
+
+  try {
+    const result = await window.api.pdf.ocr({ docId });
+    if (state.docId !== docId) return;
+
+    // New text objects go after the existing ones, so edit commands
+    // still point at the right objects.
+    if (result.words > 0) markDirty();
+
+    let summary = `Recognised ${result.recognised} page${result.recognised !== 1 ? 's' : ''}`
+      + ` (${result.words} words)`;
+    if (result.skipped > 0) summary += `, ${result.skipped} already had text`;
+    if (result.failed.length > 0) summary += `, ${result.failed.length} failed`;
+    if (result.cancelled) summary += ' (cancelled)';
+    setStatus(summary);
+  } catch (err) {
+    setStatus(`OCR failed: ${(err as Error).message}`);
+  } finally {
+    unsubscribe();
+    ocrDocId = null;
+    btnOcr.textContent = 'OCR';
+  }
+}
+
 // ── Tool mode ───────────────────────────────────────────────────────
 
 function setToolMode(mode: ToolMode): void {
   state.toolMode = mode;
   btnToolSelect.classList.toggle('active', mode === 'select');
+  btnToolSelectText.classList.toggle('active', mode === 'select-text');
   btnToolEditText.classList.toggle('active', mode === 'edit-text');
   btnToolReplaceImage.classList.toggle('active', mode === 'replace-image');
-  overlayCanvas.style.cursor = mode === 'select' ? 'default' : 'crosshair';
+  btnToolInk.classList.toggle('active', mode === 'ink');
+  overlayCanvas.style.cursor =
+    mode === 'select' ? 'default' : mode === 'select-text' ? 'text' : 'crosshair';
+  if (mode !== 'select-text' && textSelection) {
+    textSelection = null;
+    drawSelectionOverlay();
+  }
 }
 
 // ── Properties panel ────────────────────────────────────────────────
@@ -733,13 +1775,46 @@ function updatePropertiesPanel(obj: PageObject | null): void {
       <p class="indent">L: ${obj.left.toFixed(1)}, T: ${obj.top.toFixed(1)}</p>
       <p class="indent">R: ${obj.right.toFixed(1)}, B: ${obj.bottom.toFixed(1)}</p>
       <p><strong>Size:</strong> ${(obj.right - obj.left).toFixed(1)} × ${(obj.top - obj.bottom).toFixed(1)} pt</p>
+      ${obj.type === 'image' ? '<canvas class="image-preview"></canvas><p class="image-pixels"></p>' : ''}
     </div>
   `;
+  if (obj.type === 'image') void showImagePreview(panel, obj);
+}
+
+async function showImagePreview(panel: HTMLElement, obj: PageObject): Promise<void> {
+  if (!state.docId) return;
+  const docId = state.docId;
+  try {
+    const preview = await window.api.pdf.imagePreview({
+      docId,
+      pageIndex: state.currentPage,
+      objectId: obj.id,
+    });
+    // The selection may have moved on while the preview was decoding.
+    if (state.docId !== docId || state.selectedObjectId !== obj.id) return;
+
+    const canvas = panel.querySelector<HTMLCanvasElement>('canvas.image-preview');
+    const pixels = panel.querySelector<HTMLElement>('p.image-pixels');
+    const ctx = canvas?.getContext('2d');
+    if (!canvas || !ctx) return;
+    canvas.width = preview.width;
+    canvas.height = preview.height;
+    ctx.putImageData(
+      new ImageData(new Uint8ClampedArray(preview.image), preview.width, preview.height),
+      0, 0,
+    );
+    if (pixels) pixels.textContent = `${preview.pixelWidth} × ${preview.pixelHeight} px`;
+  } catch {
+    // Undecodable images simply show no preview.
+  }
 }
 
 // ── Dirty state ─────────────────────────────────────────────────────
 
 function markDirty(): void {
+  // The page's char geometry is now a version behind.
+  pageGeometry = null;
+  textSelection = null;
   state.modified = true;
   updateDirtyIndicator();
 }
@@ -772,6 +1847,10 @@ function handleKeyboard(e: KeyboardEvent): void {
   if (mod && e.key === '-') { e.preventDefault(); setZoom(state.zoomPercent - ZOOM_STEP_PERCENT); }
   if (mod && e.key === '0') { e.preventDefault(); setZoom(DEFAULT_ZOOM_PERCENT); }
 
+  // Rotation
+  if (mod && e.key === ']') { e.preventDefault(); rotateView(90); }
+  if (mod && e.key === '[') { e.preventDefault(); rotateView(-90); }
+
   // Page navigation
   if (e.key === 'PageUp') { e.preventDefault(); goToPage(state.currentPage - 1); }
   if (e.key === 'PageDown') { e.preventDefault(); goToPage(state.currentPage + 1); }
@@ -780,11 +1859,17 @@ function handleKeyboard(e: KeyboardEvent): void {
 
   // Tool shortcuts
   if (e.key === 'v' && !mod) { setToolMode('select'); }
+  if (e.key === 's' && !mod) { setToolMode('select-text'); }
   if (e.key === 't' && !mod) { setToolMode('edit-text'); }
   if (e.key === 'i' && !mod) { setToolMode('replace-image'); }
+  if (e.key === 'p' && !mod) { setToolMode('ink'); }
+
+  // Copy selected text
+  if (mod && e.key === 'c' && textSelection) { e.preventDefault(); copySelectedText(); }
 
   // Escape deselects
   if (e.key === 'Escape') {
+    textSelection = null;
     state.selectedObjectId = null;
     drawSelectionOverlay();
     updatePropertiesPanel(null);
@@ -799,12 +1884,21 @@ function enableDocumentControls(): void {
   btnZoomIn.disabled = false;
   btnZoomOut.disabled = false;
   btnZoomFit.disabled = false;
+  btnRotateLeft.disabled = false;
+  btnRotateRight.disabled = false;
   btnPrevPage.disabled = false;
   btnNextPage.disabled = false;
   pageInput.disabled = false;
   btnToolSelect.disabled = false;
+  btnToolSelectText.disabled = false;
   btnToolEditText.disabled = false;
   btnToolReplaceImage.disabled = false;
+  btnToolInk.disabled = false;
+  btnToggleAnnotations.disabled = false;
+  viewFilterSelect.disabled = false;
+  btnFlatten.disabled = false;
+  btnRasterize.disabled = false;
+  btnOcr.disabled = false;
 }
 
 function updatePageInfo(): void {
@@ -827,6 +1921,12 @@ function setStatus(text: string): void {
   statusText.textContent = text;
 }
 
+/** A job's measured rate per minute, labelled with what it counts. */
+function formatJobRate(p: PdfJobProgressPayload): string {
+  const perMinute = (p.rate ?? 0) * 60;
+  return `${perMinute.toFixed(0)} ${p.rateUnit ?? 'pages'}/min`;
+}
+
 // ── Boot ────────────────────────────────────────────────────────────
 init().catch((err) => {
   console.error('[Renderer] Init failed:', err);
@@ -37,13 +37,23 @@ interface PdfOpenResult {
 interface PdfRenderPagePayload {
   docId: string;
   pageIndex: number;
-  scale: number;
+  zoom: number;
+  devicePixelRatio?: number;
+  annotations?: boolean;
+  rotation?: PdfViewRotation;
+  filter?: PdfViewFilter;
+  refine?: boolean;
 }
 
+type PdfViewRotation = 0 | 90 | 180 | 270;
+
+type PdfViewFilter = 'none' | 'invert' | 'dark' | 'contrast';
+
 interface PdfRenderResult {
   image: Uint8Array;
   width: number;
   height: number;
+  scale: number;
 }
 
 interface PdfListObjectsPayload {
@@ -64,15 +74,231 @@ interface PageObject {
   text?: string;
 }
 
+interface PdfCharGeometryPayload {
+  docId: string;
+  pageIndex: number;
+  start?: number;
+  count?: number;
+}
+
+interface PdfCharGeometry {
+  version: number;
+  start: number;
+  count: number;
+  /** left, top, right, bottom per char, PDF points (bottom-left origin). */
+  boxes: Float32Array;
+  codepoints: Uint32Array;
+  /** Flat [start, end) char index pairs. */
+  lines: Uint32Array;
+  words: Uint32Array;
+}
+
 interface PdfEditTextPayload {
   docId: string;
   pageIndex: number;
   objectId: number;
   newText: string;
+  /** Standard-14 name or a `fontRef` from loadFont. */
   fontName?: string;
   fontSize?: number;
 }
 
+interface PdfLoadFontPayload {
+  docId: string;
+  data: Uint8Array;
+  cid?: boolean;
+}
+
+interface PdfLoadFontResult {
+  fontRef: string;
+}
+
+interface PdfMeasureTextPayload {
+  docId: string;
+  pageIndex: number;
+  objectId?: number;
+  font?: string;
+  text: string;
+  size?: number;
+}
+
+interface PdfTextMetrics {
+  width: number;
+  ascent: number;
+  descent: number;
+  advances: Float32Array;
+}
+
+type PdfMatrix = [number, number, number, number, number, number];
+
+interface PdfTransformObjectPayload {
+  docId: string;
+  pageIndex: number;
+  objectId: number;
+  matrix: PdfMatrix;
+}
+
+interface PdfPixelRect {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+}
+
+interface PdfDragBeginPayload {
+  docId: string;
+  pageIndex: number;
+  objectId: number;
+  scale: number;
+  filter?: PdfViewFilter;
+}
+
+interface PdfDragBeginResult {
+  sessionId: number;
+  image: Uint8Array;
+  width: number;
+  height: number;
+  sprite: PdfPixelRect;
+}
+
+interface PdfDragPreviewPayload {
+  sessionId: number;
+  rect: PdfPixelRect;
+}
+
+interface PdfDragPreviewResult extends PdfPixelRect {
+  image: Uint8Array;
+}
+
+interface PdfInkStyle {
+  color?: [number, number, number, number];
+  width?: number;
+}
+
+interface PdfInkBeginPayload {
+  docId: string;
+  pageIndex: number;
+  zoom: number;
+  devicePixelRatio?: number;
+  annotations?: boolean;
+  filter?: PdfViewFilter;
+  style?: PdfInkStyle;
+}
+
+interface PdfInkAppendPayload {
+  sessionId: number;
+  points: Float32Array;
+}
+
+interface PdfInkPatch extends PdfPixelRect {
+  image: Uint8Array;
+}
+
+interface PdfInkStroke {
+  points: Float32Array;
+  color: [number, number, number, number];
+  width: number;
+}
+
+interface PdfAddInkPayload {
+  docId: string;
+  pageIndex: number;
+  stroke: PdfInkStroke;
+}
+
+interface PdfRemoveAnnotationPayload {
+  docId: string;
+  pageIndex: number;
+  annotIndex: number;
+}
+
+interface PdfOutlineChildrenPayload {
+  docId: string;
+  nodeRef: number;
+  start?: number;
+  limit?: number;
+}
+
+interface PdfOutlineBatch {
+  total: number;
+  start: number;
+  count: number;
+  ids: Uint32Array;
+  flags: Uint8Array;
+  pages: Int32Array;
+  points: Float32Array;
+  titles: string;
+  titleOffsets: Uint32Array;
+}
+
+interface PdfThumbnailsPayload {
+  docId: string;
+  first: number;
+  count: number;
+  maxWidth?: number;
+  maxHeight?: number;
+  render?: boolean;
+}
+
+interface PdfThumbnailBatch {
+  first: number;
+  count: number;
+  widths: Uint16Array;
+  heights: Uint16Array;
+  offsets: Uint32Array;
+  data: Uint8Array;
+}
+
+interface PdfBuildThumbnailsPayload {
+  docId: string;
+  maxWidth?: number;
+  maxHeight?: number;
+  pages?: number[];
+}
+
+interface PdfBuildThumbnailsResult {
+  built: number;
+  current: number;
+  failed: number;
+  cancelled: boolean;
+}
+
+interface PdfListAnnotationsPayload {
+  docId: string;
+  pages?: number[];
+}
+
+interface PdfAnnotationColumns {
+  count: number;
+  pages: Uint32Array;
+  indices: Uint32Array;
+  subtypes: Uint8Array;
+  rects: Float32Array;
+  flags: Uint32Array;
+  colors: Uint8Array;
+  contents: string;
+  contentsOffsets: Uint32Array;
+}
+
+interface PdfAnnotationUpdate {
+  pageIndex: number;
+  index: number;
+  rect?: [number, number, number, number];
+  flags?: number;
+  color?: [number, number, number, number];
+  contents?: string;
+}
+
+interface PdfUpdateAnnotationsPayload {
+  docId: string;
+  updates: PdfAnnotationUpdate[];
+}
+
+interface PdfUpdateAnnotationsResult {
+  updated: number;
+  failed: number[];
+}
+
 interface PdfReplaceImagePayload {
   docId: string;
   pageIndex: number;
@@ -81,6 +307,22 @@ interface PdfReplaceImagePayload {
   format: 'png' | 'jpeg';
 }
 
+interface PdfImagePreviewPayload {
+  docId: string;
+  pageIndex: number;
+  objectId: number;
+  maxEdge?: number;
+}
+
+interface PdfImagePreview {
+  width: number;
+  height: number;
+  image: Uint8Array;
+  pixelWidth: number;
+  pixelHeight: number;
+  cached: boolean;
+}
+
 interface PdfSavePayload {
   docId: string;
 }
@@ -89,17 +331,402 @@ interface PdfSaveResult {
   data: Uint8Array;
 }
 
+interface PdfImageFingerprint {
+  pixelWidth: number;
+  pixelHeight: number;
+  hash: string;
+}
+
+type PdfMacroStep =
+  | {
+      op: 'edit-text';
+      pageIndex: number;
+      scope: 'page' | 'document';
+      match: string;
+      newText: string;
+      fontName?: string;
+      fontSize?: number;
+    }
+  | {
+      op: 'replace-image';
+      pageIndex: number;
+      scope: 'page' | 'document';
+      match: PdfImageFingerprint;
+      image: string;
+      format: 'jpeg' | 'bgra';
+      width?: number;
+      height?: number;
+    };
+
+interface PdfMacro {
+  version: 1;
+  steps: PdfMacroStep[];
+}
+
+interface PdfMacroReplayPayload {
+  macro: PdfMacro;
+  inputDir: string;
+  outputDir: string;
+}
+
+interface PdfMacroDocumentResult {
+  file: string;
+  ok: boolean;
+  edits: number;
+  unmatchedSteps: number;
+  elapsedMs: number;
+  error?: string;
+}
+
+interface PdfMacroReplayResult {
+  documents: PdfMacroDocumentResult[];
+  succeeded: number;
+  failed: number;
+  elapsedMs: number;
+  cancelled: boolean;
+}
+
+interface PdfSignPreparePayload {
+  docId: string;
+  outputPath: string;
+  placeholderSize?: number;
+  fieldName?: string;
+  name?: string;
+  reason?: string;
+  location?: string;
+}
+
+type PdfSignByteRange = [number, number, number, number];
+
+interface PdfSignPrepareResult {
+  outputPath: string;
+  byteRange: PdfSignByteRange;
+  digest: string;
+}
+
+interface PdfSignEmbedPayload {
+  outputPath: string;
+  byteRange: PdfSignByteRange;
+  signature: Uint8Array;
+}
+
+type PdfJobKind =
+  | 'flatten'
+  | 'rasterize'
+  | 'redact'
+  | 'find-replace'
+  | 'mail-merge'
+  | 'macro-replay'
+  | 'analyze'
+  | 'extract-images'
+  | 'image-previews'
+  | 'thumbnails'
+  | 'compare'
+  | 'ocr';
+
+type PdfRateUnit = 'pages' | 'documents';
+
+interface PdfJobProgressPayload {
+  docId: string;
+  job: PdfJobKind;
+  done: number;
+  total: number;
+  rate?: number;
+  rateUnit?: PdfRateUnit;
+}
+
+interface PdfCancelJobPayload {
+  docId: string;
+  job: PdfJobKind;
+}
+
+interface PdfFlattenPayload {
+  docId: string;
+  annotations?: boolean;
+  forms?: boolean;
+  print?: boolean;
+  pages?: number[];
+}
+
+interface PdfFlattenResult {
+  flattened: number;
+  unchanged: number;
+  skipped: number[];
+  failed: number[];
+  cancelled: boolean;
+}
+
+interface PdfRasterizePayload {
+  docId: string;
+  pages?: number[];
+  dpi?: number;
+  format?: 'color' | 'gray';
+  slowest?: number;
+}
+
+interface PdfRasterizeResult {
+  rasterized: number[];
+  failed: number[];
+  profile?: { pages: number[]; ms: number[] };
+  cancelled: boolean;
+}
+
+interface PdfRedactPayload {
+  docId: string;
+  outputPath: string;
+  terms?: string[];
+  patterns?: string[];
+  caseSensitive?: boolean;
+  wholeWord?: boolean;
+  boxes?: boolean;
+  pages?: number[];
+}
+
+interface PdfRedactResumePayload {
+  outputPath: string;
+}
+
+interface PdfRedactResult {
+  matches: number;
+  textObjectsRemoved: number;
+  imagesClipped: number;
+  unremovedChars: number;
+  skipped: number;
+  pages: Array<{ pageIndex: number; matches: number }>;
+  outputPath?: string;
+  pagesProcessed: number;
+  elapsedMs: number;
+  pagesPerSecond: number;
+  cancelled: boolean;
+}
+
+interface PdfFindReplacePayload {
+  docId: string;
+  pattern: string;
+  replacement: string;
+  regex?: boolean;
+  caseSensitive?: boolean;
+  wholeWord?: boolean;
+  pages?: number[];
+}
+
+interface PdfFindReplaceResult {
+  matches: number;
+  replaced: number;
+  skipped: number;
+  objectsChanged: number;
+  pages: Array<{ pageIndex: number; replaced: number }>;
+  cancelled: boolean;
+}
+
+interface PdfMailMergePayload {
+  templatePath: string;
+  records: Array<Record<string, string | number | boolean>>;
+  outputDir: string;
+  fileNameField?: string;
+  flatten?: boolean;
+  password?: string;
+}
+
+interface PdfMailMergeResult {
+  written: number;
+  failed: Array<{ record: number; error: string }>;
+  unknownFields: string[];
+  elapsedMs: number;
+  documentsPerMinute: number;
+  cancelled: boolean;
+}
+
+interface PdfAnalyzePayload {
+  paths: string[];
+  threads?: number;
+  hashStreams?: boolean;
+}
+
+interface PdfImageInventoryEntry {
+  object: number;
+  width: number;
+  height: number;
+  bitsPerComponent: number;
+  colorSpace: string;
+  filter: string;
+  bytes: number;
+}
+
+interface PdfFontInventoryEntry {
+  object: number;
+  baseFont: string;
+  subtype: string;
+  embedded: boolean;
+}
+
+interface PdfPageComplexity {
+  operators: Uint32Array;
+  pathSegments: Uint32Array;
+  paints: Uint32Array;
+  textShows: Uint32Array;
+  images: Uint32Array;
+}
+
+interface PdfFileStructure {
+  path: string;
+  version: string;
+  fileSize: number;
+  xref: 'table' | 'stream' | 'rebuilt';
+  encrypted: boolean;
+  objects: number;
+  streams: number;
+  streamBytes: number;
+  filters: Record<string, number>;
+  images: PdfImageInventoryEntry[];
+  fonts: PdfFontInventoryEntry[];
+  streamHashes?: Array<{ object: number; hash: string }>;
+  pageCount: number;
+  pages: PdfPageComplexity;
+}
+
+type PdfFileAnalysis = PdfFileStructure | { path: string; error: string };
+
+interface PdfAnalyzeResult {
+  files: PdfFileAnalysis[];
+  elapsedMs: number;
+  cancelled: boolean;
+}
+
+interface PdfExtractImagesPayload {
+  docId: string;
+  outDir: string;
+  pages?: number[];
+  threads?: number;
+}
+
+interface PdfPrefetchImagePreviewsPayload {
+  docId: string;
+  pages?: number[];
+  maxEdge?: number;
+}
+
+interface PdfPrefetchImagePreviewsResult {
+  decoded: number;
+  cancelled: boolean;
+}
+
+interface PdfExtractedImage {
+  pageIndex: number;
+  objectIndex: number;
+  path: string;
+  format: 'jpeg' | 'jp2' | 'png';
+  passthrough: boolean;
+}
+
+interface PdfExtractImagesResult {
+  files: PdfExtractedImage[];
+  failed: Array<{ pageIndex: number; objectIndex: number; error: string }>;
+  cancelled: boolean;
+}
+
+interface PdfCompareDocumentsPayload {
+  docIdA: string;
+  docIdB: string;
+  dpi?: number;
+  pairs?: Array<[number, number]>;
+  threshold?: number;
+  mergeDistance?: number;
+}
+
+interface PdfComparePageDiff {
+  pageA: number;
+  pageB: number;
+  changedPixels: number;
+  boxes: Float32Array;
+  boxPixels: Uint32Array;
+}
+
+interface PdfComparePageEvent extends PdfComparePageDiff {
+  docIdA: string;
+  docIdB: string;
+  heatmap: Uint8Array;
+  heatmapWidth: number;
+  heatmapHeight: number;
+  cellPoints: number;
+}
+
+interface PdfCompareResult {
+  pages: PdfComparePageDiff[];
+  changedPages: number;
+  cancelled: boolean;
+}
+
+interface PdfOcrPayload {
+  docId: string;
+  pages?: number[];
+  all?: boolean;
+  language?: string;
+  dpi?: number;
+  minConfidence?: number;
+  font?: string;
+}
+
+interface PdfOcrResult {
+  recognised: number;
+  skipped: number;
+  words: number;
+  failed: Array<{ pageIndex: number; error: string }>;
+  elapsedMs: number;
+  pagesPerMinute: number;
+  cancelled: boolean;
+}
+
 // ── PDF sub-API surface ─────────────────────────────────────────────
 
 interface PdfApi {
   open(payload: PdfOpenPayload): Promise<PdfOpenResult>;
   close(docId: string): Promise<void>;
   getPageCount(docId: string): Promise<number>;
+  outlineChildren(payload: PdfOutlineChildrenPayload): Promise<PdfOutlineBatch>;
+  thumbnails(payload: PdfThumbnailsPayload): Promise<PdfThumbnailBatch>;
   renderPage(payload: PdfRenderPagePayload): Promise<PdfRenderResult>;
   listObjects(payload: PdfListObjectsPayload): Promise<PageObject[]>;
+  charGeometry(payload: PdfCharGeometryPayload): Promise<PdfCharGeometry>;
   editText(payload: PdfEditTextPayload): Promise<{ ok: true }>;
+  loadFont(payload: PdfLoadFontPayload): Promise<PdfLoadFontResult>;
+  measureText(payload: PdfMeasureTextPayload): Promise<PdfTextMetrics>;
   replaceImage(payload: PdfReplaceImagePayload): Promise<{ ok: true }>;
+  imagePreview(payload: PdfImagePreviewPayload): Promise<PdfImagePreview>;
+  transformObject(payload: PdfTransformObjectPayload): Promise<{ ok: true }>;
+  dragBegin(payload: PdfDragBeginPayload): Promise<PdfDragBeginResult>;
+  dragPreview(payload: PdfDragPreviewPayload): Promise<PdfDragPreviewResult>;
+  dragEnd(sessionId: number): Promise<PdfMatrix | null>;
+  inkBegin(payload: PdfInkBeginPayload): Promise<number>;
+  inkAppend(payload: PdfInkAppendPayload): Promise<PdfInkPatch>;
+  inkEnd(sessionId: number): Promise<PdfInkStroke | null>;
+  addInk(payload: PdfAddInkPayload): Promise<number>;
+  removeAnnotation(payload: PdfRemoveAnnotationPayload): Promise<{ ok: true }>;
+  listAnnotations(payload: PdfListAnnotationsPayload): Promise<PdfAnnotationColumns>;
+  updateAnnotations(payload: PdfUpdateAnnotationsPayload): Promise<PdfUpdateAnnotationsResult>;
   save(payload: PdfSavePayload): Promise<PdfSaveResult>;
+  signPrepare(payload: PdfSignPreparePayload): Promise<PdfSignPrepareResult>;
+  signEmbed(payload: PdfSignEmbedPayload): Promise<void>;
+  macroStart(docId: string): Promise<void>;
+  macroStop(docId: string): Promise<PdfMacro>;
+  macroReplay(payload: PdfMacroReplayPayload): Promise<PdfMacroReplayResult>;
+  flatten(payload: PdfFlattenPayload): Promise<PdfFlattenResult>;
+  rasterize(payload: PdfRasterizePayload): Promise<PdfRasterizeResult>;
+  redact(payload: PdfRedactPayload): Promise<PdfRedactResult>;
+  resumeRedact(payload: PdfRedactResumePayload): Promise<PdfRedactResult>;
+  findReplace(payload: PdfFindReplacePayload): Promise<PdfFindReplaceResult>;
+  mailMerge(payload: PdfMailMergePayload): Promise<PdfMailMergeResult>;
+  analyzeFiles(payload: PdfAnalyzePayload): Promise<PdfAnalyzeResult>;
+  extractImages(payload: PdfExtractImagesPayload): Promise<PdfExtractImagesResult>;
+  buildThumbnails(payload: PdfBuildThumbnailsPayload): Promise<PdfBuildThumbnailsResult>;
+  prefetchImagePreviews(
+    payload: PdfPrefetchImagePreviewsPayload,
+  ): Promise<PdfPrefetchImagePreviewsResult>;
+  compareDocuments(payload: PdfCompareDocumentsPayload): Promise<PdfCompareResult>;
+  ocr(payload: PdfOcrPayload): Promise<PdfOcrResult>;
+  cancelJob(payload: PdfCancelJobPayload): Promise<boolean>;
+  onJobProgress(callback: (payload: PdfJobProgressPayload) => void): () => void;
+  onComparePage(callback: (payload: PdfComparePageEvent) => void): () => void;
   onPageRendered(callback: (payload: { docId: string; pageIndex: number }) => void): () => void;
 }
 
@@ -47,9 +47,47 @@ export const RENDER_CONCURRENCY_LIMIT = 4;
 /** Maximum allowed image size (bytes) for image replacement. */
 export const MAX_IMAGE_BYTES = 20 * 1024 * 1024; // 20 MB
 
+/** Pages redacted between checkpoints of a resumable redaction run. */
+export const REDACTION_CHECKPOINT_PAGES = 500;
+
+/** Upper bound on PDFium worker processes used for batch jobs. */
+export const MAX_PDF_WORKERS = 4;
+
+/** Records handed to one worker at a time during a mail merge. */
+export const MAIL_MERGE_BATCH_RECORDS = 250;
+
+/** Documents handed to one worker at a time during a macro replay. */
+export const MACRO_BATCH_DOCUMENTS = 25;
+
+/** Resolution scanned pages are rendered at for OCR. */
+export const DEFAULT_OCR_DPI = 300;
+
+/** OCR words below this confidence (0–100) stay out of the text layer. */
+export const DEFAULT_OCR_MIN_CONFIDENCE = 30;
+
+/**
+ * Pages rendered for OCR per native job.  Rendering waits while more
+ * pages than this are queued for recognition, which bounds the images
+ * on disk for long documents.
+ */
+export const OCR_RENDER_CHUNK_PAGES = 16;
+
 /** Default render scale (1.0 = 72 DPI, matching PDF points). */
 export const DEFAULT_RENDER_SCALE = 1.5;
 
+/**
+ * Scales pages are rasterised at (device pixels per PDF point).  A view
+ * at zoom × device pixel ratio renders at the next bucket up and the
+ * compositor shrinks the rest, so nearby zooms and windows moving
+ * between displays share cached bitmaps.  Neighbours are at most 25%
+ * apart and the usual zoom and DPR products land exactly.
+ */
+export const RENDER_SCALE_BUCKETS = [
+  0.25, 0.3125, 0.375, 0.4375, 0.5, 0.625, 0.75, 0.875,
+  1, 1.125, 1.25, 1.5, 1.75, 2, 2.25, 2.5, 3, 3.5,
+  4, 5, 6, 7, 8, 10, 12, 14, 16,
+];
+
 /** Zoom bounds for the viewer (percentage converted to scale internally). */
 export const MIN_ZOOM_PERCENT = 25;
 export const MAX_ZOOM_PERCENT = 500;
@@ -37,14 +37,61 @@ export const IPC_CHANNELS = {
   PDF_OPEN: 'pdf:open',
   PDF_CLOSE: 'pdf:close',
   PDF_GET_PAGE_COUNT: 'pdf:get-page-count',
+  PDF_OUTLINE_CHILDREN: 'pdf:outline-children',
+  PDF_THUMBNAILS: 'pdf:thumbnails',
   PDF_RENDER_PAGE: 'pdf:render-page',
   PDF_LIST_OBJECTS: 'pdf:list-objects',
+  PDF_CHAR_GEOMETRY: 'pdf:char-geometry',
   PDF_EDIT_TEXT: 'pdf:edit-text',
+  PDF_LOAD_FONT: 'pdf:load-font',
+  PDF_MEASURE_TEXT: 'pdf:measure-text',
   PDF_REPLACE_IMAGE: 'pdf:replace-image',
+  PDF_IMAGE_PREVIEW: 'pdf:image-preview',
+  PDF_TRANSFORM_OBJECT: 'pdf:transform-object',
   PDF_SAVE: 'pdf:save',
 
+  // PDF engine — layered drag previews
+  PDF_DRAG_BEGIN: 'pdf:drag-begin',
+  PDF_DRAG_PREVIEW: 'pdf:drag-preview',
+  PDF_DRAG_END: 'pdf:drag-end',
+
+  // PDF engine — ink capture & annotations
+  PDF_INK_BEGIN: 'pdf:ink-begin',
+  PDF_INK_APPEND: 'pdf:ink-append',
+  PDF_INK_END: 'pdf:ink-end',
+  PDF_ADD_INK: 'pdf:add-ink',
+  PDF_REMOVE_ANNOTATION: 'pdf:remove-annotation',
+  PDF_LIST_ANNOTATIONS: 'pdf:list-annotations',
+  PDF_UPDATE_ANNOTATIONS: 'pdf:update-annotations',
+
+  // PDF engine — digital signatures
+  PDF_SIGN_PREPARE: 'pdf:sign-prepare',
+  PDF_SIGN_EMBED: 'pdf:sign-embed',
+
+  // PDF engine — edit macros
+  PDF_MACRO_START: 'pdf:macro-start',
+  PDF_MACRO_STOP: 'pdf:macro-stop',
+  PDF_MACRO_REPLAY: 'pdf:macro-replay',
+
+  // PDF engine — background document passes
+  PDF_FLATTEN: 'pdf:flatten',
+  PDF_RASTERIZE: 'pdf:rasterize',
+  PDF_CANCEL_JOB: 'pdf:cancel-job',
+  PDF_REDACT: 'pdf:redact',
+  PDF_REDACT_RESUME: 'pdf:redact-resume',
+  PDF_FIND_REPLACE: 'pdf:find-replace',
+  PDF_MAIL_MERGE: 'pdf:mail-merge',
+  PDF_ANALYZE: 'pdf:analyze',
+  PDF_EXTRACT_IMAGES: 'pdf:extract-images',
+  PDF_BUILD_THUMBNAILS: 'pdf:build-thumbnails',
+  PDF_PREFETCH_IMAGE_PREVIEWS: 'pdf:prefetch-image-previews',
+  PDF_COMPARE_DOCUMENTS: 'pdf:compare-documents',
+  PDF_OCR: 'pdf:ocr',
+
   // PDF events (main → renderer)
   PDF_PAGE_RENDERED: 'pdf:page-rendered',
+  PDF_JOB_PROGRESS: 'pdf:job-progress',
+  PDF_COMPARE_PAGE: 'pdf:compare-page',
 } as const;
 
 /** Union of all allowed channel names. */
@@ -100,18 +147,146 @@ export interface PdfOpenResult {
 export interface PdfRenderPagePayload {
   docId: string;
   pageIndex: number;
-  /** Device-pixel scale (e.g. 1.0 = 72 dpi, 2.0 = 144 dpi). */
-  scale: number;
+  /** Logical zoom: CSS pixels per PDF point (1.0 = 100%). */
+  zoom: number;
+  /**
+   * Device pixels per CSS pixel.  Default 1.  The page is rendered at
+   * zoom × devicePixelRatio rounded up to a RENDER_SCALE_BUCKETS entry.
+   */
+  devicePixelRatio?: number;
+  /** Draw annotations over the page content. Default true. */
+  annotations?: boolean;
+  /** View rotation, clockwise. Default 0. */
+  rotation?: PdfViewRotation;
+  /** Reading mode, applied to the cached raster on the way out. Default 'none'. */
+  filter?: PdfViewFilter;
+  /**
+   * Rasterise at the requested rotation through PDFium instead of
+   * turning cached pixels.  Only sub-pixel (LCD) text differs.
+   */
+  refine?: boolean;
 }
 
+/** Clockwise view rotation in degrees. */
+export type PdfViewRotation = 0 | 90 | 180 | 270;
+
+/**
+ * Reading modes: colours inverted; dark (lightness inverted, hues
+ * kept, on dark grey); high contrast.  Per-pixel filters over the
+ * rendered raster, so switching modes never re-renders a page.
+ */
+export type PdfViewFilter = 'none' | 'invert' | 'dark' | 'contrast';
+
+/**
+ * Separately rendered and cached parts of a page: the content without
+ * annotations, the annotations alone, and both drawn in one pass
+ * (used when the annotations cannot be separated from the content).
+ */
+export type PdfRenderLayer = 'page' | 'content' | 'annotations';
+
 /** Result of a page render. */
 export interface PdfRenderResult {
   /** RGBA bitmap encoded as PNG bytes for transfer. */
   image: Uint8Array;
-  /** Page width in PDF points. */
+  /** Bitmap width in device pixels. */
   width: number;
-  /** Page height in PDF points. */
+  /** Bitmap height in device pixels. */
   height: number;
+  /**
+   * Scale the bitmap was rendered at (device pixels per PDF point).
+   * Display it at width × zoom / scale CSS pixels.
+   */
+  scale: number;
+}
+
+/** Payload for expanding one node of the document outline. */
+export interface PdfOutlineChildrenPayload {
+  docId: string;
+  /** Node ref from an earlier batch; 0 is the root. */
+  nodeRef: number;
+  /** First child to return. Default 0. */
+  start?: number;
+  /** Most children to return. Default 512. */
+  limit?: number;
+}
+
+/** Bits of PdfOutlineBatch.flags. */
+export const PDF_OUTLINE_FLAGS = {
+  HAS_CHILDREN: 1,
+  /** The file asks for the node to start expanded. */
+  OPEN: 2,
+  /** Action leaves the document (URI, launch, remote go-to). */
+  EXTERNAL: 4,
+} as const;
+
+/**
+ * A run of an outline node's children, one row per child across the
+ * columns, so even huge outlines cross IPC as a few typed arrays.
+ */
+export interface PdfOutlineBatch {
+  /** The node's child count. */
+  total: number;
+  start: number;
+  count: number;
+  /** Node refs, to expand in turn. */
+  ids: Uint32Array;
+  flags: Uint8Array;
+  /** Destination page, or -1. */
+  pages: Int32Array;
+  /** x, y (PDF points) and zoom per row; NaN where unspecified. */
+  points: Float32Array;
+  /** All titles; row i is titles.slice(titleOffsets[i], titleOffsets[i + 1]). */
+  titles: string;
+  titleOffsets: Uint32Array;
+}
+
+/** Thumbnail box in device pixels; one store per document and size. */
+export interface PdfThumbnailSize {
+  /** Default 160. */
+  maxWidth?: number;
+  /** Default 200. */
+  maxHeight?: number;
+}
+
+/** Payload for reading a run of page thumbnails. */
+export interface PdfThumbnailsPayload extends PdfThumbnailSize {
+  docId: string;
+  first: number;
+  count: number;
+  /** Render missing or stale thumbnails first (for pages on screen). Default false. */
+  render?: boolean;
+}
+
+/**
+ * Thumbnails of pages first .. first + count as PNG files, one row per
+ * page across the columns.  Page first + i is
+ * data.subarray(offsets[i], offsets[i + 1]), empty until it is built.
+ */
+export interface PdfThumbnailBatch {
+  first: number;
+  count: number;
+  widths: Uint16Array;
+  heights: Uint16Array;
+  offsets: Uint32Array;
+  data: Uint8Array;
+}
+
+/** Payload for filling the thumbnail store in the background. */
+export interface PdfBuildThumbnailsPayload extends PdfThumbnailSize {
+  docId: string;
+  /** Page indices (default: all pages). */
+  pages?: number[];
+}
+
+/** Result of filling the thumbnail store. */
+export interface PdfBuildThumbnailsResult {
+  /** Thumbnails rendered. */
+  built: number;
+  /** Thumbnails that were already up to date. */
+  current: number;
+  /** Pages that could not be rendered. */
+  failed: number;
+  cancelled: boolean;
 }
 
 /** Payload for listing page objects (text & image). */
@@ -120,6 +295,32 @@ export interface PdfListObjectsPayload {
   pageIndex: number;
 }
 
+/** Payload for fetching character geometry; omit the range for the whole page. */
+export interface PdfCharGeometryPayload {
+  docId: string;
+  pageIndex: number;
+  start?: number;
+  count?: number;
+}
+
+/**
+ * Geometry of chars `start … start + count - 1` of a page's text, in
+ * one transfer.  Unchanged until the page is edited, which bumps
+ * `version`.
+ */
+export interface PdfCharGeometry {
+  version: number;
+  start: number;
+  count: number;
+  /** left, top, right, bottom per char, PDF points (bottom-left origin). */
+  boxes: Float32Array;
+  codepoints: Uint32Array;
+  /** Flat [start, end) char index pairs of lines overlapping the range. */
+  lines: Uint32Array;
+  /** Flat [start, end) char index pairs of whitespace-delimited words. */
+  words: Uint32Array;
+}
+
 /** Classification of a page object. */
 export type PageObjectType = 'text' | 'image' | 'path' | 'shading' | 'form';
 
@@ -142,10 +343,50 @@ export interface PdfEditTextPayload {
   pageIndex: number;
   objectId: number;
   newText: string;
+  /** Standard-14 name ("Helvetica", "Times-Bold"…) or a `fontRef` from PDF_LOAD_FONT. */
   fontName?: string;
   fontSize?: number;
 }
 
+/** Payload for loading a TrueType/OpenType font into a document once. */
+export interface PdfLoadFontPayload {
+  docId: string;
+  data: Uint8Array;
+  /** CID-keyed encoding, for text outside Latin-1. Default false. */
+  cid?: boolean;
+}
+
+/** Reference to a loaded font, usable as `fontName` in text edits. */
+export interface PdfLoadFontResult {
+  fontRef: string;
+}
+
+/**
+ * Payload for measuring text in an object's font (`objectId`) or in a
+ * standard-14 name / `fontRef` (`font`, which then requires `size`).
+ */
+export interface PdfMeasureTextPayload {
+  docId: string;
+  pageIndex: number;
+  objectId?: number;
+  font?: string;
+  text: string;
+  /** Points; defaults to the object's font size. */
+  size?: number;
+}
+
+/**
+ * Text metrics in PDF points.  For an object, widths include the
+ * horizontal scale of its matrix.  No kerning or char spacing.
+ */
+export interface PdfTextMetrics {
+  width: number;
+  ascent: number;
+  descent: number;
+  /** One advance per UTF-16 code unit (0 for trailing surrogates). */
+  advances: Float32Array;
+}
+
 /** Payload for replacing an image object. */
 export interface PdfReplaceImagePayload {
   docId: string;
@@ -155,6 +396,181 @@ export interface PdfReplaceImagePayload {
   format: 'png' | 'jpeg';
 }
 
+/** Payload for a downsampled preview of an image object. */
+export interface PdfImagePreviewPayload {
+  docId: string;
+  pageIndex: number;
+  objectId: number;
+  /** Longest side of the preview in pixels. Default 512. */
+  maxEdge?: number;
+}
+
+/** An image object's own pixels, scaled down; shared by every placement. */
+export interface PdfImagePreview {
+  width: number;
+  height: number;
+  /** Tightly packed RGBA. */
+  image: Uint8Array;
+  /** Full size of the image. */
+  pixelWidth: number;
+  pixelHeight: number;
+  /** Served from the preview cache without decoding. */
+  cached: boolean;
+}
+
+/** PDF-space matrix `[a, b, c, d, e, f]`. */
+export type PdfMatrix = [number, number, number, number, number, number];
+
+/** Payload for moving or resizing an object. */
+export interface PdfTransformObjectPayload {
+  docId: string;
+  pageIndex: number;
+  objectId: number;
+  /** Concatenated onto the object's current transform. */
+  matrix: PdfMatrix;
+}
+
+/** Rectangle in page pixels (top-left origin) at the drag's scale. */
+export interface PdfPixelRect {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+}
+
+/** Payload for starting a drag or resize preview. */
+export interface PdfDragBeginPayload {
+  docId: string;
+  pageIndex: number;
+  objectId: number;
+  scale: number;
+  /** The view's reading mode; the layers and patches come back filtered. */
+  filter?: PdfViewFilter;
+}
+
+/** Layers rendered once at the start of a drag. */
+export interface PdfDragBeginResult {
+  sessionId: number;
+  /** RGBA page without the dragged object. */
+  image: Uint8Array;
+  width: number;
+  height: number;
+  /** Where the object sits now. */
+  sprite: PdfPixelRect;
+}
+
+/** Payload for one preview frame: where the object should appear. */
+export interface PdfDragPreviewPayload {
+  sessionId: number;
+  rect: PdfPixelRect;
+}
+
+/** RGBA patch to draw at (x, y); covers the old and new positions. */
+export interface PdfDragPreviewResult extends PdfPixelRect {
+  image: Uint8Array;
+}
+
+/** Ink colour (0–255 per component, alpha last) and width in points. */
+export interface PdfInkStyle {
+  color?: [number, number, number, number];
+  width?: number;
+}
+
+/** Payload for starting a freehand stroke on the page as displayed. */
+export interface PdfInkBeginPayload {
+  docId: string;
+  pageIndex: number;
+  /** The view's zoom and device pixel ratio; points are in its raster's pixels. */
+  zoom: number;
+  devicePixelRatio?: number;
+  /** Whether annotations are shown, so the stroke draws over the same raster. */
+  annotations?: boolean;
+  /** The view's reading mode; patches come back filtered. */
+  filter?: PdfViewFilter;
+  style?: PdfInkStyle;
+}
+
+/** Payload for appending stroke points: x, y pairs in page pixels. */
+export interface PdfInkAppendPayload {
+  sessionId: number;
+  points: Float32Array;
+}
+
+/** RGBA patch to draw at (x, y): the page with the stroke so far. */
+export interface PdfInkPatch extends PdfPixelRect {
+  image: Uint8Array;
+}
+
+/** A finished stroke: x, y pairs in PDF points. */
+export interface PdfInkStroke {
+  points: Float32Array;
+  color: [number, number, number, number];
+  width: number;
+}
+
+/** Payload for committing a stroke as an ink annotation. */
+export interface PdfAddInkPayload {
+  docId: string;
+  pageIndex: number;
+  stroke: PdfInkStroke;
+}
+
+/** Payload for removing an annotation by index. */
+export interface PdfRemoveAnnotationPayload {
+  docId: string;
+  pageIndex: number;
+  annotIndex: number;
+}
+
+/** Payload for listing annotations; all pages when `pages` is omitted. */
+export interface PdfListAnnotationsPayload {
+  docId: string;
+  pages?: number[];
+}
+
+/**
+ * Annotations as columns, one row per annotation, so that tens of
+ * thousands cross IPC as a handful of typed arrays.
+ */
+export interface PdfAnnotationColumns {
+  count: number;
+  pages: Uint32Array;
+  /** Index on its page, as used by update/remove. */
+  indices: Uint32Array;
+  /** FPDF_ANNOT_* subtype. */
+  subtypes: Uint8Array;
+  /** left, top, right, bottom per row, PDF points. */
+  rects: Float32Array;
+  flags: Uint32Array;
+  /** RGBA per row; alpha 0 when the colour is not known. */
+  colors: Uint8Array;
+  /** All /Contents strings; row i is contents.slice(offsets[i], offsets[i + 1]). */
+  contents: string;
+  contentsOffsets: Uint32Array;
+}
+
+/** Fields to change on one annotation; omitted fields stay. */
+export interface PdfAnnotationUpdate {
+  pageIndex: number;
+  index: number;
+  rect?: [number, number, number, number];
+  flags?: number;
+  color?: [number, number, number, number];
+  contents?: string;
+}
+
+/** Payload for updating many annotations in one call. */
+export interface PdfUpdateAnnotationsPayload {
+  docId: string;
+  updates: PdfAnnotationUpdate[];
+}
+
+/** Outcome of a batched update; `failed` holds positions in `updates`. */
+export interface PdfUpdateAnnotationsResult {
+  updated: number;
+  failed: number[];
+}
+
 /** Payload for saving a document. */
 export interface PdfSavePayload {
   docId: string;
@@ -166,6 +582,589 @@ export interface PdfSaveResult {
   data: Uint8Array;
 }
 
+// ── Edit macro types ────────────────────────────────────────────────
+
+/** Identifies an image by content rather than by object index. */
+export interface PdfImageFingerprint {
+  pixelWidth: number;
+  pixelHeight: number;
+  /** Hex digest of the encoded image stream. */
+  hash: string;
+}
+
+/**
+ * Where a macro step looks for its match: only the page it was recorded
+ * on, or every page.
+ */
+export type PdfMacroScope = 'page' | 'document';
+
+/** A recorded edit, replayed against every object whose content matches. */
+export type PdfMacroStep =
+  | {
+      op: 'edit-text';
+      pageIndex: number;
+      scope: PdfMacroScope;
+      /** Exact text of the objects to edit. */
+      match: string;
+      newText: string;
+      fontName?: string;
+      /**
+       * Base64 font file behind a `fontName` from PDF_LOAD_FONT.  Such
+       * references are local to the recorded document, so replay loads
+       * the font into each target and uses the reference it gets back.
+       */
+      fontData?: string;
+      fontSize?: number;
+    }
+  | {
+      op: 'replace-image';
+      pageIndex: number;
+      scope: PdfMacroScope;
+      match: PdfImageFingerprint;
+      /**
+       * Replacement image, base64-encoded so macros serialise as JSON:
+       * JPEG bytes, or PNGs decoded to BGRA at record time so replay
+       * needs no image decoder.
+       */
+      image: string;
+      format: 'jpeg' | 'bgra';
+      /** Pixel size, for `bgra`. */
+      width?: number;
+      height?: number;
+    };
+
+export interface PdfMacro {
+  version: 1;
+  steps: PdfMacroStep[];
+}
+
+/** Payload for replaying a macro over every PDF in a directory. */
+export interface PdfMacroReplayPayload {
+  macro: PdfMacro;
+  inputDir: string;
+  /** Edited copies are written here under their original names. */
+  outputDir: string;
+}
+
+/** Outcome of replaying a macro on one document. */
+export interface PdfMacroDocumentResult {
+  file: string;
+  ok: boolean;
+  /** Objects edited. */
+  edits: number;
+  /** Steps that matched nothing in this document. */
+  unmatchedSteps: number;
+  elapsedMs: number;
+  error?: string;
+}
+
+export interface PdfMacroReplayResult {
+  documents: PdfMacroDocumentResult[];
+  succeeded: number;
+  failed: number;
+  elapsedMs: number;
+  /** True if cancelled; documents not yet started are not listed. */
+  cancelled: boolean;
+}
+
+// ── Background job payload types ────────────────────────────────────
+
+/** Long-running document passes that run off the main thread. */
+export type PdfJobKind =
+  | 'flatten'
+  | 'rasterize'
+  | 'redact'
+  | 'find-replace'
+  | 'mail-merge'
+  | 'macro-replay'
+  | 'analyze'
+  | 'extract-images'
+  | 'image-previews'
+  | 'thumbnails'
+  | 'compare'
+  | 'ocr';
+
+/** What a job's progress rate counts. */
+export type PdfRateUnit = 'pages' | 'documents';
+
+/** Progress event for a running job (main → renderer). */
+export interface PdfJobProgressPayload {
+  /**
+   * Document the job runs on (the template path for mail-merge, the
+   * input directory for macro-replay, ANALYZE_JOB_ID for analyze).
+   */
+  docId: string;
+  job: PdfJobKind;
+  /** Pages processed so far. */
+  done: number;
+  /** Pages the job will visit. */
+  total: number;
+  /** Measured throughput per second, for jobs that report it. */
+  rate?: number;
+  /** What `rate` counts: whole documents for mail-merge and macro-replay. */
+  rateUnit?: PdfRateUnit;
+}
+
+/** Payload for cancelling a running job. */
+export interface PdfCancelJobPayload {
+  /** The docId the job reports progress under (outputPath for a resumed redaction). */
+  docId: string;
+  job: PdfJobKind;
+}
+
+/** What to flatten into page content. */
+export interface PdfFlattenOptions {
+  /** Flatten non-form annotations (comments, stamps, ink…). Default true. */
+  annotations?: boolean;
+  /** Flatten form-field widgets. Default true. */
+  forms?: boolean;
+  /** Use print appearances instead of display appearances. Default false. */
+  print?: boolean;
+  /** Page indices to flatten (default: all pages). */
+  pages?: number[];
+}
+
+/** Payload for flattening a document. */
+export interface PdfFlattenPayload extends PdfFlattenOptions {
+  docId: string;
+}
+
+/** Result of a flatten pass. */
+export interface PdfFlattenResult {
+  /** Pages whose annotations were baked into content. */
+  flattened: number;
+  /** Pages with nothing to flatten. */
+  unchanged: number;
+  /** Pages left alone because they hold an annotation kind not requested. */
+  skipped: number[];
+  /** Pages PDFium failed to load or flatten. */
+  failed: number[];
+  /** True if the job was cancelled before visiting every page. */
+  cancelled: boolean;
+}
+
+/** Which pages to replace with a raster, and at what resolution. */
+export interface PdfRasterizeOptions {
+  /** Candidate page indices (default: all pages). */
+  pages?: number[];
+  /** Raster resolution. Default 150. */
+  dpi?: number;
+  /** 'gray' stores one byte per pixel. Default 'color'. */
+  format?: 'color' | 'gray';
+  /**
+   * Profile the candidates first and rasterise only the N that took
+   * longest to load and render.
+   */
+  slowest?: number;
+}
+
+/** Payload for rasterising pages. */
+export interface PdfRasterizePayload extends PdfRasterizeOptions {
+  docId: string;
+}
+
+/** Result of a rasterise pass. */
+export interface PdfRasterizeResult {
+  /** Pages whose content is now a single image. */
+  rasterized: number[];
+  /** Pages PDFium failed to load, render or rewrite. */
+  failed: number[];
+  /** Load + render time per candidate page, when `slowest` was given. */
+  profile?: { pages: number[]; ms: number[] };
+  /** True if the job was cancelled before visiting every page. */
+  cancelled: boolean;
+}
+
+/** What to find and redact. */
+export interface PdfRedactSpec {
+  /** Literal terms, matched in one pass per page. */
+  terms?: string[];
+  /** ECMAScript regular expressions, matched against page text. */
+  patterns?: string[];
+  /** Match case exactly. Default false. */
+  caseSensitive?: boolean;
+  /** Only match terms bounded by non-word characters. Default false. */
+  wholeWord?: boolean;
+  /** Draw an opaque box over each hit. Default true. */
+  boxes?: boolean;
+  /** Page indices to redact (default: all pages). */
+  pages?: number[];
+}
+
+/** Payload for redacting a document into a new file. */
+export interface PdfRedactPayload extends PdfRedactSpec {
+  docId: string;
+  /** Destination of the redacted copy; checkpoints are kept beside it. */
+  outputPath: string;
+}
+
+/** Payload for resuming an interrupted redaction. */
+export interface PdfRedactResumePayload {
+  /** The `outputPath` of the interrupted run. */
+  outputPath: string;
+}
+
+/** Counts reported by the native redaction pass. */
+export interface PdfRedactStats {
+  /** Term and pattern hits. */
+  matches: number;
+  /** Text objects removed (surviving glyphs are re-created). */
+  textObjectsRemoved: number;
+  /** Image objects whose pixels under a hit were blacked out. */
+  imagesClipped: number;
+  /** Hit chars drawn inside form XObjects — covered by a box only. */
+  unremovedChars: number;
+  /**
+   * Pattern matches too long to search safely (over a few hundred
+   * chars); their text was not redacted.
+   */
+  skipped: number;
+  /** Pages with at least one hit. */
+  pages: Array<{ pageIndex: number; matches: number }>;
+}
+
+/** Result of a redaction run. */
+export interface PdfRedactResult extends PdfRedactStats {
+  /** Where the redacted copy was written (absent if cancelled). */
+  outputPath?: string;
+  /** Pages visited, including those from before a resume. */
+  pagesProcessed: number;
+  /** Wall-clock time spent redacting, including before a resume. */
+  elapsedMs: number;
+  pagesPerSecond: number;
+  /** True if cancelled; the run can be resumed from its checkpoint. */
+  cancelled: boolean;
+}
+
+/** Payload for replacing text throughout an open document. */
+export interface PdfFindReplacePayload {
+  docId: string;
+  pattern: string;
+  /** Replacement text; with `regex`, may refer to groups ($1, $&). */
+  replacement: string;
+  /** Treat `pattern` as an ECMAScript regular expression. Default false. */
+  regex?: boolean;
+  /** Match case exactly. Default false. */
+  caseSensitive?: boolean;
+  /** Only match hits bounded by non-word characters. Default false. */
+  wholeWord?: boolean;
+  /** Page indices to search (default: all pages). */
+  pages?: number[];
+}
+
+/** Change summary of a find-and-replace pass. */
+export interface PdfFindReplaceResult {
+  /** Hits found. */
+  matches: number;
+  /** Hits replaced. */
+  replaced: number;
+  /**
+   * Hits left as they were: spanning several text objects, inside a
+   * form XObject, or not settable in the object's font.
+   */
+  skipped: number;
+  /** Text objects whose text changed. */
+  objectsChanged: number;
+  /** Pages with at least one replacement. */
+  pages: Array<{ pageIndex: number; replaced: number }>;
+  /** True if cancelled; replacements made so far are kept. */
+  cancelled: boolean;
+}
+
+/**
+ * One mail-merge record: fully-qualified field name → value.  Strings
+ * fill text and choice fields and pick radio export values; booleans
+ * set check boxes.
+ */
+export type PdfMergeRecord = Record<string, string | number | boolean>;
+
+/** Payload for filling a form template once per record. */
+export interface PdfMailMergePayload {
+  /** AcroForm template on disk. */
+  templatePath: string;
+  records: PdfMergeRecord[];
+  /** Directory the filled documents are written to. */
+  outputDir: string;
+  /** Record key whose value names each output file (default: record number). */
+  fileNameField?: string;
+  /** Flatten the filled fields into page content. Default false. */
+  flatten?: boolean;
+  /** Password of an encrypted template. */
+  password?: string;
+}
+
+/** Result of a mail merge. */
+export interface PdfMailMergeResult {
+  /** Documents written. */
+  written: number;
+  /** Records that could not be filled or saved. */
+  failed: Array<{ record: number; error: string }>;
+  /** Record keys that match no field in the template. */
+  unknownFields: string[];
+  elapsedMs: number;
+  documentsPerMinute: number;
+  /** True if cancelled; documents written so far are kept. */
+  cancelled: boolean;
+}
+
+// ── File analysis types ─────────────────────────────────────────────
+
+/**
+ * Progress and cancel key of file analysis, which has no open document.
+ * Only one analysis runs at a time.
+ */
+export const ANALYZE_JOB_ID = 'analysis';
+
+/** Payload for analysing PDF files on disk without opening them. */
+export interface PdfAnalyzePayload {
+  paths: string[];
+  /** Worker threads. Default: one per CPU core. */
+  threads?: number;
+  /** SHA-256 of every raw stream, for finding duplicates. Default false. */
+  hashStreams?: boolean;
+}
+
+/** An image XObject, as stored. */
+export interface PdfImageInventoryEntry {
+  /** Object number. */
+  object: number;
+  width: number;
+  height: number;
+  bitsPerComponent: number;
+  /** Colour space family, e.g. DeviceRGB or ICCBased; empty for stencil masks. */
+  colorSpace: string;
+  /** Last filter of the chain, e.g. DCTDecode; empty if unfiltered. */
+  filter: string;
+  /** Encoded size. */
+  bytes: number;
+}
+
+/** A font dictionary (CID fonts are reported through their Type0 parent). */
+export interface PdfFontInventoryEntry {
+  object: number;
+  baseFont: string;
+  /** Type1, TrueType, Type0, Type3, ... */
+  subtype: string;
+  /** Whether the font program is in the file. */
+  embedded: boolean;
+}
+
+/**
+ * Content operator counts, one entry per page in page order.  Form
+ * XObjects count once per time they are drawn.  All zero for encrypted
+ * files.
+ */
+export interface PdfPageComplexity {
+  operators: Uint32Array;
+  /** m l c v y h re */
+  pathSegments: Uint32Array;
+  /** Fills, strokes and shadings. */
+  paints: Uint32Array;
+  /** Tj TJ ' " */
+  textShows: Uint32Array;
+  /** Inline images and image XObjects drawn. */
+  images: Uint32Array;
+}
+
+/** Structure of one readable file. */
+export interface PdfFileStructure {
+  path: string;
+  /** Header version, e.g. "1.7". */
+  version: string;
+  fileSize: number;
+  /** How objects were located; 'rebuilt' means the xref was damaged. */
+  xref: 'table' | 'stream' | 'rebuilt';
+  /** Strings and streams are encrypted; only structure is reported. */
+  encrypted: boolean;
+  objects: number;
+  streams: number;
+  /** Encoded size of all streams. */
+  streamBytes: number;
+  /** Streams per filter name. */
+  filters: Record<string, number>;
+  images: PdfImageInventoryEntry[];
+  fonts: PdfFontInventoryEntry[];
+  /** Raw (encoded) stream digests, when `hashStreams` was set. */
+  streamHashes?: Array<{ object: number; hash: string }>;
+  pageCount: number;
+  pages: PdfPageComplexity;
+}
+
+/** One analysed file: its structure, or why it could not be read. */
+export type PdfFileAnalysis = PdfFileStructure | { path: string; error: string };
+
+/** Result of analysing files. */
+export interface PdfAnalyzeResult {
+  /** In input order; files not reached before cancellation are absent. */
+  files: PdfFileAnalysis[];
+  elapsedMs: number;
+  cancelled: boolean;
+}
+
+/** Payload for writing a document's images out as files. */
+export interface PdfExtractImagesPayload {
+  docId: string;
+  /** Output directory; created if missing. */
+  outDir: string;
+  /** Page indices (default: all pages). */
+  pages?: number[];
+  /** Writer threads. Default: one per CPU core. */
+  threads?: number;
+}
+
+/** One image written by extractImages, named page<NNNN>-obj<M>.<ext>. */
+export interface PdfExtractedImage {
+  pageIndex: number;
+  objectIndex: number;
+  path: string;
+  format: 'jpeg' | 'jp2' | 'png';
+  /** The embedded stream was written byte for byte, without decoding. */
+  passthrough: boolean;
+}
+
+/** Result of extracting images, sorted by page and object. */
+export interface PdfExtractImagesResult {
+  files: PdfExtractedImage[];
+  /** Images (or pages, with objectIndex -1) that could not be written. */
+  failed: Array<{ pageIndex: number; objectIndex: number; error: string }>;
+  cancelled: boolean;
+}
+
+/** Payload for decoding image previews ahead of selection, at idle priority. */
+export interface PdfPrefetchImagePreviewsPayload {
+  docId: string;
+  /** Page indices (default: all pages). */
+  pages?: number[];
+  /** Longest side of the previews in pixels. Default 512. */
+  maxEdge?: number;
+}
+
+/** Result of prefetching image previews. */
+export interface PdfPrefetchImagePreviewsResult {
+  /** Previews decoded; images already cached are not counted. */
+  decoded: number;
+  cancelled: boolean;
+}
+
+/** Payload for comparing two open documents page by page. */
+export interface PdfCompareDocumentsPayload {
+  /** The original; progress and cancellation are keyed by it. */
+  docIdA: string;
+  /** The revision. */
+  docIdB: string;
+  /** Render resolution. Default 96. */
+  dpi?: number;
+  /**
+   * Page pairs [pageA, pageB], -1 for a page only one side has.
+   * Default: page i with page i.
+   */
+  pairs?: Array<[number, number]>;
+  /** Smallest channel difference (0–255) that counts as a change. Default 32. */
+  threshold?: number;
+  /** Changes closer than this many points share a box. Default 6. */
+  mergeDistance?: number;
+}
+
+/** Where one page pair differs. */
+export interface PdfComparePageDiff {
+  /** -1 when the page only exists in B. */
+  pageA: number;
+  /** -1 when the page only exists in A. */
+  pageB: number;
+  /** Changed pixels at the render resolution; 0 for identical pages. */
+  changedPixels: number;
+  /** left, top, right, bottom per change, in PDF points of pageA (pageB if absent). */
+  boxes: Float32Array;
+  /** Changed pixels inside each box. */
+  boxPixels: Uint32Array;
+}
+
+/**
+ * A compared page as it finishes (main → renderer), with a heatmap of
+ * the largest channel difference per cell, row by row from the top.
+ */
+export interface PdfComparePageEvent extends PdfComparePageDiff {
+  docIdA: string;
+  docIdB: string;
+  heatmap: Uint8Array;
+  heatmapWidth: number;
+  heatmapHeight: number;
+  /** Cell edge in points. */
+  cellPoints: number;
+}
+
+/** Result of comparing two documents. */
+export interface PdfCompareResult {
+  /** In pair order; pairs not reached before cancellation are absent. */
+  pages: PdfComparePageDiff[];
+  changedPages: number;
+  cancelled: boolean;
+}
+
+/** Payload for recognising scanned pages and adding a text layer. */
+export interface PdfOcrPayload {
+  docId: string;
+  /** Page indices (default: all pages). */
+  pages?: number[];
+  /** Also recognise pages that already have text. Default false. */
+  all?: boolean;
+  /** OCR language(s) as traineddata names, e.g. "deu+eng". Default "eng". */
+  language?: string;
+  /** Render resolution. Default 300. */
+  dpi?: number;
+  /** Words recognised with less confidence (0–100) are left out. Default 30. */
+  minConfidence?: number;
+  /** Font of the text layer: a standard-14 name or loadFont reference. */
+  font?: string;
+}
+
+/** Result of an OCR pass. */
+export interface PdfOcrResult {
+  /** Pages given a text layer. */
+  recognised: number;
+  /** Pages skipped because they already have text. */
+  skipped: number;
+  /** Words added across all pages. */
+  words: number;
+  failed: Array<{ pageIndex: number; error: string }>;
+  elapsedMs: number;
+  pagesPerMinute: number;
+  cancelled: boolean;
+}
+
+/** Payload for saving a copy that carries an empty signature field. */
+export interface PdfSignPreparePayload {
+  docId: string;
+  outputPath: string;
+  /** Bytes reserved for the DER signature. Default 16384. */
+  placeholderSize?: number;
+  /** Name of the new signature field. Default "Signature1". */
+  fieldName?: string;
+  /** Signer name, reason and location recorded in the signature. */
+  name?: string;
+  reason?: string;
+  location?: string;
+}
+
+/** `[offset, length, offset, length]` of the bytes a signature covers. */
+export type PdfSignByteRange = [number, number, number, number];
+
+/** What the signer needs to produce a detached signature. */
+export interface PdfSignPrepareResult {
+  outputPath: string;
+  byteRange: PdfSignByteRange;
+  /** SHA-256 of the byte ranges, hex — the CMS messageDigest. */
+  digest: string;
+}
+
+/** Payload for writing a signature into a prepared file. */
+export interface PdfSignEmbedPayload {
+  outputPath: string;
+  byteRange: PdfSignByteRange;
+  /** DER-encoded CMS SignedData (adbe.pkcs7.detached). */
+  signature: Uint8Array;
+}
+
 /** Error payload from PDFium operations. */
 export interface PdfiumErrorPayload {
   code: string;
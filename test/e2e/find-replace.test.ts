@@ -0,0 +1,174 @@
+/**
+ * E2E tests for whole-document find and replace (window.api.pdf.findReplace).
+ *
+ * Verifies:
+ *   1. Plain text → every hit replaced in its text object; page re-renders
+ *   2. Case and whole-word options → only the hits they allow
+ *   3. Regex with groups → $1 substituted
+ *   4. A hit spanning two text objects → skipped, both objects untouched
+ */
+
+/// <reference path="../../src/renderer/global.d.ts" />
+
+import { test, expect } from '@playwright/test';
+import { _electron as electron, ElectronApplication, Page } from 'playwright';
+import * as path from 'path';
+import * as fs from 'fs';
+
+// ── Constants ───────────────────────────────────────────────────────
+
+const MAIN_ENTRY = path.resolve(__dirname, '..', '..', 'dist', 'main', 'index.js');
+const CORPUS_DIR = path.resolve(__dirname, '..', 'fixtures', 'corpus');
+
+/** The text objects of simple-text.pdf, in content order. */
+const SIMPLE_TEXT = [
+  'Hello, PDF Editor!',
+  'This is a simple single-page PDF used for E2E testing.',
+  'It contains only Latin text rendered with the Helvetica font.',
+];
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+let electronApp: ElectronApplication;
+let page: Page;
+
+async function launchApp(): Promise<void> {
+  electronApp = await electron.launch({
+    args: [MAIN_ENTRY],
+    env: { ...process.env, NODE_ENV: 'test' },
+  });
+  page = await electronApp.firstWindow();
+
+  await page.waitForSelector('#status-text', { state: 'attached' });
+  await page.waitForFunction(
+    () => document.getElementById('status-text')?.textContent === 'Ready',
+    { timeout: 15_000 },
+  );
+}
+
+async function closeApp(): Promise<void> {
+  if (electronApp) {
+    await electronApp.close().catch(() => {});
+    await new Promise((r) => setTimeout(r, 2000));
+  }
+}
+
+/** Open a corpus file through the preload API; returns its docId. */
+async function openDocument(fixtureName: string): Promise<string> {
+  const bytes = Array.from(fs.readFileSync(path.join(CORPUS_DIR, fixtureName)));
+  return page.evaluate(async (data) => {
+    const result = await window.api.pdf.open({ data: new Uint8Array(data) });
+    return result.docId;
+  }, bytes);
+}
+
+/** Text of each text object on the first page, in content order. */
+async function pageTexts(docId: string): Promise<string[]> {
+  return page.evaluate(async (id) => {
+    const objects = await window.api.pdf.listObjects({ docId: id, pageIndex: 0 });
+    return objects.filter((o) => o.type === 'text').map((o) => o.text ?? '');
+  }, docId);
+}
+
+type FindReplaceOptions = {
+  regex?: boolean;
+  caseSensitive?: boolean;
+  wholeWord?: boolean;
+};
+
+async function findReplace(
+  docId: string,
+  pattern: string,
+  replacement: string,
+  options: FindReplaceOptions = {},
+) {
+  return page.evaluate(
+    ([id, p, r, o]) => window.api.pdf.findReplace({ docId: id, pattern: p, replacement: r, ...o }),
+    [docId, pattern, replacement, options] as const,
+  );
+}
+
+/** RGBA of the first page at 100 %, through main's bitmap cache. */
+async function renderFirstPage(docId: string): Promise<number[]> {
+  return page.evaluate(async (id) => {
+    const result = await window.api.pdf.renderPage({ docId: id, pageIndex: 0, zoom: 1 });
+    return Array.from(result.image);
+  }, docId);
+}
+
+// ── Cleanup ─────────────────────────────────────────────────────────
+
+test.afterEach(async () => {
+  await closeApp();
+});
+
+// ── Scenario 1: Plain replacement ───────────────────────────────────
+
+test('Scenario 1 — plain text is replaced in every text object', async () => {
+  await launchApp();
+  const docId = await openDocument('simple-text.pdf');
+  expect(await pageTexts(docId)).toEqual(SIMPLE_TEXT);
+  const before = await renderFirstPage(docId);
+
+  const result = await findReplace(docId, 'PDF', 'Doc');
+  expect(result).toEqual({
+    matches: 2,
+    replaced: 2,
+    skipped: 0,
+    objectsChanged: 2,
+    pages: [{ pageIndex: 0, replaced: 2 }],
+    cancelled: false,
+  });
+  expect(await pageTexts(docId)).toEqual([
+    'Hello, Doc Editor!',
+    'This is a simple single-page Doc used for E2E testing.',
+    SIMPLE_TEXT[2],
+  ]);
+
+  // The cached bitmap was dropped: the page renders with the new text.
+  expect(await renderFirstPage(docId)).not.toEqual(before);
+});
+
+// ── Scenario 2: Case and whole-word matching ────────────────────────
+
+test('Scenario 2 — case and whole-word options narrow the hits', async () => {
+  await launchApp();
+  const docId = await openDocument('simple-text.pdf');
+
+  const exactCase = await findReplace(docId, 'pdf', 'Doc', { caseSensitive: true });
+  expect(exactCase.matches).toBe(0);
+  const partWord = await findReplace(docId, 'Edit', 'View', { wholeWord: true });
+  expect(partWord.matches).toBe(0);
+  expect(await pageTexts(docId)).toEqual(SIMPLE_TEXT);
+
+  const anyCase = await findReplace(docId, 'pdf', 'Doc');
+  expect(anyCase.matches).toBe(2);
+  expect(anyCase.replaced).toBe(2);
+});
+
+// ── Scenario 3: Regular expression with groups ──────────────────────
+
+test('Scenario 3 — a regex replacement substitutes its groups', async () => {
+  await launchApp();
+  const docId = await openDocument('simple-text.pdf');
+
+  const result = await findReplace(docId, '(\\w+) font', '$1 typeface', { regex: true });
+  expect(result.matches).toBe(1);
+  expect(result.replaced).toBe(1);
+  expect((await pageTexts(docId))[2])
+    .toBe('It contains only Latin text rendered with the Helvetica typeface.');
+});
+
+// ── Scenario 4: Hits across text objects ────────────────────────────
+
+test('Scenario 4 — a hit spanning two text objects is skipped', async () => {
+  await launchApp();
+  const docId = await openDocument('simple-text.pdf');
+
+  const result = await findReplace(docId, 'Editor![\\s\\S]*?This', 'x', { regex: true });
+  expect(result.matches).toBe(1);
+  expect(result.replaced).toBe(0);
+  expect(result.skipped).toBe(1);
+  expect(result.objectsChanged).toBe(0);
+  expect(await pageTexts(docId)).toEqual(SIMPLE_TEXT);
+});
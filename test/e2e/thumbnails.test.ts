@@ -0,0 +1,148 @@
+/**
+ * E2E tests for the thumbnail store (window.api.pdf.thumbnails and
+ * buildThumbnails): a stored thumbnail is only served while it still
+ * shows its page.
+ *
+ * Verifies:
+ *   1. Build → every page stored; a second build finds them current
+ *   2. Add an ink annotation → that page's thumbnail is stale until rebuilt
+ *   3. Update, then remove an annotation → stale after each edit
+ */
+
+/// <reference path="../../src/renderer/global.d.ts" />
+
+import { test, expect } from '@playwright/test';
+import { _electron as electron, ElectronApplication, Page } from 'playwright';
+import * as path from 'path';
+import * as fs from 'fs';
+
+// ── Constants ───────────────────────────────────────────────────────
+
+const MAIN_ENTRY = path.resolve(__dirname, '..', '..', 'dist', 'main', 'index.js');
+const CORPUS_DIR = path.resolve(__dirname, '..', 'fixtures', 'corpus');
+
+/** A short diagonal stroke in page points, clear of the page's text. */
+const STROKE = [100, 100, 150, 150, 200, 120];
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+let electronApp: ElectronApplication;
+let page: Page;
+
+async function launchApp(): Promise<void> {
+  electronApp = await electron.launch({
+    args: [MAIN_ENTRY],
+    env: { ...process.env, NODE_ENV: 'test' },
+  });
+  page = await electronApp.firstWindow();
+
+  await page.waitForSelector('#status-text', { state: 'attached' });
+  await page.waitForFunction(
+    () => document.getElementById('status-text')?.textContent === 'Ready',
+    { timeout: 15_000 },
+  );
+}
+
+async function closeApp(): Promise<void> {
+  if (electronApp) {
+    await electronApp.close().catch(() => {});
+    await new Promise((r) => setTimeout(r, 2000));
+  }
+}
+
+/** Open a corpus file through the preload API; returns its docId. */
+async function openDocument(fixtureName: string): Promise<string> {
+  const bytes = Array.from(fs.readFileSync(path.join(CORPUS_DIR, fixtureName)));
+  return page.evaluate(async (data) => {
+    const result = await window.api.pdf.open({ data: new Uint8Array(data) });
+    return result.docId;
+  }, bytes);
+}
+
+async function buildThumbnails(docId: string) {
+  return page.evaluate((id) => window.api.pdf.buildThumbnails({ docId: id }), docId);
+}
+
+/**
+ * Whether the store serves a current thumbnail of page `pageIndex`
+ * without rendering one; a stale entry comes back empty.
+ */
+async function hasCurrentThumbnail(docId: string, pageIndex: number): Promise<boolean> {
+  return page.evaluate(async ([id, index]) => {
+    const batch = await window.api.pdf.thumbnails({
+      docId: id, first: index, count: 1, render: false,
+    });
+    return batch.widths[0] > 0 && batch.offsets[1] > batch.offsets[0];
+  }, [docId, pageIndex] as const);
+}
+
+async function addInk(docId: string, pageIndex: number): Promise<number> {
+  return page.evaluate(([id, index, points]) => window.api.pdf.addInk({
+    docId: id,
+    pageIndex: index,
+    stroke: { points: new Float32Array(points), color: [255, 0, 0, 255], width: 3 },
+  }), [docId, pageIndex, STROKE] as const);
+}
+
+// ── Cleanup ─────────────────────────────────────────────────────────
+
+test.afterEach(async () => {
+  await closeApp();
+});
+
+// ── Scenario 1: Building the store ──────────────────────────────────
+
+test('Scenario 1 — a built thumbnail stays current while the page is untouched', async () => {
+  await launchApp();
+  const docId = await openDocument('multi-page.pdf');
+
+  const first = await buildThumbnails(docId);
+  expect(first.failed).toBe(0);
+  expect(first.built).toBeGreaterThan(1);
+  expect(await hasCurrentThumbnail(docId, 0)).toBe(true);
+
+  const second = await buildThumbnails(docId);
+  expect(second).toEqual({ built: 0, current: first.built, failed: 0, cancelled: false });
+});
+
+// ── Scenario 2: Adding an annotation ────────────────────────────────
+
+test('Scenario 2 — adding an ink annotation makes the thumbnail stale', async () => {
+  await launchApp();
+  const docId = await openDocument('multi-page.pdf');
+  await buildThumbnails(docId);
+
+  await addInk(docId, 1);
+  expect(await hasCurrentThumbnail(docId, 1)).toBe(false);
+  // Other pages keep theirs.
+  expect(await hasCurrentThumbnail(docId, 0)).toBe(true);
+
+  const rebuilt = await buildThumbnails(docId);
+  expect(rebuilt.built).toBe(1);
+  expect(await hasCurrentThumbnail(docId, 1)).toBe(true);
+});
+
+// ── Scenario 3: Editing and removing an annotation ──────────────────
+
+test('Scenario 3 — updating or removing an annotation makes the thumbnail stale', async () => {
+  await launchApp();
+  const docId = await openDocument('multi-page.pdf');
+  const annotIndex = await addInk(docId, 0);
+  await buildThumbnails(docId);
+  expect(await hasCurrentThumbnail(docId, 0)).toBe(true);
+
+  const update = await page.evaluate(([id, index]) => window.api.pdf.updateAnnotations({
+    docId: id,
+    updates: [{ pageIndex: 0, index, color: [0, 0, 255, 255] }],
+  }), [docId, annotIndex] as const);
+  expect(update).toEqual({ updated: 1, failed: [] });
+  expect(await hasCurrentThumbnail(docId, 0)).toBe(false);
+
+  await buildThumbnails(docId);
+  expect(await hasCurrentThumbnail(docId, 0)).toBe(true);
+
+  await page.evaluate(([id, index]) => window.api.pdf.removeAnnotation({
+    docId: id, pageIndex: 0, annotIndex: index,
+  }), [docId, annotIndex] as const);
+  expect(await hasCurrentThumbnail(docId, 0)).toBe(false);
+});
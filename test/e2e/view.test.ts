@@ -0,0 +1,329 @@
+/**
+ * E2E tests for the view: how a page is shown, never what it contains.
+ *
+ * Verifies:
+ *   1. Rotate right / left → canvas is the cached raster turned exactly
+ *   2. Four quarter turns → back to the upright pixels
+ *   3. Each reading mode → every pixel mapped as the addon's kernels do
+ *   4. Reading mode on a turned view → filter and turn compose
+ *   5. Thumbnail strip → a small pool of items follows the scroll, each
+ *      showing its page; clicking one navigates
+ */
+
+import { test, expect } from '@playwright/test';
+import { _electron as electron, ElectronApplication, Page } from 'playwright';
+import * as path from 'path';
+
+// ── Constants ───────────────────────────────────────────────────────
+
+const MAIN_ENTRY = path.resolve(__dirname, '..', '..', 'dist', 'main', 'index.js');
+const CORPUS_DIR = path.resolve(__dirname, '..', 'fixtures', 'corpus');
+const RENDER_SETTLE_MS = 1500;
+
+// ── Helpers ─────────────────────────────────────────────────────────
+
+let electronApp: ElectronApplication;
+let page: Page;
+
+async function launchApp(): Promise<void> {
+  electronApp = await electron.launch({
+    args: [MAIN_ENTRY],
+    env: { ...process.env, NODE_ENV: 'test' },
+  });
+  page = await electronApp.firstWindow();
+
+  await page.waitForSelector('#status-text', { state: 'attached' });
+  await page.waitForFunction(
+    () => document.getElementById('status-text')?.textContent === 'Ready',
+    { timeout: 15_000 },
+  );
+}
+
+async function openFixture(fixtureName: string): Promise<void> {
+  const fixturePath = path.join(CORPUS_DIR, fixtureName);
+
+  await electronApp.evaluate(async ({ dialog }, filePath) => {
+    dialog.showOpenDialog = async () => ({
+      canceled: false,
+      filePaths: [filePath],
+    });
+  }, fixturePath);
+
+  await page.click('#btn-open');
+
+  await page.waitForFunction(
+    () => {
+      const st = document.getElementById('status-text')?.textContent ?? '';
+      return st.startsWith('Opened:') || st.startsWith('Failed');
+    },
+    { timeout: 15_000 },
+  );
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+}
+
+async function closeApp(): Promise<void> {
+  if (electronApp) {
+    await electronApp.close();
+    await new Promise((r) => setTimeout(r, 2000));
+  }
+}
+
+/** Keep the page canvas's pixels in the window, under `name`. */
+async function snapshotCanvas(name: string): Promise<{ width: number; height: number }> {
+  return page.evaluate((key) => {
+    const canvas = document.getElementById('page-canvas') as HTMLCanvasElement;
+    const image = canvas.getContext('2d')!.getImageData(0, 0, canvas.width, canvas.height);
+    const store = window as unknown as { __snapshots?: Record<string, ImageData> };
+    store.__snapshots ??= {};
+    store.__snapshots[key] = image;
+    return { width: image.width, height: image.height };
+  }, name);
+}
+
+/** The top-left canvas pixel: blank paper on every corpus page. */
+async function cornerPixel(): Promise<number[]> {
+  return page.evaluate(() => {
+    const canvas = document.getElementById('page-canvas') as HTMLCanvasElement;
+    return Array.from(canvas.getContext('2d')!.getImageData(0, 0, 1, 1).data);
+  });
+}
+
+/** Thumbnail items in use (the pool's free items are hidden). */
+const SHOWN_THUMBNAILS = '#thumbnails-panel .thumbnail-item:not([hidden])';
+
+/** Wait until every shown thumbnail has decoded its page image. */
+async function waitForThumbnails(): Promise<void> {
+  await page.waitForFunction(
+    (selector) => {
+      const images = Array.from(document.querySelectorAll<HTMLImageElement>(`${selector} img`));
+      return images.length > 0 &&
+        images.every((img) => img.src.startsWith('blob:') && img.complete && img.naturalWidth > 0);
+    },
+    SHOWN_THUMBNAILS,
+    { timeout: 10_000 },
+  );
+}
+
+/** Page labels of the shown thumbnails, top to bottom. */
+async function shownThumbnailLabels(): Promise<number[]> {
+  const labels = await page.locator(`${SHOWN_THUMBNAILS} .thumbnail-label`).allTextContents();
+  return labels.map(Number).sort((a, b) => a - b);
+}
+
+type ReadingMode = 'invert' | 'dark' | 'contrast';
+
+/**
+ * Pixels of the canvas that differ from snapshot `name` turned
+ * clockwise by `turns` quarter turns and passed through reading mode
+ * `filter`; -1 if the sizes do not match.
+ */
+async function countMismatches(
+  name: string,
+  turns: number,
+  filter: ReadingMode | null = null,
+): Promise<number> {
+  return page.evaluate(([key, quarterTurns, mode]) => {
+    const store = window as unknown as { __snapshots: Record<string, ImageData> };
+    const before = store.__snapshots[key];
+    const canvas = document.getElementById('page-canvas') as HTMLCanvasElement;
+    const after = canvas.getContext('2d')!.getImageData(0, 0, canvas.width, canvas.height);
+    const w = before.width, h = before.height;
+
+    const t = ((quarterTurns % 4) + 4) % 4;
+    const [aw, ah] = t % 2 ? [h, w] : [w, h];
+    if (after.width !== aw || after.height !== ah) return -1;
+
+    // The reading modes as layers.cc computes them; alpha is kept.
+    const expected = (rgb: number[], c: number): number => {
+      if (mode === 'invert') return 255 - rgb[c];
+      if (mode === 'dark') {
+        const shift = 255 - Math.max(...rgb) - Math.min(...rgb);
+        return 30 + Math.round(((rgb[c] + shift) * 194) / 255);
+      }
+      if (mode === 'contrast') {
+        return Math.min(255, Math.max(0, 128 + (((rgb[c] - 128) * 40) >> 4)));
+      }
+      return rgb[c];
+    };
+
+    let mismatches = 0;
+    for (let y = 0; y < h; y++) {
+      for (let x = 0; x < w; x++) {
+        // Where upright (x, y) lands after the turn.
+        const [dx, dy] = t === 1 ? [h - 1 - y, x]
+          : t === 2 ? [w - 1 - x, h - 1 - y]
+          : t === 3 ? [y, w - 1 - x]
+          : [x, y];
+        const s = (y * w + x) * 4;
+        const d = (dy * aw + dx) * 4;
+        const rgb = [before.data[s], before.data[s + 1], before.data[s + 2]];
+        if (
+          after.data[d] !== expected(rgb, 0) ||
+          after.data[d + 1] !== expected(rgb, 1) ||
+          after.data[d + 2] !== expected(rgb, 2) ||
+          after.data[d + 3] !== before.data[s + 3]
+        ) {
+          mismatches++;
+        }
+      }
+    }
+    return mismatches;
+  }, [name, turns, filter] as const);
+}
+
+// ── Cleanup ─────────────────────────────────────────────────────────
+
+test.afterEach(async () => {
+  await closeApp();
+});
+
+// ── Scenario 1: Rotate the view ─────────────────────────────────────
+
+test('Scenario 1 — rotating the view turns the cached raster exactly', async () => {
+  await launchApp();
+  await openFixture('simple-text.pdf');
+  const upright = await snapshotCanvas('upright');
+  expect(upright.height).toBeGreaterThan(upright.width); // portrait page
+
+  await page.click('#btn-rotate-right');
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+  expect(await countMismatches('upright', 1)).toBe(0);
+  const overlayTransform = await page.evaluate(
+    () => (document.getElementById('overlay-canvas') as HTMLCanvasElement).style.transform,
+  );
+  expect(overlayTransform).toBe('rotate(90deg)');
+
+  // Ctrl+[ turns back, then once more to 270°.
+  await page.keyboard.press('ControlOrMeta+BracketLeft');
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+  expect(await countMismatches('upright', 0)).toBe(0);
+  await page.click('#btn-rotate-left');
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+  expect(await countMismatches('upright', 3)).toBe(0);
+});
+
+// ── Scenario 2: A full turn ─────────────────────────────────────────
+
+test('Scenario 2 — four quarter turns restore the upright page', async () => {
+  await launchApp();
+  await openFixture('simple-text.pdf');
+  const upright = await snapshotCanvas('upright');
+
+  for (let i = 0; i < 2; i++) {
+    await page.click('#btn-rotate-right');
+    await page.waitForTimeout(RENDER_SETTLE_MS);
+  }
+  // 180° is rendered by PDFium (LCD text), so only its size is exact.
+  const half = await snapshotCanvas('half');
+  expect(half).toEqual(upright);
+
+  for (let i = 0; i < 2; i++) {
+    await page.click('#btn-rotate-right');
+    await page.waitForTimeout(RENDER_SETTLE_MS);
+  }
+  expect(await countMismatches('upright', 0)).toBe(0);
+});
+
+// ── Scenario 3: Reading modes ───────────────────────────────────────
+
+test('Scenario 3 — each reading mode maps every pixel of the page', async () => {
+  await launchApp();
+  await openFixture('simple-text.pdf');
+  await snapshotCanvas('upright');
+
+  for (const mode of ['invert', 'dark', 'contrast'] as const) {
+    await page.selectOption('#view-filter', mode);
+    await page.waitForTimeout(RENDER_SETTLE_MS);
+    expect(await countMismatches('upright', 0, mode)).toBe(0);
+  }
+
+  // Contrast leaves white paper white; dark mode makes it grey, not black.
+  expect(await cornerPixel()).toEqual([255, 255, 255, 255]);
+  await page.selectOption('#view-filter', 'dark');
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+  expect(await cornerPixel()).toEqual([30, 30, 30, 255]);
+
+  // Back to normal: the cached raster, untouched.
+  await page.selectOption('#view-filter', 'none');
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+  expect(await countMismatches('upright', 0)).toBe(0);
+});
+
+// ── Scenario 4: Reading mode and rotation together ──────────────────
+
+test('Scenario 4 — a reading mode applies to the turned view', async () => {
+  await launchApp();
+  await openFixture('simple-text.pdf');
+  await snapshotCanvas('upright');
+
+  await page.click('#btn-rotate-right');
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+  await page.selectOption('#view-filter', 'invert');
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+  expect(await countMismatches('upright', 1, 'invert')).toBe(0);
+});
+
+// ── Scenario 5: Virtual thumbnail strip ─────────────────────────────
+
+test('Scenario 5 — the thumbnail strip renders only the rows in view', async () => {
+  const MULTI_PAGE_COUNT = 12;
+  await launchApp();
+  // A short window, so most of the strip is off screen.
+  await electronApp.evaluate(({ BrowserWindow }) => {
+    BrowserWindow.getAllWindows()[0].setSize(1000, 600);
+  });
+  await openFixture('multi-page.pdf');
+  await waitForThumbnails();
+
+  // The strip scrolls as if every row existed; the items are a few of them.
+  const strip = await page.evaluate(() => {
+    const panel = document.getElementById('thumbnails-panel')!;
+    return {
+      scrolls: panel.scrollHeight > panel.clientHeight,
+      items: panel.querySelectorAll('.thumbnail-item').length,
+    };
+  });
+  expect(strip.scrolls).toBe(true);
+  expect(strip.items).toBeLessThan(MULTI_PAGE_COUNT);
+  const top = await shownThumbnailLabels();
+  expect(top[0]).toBe(1);
+  expect(top.length).toBeLessThan(MULTI_PAGE_COUNT);
+
+  // Scrolled to the end, the pool moves onto the last rows.
+  await page.evaluate(() => {
+    const panel = document.getElementById('thumbnails-panel')!;
+    panel.scrollTop = panel.scrollHeight;
+  });
+  await page.waitForFunction(
+    (selector) => Array.from(document.querySelectorAll(`${selector} .thumbnail-label`))
+      .some((label) => label.textContent === '12'),
+    SHOWN_THUMBNAILS,
+    { timeout: 10_000 },
+  );
+  await waitForThumbnails();
+  const bottom = await shownThumbnailLabels();
+  expect(bottom[bottom.length - 1]).toBe(MULTI_PAGE_COUNT);
+  expect(bottom).not.toContain(1);
+  const itemsAfterScroll = await page.locator('#thumbnails-panel .thumbnail-item').count();
+  expect(itemsAfterScroll).toBeLessThan(MULTI_PAGE_COUNT);
+
+  // Clicking a thumbnail goes to its page and marks it active.
+  const last = page.locator(SHOWN_THUMBNAILS, {
+    has: page.locator('.thumbnail-label', { hasText: /^12$/ }),
+  });
+  await last.click();
+  await page.waitForTimeout(RENDER_SETTLE_MS);
+  expect(parseInt(await page.inputValue('#page-input'), 10)).toBe(MULTI_PAGE_COUNT);
+  await expect(last).toHaveClass(/active/);
+
+  // Going back to page 1 scrolls its row into view.
+  await page.fill('#page-input', '1');
+  await page.press('#page-input', 'Enter');
+  await page.waitForFunction(
+    (selector) => Array.from(document.querySelectorAll(`${selector}.active .thumbnail-label`))
+      .some((label) => label.textContent === '1'),
+    SHOWN_THUMBNAILS,
+    { timeout: 10_000 },
+  );
+  await waitForThumbnails();
+});
@@ -0,0 +1,55 @@
+/**
+ * Unit tests for render-scale quantisation: views at nearby zooms and
+ * device pixel ratios must land on the same cached scale, and never on
+ * one below what the screen shows.
+ */
+
+import { test, expect } from '@playwright/test';
+import { quantiseScale } from '../../src/main/render-scale';
+import { RENDER_SCALE_BUCKETS } from '../../src/shared/constants';
+
+test('bucket scales map to themselves', () => {
+  for (const bucket of RENDER_SCALE_BUCKETS) {
+    expect(quantiseScale(bucket)).toBe(bucket);
+  }
+});
+
+test('scales round up to the next bucket', () => {
+  expect(quantiseScale(1.1)).toBe(1.125);
+  expect(quantiseScale(1.1, 1.25)).toBe(1.5);
+  expect(quantiseScale(0.9, 2)).toBe(2);
+  expect(quantiseScale(0.1)).toBe(0.25);
+});
+
+test('zoom and device pixel ratio multiply', () => {
+  expect(quantiseScale(1.2, 1.25)).toBe(1.5);
+  expect(quantiseScale(0.5, 2)).toBe(1);
+  expect(quantiseScale(1.75, 1.5)).toBe(3);
+});
+
+test('float noise above a bucket stays on it', () => {
+  expect(quantiseScale(1.5 * (1 + 1e-9))).toBe(1.5);
+  expect(quantiseScale(1.5 * (1 + 1e-4))).toBe(1.75);
+});
+
+test('never renders below the displayed scale', () => {
+  for (let zoom = 0.25; zoom <= 5; zoom += 0.05) {
+    for (const dpr of [1, 1.25, 1.5, 2, 3]) {
+      const scale = quantiseScale(zoom, dpr);
+      expect(scale).toBeGreaterThanOrEqual(zoom * dpr * (1 - 1e-6));
+      expect(RENDER_SCALE_BUCKETS).toContain(scale);
+    }
+  }
+});
+
+test('past the last bucket, scales round up to 1/64', () => {
+  const last = RENDER_SCALE_BUCKETS[RENDER_SCALE_BUCKETS.length - 1];
+  expect(quantiseScale(last + 1)).toBe(last + 1);
+  expect(quantiseScale(20.01)).toBe(1281 / 64);
+});
+
+test('non-positive scales pass through for the engine to reject', () => {
+  expect(quantiseScale(0)).toBe(0);
+  expect(quantiseScale(-1)).toBe(-1);
+  expect(quantiseScale(NaN)).toBeNaN();
+});